@@ -5,12 +5,16 @@
 #include <unistd.h>
 
 #include <cstdlib>
+#include <fstream>
 #include <iostream>
 #include <thread>
 #include <vector>
 
+#include "libCacheSim/cache.h"
+#include "libCacheSim/hierarchySimulator.h"
+#include "libCacheSim/plugin.h"
+#include "libCacheSim/reader.h"
 #include "myconfig.hpp"
-#include "simulator.hpp"
 #include "utils.hpp"
 
 using namespace std;
@@ -28,30 +32,53 @@ int main(int argc, char* argv[]) {
   Myconfig config(config_path);
   config.print();
 
-  // start L1: generate N cachemiss traces
-  vector<thread> simulator_thread_vec;
+  // the misses of the L1 caches are merged and sent to every L2 cache in
+  // memory, so all L2 sizes are evaluated in one pass over the L1 traces
+  cache_hierarchy_t* hierarchy = create_cache_hierarchy();
+  vector<reader_t*> readers;
+  vector<int> l1_nodes;
   for (int i = 0; i < config.n_l1; i++) {
-    uint64_t cache_size = config.l1_sizes.at(i);
-    string& trace_path = config.l1_trace_path.at(i);
-    string& miss_output_path = config.l1_miss_output_path.at(i);
-    std::thread t(Simulator::gen_miss_trace, cache_algo, cache_size, trace_path,
-                  miss_output_path);
-    simulator_thread_vec.push_back(std::move(t));
+    reader_init_param_t reader_init_params = {
+        .time_field = 1, .obj_id_field = 2, .obj_size_field = 3, .next_access_vtime_field = 4};
+    // see the cacheSimulator example for using csv trace
+    reader_init_params.binary_fmt_str = "<IQIQ";
+    reader_t* reader = open_trace(config.l1_trace_path.at(i).c_str(), BIN_TRACE, &reader_init_params);
+    readers.push_back(reader);
+
+    int trace = hierarchy_add_trace(hierarchy, reader);
+    common_cache_params_t cc_params = {.cache_size = config.l1_sizes.at(i)};
+    cache_t* cache = create_cache(cache_algo.c_str(), cc_params, nullptr);
+    l1_nodes.push_back(hierarchy_add_cache(hierarchy, cache, &trace, 1));
   }
 
-  for (auto& t : simulator_thread_vec) {
-    t.join();
+  vector<int> l2_nodes;
+  for (auto l2_size : config.l2_sizes) {
+    common_cache_params_t cc_params = {.cache_size = l2_size};
+    cache_t* cache = create_cache(cache_algo.c_str(), cc_params, nullptr);
+    l2_nodes.push_back(hierarchy_add_cache(hierarchy, cache, l1_nodes.data(), l1_nodes.size()));
   }
 
-  // create L2 traces
-  std::cout << "************* create L2 trace "
-            << TraceUtils::merge_l1_trace(config.l1_miss_output_path,
-                                          config.l2_trace_path)
-            << " req" << std::endl;
+  cache_stat_t* stat = simulate_cache_hierarchy(hierarchy, std::thread::hardware_concurrency());
+
+  for (int i = 0; i < config.n_l1; i++) {
+    const cache_stat_t& s = stat[l1_nodes.at(i)];
+    std::cout << config.l1_trace_path.at(i) << ", object miss ratio " << (double)s.n_miss / s.n_req << std::endl;
+  }
 
-  // start L2: get a MRC
-  Simulator::output_mrc(cache_algo, config.l2_sizes, config.l2_trace_path,
-                        config.l2_mrc_output_path);
+  std::ofstream mrc_ofs(config.l2_mrc_output_path);
+  const cache_stat_t& l2_first = stat[l2_nodes.at(0)];
+  mrc_ofs << "# L2, " << l2_first.n_req << " req, " << l2_first.n_req_byte << " byte" << std::endl;
+  mrc_ofs << "# cache size, miss_cnt, miss_byte" << std::endl;
+  for (auto node : l2_nodes) {
+    mrc_ofs << stat[node].cache_size << "," << stat[node].n_miss << "," << stat[node].n_miss_byte << std::endl;
+  }
+  mrc_ofs.close();
+
+  free(stat);
+  free_cache_hierarchy(hierarchy);
+  for (auto reader : readers) {
+    close_trace(reader);
+  }
 
   return 0;
-}
\ No newline at end of file
+}
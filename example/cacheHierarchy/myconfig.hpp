@@ -31,8 +31,6 @@ class Myconfig {
   std::vector<uint64_t> l2_sizes;  // L2 size to evaluate
 
   std::vector<std::string> l1_names;
-  std::vector<std::string> l1_miss_output_path;
-  std::string l2_trace_path;
   std::string l2_mrc_output_path;
 
   explicit Myconfig(std::string& path) : config_path(path) {
@@ -56,7 +54,7 @@ class Myconfig {
     }
     std::cout << "L2 evaluate sizes ";
     for (auto& sz : l2_sizes_str) std::cout << sz << ",";
-    std::cout << ", output " << l2_trace_path << std::endl;
+    std::cout << ", output " << l2_mrc_output_path << std::endl;
     std::cout << "************************* simulation start "
                  "*************************"
               << std::endl;
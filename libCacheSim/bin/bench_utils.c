@@ -0,0 +1,62 @@
+
+#define _GNU_SOURCE
+#include "bench_utils.h"
+
+#include <stdlib.h>
+
+#include "../include/libCacheSim/logging.h"
+#include "cli_reader_utils.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+void load_mem_trace(const char *trace_type_str, const char *trace_path, int64_t n_req_cap, mem_trace_t *trace) {
+  reader_t *reader = create_reader(trace_type_str, trace_path, NULL, n_req_cap, false, 1);
+  cal_working_set_size(reader, &trace->wss_obj, &trace->wss_byte);
+
+  int64_t n_req = get_num_of_req(reader);
+  if (n_req_cap > 0 && n_req_cap < n_req) n_req = n_req_cap;
+
+  trace->reqs = malloc(sizeof(mem_req_t) * (n_req > 0 ? n_req : 1));
+  if (trace->reqs == NULL) {
+    ERROR("cannot allocate %lld requests\n", (long long)n_req);
+  }
+  trace->n_req = 0;
+  request_t *req = new_request();
+  while (trace->n_req < n_req && read_one_req(reader, req) == 0) {
+    mem_req_t *r = &trace->reqs[trace->n_req++];
+    r->clock_time = req->clock_time;
+    r->obj_id = req->obj_id;
+    r->obj_size = req->obj_size;
+    r->next_access_vtime = req->next_access_vtime;
+  }
+
+  free_request(req);
+  close_reader(reader);
+}
+
+void free_mem_trace(mem_trace_t *trace) {
+  free(trace->reqs);
+  trace->reqs = NULL;
+  trace->n_req = 0;
+}
+
+void write_json_str(FILE *f, const char *s) {
+  fputc('"', f);
+  for (; *s != '\0'; s++) {
+    if (*s == '"' || *s == '\\') {
+      fputc('\\', f);
+      fputc(*s, f);
+    } else if ((unsigned char)*s < 0x20) {
+      fprintf(f, "\\u%04x", (unsigned char)*s);
+    } else {
+      fputc(*s, f);
+    }
+  }
+  fputc('"', f);
+}
+
+#ifdef __cplusplus
+}
+#endif
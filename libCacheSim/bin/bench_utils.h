@@ -0,0 +1,60 @@
+#pragma once
+
+// the helpers shared by the benchmark tools (cacheBench, concurrentReplay)
+
+#include <stdio.h>
+#include <time.h>
+
+#include "../include/libCacheSim/reader.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* the fields of a request used by the eviction algorithms */
+typedef struct {
+  int64_t clock_time;
+  obj_id_t obj_id;
+  int64_t obj_size;
+  int64_t next_access_vtime;
+} mem_req_t;
+
+/* the requests of a trace loaded in memory so that the time of a benchmark
+ * does not include reading the trace */
+typedef struct {
+  mem_req_t *reqs;
+  int64_t n_req;
+  int64_t wss_obj;
+  int64_t wss_byte;
+} mem_trace_t;
+
+static inline int64_t now_ns(void) {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (int64_t)ts.tv_sec * 1000000000LL + ts.tv_nsec;
+}
+
+static inline void mem_req_to_req(const mem_req_t *r, request_t *req) {
+  req->clock_time = r->clock_time;
+  req->obj_id = r->obj_id;
+  req->obj_size = r->obj_size;
+  req->next_access_vtime = r->next_access_vtime;
+}
+
+/**
+ * @brief load the first n_req_cap requests (all if n_req_cap <= 0) of a
+ * trace and compute its working set size
+ */
+void load_mem_trace(const char *trace_type_str, const char *trace_path, int64_t n_req_cap, mem_trace_t *trace);
+
+void free_mem_trace(mem_trace_t *trace);
+
+/**
+ * @brief write a quoted JSON string, escaping quotes, backslashes and
+ * control characters
+ */
+void write_json_str(FILE *f, const char *s);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,231 @@
+#define _GNU_SOURCE
+#include <argp.h>
+#include <stdbool.h>
+#include <string.h>
+
+#include "../../include/libCacheSim/const.h"
+#include "../../include/libCacheSim/logging.h"
+#include "../../utils/include/mystr.h"
+#include "../cachesim/cache_init.h"
+#include "../cli_reader_utils.h"
+#include "internal.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#ifndef BENCH_DATA_DIR
+#define BENCH_DATA_DIR "../data"
+#endif
+
+const char *argp_program_version = "cacheBench 0.0.1";
+const char *argp_program_bug_address = "https://groups.google.com/g/libcachesim/";
+
+/* fixed seeds so that the workloads are the same across runs */
+static const char *default_synthetic_workloads[] = {
+    "zipf:alpha=0.8,n_obj=1e6;n_req=5e6,seed=1",
+    "zipf:alpha=1.0,n_obj=1e6;n_req=5e6,seed=1",
+    "zipf:alpha=1.0,n_obj=1e6,weight=0.8;scan:weight=0.2;n_req=5e6,seed=1",
+};
+
+enum argp_option_short {
+  OPTION_TRACE = 'r',
+  OPTION_SYNTHETIC = 's',
+  OPTION_EVICTION_ALGO = 'a',
+  OPTION_CACHE_SIZE = 'c',
+  OPTION_WARMUP_RATIO = 'w',
+  OPTION_REPEAT = 'p',
+  OPTION_NUM_REQ = 'n',
+  OPTION_OUTPUT_PATH = 'o',
+  OPTION_LABEL = 'l',
+  OPTION_VERBOSE = 'v',
+};
+
+/*
+   OPTIONS.  Field 1 in ARGP.
+   Order of fields: {NAME, KEY, ARG, FLAGS, DOC}.
+*/
+static struct argp_option options[] = {
+    {"trace", OPTION_TRACE, "path,type", 0,
+     "A trace to benchmark, e.g., ../data/cloudPhysicsIO.vscsi,vscsi, can be used multiple times", 1},
+    {"synthetic", OPTION_SYNTHETIC, "spec", 0,
+     "A synthetic workload to benchmark, e.g., \"zipf:alpha=1.0,n_obj=1e6;n_req=1e7,seed=1\", can be used multiple "
+     "times",
+     1},
+    {"algo", OPTION_EVICTION_ALGO, "lru,s3fifo", 0, "The eviction algorithms, default all built-in algorithms", 2},
+    {"cache-size", OPTION_CACHE_SIZE, "0.01,0.1", 0, "The cache sizes as fractions of the working set size", 2},
+    {"warmup", OPTION_WARMUP_RATIO, "0.2", 0, "The fraction of requests used to warm up the cache, not timed", 3},
+    {"repeat", OPTION_REPEAT, "3", 0, "Run each case repeat times and report the fastest run", 3},
+    {"num-req", OPTION_NUM_REQ, "-1", 0, "Num of requests to use from each workload, default -1 means all", 3},
+    {"output", OPTION_OUTPUT_PATH, "bench.json", 0, "The output path of the JSON results", 4},
+    {"label", OPTION_LABEL, "label", 0, "A label stored in the results, e.g., the commit", 4},
+    {"verbose", OPTION_VERBOSE, "1", 0, "Produce verbose output", 4},
+
+    {0}};
+
+static void add_workload(struct arguments *arguments, const char *trace_path, const char *trace_type_str,
+                         const char *name) {
+  if (arguments->n_workload == BENCH_MAX_N_WORKLOAD) {
+    ERROR("at most %d workloads are supported\n", BENCH_MAX_N_WORKLOAD);
+  }
+
+  bench_workload_t *workload = &arguments->workloads[arguments->n_workload++];
+  workload->trace_path = trace_path;
+  workload->trace_type_str = trace_type_str;
+  workload->name = name;
+}
+
+/*
+   PARSER. Field 2 in ARGP.
+   Order of parameters: KEY, ARG, STATE.
+*/
+static error_t parse_opt(int key, char *arg, struct argp_state *state) {
+  struct arguments *arguments = state->input;
+
+  switch (key) {
+    case OPTION_TRACE: {
+      char *trace_path = strsep(&arg, ",");
+      add_workload(arguments, trace_path, arg == NULL ? "auto" : arg, mybasename(trace_path));
+      break;
+    }
+    case OPTION_SYNTHETIC:
+      add_workload(arguments, arg, "synthetic", arg);
+      break;
+    case OPTION_EVICTION_ALGO: {
+      char *algo;
+      while ((algo = strsep(&arg, ",")) != NULL) {
+        if (arguments->n_eviction_algo == BENCH_MAX_N_ALGO) {
+          ERROR("at most %d algorithms are supported\n", BENCH_MAX_N_ALGO);
+        }
+        arguments->eviction_algo[arguments->n_eviction_algo++] = algo;
+      }
+      break;
+    }
+    case OPTION_CACHE_SIZE: {
+      arguments->n_cache_size = 0;
+      char *size;
+      while ((size = strsep(&arg, ",")) != NULL) {
+        if (arguments->n_cache_size == BENCH_MAX_N_CACHE_SIZE) {
+          ERROR("at most %d cache sizes are supported\n", BENCH_MAX_N_CACHE_SIZE);
+        }
+        double ratio = strtod(size, NULL);
+        if (ratio <= 0 || ratio > 1) {
+          ERROR("cache size %s should be a fraction of the working set size in (0, 1]\n", size);
+        }
+        arguments->cache_size_ratios[arguments->n_cache_size++] = ratio;
+      }
+      break;
+    }
+    case OPTION_WARMUP_RATIO:
+      arguments->warmup_ratio = strtod(arg, NULL);
+      if (arguments->warmup_ratio < 0 || arguments->warmup_ratio >= 1) {
+        ERROR("warmup ratio should be in [0, 1)\n");
+      }
+      break;
+    case OPTION_REPEAT:
+      arguments->repeat = atoi(arg);
+      if (arguments->repeat <= 0) {
+        ERROR("repeat should be positive\n");
+      }
+      break;
+    case OPTION_NUM_REQ:
+      arguments->n_req = atoll(arg);
+      break;
+    case OPTION_OUTPUT_PATH:
+      strncpy(arguments->ofilepath, arg, OFILEPATH_LEN - 1);
+      break;
+    case OPTION_LABEL:
+      arguments->label = arg;
+      break;
+    case OPTION_VERBOSE:
+      arguments->verbose = is_true(arg) ? true : false;
+      break;
+    case ARGP_KEY_ARG:
+      printf("cacheBench does not take positional arguments, found %s\n", arg);
+      argp_usage(state);
+      exit(1);
+    default:
+      return ARGP_ERR_UNKNOWN;
+  }
+  return 0;
+}
+
+/*
+   ARGS_DOC. Field 3 in ARGP.
+   A description of the non-option command-line arguments
+     that we accept.
+*/
+static char args_doc[] = "";
+
+/* Program documentation. */
+static char doc[] =
+    "example: ./bin/cacheBench -o bench.json\n\n"
+    "measure the throughput, metadata size and peak memory of eviction algorithms "
+    "on the bundled traces and synthetic workloads, and write the results as JSON, "
+    "use scripts/bench_compare.py to compare the results of two runs\n\n"
+    "each case runs in a forked process so that the memory usage is measured "
+    "separately and a crash does not stop the benchmark\n\n";
+
+/**
+ * @brief initialize the arguments
+ *
+ * @param args
+ */
+static void init_arg(struct arguments *args) {
+  memset(args, 0, sizeof(struct arguments));
+
+  args->cache_size_ratios[0] = 0.01;
+  args->cache_size_ratios[1] = 0.1;
+  args->n_cache_size = 2;
+  args->warmup_ratio = 0.2;
+  args->repeat = 3;
+  args->n_req = -1;
+  args->label = "";
+  args->verbose = true;
+  strcpy(args->ofilepath, "bench.json");
+}
+
+/**
+ * @brief parse the command line arguments
+ *
+ * @param argc
+ * @param argv
+ */
+void parse_cmd(int argc, char *argv[], struct arguments *args) {
+  init_arg(args);
+
+  static struct argp argp = {.options = options,
+                             .parser = parse_opt,
+                             .args_doc = args_doc,
+                             .doc = doc,
+                             .children = NULL,
+                             .help_filter = NULL,
+                             .argp_domain = NULL};
+
+  argp_parse(&argp, argc, argv, 0, 0, args);
+
+  if (args->n_workload == 0) {
+    add_workload(args, BENCH_DATA_DIR "/cloudPhysicsIO.oracleGeneral.bin", "oracleGeneral",
+                 "cloudPhysicsIO.oracleGeneral.bin");
+    add_workload(args, BENCH_DATA_DIR "/cloudPhysicsIO.vscsi", "vscsi", "cloudPhysicsIO.vscsi");
+    for (size_t i = 0; i < sizeof(default_synthetic_workloads) / sizeof(default_synthetic_workloads[0]); i++) {
+      add_workload(args, default_synthetic_workloads[i], "synthetic", default_synthetic_workloads[i]);
+    }
+  }
+
+  /* the algorithms in the registry that do not need an oracle trace or
+   * optional modules */
+  if (args->n_eviction_algo == 0) {
+    for (size_t i = 0; i < N_CACHE_ALGO; i++) {
+      if (cache_algo_registry[i].flags & CACHE_ALGO_NOT_DEFAULT) continue;
+      if (args->n_eviction_algo == BENCH_MAX_N_ALGO) {
+        ERROR("at most %d algorithms are supported\n", BENCH_MAX_N_ALGO);
+      }
+      args->eviction_algo[args->n_eviction_algo++] = cache_algo_registry[i].name;
+    }
+  }
+}
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,66 @@
+#pragma once
+
+#include <inttypes.h>
+
+#include "../../include/libCacheSim/cache.h"
+#include "../../include/libCacheSim/enum.h"
+#include "../../include/libCacheSim/reader.h"
+
+#define BENCH_MAX_N_WORKLOAD 16
+#define BENCH_MAX_N_ALGO 64
+#define BENCH_MAX_N_CACHE_SIZE 16
+#define OFILEPATH_LEN 256
+
+typedef struct {
+  const char *trace_path;
+  const char *trace_type_str;
+  /* the name in the results, the file name of the trace */
+  const char *name;
+} bench_workload_t;
+
+/* This structure is used to communicate with parse_opt. */
+struct arguments {
+  bench_workload_t workloads[BENCH_MAX_N_WORKLOAD];
+  int n_workload;
+
+  const char *eviction_algo[BENCH_MAX_N_ALGO];
+  int n_eviction_algo;
+
+  /* the cache sizes are fractions of the working set size (in bytes) */
+  double cache_size_ratios[BENCH_MAX_N_CACHE_SIZE];
+  int n_cache_size;
+
+  /* the requests used to warm up the cache, which are not timed */
+  double warmup_ratio;
+  /* each case is run repeat times and the fastest run is reported */
+  int repeat;
+  int64_t n_req;
+
+  char ofilepath[OFILEPATH_LEN];
+  /* a free-form label of the run, e.g., the commit */
+  const char *label;
+  bool verbose;
+};
+
+/* the result of one (workload, algorithm, cache size) case */
+typedef struct {
+  bool success;
+  int64_t cache_size;
+  int64_t n_warmup_req;
+  int64_t n_req;
+  int64_t n_miss;
+  /* the fastest of the repeated runs */
+  double elapsed_sec;
+  /* the number of objects in the cache at the end */
+  int64_t n_obj_cached;
+  /* the heap allocated when the cache is created, e.g., the hash table */
+  int64_t fixed_md_byte;
+  /* the heap allocated during the run */
+  int64_t obj_md_byte;
+  int64_t peak_rss_byte;
+  /* the resident size before the cache is created, which includes the
+   * requests loaded in memory */
+  int64_t base_rss_byte;
+} bench_result_t;
+
+void parse_cmd(int argc, char *argv[], struct arguments *args);
@@ -0,0 +1,259 @@
+//
+//  benchmark the throughput and memory usage of eviction algorithms
+//
+//  the requests of a workload are loaded in memory before the benchmark so
+//  that the time does not include reading the trace, then each case (workload,
+//  algorithm, cache size) runs in a forked process, which warms up the cache,
+//  times the rest of the requests, and measures the heap allocated by the
+//  cache and the peak RSS of the process
+//
+
+#define _GNU_SOURCE
+#include <errno.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/resource.h>
+#include <sys/time.h>
+#include <sys/wait.h>
+#include <time.h>
+#include <unistd.h>
+
+#if defined(__GLIBC__) && (__GLIBC__ > 2 || (__GLIBC__ == 2 && __GLIBC_MINOR__ >= 33))
+#include <malloc.h>
+#define BENCH_HAS_MALLINFO2
+#endif
+
+#include "../../include/libCacheSim/const.h"
+#include "../../include/libCacheSim/logging.h"
+#include "../bench_utils.h"
+#include "../cachesim/cache_init.h"
+#include "../cli_reader_utils.h"
+#include "internal.h"
+
+#ifndef BENCH_BUILD_TYPE
+#define BENCH_BUILD_TYPE "unknown"
+#endif
+
+/* the bytes allocated on the heap, the RSS if mallinfo2 is not available */
+static int64_t heap_byte(void) {
+#ifdef BENCH_HAS_MALLINFO2
+  struct mallinfo2 mi = mallinfo2();
+  return (int64_t)(mi.uordblks + mi.hblkhd);
+#else
+  long rss = 0;
+  FILE *f = fopen("/proc/self/statm", "r");
+  if (f != NULL) {
+    if (fscanf(f, "%*s %ld", &rss) != 1) rss = 0;
+    fclose(f);
+  }
+  return (int64_t)rss * sysconf(_SC_PAGESIZE);
+#endif
+}
+
+static int64_t curr_rss_byte(void) {
+  long rss = 0;
+  FILE *f = fopen("/proc/self/statm", "r");
+  if (f != NULL) {
+    if (fscanf(f, "%*s %ld", &rss) != 1) rss = 0;
+    fclose(f);
+  }
+  return (int64_t)rss * sysconf(_SC_PAGESIZE);
+}
+
+static int64_t peak_rss_byte(void) {
+  struct rusage usage;
+  getrusage(RUSAGE_SELF, &usage);
+#ifdef __APPLE__
+  return (int64_t)usage.ru_maxrss;
+#else
+  return (int64_t)usage.ru_maxrss * 1024;
+#endif
+}
+
+/* run one case in the current process */
+static void run_case(const mem_trace_t *trace, const char *trace_path, const char *algo, int64_t cache_size,
+                     double warmup_ratio, bench_result_t *result) {
+  memset(result, 0, sizeof(bench_result_t));
+  result->cache_size = cache_size;
+  result->base_rss_byte = curr_rss_byte();
+
+  int64_t heap_start = heap_byte();
+  cache_t *cache = create_cache(trace_path, algo, cache_size, NULL, false);
+  int64_t heap_created = heap_byte();
+
+  request_t *req = new_request();
+  req->op = OP_GET;
+  int64_t n_warmup_req = (int64_t)(trace->n_req * warmup_ratio);
+  for (int64_t i = 0; i < n_warmup_req; i++) {
+    mem_req_to_req(&trace->reqs[i], req);
+    cache->get(cache, req);
+  }
+
+  int64_t n_miss = 0;
+  int64_t start_ns = now_ns();
+  for (int64_t i = n_warmup_req; i < trace->n_req; i++) {
+    mem_req_to_req(&trace->reqs[i], req);
+    n_miss += !cache->get(cache, req);
+  }
+  int64_t end_ns = now_ns();
+
+  result->success = true;
+  result->n_warmup_req = n_warmup_req;
+  result->n_req = trace->n_req - n_warmup_req;
+  result->n_miss = n_miss;
+  result->elapsed_sec = (double)(end_ns - start_ns) / 1e9;
+  result->n_obj_cached = cache->get_n_obj(cache);
+  result->fixed_md_byte = heap_created - heap_start;
+  result->obj_md_byte = heap_byte() - heap_created;
+  result->peak_rss_byte = peak_rss_byte();
+
+  free_request(req);
+  cache->cache_free(cache);
+}
+
+/* run one case in a child process, return false if the child fails */
+static bool run_case_in_child(const mem_trace_t *trace, const char *trace_path, const char *algo,
+                              int64_t cache_size, double warmup_ratio, bench_result_t *result) {
+  int fds[2];
+  if (pipe(fds) != 0) {
+    ERROR("cannot create pipe: %s\n", strerror(errno));
+  }
+
+  fflush(stdout);
+  fflush(stderr);
+  pid_t pid = fork();
+  if (pid < 0) {
+    ERROR("fork failed: %s\n", strerror(errno));
+  }
+
+  if (pid == 0) {
+    close(fds[0]);
+    run_case(trace, trace_path, algo, cache_size, warmup_ratio, result);
+    ssize_t n = write(fds[1], result, sizeof(bench_result_t));
+    close(fds[1]);
+    _exit(n == (ssize_t)sizeof(bench_result_t) ? 0 : 1);
+  }
+
+  close(fds[1]);
+  ssize_t n_read = 0;
+  while (n_read < (ssize_t)sizeof(bench_result_t)) {
+    ssize_t n = read(fds[0], (char *)result + n_read, sizeof(bench_result_t) - n_read);
+    if (n <= 0) break;
+    n_read += n;
+  }
+  close(fds[0]);
+
+  int status;
+  waitpid(pid, &status, 0);
+  if (n_read != (ssize_t)sizeof(bench_result_t) || !WIFEXITED(status) || WEXITSTATUS(status) != 0) {
+    WARN("%s cache size %lld failed (status %d)\n", algo, (long long)cache_size, status);
+    memset(result, 0, sizeof(bench_result_t));
+    result->cache_size = cache_size;
+    return false;
+  }
+  return true;
+}
+
+static void write_json_result(FILE *f, const char *workload, const char *algo, double cache_size_ratio,
+                              const bench_result_t *result) {
+  fprintf(f, "    {\"workload\": ");
+  write_json_str(f, workload);
+  fprintf(f, ", \"algo\": ");
+  write_json_str(f, algo);
+  fprintf(f, ", \"cache_size_ratio\": %g, \"cache_size\": %lld, \"success\": %s", cache_size_ratio,
+          (long long)result->cache_size, result->success ? "true" : "false");
+  if (result->success) {
+    double n_req = (double)result->n_req;
+    fprintf(f,
+            ", \"n_warmup_req\": %lld, \"n_req\": %lld, \"miss_ratio\": %.6f, "
+            "\"req_per_sec\": %.0f, \"ns_per_get\": %.2f, \"n_obj_cached\": %lld, "
+            "\"md_byte_per_obj\": %.2f, \"fixed_md_byte\": %lld, \"peak_rss_byte\": %lld, "
+            "\"base_rss_byte\": %lld",
+            (long long)result->n_warmup_req, (long long)result->n_req, result->n_miss / n_req,
+            n_req / result->elapsed_sec, result->elapsed_sec * 1e9 / n_req, (long long)result->n_obj_cached,
+            result->n_obj_cached > 0 ? (double)result->obj_md_byte / result->n_obj_cached : 0.0,
+            (long long)result->fixed_md_byte, (long long)result->peak_rss_byte, (long long)result->base_rss_byte);
+  }
+  fprintf(f, "}");
+}
+
+int main(int argc, char **argv) {
+  struct arguments args;
+  parse_cmd(argc, argv, &args);
+
+  FILE *f = fopen(args.ofilepath, "w");
+  if (f == NULL) {
+    ERROR("cannot open %s: %s\n", args.ofilepath, strerror(errno));
+  }
+
+  char hostname[128] = "unknown";
+  gethostname(hostname, sizeof(hostname) - 1);
+  fprintf(f, "{\n  \"version\": 1,\n  \"label\": ");
+  write_json_str(f, args.label);
+  fprintf(f, ",\n  \"host\": ");
+  write_json_str(f, hostname);
+  fprintf(f, ",\n  \"build_type\": ");
+  write_json_str(f, BENCH_BUILD_TYPE);
+  fprintf(f, ",\n  \"timestamp\": %lld,\n", (long long)time(NULL));
+  fprintf(f, "  \"warmup_ratio\": %g,\n  \"repeat\": %d,\n  \"results\": [\n", args.warmup_ratio, args.repeat);
+
+  bool first = true;
+  for (int w = 0; w < args.n_workload; w++) {
+    const bench_workload_t *workload = &args.workloads[w];
+    if (strcmp(workload->trace_type_str, "synthetic") != 0 && access(workload->trace_path, R_OK) != 0) {
+      WARN("skip %s: %s\n", workload->trace_path, strerror(errno));
+      continue;
+    }
+
+    mem_trace_t trace;
+    load_mem_trace(workload->trace_type_str, workload->trace_path, args.n_req, &trace);
+    if (args.verbose) {
+      INFO("workload %s: %lld req, working set %lld bytes\n", workload->name, (long long)trace.n_req,
+           (long long)trace.wss_byte);
+    }
+
+    for (int a = 0; a < args.n_eviction_algo; a++) {
+      for (int s = 0; s < args.n_cache_size; s++) {
+        int64_t cache_size = (int64_t)(trace.wss_byte * args.cache_size_ratios[s]);
+        if (cache_size <= 0) cache_size = 1;
+
+        /* report the fastest run, the other metrics are deterministic, a
+         * case that fails in any run is reported as failed */
+        bench_result_t result, best;
+        memset(&best, 0, sizeof(best));
+        for (int r = 0; r < args.repeat; r++) {
+          if (!run_case_in_child(&trace, workload->trace_path, args.eviction_algo[a], cache_size,
+                                 args.warmup_ratio, &result)) {
+            best = result;
+            break;
+          }
+          if (r == 0 || result.elapsed_sec < best.elapsed_sec) {
+            best = result;
+          }
+        }
+
+        if (args.verbose && best.success) {
+          printf("%-24.24s %-12s %.4f cache size %12lld, miss ratio %.4f, %8.2f ns/get, %6.1f md byte/obj, peak rss %lld MiB\n",
+                 workload->name, args.eviction_algo[a], args.cache_size_ratios[s], (long long)cache_size,
+                 (double)best.n_miss / best.n_req, best.elapsed_sec * 1e9 / best.n_req,
+                 best.n_obj_cached > 0 ? (double)best.obj_md_byte / best.n_obj_cached : 0.0,
+                 (long long)(best.peak_rss_byte / MiB));
+          fflush(stdout);
+        }
+
+        fprintf(f, "%s", first ? "" : ",\n");
+        write_json_result(f, workload->name, args.eviction_algo[a], args.cache_size_ratios[s], &best);
+        first = false;
+      }
+    }
+
+    free_mem_trace(&trace);
+  }
+
+  fprintf(f, "\n  ]\n}\n");
+  fclose(f);
+  INFO("results are written to %s\n", args.ofilepath);
+
+  return 0;
+}
@@ -12,6 +12,117 @@
 extern "C" {
 #endif
 
+/* the algorithm uses the future requests, which are only in oracleGeneral
+ * and lcs traces */
+#define CACHE_ALGO_ORACLE 0x1
+/* an old version, a variant for experiments or not an eviction algorithm */
+#define CACHE_ALGO_EXPERIMENTAL 0x2
+/* built only with an optional module, e.g., xgboost or LightGBM */
+#define CACHE_ALGO_OPTIONAL 0x4
+/* another name of the algorithm in the previous entry */
+#define CACHE_ALGO_ALIAS 0x8
+/* the algorithm uses a smaller hash table */
+#define CACHE_ALGO_SMALL_HASHTABLE 0x10
+
+/* the algorithms that are not benchmarked by default */
+#define CACHE_ALGO_NOT_DEFAULT (CACHE_ALGO_ORACLE | CACHE_ALGO_EXPERIMENTAL | CACHE_ALGO_OPTIONAL | CACHE_ALGO_ALIAS)
+
+typedef struct {
+  const char *name;
+  cache_init_func_ptr init;
+  unsigned int flags;
+} cache_algo_t;
+
+/* the algorithms that create_cache can create, matched case-insensitively */
+static const cache_algo_t cache_algo_registry[] = {
+    {"lru", LRU_init, 0},
+    {"fifo", FIFO_init, 0},
+    {"arc", ARC_init, 0},
+    {"arcv0", ARCv0_init, CACHE_ALGO_EXPERIMENTAL},
+    {"lhd", LHD_init, 0},
+    {"random", Random_init, 0},
+    {"randomTwo", RandomTwo_init, 0},
+    {"lfu", LFU_init, 0},
+    {"gdsf", GDSF_init, 0},
+    {"lfuda", LFUDA_init, 0},
+    {"twoq", TwoQ_init, 0},
+    {"2q", TwoQ_init, CACHE_ALGO_ALIAS},
+    {"slru", SLRU_init, 0},
+    {"slruv0", SLRUv0_init, CACHE_ALGO_EXPERIMENTAL},
+    {"hyperbolic", Hyperbolic_init, CACHE_ALGO_SMALL_HASHTABLE},
+    {"lecar", LeCaR_init, 0},
+    {"lecarv0", LeCaRv0_init, CACHE_ALGO_EXPERIMENTAL},
+    {"RandomLRU", RandomLRU_init, CACHE_ALGO_EXPERIMENTAL},
+    {"cacheus", Cacheus_init, 0},
+    {"size", Size_init, CACHE_ALGO_EXPERIMENTAL},
+    {"lfucpp", LFUCpp_init, CACHE_ALGO_EXPERIMENTAL},
+    {"evolve", EvolveCache_init, CACHE_ALGO_EXPERIMENTAL},
+    {"evolveCPP", EvolveComplete_init, CACHE_ALGO_EXPERIMENTAL},
+    /* create_cache adds window-size=0.01 to the parameters */
+    {"tinyLFU", WTinyLFU_init, 0},
+    {"wtinyLFU", WTinyLFU_init, 0},
+    {"belady", Belady_init, CACHE_ALGO_ORACLE},
+    {"nop", nop_init, CACHE_ALGO_EXPERIMENTAL},
+    {"beladySize", BeladySize_init, CACHE_ALGO_ORACLE | CACHE_ALGO_SMALL_HASHTABLE},
+    {"clock", Clock_init, 0},
+    {"fifo-reinsertion", Clock_init, CACHE_ALGO_ALIAS},
+    {"second-chance", Clock_init, CACHE_ALGO_ALIAS},
+    {"clockpro", ClockPro_init, 0},
+    {"lirs", LIRS_init, 0},
+    {"fifomerge", FIFO_Merge_init, 0},
+    {"fifo-merge", FIFO_Merge_init, CACHE_ALGO_ALIAS},
+    /* used to measure application level write amp */
+    {"flashProb", flashProb_init, CACHE_ALGO_EXPERIMENTAL},
+    {"sfifo", SFIFO_init, 0},
+    {"sfifov0", SFIFOv0_init, CACHE_ALGO_EXPERIMENTAL},
+    {"lru-prob", LRU_Prob_init, 0},
+    {"fifo-belady", FIFO_Belady_init, CACHE_ALGO_ORACLE},
+    {"lru-belady", LRU_Belady_init, CACHE_ALGO_ORACLE},
+    {"sieve-belady", Sieve_Belady_init, CACHE_ALGO_ORACLE},
+    {"s3lru", S3LRU_init, 0},
+    {"s3fifo", S3FIFO_init, 0},
+    {"s3-fifo", S3FIFO_init, CACHE_ALGO_ALIAS},
+    {"s3fifov0", S3FIFOv0_init, CACHE_ALGO_EXPERIMENTAL},
+    {"s3-fifov0", S3FIFOv0_init, CACHE_ALGO_EXPERIMENTAL | CACHE_ALGO_ALIAS},
+    {"s3fifod", S3FIFOd_init, CACHE_ALGO_EXPERIMENTAL},
+    {"qdlp", QDLP_init, 0},
+    {"CAR", CAR_init, 0},
+    /* simulates the shards in threads, see Sharded.c */
+    {"sharded", Sharded_init, CACHE_ALGO_EXPERIMENTAL},
+    {"sieve", Sieve_init, 0},
+#ifdef ENABLE_3L_CACHE
+    {"3LCache", ThreeLCache_init, CACHE_ALGO_OPTIONAL},
+#endif
+#ifdef ENABLE_GLCACHE
+    {"GLCache", GLCache_init, CACHE_ALGO_OPTIONAL},
+    {"gl-cache", GLCache_init, CACHE_ALGO_OPTIONAL | CACHE_ALGO_ALIAS},
+#endif
+#ifdef ENABLE_LRB
+    {"lrb", LRB_init, CACHE_ALGO_OPTIONAL},
+#endif
+#ifdef INCLUDE_PRIV
+    {"mclock", MClock_init, CACHE_ALGO_EXPERIMENTAL},
+    {"lp-sfifo", LP_SFIFO_init, CACHE_ALGO_EXPERIMENTAL},
+    {"lp-arc", LP_ARC_init, CACHE_ALGO_EXPERIMENTAL},
+    {"lp-twoq", LP_TwoQ_init, CACHE_ALGO_EXPERIMENTAL},
+    {"qdlpv0", QDLPv0_init, CACHE_ALGO_EXPERIMENTAL},
+    {"s3fifodv2", S3FIFOdv2_init, CACHE_ALGO_EXPERIMENTAL},
+    {"myMQv1", myMQv1_init, CACHE_ALGO_EXPERIMENTAL},
+#endif
+};
+
+#define N_CACHE_ALGO (sizeof(cache_algo_registry) / sizeof(cache_algo_registry[0]))
+
+/* return NULL if the algorithm is not in the registry */
+static inline const cache_algo_t *find_cache_algo(const char *eviction_algo) {
+  for (size_t i = 0; i < N_CACHE_ALGO; i++) {
+    if (strcasecmp(eviction_algo, cache_algo_registry[i].name) == 0) {
+      return &cache_algo_registry[i];
+    }
+  }
+  return NULL;
+}
+
 static inline cache_t *create_cache(const char *trace_path, const char *eviction_algo, const uint64_t cache_size,
                                     const char *eviction_params, const bool consider_obj_metadata) {
   common_cache_params_t cc_params = {
@@ -20,166 +131,39 @@ static inline cache_t *create_cache(const char *trace_path, const char *eviction
     .hashpower = 24,
     .consider_obj_metadata = consider_obj_metadata,
 };
-  cache_t *cache;
 
   /* the trace provided is small */
   if (trace_path != NULL && strstr(trace_path, "data/trace.") != NULL) cc_params.hashpower -= 8;
 
-  if (strcasecmp(eviction_algo, "lru") == 0) {
-    cache = LRU_init(cc_params, eviction_params);
-  } else if (strcasecmp(eviction_algo, "fifo") == 0) {
-    cache = FIFO_init(cc_params, eviction_params);
-  } else if (strcasecmp(eviction_algo, "arc") == 0) {
-    cache = ARC_init(cc_params, eviction_params);
-  } else if (strcasecmp(eviction_algo, "arcv0") == 0) {
-    cache = ARCv0_init(cc_params, eviction_params);
-  } else if (strcasecmp(eviction_algo, "lhd") == 0) {
-    cache = LHD_init(cc_params, eviction_params);
-  } else if (strcasecmp(eviction_algo, "random") == 0) {
-    cache = Random_init(cc_params, eviction_params);
-  } else if (strcasecmp(eviction_algo, "randomTwo") == 0) {
-    cache = RandomTwo_init(cc_params, eviction_params);
-  } else if (strcasecmp(eviction_algo, "lfu") == 0) {
-    cache = LFU_init(cc_params, eviction_params);
-  } else if (strcasecmp(eviction_algo, "gdsf") == 0) {
-    cache = GDSF_init(cc_params, eviction_params);
-  } else if (strcasecmp(eviction_algo, "lfuda") == 0) {
-    cache = LFUDA_init(cc_params, eviction_params);
-  } else if (strcasecmp(eviction_algo, "twoq") == 0 || strcasecmp(eviction_algo, "2q") == 0) {
-    cache = TwoQ_init(cc_params, eviction_params);
-  } else if (strcasecmp(eviction_algo, "slru") == 0) {
-    cache = SLRU_init(cc_params, eviction_params);
-  } else if (strcasecmp(eviction_algo, "slruv0") == 0) {
-    cache = SLRUv0_init(cc_params, eviction_params);
-  } else if (strcasecmp(eviction_algo, "hyperbolic") == 0) {
-    cc_params.hashpower = MAX(cc_params.hashpower - 8, 16);
-    cache = Hyperbolic_init(cc_params, eviction_params);
-  } else if (strcasecmp(eviction_algo, "lecar") == 0) {
-    cache = LeCaR_init(cc_params, eviction_params);
-  } else if (strcasecmp(eviction_algo, "lecarv0") == 0) {
-    cache = LeCaRv0_init(cc_params, eviction_params);
-  } else if (strcasecmp(eviction_algo, "RandomLRU") == 0) {
-    cache = RandomLRU_init(cc_params, eviction_params);
-  } else if (strcasecmp(eviction_algo, "cacheus") == 0) {
-    cache = Cacheus_init(cc_params, eviction_params);
-  } else if (strcasecmp(eviction_algo, "size") == 0) {
-    cache = Size_init(cc_params, eviction_params);
-  } else if (strcasecmp(eviction_algo, "lfucpp") == 0) {
-    cache = LFUCpp_init(cc_params, eviction_params);
-  } else if (strcasecmp(eviction_algo, "evolve") == 0) {
-    cache = EvolveCache_init(cc_params, eviction_params);
-  } else if (strcasecmp(eviction_algo, "evolveCPP") == 0) {
-    cache = EvolveComplete_init(cc_params, eviction_params);
-  } else if (strcasecmp(eviction_algo, "tinyLFU") == 0) {
-    if (eviction_params == NULL) {
-      cache = WTinyLFU_init(cc_params, eviction_params);
-    } else {
-      const char *window_size = strstr(eviction_params, "window-size=");
-      if (window_size == NULL) {
-        char *new_params = malloc(strlen(eviction_params) + 20);
-        sprintf(new_params, "%s,window-size=0.01", eviction_params);
-        cache = WTinyLFU_init(cc_params, new_params);
-      } else {
-        cache = WTinyLFU_init(cc_params, eviction_params);
-      }
-    }
-  } else if (strcasecmp(eviction_algo, "wtinyLFU") == 0) {
-    cache = WTinyLFU_init(cc_params, eviction_params);
-  } else if (strcasecmp(eviction_algo, "belady") == 0 && strcasestr(trace_path, "lcs") == NULL) {
-    if (strcasestr(trace_path, "oracleGeneral") == NULL) {
-      WARN("belady is only supported for oracleGeneral and lcs trace\n");
-      WARN("to convert a trace to lcs format\n");
-      WARN("./bin/traceConv input_trace trace_format output_trace\n");
-      WARN("./bin/traceConv ../data/cloudPhysicsIO.txt txt\n");
-      exit(1);
-    }
-    cache = Belady_init(cc_params, eviction_params);
-  } else if (strcasecmp(eviction_algo, "nop") == 0) {
-    cache = nop_init(cc_params, eviction_params);
-  } else if (strcasecmp(eviction_algo, "beladySize") == 0) {
-    if (strcasestr(trace_path, "oracleGeneral") == NULL && strcasestr(trace_path, "lcs") == NULL) {
-      WARN("beladySize is only supported for oracleGeneral and lcs trace\n");
+  const cache_algo_t *algo = find_cache_algo(eviction_algo);
+  if (algo == NULL) {
+    ERROR("do not support algorithm %s\n", eviction_algo);
+    abort();
+  }
+
+  if (algo->flags & CACHE_ALGO_ORACLE) {
+    if (trace_path == NULL ||
+        (strcasestr(trace_path, "oracleGeneral") == NULL && strcasestr(trace_path, "lcs") == NULL)) {
+      WARN("%s is only supported for oracleGeneral and lcs trace\n", algo->name);
       WARN("to convert a trace to lcs format\n");
       WARN("./bin/traceConv input_trace trace_format output_trace\n");
       WARN("./bin/traceConv ../data/cloudPhysicsIO.txt txt\n");
       exit(1);
     }
+  }
+
+  if (algo->flags & CACHE_ALGO_SMALL_HASHTABLE) {
     cc_params.hashpower = MAX(cc_params.hashpower - 8, 16);
-    cache = BeladySize_init(cc_params, eviction_params);
-  } else if (strcasecmp(eviction_algo, "fifo-reinsertion") == 0 || strcasecmp(eviction_algo, "clock") == 0 ||
-             strcasecmp(eviction_algo, "second-chance") == 0) {
-    cache = Clock_init(cc_params, eviction_params);
-  } else if (strcasecmp(eviction_algo, "clockpro") == 0) {
-    cache = ClockPro_init(cc_params, eviction_params);
-  } else if (strcasecmp(eviction_algo, "lirs") == 0) {
-    cache = LIRS_init(cc_params, eviction_params);
-  } else if (strcasecmp(eviction_algo, "fifomerge") == 0 || strcasecmp(eviction_algo, "fifo-merge") == 0) {
-    cache = FIFO_Merge_init(cc_params, eviction_params);
-    // } else if (strcasecmp(eviction_algo, "fifo-reinsertion") == 0) {
-    //   cache = FIFO_Reinsertion_init(cc_params, eviction_params);
-  } else if (strcasecmp(eviction_algo, "flashProb") == 0) {
-    // used to measure application level write amp
-    cache = flashProb_init(cc_params, eviction_params);
-  } else if (strcasecmp(eviction_algo, "sfifo") == 0) {
-    cache = SFIFO_init(cc_params, eviction_params);
-  } else if (strcasecmp(eviction_algo, "sfifov0") == 0) {
-    cache = SFIFOv0_init(cc_params, eviction_params);
-  } else if (strcasecmp(eviction_algo, "lru-prob") == 0) {
-    cache = LRU_Prob_init(cc_params, eviction_params);
-  } else if (strcasecmp(eviction_algo, "fifo-belady") == 0) {
-    cache = FIFO_Belady_init(cc_params, eviction_params);
-  } else if (strcasecmp(eviction_algo, "lru-belady") == 0) {
-    cache = LRU_Belady_init(cc_params, eviction_params);
-  } else if (strcasecmp(eviction_algo, "sieve-belady") == 0) {
-    cache = Sieve_Belady_init(cc_params, eviction_params);
-  } else if (strcasecmp(eviction_algo, "s3lru") == 0) {
-    cache = S3LRU_init(cc_params, eviction_params);
-  } else if (strcasecmp(eviction_algo, "s3fifo") == 0 || strcasecmp(eviction_algo, "s3-fifo") == 0) {
-    cache = S3FIFO_init(cc_params, eviction_params);
-  } else if (strcasecmp(eviction_algo, "s3fifov0") == 0 || strcasecmp(eviction_algo, "s3-fifov0") == 0) {
-    cache = S3FIFOv0_init(cc_params, eviction_params);
-  } else if (strcasecmp(eviction_algo, "s3fifod") == 0) {
-    cache = S3FIFOd_init(cc_params, eviction_params);
-  } else if (strcasecmp(eviction_algo, "qdlp") == 0) {
-    cache = QDLP_init(cc_params, eviction_params);
-  } else if(strcasecmp(eviction_algo, "CAR") == 0) {
-    cache = CAR_init(cc_params, eviction_params);
-  } else if (strcasecmp(eviction_algo, "sieve") == 0) {
-    cache = Sieve_init(cc_params, eviction_params);
-#ifdef ENABLE_3L_CACHE
-  } else if (strcasecmp(eviction_algo, "3LCache") == 0) {
-    cache = ThreeLCache_init(cc_params, eviction_params);
-#endif
-#ifdef ENABLE_GLCACHE
-  } else if (strcasecmp(eviction_algo, "GLCache") == 0 || strcasecmp(eviction_algo, "gl-cache") == 0) {
-    cache = GLCache_init(cc_params, eviction_params);
-#endif
-#ifdef ENABLE_LRB
-  } else if (strcasecmp(eviction_algo, "lrb") == 0) {
-    cache = LRB_init(cc_params, eviction_params);
-#endif
-#ifdef INCLUDE_PRIV
-  } else if (strcasecmp(eviction_algo, "mclock") == 0) {
-    cache = MClock_init(cc_params, eviction_params);
-  } else if (strcasecmp(eviction_algo, "lp-sfifo") == 0) {
-    cache = LP_SFIFO_init(cc_params, eviction_params);
-  } else if (strcasecmp(eviction_algo, "lp-arc") == 0) {
-    cache = LP_ARC_init(cc_params, eviction_params);
-  } else if (strcasecmp(eviction_algo, "lp-twoq") == 0) {
-    cache = LP_TwoQ_init(cc_params, eviction_params);
-  } else if (strcasecmp(eviction_algo, "qdlpv0") == 0) {
-    cache = QDLPv0_init(cc_params, eviction_params);
-  } else if (strcasecmp(eviction_algo, "s3fifodv2") == 0) {
-    cache = S3FIFOdv2_init(cc_params, eviction_params);
-  } else if (strcasecmp(eviction_algo, "myMQv1") == 0) {
-    cache = myMQv1_init(cc_params, eviction_params);
-#endif
-  } else {
-    ERROR("do not support algorithm %s\n", eviction_algo);
-    abort();
   }
 
-  return cache;
+  if (strcasecmp(algo->name, "tinyLFU") == 0 && eviction_params != NULL &&
+      strstr(eviction_params, "window-size=") == NULL) {
+    char *new_params = malloc(strlen(eviction_params) + 20);
+    sprintf(new_params, "%s,window-size=0.01", eviction_params);
+    return algo->init(cc_params, new_params);
+  }
+
+  return algo->init(cc_params, eviction_params);
 }
 
 #ifdef __cplusplus
@@ -46,6 +46,12 @@ enum argp_option_short {
   OPTION_PREFETCH_ALGO = 'p',
   OPTION_PREFETCH_PARAMS = 0x109,
   OPTION_PRINT_HEAD_REQ = 0x10a,
+  OPTION_SAVE_CHECKPOINT = 0x10b,
+  OPTION_LOAD_CHECKPOINT = 0x10c,
+  OPTION_METRICS_OUTPUT = 0x10d,
+  OPTION_METRICS_INTERVAL = 0x10e,
+  OPTION_OP_STAT = 0x10f,
+  OPTION_STATIC_SIM = 0x110,
 };
 
 /*
@@ -87,10 +93,33 @@ static struct argp_option options[] = {
     {"report-interval", OPTION_REPORT_INTERVAL, "3600", 0,
      "how often to report stat when running one cache", 10},
     {"warmup-sec", OPTION_WARMUP_SEC, "0", 0, "warm up time in seconds", 10},
+    {"save-checkpoint", OPTION_SAVE_CHECKPOINT, "ckpt/trace", 0,
+     "save the warmed caches to checkpoints with the given path prefix, "
+     "requires warmup-sec",
+     10},
+    {"load-checkpoint", OPTION_LOAD_CHECKPOINT, "ckpt/trace", 0,
+     "load the caches from checkpoints with the given path prefix and skip "
+     "the warmup",
+     10},
     {"use-ttl", OPTION_USE_TTL, "false", 0, "specify to use ttl from the trace",
      10},
     {"consider-obj-metadata", OPTION_CONSIDER_OBJ_METADATA, "false", 0,
      "Whether consider per object metadata size in the simulated cache", 10},
+    {"metrics-output", OPTION_METRICS_OUTPUT, "result/trace.metrics", 0,
+     "write the per-interval metrics of each cache to a binary columnar file",
+     10},
+    {"metrics-interval", OPTION_METRICS_INTERVAL, "3600", 0,
+     "the metrics interval in seconds, or in requests with suffix req, e.g., "
+     "1000000req",
+     10},
+    {"op-stat", OPTION_OP_STAT, "false", 0,
+     "count and time the cache operations (true/false/perf), perf also reads "
+     "the cache miss and branch miss counters, requires ENABLE_CACHE_OP_STAT",
+     10},
+    {"static-sim", OPTION_STATIC_SIM, "false", 0,
+     "run LRU, FIFO, Clock, Sieve, S3FIFO, SLRU and ARC with the "
+     "static-dispatch engine, the other caches use the generic path",
+     10},
     {"verbose", OPTION_VERBOSE, "1", 0, "Produce verbose output", 10},
     {"print-head-req", OPTION_PRINT_HEAD_REQ, "false", 0,
      "Print the first few requests", 10},
@@ -166,6 +195,32 @@ static error_t parse_opt(int key, char *arg, struct argp_state *state) {
     case OPTION_WARMUP_SEC:
       arguments->warmup_sec = atoi(arg);
       break;
+    case OPTION_SAVE_CHECKPOINT:
+      arguments->save_checkpoint_prefix = arg;
+      break;
+    case OPTION_LOAD_CHECKPOINT:
+      arguments->load_checkpoint_prefix = arg;
+      break;
+    case OPTION_METRICS_OUTPUT:
+      arguments->metrics_output = arg;
+      break;
+    case OPTION_METRICS_INTERVAL: {
+      char *end;
+      arguments->metrics_interval = strtoll(arg, &end, 10);
+      arguments->metrics_interval_in_req = strcasecmp(end, "req") == 0;
+      if (arguments->metrics_interval <= 0 ||
+          (end[0] != '\0' && !arguments->metrics_interval_in_req)) {
+        ERROR("cannot parse metrics interval %s\n", arg);
+      }
+      break;
+    }
+    case OPTION_OP_STAT:
+      arguments->op_stat_perf_event = strcasecmp(arg, "perf") == 0;
+      arguments->op_stat = arguments->op_stat_perf_event || is_true(arg);
+      break;
+    case OPTION_STATIC_SIM:
+      arguments->static_sim = is_true(arg);
+      break;
     case OPTION_PRINT_HEAD_REQ:
       arguments->print_head_req = is_true(arg) ? true : false;
       break;
@@ -233,6 +288,15 @@ static void init_arg(struct arguments *args) {
   args->n_req = -1;
   args->sample_ratio = 1.0;
   args->print_head_req = true;
+  args->save_checkpoint_prefix = NULL;
+  args->load_checkpoint_prefix = NULL;
+  args->metrics_output = NULL;
+  args->metrics_interval = 3600;
+  args->metrics_interval_in_req = false;
+  args->metrics_sink = NULL;
+  args->op_stat = false;
+  args->op_stat_perf_event = false;
+  args->static_sim = false;
 
   for (int i = 0; i < N_MAX_ALGO; i++) {
     args->eviction_algo[i] = NULL;
@@ -262,9 +326,49 @@ void free_arg(struct arguments *args) {
   //     args->caches[i]->cache_free(args->caches[i]);
   // }
 
+  if (args->metrics_sink != NULL) {
+    close_metrics_sink(args->metrics_sink);
+  }
+
   close_reader(args->reader);
 }
 
+/**
+ * @brief load the cache from the checkpoint or set the path to save the
+ * checkpoint after warmup, the checkpoint of each cache is stored at
+ * prefix.eviction_algo.cache_size.ckpt
+ *
+ * @param args
+ * @param cache
+ * @param eviction_algo
+ * @param cache_size
+ */
+static void setup_checkpoint(struct arguments *args, cache_t *cache,
+                             const char *eviction_algo, uint64_t cache_size) {
+  if (args->save_checkpoint_prefix == NULL &&
+      args->load_checkpoint_prefix == NULL) {
+    return;
+  }
+
+  char ckpt_path[OFILEPATH_LEN * 2];
+  if (args->load_checkpoint_prefix != NULL) {
+    snprintf(ckpt_path, sizeof(ckpt_path), "%s.%s.%lu.ckpt",
+             args->load_checkpoint_prefix, eviction_algo,
+             (unsigned long)cache_size);
+    if (!cache_load_checkpoint(cache, ckpt_path)) {
+      ERROR("fail to load checkpoint %s\n", ckpt_path);
+      exit(1);
+    }
+  }
+
+  if (args->save_checkpoint_prefix != NULL) {
+    snprintf(ckpt_path, sizeof(ckpt_path), "%s.%s.%lu.ckpt",
+             args->save_checkpoint_prefix, eviction_algo,
+             (unsigned long)cache_size);
+    cache->warmup_checkpoint_path = strdup(ckpt_path);
+  }
+}
+
 /**
  * @brief parse the command line arguments
  *
@@ -342,6 +446,22 @@ void parse_cmd(int argc, char *argv[], struct arguments *args) {
    * the working set size **/
   conv_cache_sizes(args->args[3], args);
 
+  if (args->save_checkpoint_prefix != NULL) {
+    if (args->warmup_sec <= 0) {
+      WARN("--save-checkpoint requires --warmup-sec, no checkpoint is saved\n");
+    } else {
+      // ensure the checkpoint directory exists
+      char *ckpt_dir = rindex(args->save_checkpoint_prefix, '/');
+      if (ckpt_dir != NULL) {
+        size_t dir_length = ckpt_dir - args->save_checkpoint_prefix;
+        char dir_path[1024];
+        snprintf(dir_path, MIN(dir_length + 1, sizeof(dir_path)), "%s",
+                 args->save_checkpoint_prefix);
+        create_dir(dir_path);
+      }
+    }
+  }
+
   for (int i = 0; i < args->n_eviction_algo; i++) {
     for (int j = 0; j < args->n_cache_size; j++) {
       int idx = i * args->n_cache_size + j;
@@ -358,6 +478,48 @@ void parse_cmd(int argc, char *argv[], struct arguments *args) {
         args->caches[idx]->prefetcher = create_prefetcher(
             args->prefetch_algo, args->prefetch_params, args->cache_sizes[j]);
       }
+
+      setup_checkpoint(args, args->caches[idx], args->eviction_algo[i],
+                       args->cache_sizes[j]);
+    }
+  }
+
+  if (args->metrics_output != NULL) {
+    char *metrics_dir = rindex(args->metrics_output, '/');
+    if (metrics_dir != NULL) {
+      size_t dir_length = metrics_dir - args->metrics_output;
+      char dir_path[1024];
+      snprintf(dir_path, MIN(dir_length + 1, sizeof(dir_path)), "%s",
+               args->metrics_output);
+      create_dir(dir_path);
+    }
+    args->metrics_sink = create_metrics_sink(
+        args->metrics_output,
+        args->metrics_interval_in_req ? METRICS_INTERVAL_REQ
+                                      : METRICS_INTERVAL_SEC,
+        args->metrics_interval);
+    if (args->metrics_sink == NULL) {
+      ERROR("cannot create metrics output %s\n", args->metrics_output);
+    }
+    for (int i = 0; i < args->n_eviction_algo * args->n_cache_size; i++) {
+      metrics_sink_attach(args->metrics_sink, args->caches[i]);
+    }
+  }
+
+  if (args->op_stat) {
+    for (int i = 0; i < args->n_eviction_algo * args->n_cache_size; i++) {
+      if (!cache_enable_op_stat(args->caches[i],
+                                CACHE_OP_STAT_DEFAULT_SAMPLE_SHIFT,
+                                args->op_stat_perf_event)) {
+        args->op_stat = false;
+        break;
+      }
+    }
+  }
+
+  if (args->static_sim) {
+    for (int i = 0; i < args->n_eviction_algo * args->n_cache_size; i++) {
+      args->caches[i]->use_static_sim = true;
     }
   }
 
@@ -553,6 +715,27 @@ void print_parsed_args(struct arguments *args) {
     n += snprintf(output_str + n, OUTPUT_STR_LEN - n - 1,
                   ", consider object metadata");
 
+  if (args->load_checkpoint_prefix != NULL)
+    n += snprintf(output_str + n, OUTPUT_STR_LEN - n - 1,
+                  ", load checkpoint: %s", args->load_checkpoint_prefix);
+
+  if (args->save_checkpoint_prefix != NULL)
+    n += snprintf(output_str + n, OUTPUT_STR_LEN - n - 1,
+                  ", save checkpoint: %s", args->save_checkpoint_prefix);
+
+  if (args->op_stat)
+    n += snprintf(output_str + n, OUTPUT_STR_LEN - n - 1, ", op stat%s",
+                  args->op_stat_perf_event ? " with perf_event" : "");
+
+  if (args->static_sim)
+    n += snprintf(output_str + n, OUTPUT_STR_LEN - n - 1, ", static sim");
+
+  if (args->metrics_output != NULL)
+    n += snprintf(output_str + n, OUTPUT_STR_LEN - n - 1,
+                  ", metrics output: %s every %ld %s", args->metrics_output,
+                  (long)args->metrics_interval,
+                  args->metrics_interval_in_req ? "req" : "sec");
+
   snprintf(output_str + n, OUTPUT_STR_LEN - n - 1, "\n");
 
   INFO("%s", output_str);
@@ -6,6 +6,8 @@
 #include "../../include/libCacheSim/cache.h"
 #include "../../include/libCacheSim/enum.h"
 #include "../../include/libCacheSim/evictionAlgo.h"
+#include "../../include/libCacheSim/cacheOpStat.h"
+#include "../../include/libCacheSim/metricsSink.h"
 #include "../../include/libCacheSim/reader.h"
 
 #ifdef __cplusplus
@@ -47,10 +49,23 @@ struct arguments {
   bool consider_obj_metadata;
   bool use_ttl;
   bool print_head_req;
+  /* path prefix of the cache checkpoints */
+  char *save_checkpoint_prefix;
+  char *load_checkpoint_prefix;
+  /* per-interval metrics */
+  char *metrics_output;
+  int64_t metrics_interval;
+  bool metrics_interval_in_req;
+  /* count and time the cache operations */
+  bool op_stat;
+  bool op_stat_perf_event;
+  /* run the supported caches with the static-dispatch engine */
+  bool static_sim;
 
   /* arguments generated */
   reader_t *reader;
   cache_t *caches[N_MAX_ALGO * N_MAX_CACHE_SIZE];
+  metrics_sink_t *metrics_sink;
 };
 
 void parse_cmd(int argc, char *argv[], struct arguments *args);
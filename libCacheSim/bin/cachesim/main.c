@@ -19,7 +19,8 @@ int main(int argc, char **argv) {
   if (args.n_cache_size == 0) {
     ERROR("no cache size found\n");
   }
-  if (args.n_cache_size * args.n_eviction_algo == 1) {
+  /* the static-dispatch engine is used by simulate_with_multi_caches */
+  if (args.n_cache_size * args.n_eviction_algo == 1 && !args.static_sim) {
     simulate(args.reader, args.caches[0], args.report_interval, args.warmup_sec, args.ofilepath, args.ignore_obj_size,
              args.print_head_req);
 
@@ -27,9 +28,10 @@ int main(int argc, char **argv) {
     return 0;
   }
 
+  /* keep the caches to print the operation stat after all simulations */
   cache_stat_t *result = simulate_with_multi_caches(
       args.reader, args.caches, args.n_cache_size * args.n_eviction_algo, NULL,
-      0, args.warmup_sec, args.n_thread, true, true);
+      0, args.warmup_sec, args.n_thread, !args.op_stat, true);
 
   // output to file
   char output_str[1024];
@@ -79,6 +81,13 @@ int main(int argc, char **argv) {
   }
   fclose(output_file);
 
+  if (args.op_stat) {
+    for (int i = 0; i < args.n_cache_size * args.n_eviction_algo; i++) {
+      cache_print_op_stat(args.caches[i]);
+      args.caches[i]->cache_free(args.caches[i]);
+    }
+  }
+
   if (args.n_cache_size * args.n_eviction_algo > 0)
     my_free(sizeof(cache_stat_t) * args.n_cache_size * args.n_eviction_algo, result);
 
@@ -1,4 +1,6 @@
 #include "../../include/libCacheSim/cache.h"
+#include "../../include/libCacheSim/cacheOpStat.h"
+#include "../../include/libCacheSim/metricsSink.h"
 #include "../../include/libCacheSim/reader.h"
 #include "../../utils/include/mymath.h"
 #include "../../utils/include/mystr.h"
@@ -32,6 +34,9 @@ void simulate(reader_t *reader, cache_t *cache, int report_interval, int warmup_
   char detailed_cache_name[256];
   generate_cache_name(cache, detailed_cache_name, 256);
 
+  /* a cache restored from a checkpoint has been warmed up */
+  bool need_warmup = !cache->restored_from_checkpoint;
+
   double start_time = -1;
   while (req->valid) {
     if (print_head_req) {
@@ -40,21 +45,30 @@ void simulate(reader_t *reader, cache_t *cache, int report_interval, int warmup_
 
     req->clock_time -= start_ts;
     if (req->clock_time <= warmup_sec) {
-      cache->get(cache, req);
+      if (need_warmup) {
+        cache->get(cache, req);
+      }
       read_one_req(reader, req);
       continue;
     } else {
       if (start_time < 0) {
+        if (need_warmup && warmup_sec > 0 && cache->warmup_checkpoint_path != NULL) {
+          cache_save_checkpoint(cache, cache->warmup_checkpoint_path);
+        }
         start_time = gettime();
       }
     }
 
     req_cnt++;
     req_byte += req->obj_size;
-    if (cache->get(cache, req) == false) {
+    bool hit = cache->get(cache, req);
+    if (hit == false) {
       miss_cnt++;
       miss_byte += req->obj_size;
     }
+    if (cache->metrics_recorder != NULL) {
+      metrics_recorder_record(cache->metrics_recorder, req, hit);
+    }
     if (req->clock_time - last_report_ts >= (uint64_t) report_interval &&
         req->clock_time != 0) {
       INFO(
@@ -74,6 +88,9 @@ void simulate(reader_t *reader, cache_t *cache, int report_interval, int warmup_
   }
 
   double runtime = gettime() - start_time;
+  if (cache->metrics_recorder != NULL) {
+    metrics_recorder_finish(cache->metrics_recorder);
+  }
 
   char output_str[1024];
   char size_str[8];
@@ -102,6 +119,7 @@ void simulate(reader_t *reader, cache_t *cache, int report_interval, int warmup_
 
 #pragma GCC diagnostic pop
   printf("%s", output_str);
+  cache_print_op_stat(cache);
   char *output_dir = rindex(ofilepath, '/');
   if (output_dir != NULL) {
     size_t dir_length = output_dir - ofilepath;
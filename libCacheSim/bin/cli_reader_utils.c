@@ -7,6 +7,7 @@
 #include <string.h>
 
 #include "../include/libCacheSim/reader.h"
+#include "../include/libCacheSim/traceMeta.h"
 #include "../utils/include/mystr.h"
 
 #ifdef __cplusplus
@@ -51,6 +52,9 @@ trace_type_e trace_type_str_to_enum(const char *trace_type_str,
     return ORACLE_SYS_TWRNS_TRACE;
   } else if (strcasecmp(trace_type_str, "valpinTrace") == 0) {
     return VALPIN_TRACE;
+  } else if (strcasecmp(trace_type_str, "synthetic") == 0) {
+    // trace_path is the workload spec
+    return SYNTHETIC_TRACE;
   } else {
     ERROR("unsupported trace type: %s\n", trace_type_str);
   }
@@ -151,6 +155,8 @@ void parse_reader_params(const char *reader_params_str,
                strcasecmp(key, "has-header") == 0) {
       params->has_header = is_true(value);
       params->has_header_set = true;
+    } else if (strcasecmp(key, "save-trace-meta") == 0) {
+      params->save_trace_meta = is_true(value);
     } else if (strcasecmp(key, "format") == 0) {
       params->binary_fmt_str = strdup(value);
     } else if (strcasecmp(key, "delimiter") == 0) {
@@ -240,58 +246,22 @@ bool should_disable_obj_metadata(reader_t *reader) {
 
 void cal_working_set_size(reader_t *reader, int64_t *wss_obj,
                           int64_t *wss_byte) {
-  reset_reader(reader);
-  request_t *req = new_request();
-  GHashTable *obj_table = g_hash_table_new(g_direct_hash, g_direct_equal);
-  *wss_obj = 0;
-  *wss_byte = 0;
-
-  // sample the object space in case there are too many objects
-  // which can cause a crash
-  int scaling_factor = 1;
-  if (reader->file_size > 5 * GiB) {
-    scaling_factor = 101;
-  } else if (reader->file_size > 1 * GiB) {
-    scaling_factor = 11;
-  }
+  /* the working set size is part of the trace metadata, which is computed
+   * once and stored in a sidecar file next to the trace */
+  const trace_meta_t *meta = get_trace_meta(reader);
+  *wss_obj = meta->n_obj;
+  *wss_byte = meta->n_obj_byte;
 
-  int64_t n_req = 0;
-  INFO("calculating working set size...\n");
-  while (read_one_req(reader, req) == 0) {
-    n_req += 1;
-    if (n_req % 2000000 == 0) {
-      DEBUG("processed %ld requests, %lld objects, %lld bytes\n", (long)n_req,
-            (long long)*wss_obj, (long long)*wss_byte);
-    }
-    if (scaling_factor > 1 && req->obj_id % scaling_factor != 0) {
-      continue;
-    }
-
-    if (g_hash_table_contains(obj_table, (gconstpointer)req->obj_id)) {
-      continue;
-    }
-
-    g_hash_table_add(obj_table, (gpointer)req->obj_id);
-
-    *wss_obj += 1;
-    *wss_byte += req->obj_size;
-  }
-  *wss_obj *= scaling_factor;
-  *wss_byte *= scaling_factor;
-
-  if (scaling_factor > 1) {
+  if (meta->obj_sample_scale > 1) {
     INFO(
         "estimated working set size (%.2f sample ratio): %lld object %lld "
         "byte\n",
-        1.0 / scaling_factor, (long long)*wss_obj, (long long)*wss_byte);
+        1.0 / meta->obj_sample_scale, (long long)*wss_obj,
+        (long long)*wss_byte);
   } else {
     INFO("working set size: %lld object %lld byte\n", (long long)*wss_obj,
          (long long)*wss_byte);
   }
-
-  g_hash_table_destroy(obj_table);
-  free_request(req);
-  reset_reader(reader);
 }
 
 /**
@@ -0,0 +1,211 @@
+#define _GNU_SOURCE
+#include <argp.h>
+#include <stdbool.h>
+#include <string.h>
+#include <strings.h>
+#include <unistd.h>
+
+#include "../../include/libCacheSim/const.h"
+#include "../../include/libCacheSim/logging.h"
+#include "../cli_reader_utils.h"
+#include "internal.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+const char *argp_program_version = "concurrentReplay 0.0.1";
+const char *argp_program_bug_address = "https://groups.google.com/g/libcachesim/";
+
+/* the algorithms that have a concurrent variant */
+static const char *default_algos[] = {"fifo", "clock", "sieve", "s3fifo"};
+
+enum argp_option_short {
+  OPTION_EVICTION_ALGO = 'a',
+  OPTION_CACHE_SIZE = 'c',
+  OPTION_THREADS = 'j',
+  OPTION_DISPATCH = 'd',
+  OPTION_REPEAT = 'p',
+  OPTION_NUM_REQ = 'n',
+  OPTION_OUTPUT_PATH = 'o',
+};
+
+/*
+   OPTIONS.  Field 1 in ARGP.
+   Order of fields: {NAME, KEY, ARG, FLAGS, DOC}.
+*/
+static struct argp_option options[] = {
+    {"algo", OPTION_EVICTION_ALGO, "fifo,sieve", 0, "The eviction algorithms, default fifo,clock,sieve,s3fifo", 1},
+    {"cache-size", OPTION_CACHE_SIZE, "0.01,0.1", 0, "The cache sizes as fractions of the working set size", 1},
+    {"threads", OPTION_THREADS, "1,2,4,8", 0, "The numbers of threads, default powers of 2 up to the number of cores",
+     2},
+    {"dispatch", OPTION_DISPATCH, "hash", 0,
+     "How the requests are sent to the threads, hash (by object) or rr (round-robin by request)", 2},
+    {"repeat", OPTION_REPEAT, "3", 0, "Run each case repeat times and report the fastest run", 3},
+    {"num-req", OPTION_NUM_REQ, "-1", 0, "Num of requests to use, default -1 means all", 3},
+    {"output", OPTION_OUTPUT_PATH, "replay.json", 0, "Also write the results as JSON to the path", 3},
+
+    {0}};
+
+/*
+   PARSER. Field 2 in ARGP.
+   Order of parameters: KEY, ARG, STATE.
+*/
+static error_t parse_opt(int key, char *arg, struct argp_state *state) {
+  struct arguments *arguments = state->input;
+
+  switch (key) {
+    case OPTION_EVICTION_ALGO: {
+      char *algo;
+      while ((algo = strsep(&arg, ",")) != NULL) {
+        if (arguments->n_eviction_algo == REPLAY_MAX_N_ALGO) {
+          ERROR("at most %d algorithms are supported\n", REPLAY_MAX_N_ALGO);
+        }
+        arguments->eviction_algo[arguments->n_eviction_algo++] = algo;
+      }
+      break;
+    }
+    case OPTION_CACHE_SIZE: {
+      arguments->n_cache_size = 0;
+      char *size;
+      while ((size = strsep(&arg, ",")) != NULL) {
+        if (arguments->n_cache_size == REPLAY_MAX_N_CACHE_SIZE) {
+          ERROR("at most %d cache sizes are supported\n", REPLAY_MAX_N_CACHE_SIZE);
+        }
+        double ratio = strtod(size, NULL);
+        if (ratio <= 0 || ratio > 1) {
+          ERROR("cache size %s should be a fraction of the working set size in (0, 1]\n", size);
+        }
+        arguments->cache_size_ratios[arguments->n_cache_size++] = ratio;
+      }
+      break;
+    }
+    case OPTION_THREADS: {
+      char *n;
+      while ((n = strsep(&arg, ",")) != NULL) {
+        if (arguments->n_thread_config == REPLAY_MAX_N_THREAD_CONFIG) {
+          ERROR("at most %d thread numbers are supported\n", REPLAY_MAX_N_THREAD_CONFIG);
+        }
+        int n_thread = atoi(n);
+        if (n_thread <= 0 || n_thread > REPLAY_MAX_N_THREAD) {
+          ERROR("the number of threads should be in [1, %d], find %s\n", REPLAY_MAX_N_THREAD, n);
+        }
+        arguments->n_threads[arguments->n_thread_config++] = n_thread;
+      }
+      break;
+    }
+    case OPTION_DISPATCH:
+      if (strcasecmp(arg, "hash") == 0) {
+        arguments->dispatch = DISPATCH_HASH;
+      } else if (strcasecmp(arg, "rr") == 0 || strcasecmp(arg, "round-robin") == 0) {
+        arguments->dispatch = DISPATCH_ROUND_ROBIN;
+      } else {
+        ERROR("unknown dispatch %s, supported hash and rr\n", arg);
+      }
+      break;
+    case OPTION_REPEAT:
+      arguments->repeat = atoi(arg);
+      if (arguments->repeat <= 0) {
+        ERROR("repeat should be positive\n");
+      }
+      break;
+    case OPTION_NUM_REQ:
+      arguments->n_req = atoll(arg);
+      break;
+    case OPTION_OUTPUT_PATH:
+      strncpy(arguments->ofilepath, arg, OFILEPATH_LEN - 1);
+      break;
+    case ARGP_KEY_ARG:
+      if (state->arg_num == 0) {
+        arguments->trace_path = arg;
+      } else if (state->arg_num == 1) {
+        arguments->trace_type_str = arg;
+      } else {
+        printf("found too many arguments, current %s\n", arg);
+        argp_usage(state);
+        exit(1);
+      }
+      break;
+    case ARGP_KEY_END:
+      if (state->arg_num < 2) {
+        printf("not enough arguments found\n");
+        argp_usage(state);
+        exit(1);
+      }
+      break;
+    default:
+      return ARGP_ERR_UNKNOWN;
+  }
+  return 0;
+}
+
+/*
+   ARGS_DOC. Field 3 in ARGP.
+   A description of the non-option command-line arguments
+     that we accept.
+*/
+static char args_doc[] = "trace_path trace_type";
+
+/* Program documentation. */
+static char doc[] =
+    "example: ./bin/concurrentReplay ../data/cloudPhysicsIO.vscsi vscsi -a sieve,s3fifo -j 1,2,4,8\n\n"
+    "replay a trace on the concurrent caches shared by multiple threads, and report the throughput "
+    "and the change of miss ratio compared to the single-threaded cache of the same algorithm\n\n"
+    "trace_type: txt/csv/twr/vscsi/oracleGeneral/synthetic\n\n";
+
+/**
+ * @brief initialize the arguments
+ *
+ * @param args
+ */
+static void init_arg(struct arguments *args) {
+  memset(args, 0, sizeof(struct arguments));
+
+  args->cache_size_ratios[0] = 0.01;
+  args->cache_size_ratios[1] = 0.1;
+  args->n_cache_size = 2;
+  args->dispatch = DISPATCH_HASH;
+  args->repeat = 3;
+  args->n_req = -1;
+}
+
+/**
+ * @brief parse the command line arguments
+ *
+ * @param argc
+ * @param argv
+ */
+void parse_cmd(int argc, char *argv[], struct arguments *args) {
+  init_arg(args);
+
+  static struct argp argp = {.options = options,
+                             .parser = parse_opt,
+                             .args_doc = args_doc,
+                             .doc = doc,
+                             .children = NULL,
+                             .help_filter = NULL,
+                             .argp_domain = NULL};
+
+  argp_parse(&argp, argc, argv, 0, 0, args);
+
+  if (args->n_eviction_algo == 0) {
+    for (size_t i = 0; i < sizeof(default_algos) / sizeof(default_algos[0]); i++) {
+      args->eviction_algo[args->n_eviction_algo++] = default_algos[i];
+    }
+  }
+
+  if (args->n_thread_config == 0) {
+    long n_core = sysconf(_SC_NPROCESSORS_ONLN);
+    for (int n_thread = 1; n_thread <= n_core && n_thread <= REPLAY_MAX_N_THREAD; n_thread *= 2) {
+      args->n_threads[args->n_thread_config++] = n_thread;
+    }
+    if (args->n_thread_config == 1) {
+      /* still show the miss ratio change on a single core */
+      args->n_threads[args->n_thread_config++] = 2;
+    }
+  }
+}
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,46 @@
+#pragma once
+
+#include <inttypes.h>
+
+#include "../../include/libCacheSim/cache.h"
+#include "../../include/libCacheSim/reader.h"
+
+#define REPLAY_MAX_N_ALGO 16
+#define REPLAY_MAX_N_CACHE_SIZE 16
+#define REPLAY_MAX_N_THREAD_CONFIG 16
+#define REPLAY_MAX_N_THREAD 256
+#define OFILEPATH_LEN 256
+
+/* how the requests are sent to the threads */
+typedef enum {
+  /* the requests of an object go to the same thread in trace order */
+  DISPATCH_HASH,
+  /* request i goes to thread i % n_thread */
+  DISPATCH_ROUND_ROBIN,
+} dispatch_e;
+
+/* This structure is used to communicate with parse_opt. */
+struct arguments {
+  const char *trace_path;
+  const char *trace_type_str;
+
+  const char *eviction_algo[REPLAY_MAX_N_ALGO];
+  int n_eviction_algo;
+
+  /* the cache sizes are fractions of the working set size (in bytes) */
+  double cache_size_ratios[REPLAY_MAX_N_CACHE_SIZE];
+  int n_cache_size;
+
+  int n_threads[REPLAY_MAX_N_THREAD_CONFIG];
+  int n_thread_config;
+
+  dispatch_e dispatch;
+  /* each case is run repeat times and the fastest run is reported */
+  int repeat;
+  int64_t n_req;
+
+  /* the JSON results are written if the path is not empty */
+  char ofilepath[OFILEPATH_LEN];
+};
+
+void parse_cmd(int argc, char *argv[], struct arguments *args);
@@ -0,0 +1,275 @@
+//
+//  replay a trace on a concurrent cache shared by multiple threads
+//
+//  the requests are loaded in memory and sent to the threads before the
+//  replay, either by hashing the object id, so that the requests of an object
+//  are processed by one thread in trace order, or round-robin, where the
+//  requests of an object can be processed by different threads at the same
+//  time, then all threads start at a barrier and the wall time of the replay
+//  is reported, the miss ratio is compared with the single-threaded cache of
+//  the same algorithm in cache/eviction, the difference comes from the
+//  interleaving of the threads and the approximations of the concurrent caches
+//
+
+#define _GNU_SOURCE
+#include <errno.h>
+#include <math.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "../../include/libCacheSim/concurrentCache.h"
+#include "../../include/libCacheSim/const.h"
+#include "../../include/libCacheSim/logging.h"
+#include "../bench_utils.h"
+#include "../cachesim/cache_init.h"
+#include "../cli_reader_utils.h"
+#include "internal.h"
+
+typedef struct {
+  concurrent_cache_t *cache;
+  const mem_req_t *reqs;
+  int64_t n_req;
+  pthread_barrier_t *barrier;
+  int64_t n_miss;
+} replay_worker_t;
+
+typedef struct {
+  int n_thread;
+  int64_t n_req;
+  int64_t n_miss;
+  /* the fastest of the repeated runs */
+  double elapsed_sec;
+} replay_result_t;
+
+static const char *dispatch_name[] = {"hash", "rr"};
+
+/* split the requests into one array per thread */
+static mem_req_t **dispatch_requests(const mem_trace_t *trace, int n_thread, dispatch_e dispatch,
+                                        int64_t *n_reqs) {
+  mem_req_t **parts = malloc(sizeof(mem_req_t *) * n_thread);
+  int *owner = malloc(sizeof(int) * trace->n_req);
+  memset(n_reqs, 0, sizeof(int64_t) * n_thread);
+
+  for (int64_t i = 0; i < trace->n_req; i++) {
+    if (dispatch == DISPATCH_HASH) {
+      uint64_t hv = (uint64_t)trace->reqs[i].obj_id * 0x9e3779b97f4a7c15ULL;
+      owner[i] = (int)(((hv >> 32) * (uint64_t)n_thread) >> 32);
+    } else {
+      owner[i] = (int)(i % n_thread);
+    }
+    n_reqs[owner[i]] += 1;
+  }
+
+  for (int t = 0; t < n_thread; t++) {
+    parts[t] = malloc(sizeof(mem_req_t) * (n_reqs[t] > 0 ? n_reqs[t] : 1));
+    n_reqs[t] = 0;
+  }
+  for (int64_t i = 0; i < trace->n_req; i++) {
+    parts[owner[i]][n_reqs[owner[i]]++] = trace->reqs[i];
+  }
+
+  free(owner);
+  return parts;
+}
+
+static void *replay_worker(void *arg) {
+  replay_worker_t *worker = (replay_worker_t *)arg;
+  concurrent_cache_t *cache = worker->cache;
+  request_t *req = new_request();
+  req->op = OP_GET;
+
+  pthread_barrier_wait(worker->barrier);
+  int64_t n_miss = 0;
+  for (int64_t i = 0; i < worker->n_req; i++) {
+    req->obj_id = worker->reqs[i].obj_id;
+    req->obj_size = worker->reqs[i].obj_size;
+    n_miss += !cache->get(cache, req);
+  }
+  worker->n_miss = n_miss;
+
+  free_request(req);
+  return NULL;
+}
+
+/* replay on the single-threaded cache in trace order */
+static void run_serial(const mem_trace_t *trace, const struct arguments *args, const char *algo,
+                       int64_t cache_size, replay_result_t *result) {
+  cache_t *cache = create_cache(args->trace_path, algo, cache_size, NULL, false);
+  request_t *req = new_request();
+  req->op = OP_GET;
+
+  int64_t n_miss = 0;
+  int64_t start_ns = now_ns();
+  for (int64_t i = 0; i < trace->n_req; i++) {
+    req->obj_id = trace->reqs[i].obj_id;
+    req->obj_size = trace->reqs[i].obj_size;
+    n_miss += !cache->get(cache, req);
+  }
+  int64_t end_ns = now_ns();
+
+  result->n_thread = 0;
+  result->n_req = trace->n_req;
+  result->n_miss = n_miss;
+  result->elapsed_sec = (double)(end_ns - start_ns) / 1e9;
+
+  free_request(req);
+  cache->cache_free(cache);
+}
+
+static void run_concurrent(mem_req_t **parts, const int64_t *n_reqs, int n_thread, const char *algo,
+                           const common_cache_params_t ccache_params, replay_result_t *result) {
+  concurrent_cache_t *cache = create_concurrent_cache(algo, ccache_params, NULL);
+
+  pthread_barrier_t barrier;
+  pthread_barrier_init(&barrier, NULL, n_thread + 1);
+  replay_worker_t workers[REPLAY_MAX_N_THREAD];
+  pthread_t threads[REPLAY_MAX_N_THREAD];
+  for (int t = 0; t < n_thread; t++) {
+    workers[t] = (replay_worker_t){
+        .cache = cache, .reqs = parts[t], .n_req = n_reqs[t], .barrier = &barrier, .n_miss = 0};
+    if (pthread_create(&threads[t], NULL, replay_worker, &workers[t]) != 0) {
+      ERROR("cannot create thread: %s\n", strerror(errno));
+    }
+  }
+
+  pthread_barrier_wait(&barrier);
+  int64_t start_ns = now_ns();
+  result->n_req = 0;
+  result->n_miss = 0;
+  for (int t = 0; t < n_thread; t++) {
+    pthread_join(threads[t], NULL);
+    result->n_req += workers[t].n_req;
+    result->n_miss += workers[t].n_miss;
+  }
+  int64_t end_ns = now_ns();
+
+  result->n_thread = n_thread;
+  result->elapsed_sec = (double)(end_ns - start_ns) / 1e9;
+
+  pthread_barrier_destroy(&barrier);
+  cache->cache_free(cache);
+}
+
+static void print_result(FILE *json, bool *first, const char *algo, double cache_size_ratio, int64_t cache_size,
+                         dispatch_e dispatch, const replay_result_t *result, const replay_result_t *serial,
+                         const replay_result_t *single_thread) {
+  double miss_ratio = (double)result->n_miss / result->n_req;
+  double drift = miss_ratio - (double)serial->n_miss / serial->n_req;
+  double req_per_sec = result->n_req / result->elapsed_sec;
+  double speedup = single_thread == NULL ? NAN : single_thread->elapsed_sec / result->elapsed_sec;
+
+  char n_thread_str[16] = "serial";
+  char speedup_str[16] = "-";
+  if (result->n_thread > 0) {
+    snprintf(n_thread_str, sizeof(n_thread_str), "%d", result->n_thread);
+  }
+  if (!isnan(speedup)) {
+    snprintf(speedup_str, sizeof(speedup_str), "%.2f", speedup);
+  }
+  printf("%-8s %8.4f %8s %10.2f %8s %10.4f %+10.4f\n", algo, cache_size_ratio, n_thread_str, req_per_sec / 1e6,
+         speedup_str, miss_ratio, drift);
+  fflush(stdout);
+
+  if (json == NULL) return;
+  fprintf(json, "%s    {\"algo\": ", *first ? "" : ",\n");
+  write_json_str(json, algo);
+  fprintf(json,
+          ", \"cache_size_ratio\": %g, \"cache_size\": %lld, \"n_thread\": %d, "
+          "\"dispatch\": \"%s\", \"n_req\": %lld, \"miss_ratio\": %.6f, \"miss_ratio_drift\": %.6f, "
+          "\"req_per_sec\": %.0f, \"speedup\": %.4f}",
+          cache_size_ratio, (long long)cache_size, result->n_thread,
+          result->n_thread > 0 ? dispatch_name[dispatch] : "serial", (long long)result->n_req, miss_ratio, drift,
+          req_per_sec, isnan(speedup) ? 0 : speedup);
+  *first = false;
+}
+
+int main(int argc, char **argv) {
+  struct arguments args;
+  parse_cmd(argc, argv, &args);
+
+  for (int a = 0; a < args.n_eviction_algo; a++) {
+    common_cache_params_t ccache_params = default_common_cache_params();
+    concurrent_cache_t *cache = create_concurrent_cache(args.eviction_algo[a], ccache_params, NULL);
+    if (cache == NULL) {
+      ERROR("%s does not have a concurrent variant, supported fifo, clock, sieve and s3fifo\n",
+            args.eviction_algo[a]);
+    }
+    cache->cache_free(cache);
+  }
+
+  mem_trace_t trace;
+  load_mem_trace(args.trace_type_str, args.trace_path, args.n_req, &trace);
+  INFO("%s: %lld req, working set %lld objects %lld bytes, dispatch %s\n", args.trace_path, (long long)trace.n_req,
+       (long long)trace.wss_obj, (long long)trace.wss_byte, dispatch_name[args.dispatch]);
+
+  FILE *json = NULL;
+  if (args.ofilepath[0] != '\0') {
+    json = fopen(args.ofilepath, "w");
+    if (json == NULL) {
+      ERROR("cannot open %s: %s\n", args.ofilepath, strerror(errno));
+    }
+    fprintf(json, "{\n  \"trace\": ");
+    write_json_str(json, args.trace_path);
+    fprintf(json, ",\n  \"results\": [\n");
+  }
+
+  printf("%-8s %8s %8s %10s %8s %10s %10s\n", "algo", "size", "threads", "Mreq/s", "speedup", "miss ratio",
+         "drift");
+  bool first = true;
+  for (int s = 0; s < args.n_cache_size; s++) {
+    int64_t cache_size = (int64_t)(trace.wss_byte * args.cache_size_ratios[s]);
+    if (cache_size <= 0) cache_size = 1;
+
+    /* the hash table of the concurrent caches does not grow */
+    common_cache_params_t ccache_params = default_common_cache_params();
+    ccache_params.cache_size = cache_size;
+    ccache_params.hashpower = 10;
+    while (ccache_params.hashpower < 28 && (1LL << ccache_params.hashpower) < trace.wss_obj) {
+      ccache_params.hashpower += 1;
+    }
+
+    for (int a = 0; a < args.n_eviction_algo; a++) {
+      const char *algo = args.eviction_algo[a];
+      replay_result_t serial, result, best, single_thread;
+      memset(&serial, 0, sizeof(serial));
+      for (int r = 0; r < args.repeat; r++) {
+        run_serial(&trace, &args, algo, cache_size, &result);
+        if (r == 0 || result.elapsed_sec < serial.elapsed_sec) serial = result;
+      }
+      print_result(json, &first, algo, args.cache_size_ratios[s], cache_size, args.dispatch, &serial, &serial, NULL);
+
+      memset(&single_thread, 0, sizeof(single_thread));
+      for (int c = 0; c < args.n_thread_config; c++) {
+        int n_thread = args.n_threads[c];
+        int64_t n_reqs[REPLAY_MAX_N_THREAD];
+        mem_req_t **parts = dispatch_requests(&trace, n_thread, args.dispatch, n_reqs);
+
+        memset(&best, 0, sizeof(best));
+        for (int r = 0; r < args.repeat; r++) {
+          run_concurrent(parts, n_reqs, n_thread, algo, ccache_params, &result);
+          if (r == 0 || result.elapsed_sec < best.elapsed_sec) best = result;
+        }
+        if (n_thread == 1) single_thread = best;
+
+        print_result(json, &first, algo, args.cache_size_ratios[s], cache_size, args.dispatch, &best, &serial,
+                     single_thread.n_thread == 1 ? &single_thread : NULL);
+
+        for (int t = 0; t < n_thread; t++) {
+          free(parts[t]);
+        }
+        free(parts);
+      }
+    }
+  }
+
+  if (json != NULL) {
+    fprintf(json, "\n  ]\n}\n");
+    fclose(json);
+    INFO("results are written to %s\n", args.ofilepath);
+  }
+
+  free_mem_trace(&trace);
+  return 0;
+}
@@ -28,6 +28,11 @@ enum argp_option_short {
   OPTION_ACCESS_PATTERN_SAMPLE_RATIO = 0x102,
   OPTION_TRACK_N_HIT = 0x103,
   OPTION_TRACK_N_POPULAR = 0x104,
+  OPTION_PIPELINE = 0x105,
+  OPTION_PIPELINE_BATCH_SIZE = 0x106,
+  OPTION_OBJ_TABLE_MEM_GB = 0x107,
+  OPTION_POPULARITY_TOP_K = 0x108,
+  OPTION_POPULARITY_SKETCH_MERGE = 0x109,
 
   OPTION_ENABLE_ALL = 0x200,
   OPTION_ENABLE_COMMON = 0x201,
@@ -107,6 +112,25 @@ static struct argp_option options[] = {
      "track one-hit-wonder, two-hit-wonder, etc.", 4},
     {"track-n-popular", OPTION_TRACK_N_POPULAR, "8", 0,
      "track how many requests the n most popular objects get", 4},
+    {"pipeline", OPTION_PIPELINE, "false", OPTION_ARG_OPTIONAL,
+     "run each analysis module on its own thread, the results are the same as "
+     "the single-threaded run",
+     4},
+    {"pipeline-batch-size", OPTION_PIPELINE_BATCH_SIZE, "4096", 0,
+     "the number of requests passed to the module threads at a time", 4},
+    {"obj-table-mem-gb", OPTION_OBJ_TABLE_MEM_GB, "0", 0,
+     "memory budget (GiB) of the object table, objects are spatially sampled "
+     "when the table grows beyond the budget, default 0 means unbounded",
+     4},
+    {"popularity-top-k", OPTION_POPULARITY_TOP_K, "0", 0,
+     "use a streaming top-k sketch and HyperLogLog in popularity analysis, "
+     "default 0 means exact popularity using all objects",
+     4},
+    {"popularity-sketch-merge", OPTION_POPULARITY_SKETCH_MERGE,
+     "a.popularitySketch,b.popularitySketch", 0,
+     "merge the popularity sketches saved by other runs into the sketch of this "
+     "trace, requires popularity-top-k",
+     4},
 
     {NULL, 0, NULL, 0, "common parameters:", 0},
 
@@ -149,6 +173,22 @@ static error_t parse_opt(int key, char *arg, struct argp_state *state) {
     case OPTION_TRACK_N_HIT:
       arguments->analysis_param.track_n_hit = atoi(arg);
       break;
+    case OPTION_PIPELINE:
+      arguments->analysis_param.pipeline = arg == NULL || is_true(arg);
+      break;
+    case OPTION_PIPELINE_BATCH_SIZE:
+      arguments->analysis_param.pipeline_batch_size = atoi(arg);
+      break;
+    case OPTION_POPULARITY_TOP_K:
+      arguments->analysis_param.popularity_top_k = atoi(arg);
+      break;
+    case OPTION_POPULARITY_SKETCH_MERGE:
+      arguments->analysis_param.popularity_sketch_merge = arg;
+      break;
+    case OPTION_OBJ_TABLE_MEM_GB:
+      arguments->analysis_param.obj_table_mem_budget =
+          (int64_t)(atof(arg) * GiB);
+      break;
     case OPTION_ENABLE_ALL:
       arguments->analysis_option.req_rate = true;
       arguments->analysis_option.access_pattern = true;
@@ -266,6 +306,11 @@ void parse_cmd(int argc, char *argv[], struct arguments *args) {
 
   argp_parse(&argp, argc, argv, 0, 0, args);
 
+  if (args->analysis_param.popularity_sketch_merge != NULL &&
+      args->analysis_param.popularity_top_k <= 0) {
+    ERROR("popularity-sketch-merge requires popularity-top-k\n");
+  }
+
   args->trace_path = args->args[0];
   const char *trace_type_str = args->args[1];
 
@@ -2,6 +2,7 @@
 
 #include <sys/types.h>
 
+#include <algorithm>
 #include <cmath>
 #include <cstdint>
 
@@ -13,6 +14,33 @@
 const double EWMA_DECAY = 0.3;
 const double gss_r = 0.61803399;
 const double tol = 3.0e-8;
+// an object whose decayed request count is below this is forgotten
+const double STALE_SEEN_TIMES = 0.1;
+// the scaled request counts are renormalized before the scale underflows
+const int RESCALE_LOG2 = 64;
+// the number of objects checked for staleness on each request
+const int N_SWEEP_PER_REQ = 2;
+
+/**
+ * @brief the index of a logarithmic bucket, each power of two has
+ * ADAPTSIZE_N_SUB_BUCKET buckets
+ * @param x a positive number
+ */
+static inline int log_bucket(double x) {
+  int exp2;
+  double mantissa = frexp(x, &exp2);
+  return exp2 * ADAPTSIZE_N_SUB_BUCKET +
+         (int)((mantissa - 0.5) * 2 * ADAPTSIZE_N_SUB_BUCKET);
+}
+
+static inline int histogram_bucket(double scaled_seen_times, int64_t obj_size) {
+  int rate_idx = log_bucket(scaled_seen_times) + 8 * ADAPTSIZE_N_SUB_BUCKET;
+  int size_idx =
+      log_bucket(obj_size > 1 ? obj_size : 1) - ADAPTSIZE_N_SUB_BUCKET;
+  rate_idx = std::min(std::max(rate_idx, 0), ADAPTSIZE_N_RATE_BUCKET - 1);
+  size_idx = std::min(std::max(size_idx, 0), ADAPTSIZE_N_SIZE_BUCKET - 1);
+  return rate_idx * ADAPTSIZE_N_SIZE_BUCKET + size_idx;
+}
 
 /**
  * @brief Initialzie Adaptstat
@@ -27,88 +55,81 @@ Adaptsize::Adaptsize(const uint64_t max_iteration_param,
       next_reconf(reconf_interval_param),
       stat_size(0),
       c_param(1 << 15),
-      gss_v(1 - gss_r) {}
+      gss_v(1 - gss_r),
+      epoch(0),
+      scale(1.0),
+      next_scale(1.0),
+      sweep_pos(0),
+      histogram(ADAPTSIZE_N_RATE_BUCKET * ADAPTSIZE_N_SIZE_BUCKET,
+                bucket_info{0, 0.0, 0.0}) {}
 
 /**
  * @brief Copy constructor
  * @param other The Adaptsize object to copy from
  */
-Adaptsize::Adaptsize(const Adaptsize& other)
-    : cache_size(other.cache_size),
-      max_iteration(other.max_iteration),
-      reconf_interval(other.reconf_interval),
-      next_reconf(other.next_reconf),
-      stat_size(other.stat_size),
-      c_param(other.c_param),
-      gss_v(other.gss_v),
-      interval_metadata(other.interval_metadata),
-      longterm_metadata(other.longterm_metadata),
-      aligned_obj_size(other.aligned_obj_size),
-      aligned_obj_seen_times(other.aligned_obj_seen_times),
-      aligned_admission_probs(other.aligned_admission_probs) {}
+Adaptsize::Adaptsize(const Adaptsize& other) = default;
 
 /**
  * @brief Move constructor
  * @param other The Adaptsize object to move from
  */
-Adaptsize::Adaptsize(Adaptsize&& other) noexcept
-    : cache_size(other.cache_size),
-      max_iteration(other.max_iteration),
-      reconf_interval(other.reconf_interval),
-      next_reconf(other.next_reconf),
-      stat_size(other.stat_size),
-      c_param(other.c_param),
-      gss_v(other.gss_v),
-      interval_metadata(std::move(other.interval_metadata)),
-      longterm_metadata(std::move(other.longterm_metadata)),
-      aligned_obj_size(std::move(other.aligned_obj_size)),
-      aligned_obj_seen_times(std::move(other.aligned_obj_seen_times)),
-      aligned_admission_probs(std::move(other.aligned_admission_probs)) {}
+Adaptsize::Adaptsize(Adaptsize&& other) noexcept = default;
 
 /**
  * @brief Copy assignment operator
  * @param other The Adaptsize object to copy from
  * @return Reference to this object
  */
-Adaptsize& Adaptsize::operator=(const Adaptsize& other) {
-  if (this != &other) {
-    cache_size = other.cache_size;
-    max_iteration = other.max_iteration;
-    reconf_interval = other.reconf_interval;
-    next_reconf = other.next_reconf;
-    stat_size = other.stat_size;
-    c_param = other.c_param;
-    gss_v = other.gss_v;
-    interval_metadata = other.interval_metadata;
-    longterm_metadata = other.longterm_metadata;
-    aligned_obj_size = other.aligned_obj_size;
-    aligned_obj_seen_times = other.aligned_obj_seen_times;
-    aligned_admission_probs = other.aligned_admission_probs;
-  }
-  return *this;
-}
+Adaptsize& Adaptsize::operator=(const Adaptsize& other) = default;
 
 /**
  * @brief Move assignment operator
  * @param other The Adaptsize object to move from
  * @return Reference to this object
  */
-Adaptsize& Adaptsize::operator=(Adaptsize&& other) noexcept {
-  if (this != &other) {
-    cache_size = other.cache_size;
-    max_iteration = other.max_iteration;
-    reconf_interval = other.reconf_interval;
-    next_reconf = other.next_reconf;
-    stat_size = other.stat_size;
-    c_param = other.c_param;
-    gss_v = other.gss_v;
-    interval_metadata = std::move(other.interval_metadata);
-    longterm_metadata = std::move(other.longterm_metadata);
-    aligned_obj_size = std::move(other.aligned_obj_size);
-    aligned_obj_seen_times = std::move(other.aligned_obj_seen_times);
-    aligned_admission_probs = std::move(other.aligned_admission_probs);
+Adaptsize& Adaptsize::operator=(Adaptsize&& other) noexcept = default;
+
+/**
+ * @brief add an object to (sign = 1) or remove it from (sign = -1) the
+ * histogram
+ */
+void Adaptsize::histogram_add(const obj_info& obj, int sign) {
+  auto& bucket = histogram[histogram_bucket(obj.scaled_seen_times, obj.obj_size)];
+  bucket.n_obj += sign;
+  if (bucket.n_obj == 0) {
+    // drop the rounding error of the sums
+    bucket.scaled_seen_times = 0;
+    bucket.obj_size = 0;
+  } else {
+    bucket.scaled_seen_times += sign * obj.scaled_seen_times;
+    bucket.obj_size += sign * (double)obj.obj_size;
+  }
+}
+
+void Adaptsize::remove_obj(uint32_t idx) {
+  histogram_add(objs[idx], -1);
+  stat_size -= objs[idx].obj_size;
+  obj_index.erase(objs[idx].obj_id);
+  if (idx != objs.size() - 1) {
+    objs[idx] = objs.back();
+    obj_index[objs[idx].obj_id] = idx;
+  }
+  objs.pop_back();
+}
+
+/**
+ * @brief multiply the scale by 2^RESCALE_LOG2 and divide the scaled request
+ * counts by it, this touches all objects, but only happens once every
+ * RESCALE_LOG2 / log2(1 / EWMA_DECAY) reconfigurations
+ */
+void Adaptsize::rescale() {
+  scale = ldexp(scale, RESCALE_LOG2);
+  next_scale = ldexp(next_scale, RESCALE_LOG2);
+  std::fill(histogram.begin(), histogram.end(), bucket_info{0, 0.0, 0.0});
+  for (auto& obj : objs) {
+    obj.scaled_seen_times = ldexp(obj.scaled_seen_times, -RESCALE_LOG2);
+    histogram_add(obj, 1);
   }
-  return *this;
 }
 
 /**
@@ -120,24 +141,38 @@ void Adaptsize::updateStats(const request_t* req,
                             const uint64_t cache_size_param) {
   this->cache_size = cache_size_param;
   reconfigure();
-  if (interval_metadata.count(req->obj_id) == 0 &&
-      longterm_metadata.count(req->obj_id) == 0) {
+
+  obj_info* obj;
+  auto it = obj_index.find(req->obj_id);
+  if (it == obj_index.end()) {
+    obj_index[req->obj_id] = objs.size();
+    objs.push_back(obj_info{req->obj_id, 0.0, req->obj_size, epoch});
+    obj = &objs.back();
     stat_size += req->obj_size;
   } else {
-    if (interval_metadata.count(req->obj_id) > 0 &&
-        interval_metadata[req->obj_id].obj_size != req->obj_size) {
-      stat_size -= interval_metadata[req->obj_id].obj_size;
+    obj = &objs[it->second];
+    histogram_add(*obj, -1);
+    if (obj->obj_size != req->obj_size) {
+      stat_size -= obj->obj_size;
       stat_size += req->obj_size;
+      obj->obj_size = req->obj_size;
     }
-    if (longterm_metadata.count(req->obj_id) > 0 &&
-        longterm_metadata[req->obj_id].obj_size != req->obj_size) {
-      stat_size -= longterm_metadata[req->obj_id].obj_size;
-      stat_size += req->obj_size;
+  }
+  // the requests of this interval are added with weight 1 - EWMA_DECAY at the
+  // next reconfiguration, or weight 1 if the object is first seen in it
+  double weight = obj->first_epoch == epoch ? 1.0 : 1 - EWMA_DECAY;
+  obj->scaled_seen_times += weight / next_scale;
+  histogram_add(*obj, 1);
+
+  // forget the objects whose count will be stale at the next reconfiguration
+  for (int i = 0; i < N_SWEEP_PER_REQ && !objs.empty(); i++) {
+    if (sweep_pos >= objs.size()) sweep_pos = 0;
+    if (objs[sweep_pos].scaled_seen_times * next_scale < STALE_SEEN_TIMES) {
+      remove_obj(sweep_pos);
+    } else {
+      sweep_pos++;
     }
   }
-  auto& oinfo = interval_metadata[req->obj_id];
-  oinfo.obj_seen_times += 1.0;
-  oinfo.obj_size = req->obj_size;
 }
 
 /**
@@ -157,40 +192,39 @@ void Adaptsize::reconfigure() {
   // END Check if its time for reconfiguration
   // Prepare for reconf
   next_reconf = reconf_interval;
-  for (auto& obj : longterm_metadata) {
-    obj.second.obj_seen_times *= EWMA_DECAY;
+  epoch += 1;
+  scale = next_scale;
+  next_scale = scale * EWMA_DECAY;
+  if (next_scale < ldexp(1.0, -RESCALE_LOG2)) {
+    rescale();
   }
-  for (auto& obj : interval_metadata) {
-    if (longterm_metadata.count(obj.first) == 0) {
-      longterm_metadata[obj.first] = obj.second;
-      continue;
-    }
-    longterm_metadata[obj.first].obj_seen_times +=
-        (1 - EWMA_DECAY) * obj.second.obj_seen_times;
-    longterm_metadata[obj.first].obj_size = obj.second.obj_size;
-  }
-  interval_metadata.clear();
+
   aligned_obj_seen_times.clear();
   aligned_obj_size.clear();
+  aligned_obj_count.clear();
 
   double total_seen_times = 0.0;
-  uint64_t total_obj_size = 0.0;
+  double total_obj_size = 0.0;
 
-  for (auto it = longterm_metadata.begin(); it != longterm_metadata.end();) {
-    if (it->second.obj_seen_times < 0.1) {
-      stat_size -= it->second.obj_size;
-      it = longterm_metadata.erase(it);
+  for (auto& bucket : histogram) {
+    if (bucket.n_obj == 0) {
       continue;
     }
-    aligned_obj_seen_times.push_back(it->second.obj_seen_times);
-    total_seen_times += it->second.obj_seen_times;
-    aligned_obj_size.push_back(it->second.obj_size);
-    total_obj_size += it->second.obj_size;
-    ++it;
+    double seen_times = bucket.scaled_seen_times * scale / bucket.n_obj;
+    if (seen_times < STALE_SEEN_TIMES) {
+      continue;
+    }
+    aligned_obj_seen_times.push_back(seen_times);
+    total_seen_times += seen_times * bucket.n_obj;
+    aligned_obj_size.push_back(bucket.obj_size / bucket.n_obj);
+    total_obj_size += bucket.obj_size;
+    aligned_obj_count.push_back(bucket.n_obj);
   }
   VVERBOSE(
-      "Reconfiguring over %zu objects - log2 total size %f log2 statsize %f\n",
-      longterm_metadata.size(), log2(total_obj_size), log2(stat_size));
+      "Reconfiguring over %zu objects in %zu buckets - log2 total size %f "
+      "log2 statsize %f\n",
+      objs.size(), aligned_obj_count.size(), log2(total_obj_size),
+      log2(stat_size));
   // END Prepare for reconf
   // Finding the value of C with the best hit rate
   double x0 = 0;
@@ -291,48 +325,45 @@ static inline double oP2(double T, double l, double p) {
 double Adaptsize::modelHitRate(double log2c) {
   double old_T, the_T, the_C;
   double sum_val = 0.;
-  double thparam = log2c;
+  const double c = pow(2.0, log2c);
+  const size_t n_bucket = aligned_obj_seen_times.size();
+  const double* seen_times = aligned_obj_seen_times.data();
+  const double* obj_size = aligned_obj_size.data();
+  const double* obj_count = aligned_obj_count.data();
 
-  for (size_t i = 0; i < aligned_obj_seen_times.size(); i++) {
-    sum_val += aligned_obj_seen_times[i] *
-               (exp(-aligned_obj_size[i] / pow(2, thparam))) *
-               aligned_obj_size[i];
+  aligned_admission_probs.resize(n_bucket);
+  double* admission_probs = aligned_admission_probs.data();
+  for (size_t i = 0; i < n_bucket; i++) {
+    admission_probs[i] = exp(-obj_size[i] / c);
+    sum_val += obj_count[i] * seen_times[i] * admission_probs[i] * obj_size[i];
   }
   if (sum_val <= 0) {
     return (0);
   }
   the_T = cache_size / sum_val;
-  aligned_admission_probs.clear();
-  for (size_t i = 0; i < aligned_obj_seen_times.size(); i++) {
-    aligned_admission_probs.push_back(
-        exp(-aligned_obj_size[i] / pow(2.0, thparam)));
-  }
   for (int j = 0; j < 20; j++) {
     the_C = 0;
     if (the_T > 1e70) {
       break;
     }
-    for (size_t i = 0; i < aligned_obj_seen_times.size(); i++) {
-      const double reqTProd = aligned_obj_seen_times[i] * the_T;
-      if (reqTProd > 150) {
-        the_C += aligned_obj_size[i];
-      } else {
+    for (size_t i = 0; i < n_bucket; i++) {
+      const double reqTProd = seen_times[i] * the_T;
+      double tmp = 1.0;
+      if (reqTProd <= 150) {
         const double expTerm = exp(reqTProd) - 1;
-        const double expAdmProd = aligned_admission_probs[i] * expTerm;
-        const double tmp = expAdmProd / (1 + expAdmProd);
-        the_C += aligned_obj_size[i] * tmp;
+        const double expAdmProd = admission_probs[i] * expTerm;
+        tmp = expAdmProd / (1 + expAdmProd);
       }
+      the_C += obj_count[i] * obj_size[i] * tmp;
     }
     old_T = the_T;
     the_T = cache_size * old_T / the_C;
   }
 
   double weighted_hitratio_sum = 0;
-  for (size_t i = 0; i < aligned_obj_seen_times.size(); i++) {
-    const double tmp01 =
-        oP1(the_T, aligned_obj_seen_times[i], aligned_admission_probs[i]);
-    const double tmp02 =
-        oP2(the_T, aligned_obj_seen_times[i], aligned_admission_probs[i]);
+  for (size_t i = 0; i < n_bucket; i++) {
+    const double tmp01 = oP1(the_T, seen_times[i], admission_probs[i]);
+    const double tmp02 = oP2(the_T, seen_times[i], admission_probs[i]);
     double tmp;
     if (tmp01 != 0 && tmp02 == 0)
       tmp = 0.0;
@@ -342,7 +373,7 @@ double Adaptsize::modelHitRate(double log2c) {
       tmp = 0.0;
     else if (tmp > 1.0)
       tmp = 1.0;
-    weighted_hitratio_sum += aligned_obj_seen_times[i] * tmp;
+    weighted_hitratio_sum += obj_count[i] * seen_times[i] * tmp;
   }
   return weighted_hitratio_sum;
-}
\ No newline at end of file
+}
@@ -9,6 +9,13 @@
 
 #include "../../include/libCacheSim/request.h"
 
+// the request rate and the size of the objects are kept in a histogram of
+// (log rate, log size) buckets, which is updated on every request, so
+// reconfiguration evaluates the model over the buckets instead of the objects
+#define ADAPTSIZE_N_SUB_BUCKET 4
+#define ADAPTSIZE_N_SIZE_BUCKET (48 * ADAPTSIZE_N_SUB_BUCKET)
+#define ADAPTSIZE_N_RATE_BUCKET (96 * ADAPTSIZE_N_SUB_BUCKET)
+
 class Adaptsize {
  public:
   Adaptsize(const uint64_t max_iteration, const uint64_t reconf_interval);
@@ -32,6 +39,27 @@ class Adaptsize {
   void reconfigure();
   double modelHitRate(double log2c);
 
+  /* the decayed request count of an object is scaled_seen_times * scale,
+   * scale is multiplied by EWMA_DECAY at each reconfiguration, so the decay
+   * does not touch the objects */
+  struct obj_info {
+    obj_id_t obj_id;
+    double scaled_seen_times;
+    int64_t obj_size;
+    /* the reconfiguration epoch the object is first seen in */
+    uint64_t first_epoch;
+  };
+
+  struct bucket_info {
+    int64_t n_obj;
+    double scaled_seen_times;
+    double obj_size;
+  };
+
+  void histogram_add(const obj_info& obj, int sign);
+  void remove_obj(uint32_t idx);
+  void rescale();
+
   uint64_t cache_size;
   uint64_t max_iteration;
   uint64_t reconf_interval;
@@ -40,15 +68,21 @@ class Adaptsize {
   double c_param;
   double gss_v;
 
-  struct obj_info {
-    double obj_seen_times;
-    int64_t obj_size;
-  };
+  uint64_t epoch;
+  /* the scale of the last reconfiguration and the next one */
+  double scale;
+  double next_scale;
+  /* the next object checked for removal */
+  uint32_t sweep_pos;
+
+  std::unordered_map<obj_id_t, uint32_t> obj_index;
+  std::vector<obj_info> objs;
+  std::vector<bucket_info> histogram;
 
-  std::unordered_map<obj_id_t, obj_info> interval_metadata;
-  std::unordered_map<obj_id_t, obj_info> longterm_metadata;
+  // one entry for each non-empty bucket, filled at reconfiguration
   std::vector<double> aligned_obj_size;
   std::vector<double> aligned_obj_seen_times;
+  std::vector<double> aligned_obj_count;
   std::vector<double> aligned_admission_probs;
 };
 
@@ -1,33 +1,221 @@
 //
 // Created by Juncheng on 5/29/21.
 //
+// admit an object on its second request, the seen objects are recorded in
+// rotating generations of blocked bloom filters, when the current generation
+// has recorded as many objects as the cache can hold, the oldest generation
+// is cleared and becomes the current one, so the memory is bounded and the
+// objects not requested for several generations are forgotten
+//
+// each filter is an array of 64-byte blocks, all bits of an object are in one
+// block, so a lookup touches one cache line, which has a slightly higher false
+// positive rate than a standard bloom filter of the same size
+//
+// parameters
+// fpr: the false positive rate of one generation, a smaller rate uses more
+//      bits per object, default 0.01
+// n-gen: the number of generations, default 2
+// capacity-ratio: the number of objects recorded by one generation divided by
+//      the number of objects the cache can hold, default 1
+//
 
-#include <glib.h>
+#include <math.h>
 #include <stdbool.h>
 
 #include "../../include/libCacheSim/admissionAlgo.h"
+#include "../../include/libCacheSim/macro.h"
+#include "../../utils/include/mymath.h"
 
 #ifdef __cplusplus
 extern "C" {
 #endif
 
+#define BF_BLOCK_N_BIT 512
+#define BF_MAX_N_GEN 16
+#define BF_MIN_GEN_CAPACITY 1024
+
+typedef struct {
+  uint64_t bits[BF_BLOCK_N_BIT / 64];
+} __attribute__((aligned(64))) bf_block_t;
+
+typedef struct {
+  bf_block_t *blocks;
+  uint64_t n_block;
+  int64_t n_insert;
+} bf_generation_t;
+
 typedef struct bloomfilter_admission {
-  GHashTable *seen_times;
+  double fpr;
+  int n_gen;
+  double capacity_ratio;
+  int n_hash;
+  double bits_per_obj;
+
+  bf_generation_t gens[BF_MAX_N_GEN];
+  int curr_gen;
+  /* the number of objects a generation records before rotation */
+  int64_t gen_capacity;
+
+  /* used to estimate the number of objects the cache can hold */
+  uint64_t cache_size;
+  int64_t n_req;
+  int64_t n_req_byte;
 } bf_admission_params_t;
 
+static inline uint64_t bf_hash(obj_id_t obj_id) { return mix64((uint64_t)obj_id); }
+
+static inline bf_block_t *bf_get_block(const bf_generation_t *gen, uint64_t hv) {
+  return &gen->blocks[((hv >> 32) * gen->n_block) >> 32];
+}
+
+/* the bits in the block use another hash, because the objects in a block
+ * share the upper bits of hv */
+static inline void bf_bit_hash(uint64_t hv, uint32_t *h1, uint32_t *h2) {
+  hv *= 0x9e3779b97f4a7c15ULL;
+  *h1 = (uint32_t)hv;
+  *h2 = (uint32_t)(hv >> 32) | 1;
+}
+
+static bool bf_block_contains(const bf_block_t *block, uint64_t hv, int n_hash) {
+  uint32_t h1, h2;
+  bf_bit_hash(hv, &h1, &h2);
+  for (int i = 0; i < n_hash; i++) {
+    uint32_t bit = (h1 + i * h2) & (BF_BLOCK_N_BIT - 1);
+    if ((block->bits[bit / 64] & (1ULL << (bit % 64))) == 0) return false;
+  }
+  return true;
+}
+
+static void bf_block_insert(bf_block_t *block, uint64_t hv, int n_hash) {
+  uint32_t h1, h2;
+  bf_bit_hash(hv, &h1, &h2);
+  for (int i = 0; i < n_hash; i++) {
+    uint32_t bit = (h1 + i * h2) & (BF_BLOCK_N_BIT - 1);
+    block->bits[bit / 64] |= 1ULL << (bit % 64);
+  }
+}
+
+/* the number of objects the cache can hold, estimated from the mean size of
+ * the requested objects */
+static int64_t bf_estimate_gen_capacity(const bf_admission_params_t *bf) {
+  double n_obj = BF_MIN_GEN_CAPACITY;
+  if (bf->cache_size > 0 && bf->n_req_byte > 0) {
+    double mean_obj_size = (double)bf->n_req_byte / (double)bf->n_req;
+    n_obj = (double)bf->cache_size / mean_obj_size * bf->capacity_ratio;
+  }
+  return MAX((int64_t)n_obj, BF_MIN_GEN_CAPACITY);
+}
+
+/* clear the generation and resize it for the current capacity estimate */
+static void bf_reset_generation(bf_admission_params_t *bf, bf_generation_t *gen) {
+  uint64_t n_block = (uint64_t)ceil(bf->gen_capacity * bf->bits_per_obj / BF_BLOCK_N_BIT);
+  if (gen->n_block != n_block) {
+    free(gen->blocks);
+    gen->blocks = aligned_alloc(64, sizeof(bf_block_t) * n_block);
+    gen->n_block = n_block;
+  }
+  memset(gen->blocks, 0, sizeof(bf_block_t) * n_block);
+  gen->n_insert = 0;
+}
+
+static void bf_rotate(bf_admission_params_t *bf) {
+  bf->gen_capacity = bf_estimate_gen_capacity(bf);
+  bf->curr_gen = (bf->curr_gen + 1) % bf->n_gen;
+  bf_reset_generation(bf, &bf->gens[bf->curr_gen]);
+}
+
+void bloomfilter_update(admissioner_t *admissioner, const request_t *req, const uint64_t cache_size) {
+  bf_admission_params_t *bf = admissioner->params;
+  bf->cache_size = cache_size;
+  bf->n_req += 1;
+  bf->n_req_byte += req->obj_size;
+}
+
 bool bloomfilter_admit(admissioner_t *admissioner, const request_t *req) {
   bf_admission_params_t *bf = admissioner->params;
-  gpointer key = GINT_TO_POINTER(req->obj_id);
-  gpointer n_times =
-      g_hash_table_lookup(bf->seen_times, GSIZE_TO_POINTER(req->obj_id));
-  if (n_times == NULL) {
-    g_hash_table_insert(bf->seen_times, key, GINT_TO_POINTER(1));
-    return false;
-  } else {
-    g_hash_table_insert(bf->seen_times, key,
-                        GINT_TO_POINTER(GPOINTER_TO_INT(n_times) + 1));
+  if (unlikely(bf->gens[0].blocks == NULL)) {
+    bf->gen_capacity = bf_estimate_gen_capacity(bf);
+    for (int i = 0; i < bf->n_gen; i++) {
+      bf_reset_generation(bf, &bf->gens[i]);
+    }
+  }
+
+  uint64_t hv = bf_hash(req->obj_id);
+  bf_generation_t *curr = &bf->gens[bf->curr_gen];
+  bf_block_t *curr_block = bf_get_block(curr, hv);
+  if (bf_block_contains(curr_block, hv, bf->n_hash)) {
     return true;
   }
+
+  bool seen = false;
+  for (int i = 0; i < bf->n_gen; i++) {
+    if (i != bf->curr_gen && bf_block_contains(bf_get_block(&bf->gens[i], hv), hv, bf->n_hash)) {
+      seen = true;
+      break;
+    }
+  }
+
+  /* an object seen in an old generation is recorded in the current one so
+   * that it is not forgotten when the old generation is cleared */
+  bf_block_insert(curr_block, hv, bf->n_hash);
+  curr->n_insert += 1;
+  if (curr->n_insert >= bf->gen_capacity) {
+    bf_rotate(bf);
+  }
+
+  return seen;
+}
+
+static void bloomfilter_parse_params(const char *init_params, bf_admission_params_t *bf) {
+  bf->fpr = 0.01;
+  bf->n_gen = 2;
+  bf->capacity_ratio = 1.0;
+
+  if (init_params != NULL) {
+    char *params_str = strdup(init_params);
+    char *old_params_str = params_str;
+    char *end;
+
+    while (params_str != NULL && params_str[0] != '\0') {
+      /* different parameters are separated by comma,
+       * key and value are separated by = */
+      char *key = strsep((char **)&params_str, "=");
+      char *value = strsep((char **)&params_str, ",");
+
+      // skip the white space
+      while (params_str != NULL && *params_str == ' ') {
+        params_str++;
+      }
+
+      if (strcasecmp(key, "fpr") == 0) {
+        bf->fpr = strtod(value, &end);
+      } else if (strcasecmp(key, "n-gen") == 0) {
+        bf->n_gen = (int)strtol(value, &end, 0);
+      } else if (strcasecmp(key, "capacity-ratio") == 0) {
+        bf->capacity_ratio = strtod(value, &end);
+      } else {
+        ERROR("bloomfilter admission does not have parameter %s\n", key);
+      }
+      if (strlen(end) > 2) {
+        ERROR("param parsing error, find string \"%s\" after number\n", end);
+      }
+    }
+    free(old_params_str);
+  }
+
+  if (bf->fpr <= 0 || bf->fpr >= 1) {
+    ERROR("bloomfilter admission fpr should be in (0, 1), get %lf\n", bf->fpr);
+  }
+  if (bf->n_gen < 2 || bf->n_gen > BF_MAX_N_GEN) {
+    ERROR("bloomfilter admission n-gen should be 2 - %d, get %d\n", BF_MAX_N_GEN, bf->n_gen);
+  }
+  if (bf->capacity_ratio <= 0) {
+    ERROR("bloomfilter admission capacity-ratio should be positive, get %lf\n", bf->capacity_ratio);
+  }
+
+  /* the optimal number of bits and hash functions of a bloom filter */
+  bf->bits_per_obj = -log(bf->fpr) / (M_LN2 * M_LN2);
+  bf->n_hash = MAX((int)round(bf->bits_per_obj * M_LN2), 1);
 }
 
 admissioner_t *clone_bloomfilter_admissioner(admissioner_t *admissioner) {
@@ -35,8 +223,10 @@ admissioner_t *clone_bloomfilter_admissioner(admissioner_t *admissioner) {
 }
 
 void free_bloomfilter_admissioner(admissioner_t *admissioner) {
-  struct bloomfilter_admission *bf = admissioner->params;
-  g_hash_table_destroy(bf->seen_times);
+  bf_admission_params_t *bf = admissioner->params;
+  for (int i = 0; i < bf->n_gen; i++) {
+    free(bf->gens[i].blocks);
+  }
   free(bf);
   if (admissioner->init_params) {
     free(admissioner->init_params);
@@ -45,23 +235,19 @@ void free_bloomfilter_admissioner(admissioner_t *admissioner) {
 }
 
 admissioner_t *create_bloomfilter_admissioner(const char *init_params) {
-  if (init_params != NULL) {
-    ERROR("bloomfilter admission does not take any parameters");
-  }
+  bf_admission_params_t *bf_params = (bf_admission_params_t *)malloc(sizeof(bf_admission_params_t));
+  memset(bf_params, 0, sizeof(bf_admission_params_t));
+  bloomfilter_parse_params(init_params, bf_params);
 
   admissioner_t *admissioner = (admissioner_t *)malloc(sizeof(admissioner_t));
   memset(admissioner, 0, sizeof(admissioner_t));
-  admissioner->init_params = NULL;
-
-  bf_admission_params_t *bf_params =
-      (bf_admission_params_t *)malloc(sizeof(bf_admission_params_t));
-  memset(bf_params, 0, sizeof(struct bloomfilter_admission));
-  bf_params->seen_times = g_hash_table_new(g_direct_hash, g_direct_equal);
+  if (init_params != NULL) admissioner->init_params = strdup(init_params);
 
   admissioner->params = bf_params;
   admissioner->clone = clone_bloomfilter_admissioner;
   admissioner->free = free_bloomfilter_admissioner;
   admissioner->admit = bloomfilter_admit;
+  admissioner->update = bloomfilter_update;
 
   strncpy(admissioner->admissioner_name, "BloomFilter", CACHE_NAME_LEN - 1);
   admissioner->admissioner_name[CACHE_NAME_LEN - 1] = '\0';
@@ -5,6 +5,8 @@
 #include "../include/libCacheSim/cache.h"
 
 #include "../dataStructure/hashtable/hashtable.h"
+#include "../dataStructure/timerWheel.h"
+#include "../include/libCacheSim/cacheOpStat.h"
 #include "../include/libCacheSim/prefetchAlgo.h"
 
 #ifdef __cplusplus
@@ -75,6 +77,9 @@ cache_t *cache_struct_init(const char *const cache_name, const common_cache_para
  */
 void cache_struct_free(cache_t *cache) {
   free_hashtable(cache->hashtable);
+  if (cache->ttl_wheel != NULL) free_timer_wheel(cache->ttl_wheel);
+  cache_free_op_stat(cache);
+  if (cache->warmup_checkpoint_path != NULL) free(cache->warmup_checkpoint_path);
   if (cache->admissioner != NULL) cache->admissioner->free(cache->admissioner);
   if (cache->prefetcher != NULL) cache->prefetcher->free(cache->prefetcher);
   my_free(sizeof(cache_t), cache);
@@ -101,6 +106,7 @@ cache_t *clone_cache(const cache_t *old_cache) {
   }
   cache->future_stack_dist = old_cache->future_stack_dist;
   cache->future_stack_dist_array_size = old_cache->future_stack_dist_array_size;
+  cache->use_static_sim = old_cache->use_static_sim;
 
   return cache;
 }
@@ -129,6 +135,7 @@ cache_t *create_cache_with_new_size(const cache_t *old_cache, uint64_t new_size)
   }
   cache->future_stack_dist = old_cache->future_stack_dist;
   cache->future_stack_dist_array_size = old_cache->future_stack_dist_array_size;
+  cache->use_static_sim = old_cache->use_static_sim;
   return cache;
 }
 
@@ -185,10 +192,12 @@ cache_obj_t *cache_find_base(cache_t *cache, const request_t *req, const bool up
 #ifdef SUPPORT_TTL
     if (cache_obj->exp_time != 0 && cache_obj->exp_time < req->clock_time) {
       if (update_cache) {
+        cache->n_expired_obj += 1;
+        cache->n_expired_byte += cache_obj->obj_size;
         cache->remove(cache, cache_obj->obj_id);
       }
 
-      cache_obj = NULL;
+      return NULL;
     }
 #endif
 
@@ -201,6 +210,61 @@ cache_obj_t *cache_find_base(cache_t *cache, const request_t *req, const bool up
   return cache_obj;
 }
 
+void cache_foreach_obj(cache_t *cache, cache_obj_iter_func_ptr iter_func, void *user_data) {
+  if (cache->foreach_obj != NULL) {
+    cache->foreach_obj(cache, iter_func, user_data);
+  } else {
+    hashtable_foreach(cache->hashtable, iter_func, user_data);
+  }
+}
+
+#ifdef SUPPORT_TTL
+static void _cache_expire_obj(obj_id_t obj_id, uint32_t exp_time, void *user_data) {
+  cache_t *cache = user_data;
+  /* look up through the cache because some caches keep the objects in the
+   * hash tables of sub-caches, clock_time 0 so that the expired object is
+   * returned */
+  request_t req;
+  memset(&req, 0, sizeof(req));
+  req.obj_id = obj_id;
+  cache_obj_t *cache_obj = cache->find(cache, &req, false);
+  /* the object has been evicted, or it has been inserted again later */
+  if (cache_obj == NULL || cache_obj->exp_time != exp_time) {
+    return;
+  }
+
+  int64_t n_obj = cache->get_n_obj(cache);
+  int64_t obj_size = cache_obj->obj_size;
+  cache->remove(cache, obj_id);
+  /* a ghost entry in the hash table is not counted */
+  if (cache->get_n_obj(cache) < n_obj) {
+    cache->n_expired_obj += 1;
+    cache->n_expired_byte += obj_size;
+  }
+}
+
+static void _cache_add_to_ttl_wheel(cache_obj_t *cache_obj, void *user_data) {
+  cache_t *cache = user_data;
+  if (cache_obj->exp_time != 0) {
+    timer_wheel_add(cache->ttl_wheel, cache_obj->obj_id, cache_obj->exp_time);
+  }
+}
+
+/**
+ * @brief remove the objects that have expired at the time of the request,
+ * so that the expired space is reclaimed before evicting live objects
+ */
+static void cache_expire_base(cache_t *cache, const request_t *req) {
+  if (unlikely(cache->ttl_wheel == NULL)) {
+    cache->ttl_wheel = create_timer_wheel(req->clock_time);
+    /* the objects restored from a checkpoint */
+    cache_foreach_obj(cache, _cache_add_to_ttl_wheel, cache);
+  }
+
+  timer_wheel_advance(cache->ttl_wheel, req->clock_time, _cache_expire_obj, cache);
+}
+#endif
+
 /**
  * @brief this function is called by all eviction algorithms
  * it performs the following logic
@@ -226,6 +290,10 @@ bool cache_get_base(cache_t *cache, const request_t *req) {
   VERBOSE("******* %s req %ld, obj %ld, obj_size %ld, cache size %ld/%ld\n", cache->cache_name, cache->n_req,
           req->obj_id, req->obj_size, cache->get_occupied_byte(cache), cache->cache_size);
 
+#ifdef SUPPORT_TTL
+  cache_expire_base(cache, req);
+#endif
+
   cache_obj_t *obj = cache->find(cache, req, true);
   bool hit = (obj != NULL);
 
@@ -240,8 +308,18 @@ bool cache_get_base(cache_t *cache, const request_t *req) {
   } else {
     while (cache->get_occupied_byte(cache) + req->obj_size + cache->obj_md_size > cache->cache_size) {
       cache->evict(cache, req);
+      cache->n_evict += 1;
     }
-    cache->insert(cache, req);
+    obj = cache->insert(cache, req);
+#ifdef SUPPORT_TTL
+    /* some algorithms do not return the inserted object */
+    if (obj == NULL || obj->obj_id != req->obj_id) {
+      obj = cache->find(cache, req, false);
+    }
+    if (obj != NULL) {
+      _cache_add_to_ttl_wheel(obj, cache);
+    }
+#endif
   }
 
   if (cache->prefetcher && cache->prefetcher->prefetch) {
@@ -0,0 +1,232 @@
+//
+//  save and restore the state of a warmed cache, so that simulations of
+//  many parameter variants can start from the same warmup
+//
+//  a checkpoint consists of a header, the common cache state and the
+//  eviction algorithm state written by cache->save_state, the objects are
+//  stored in the queue order with their per-object metadata
+//
+//  cacheCheckpoint.c
+//  libCacheSim
+//
+
+#include <errno.h>
+
+#include "../dataStructure/hashtable/hashtable.h"
+#include "../dataStructure/ringQueue.h"
+#include "../include/libCacheSim/cache.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+static const char CHECKPOINT_MAGIC[8] = {'L', 'C', 'S', 'C', 'K', 'P', 'T', '1'};
+#define CHECKPOINT_VERSION 2
+
+typedef struct {
+  char magic[8];
+  int32_t version;
+  /* the object layout depends on the compile options, e.g., SUPPORT_TTL */
+  int32_t obj_struct_size;
+  /* cache->checkpoint_algo */
+  char algo[CACHE_NAME_ARRAY_LEN];
+  char cache_name[CACHE_NAME_ARRAY_LEN];
+  char init_params[CACHE_INIT_PARAMS_LEN];
+  int64_t cache_size;
+} checkpoint_header_t;
+
+bool cache_save_obj_queue(const cache_obj_t *head, FILE *f) {
+  int64_t n_obj = 0;
+  for (const cache_obj_t *obj = head; obj != NULL; obj = obj->queue.next) {
+    n_obj += 1;
+  }
+
+  if (fwrite(&n_obj, sizeof(n_obj), 1, f) != 1) return false;
+  /* the pointers in the object are written but ignored when loading */
+  for (const cache_obj_t *obj = head; obj != NULL; obj = obj->queue.next) {
+    if (fwrite(obj, sizeof(cache_obj_t), 1, f) != 1) return false;
+  }
+
+  return true;
+}
+
+bool cache_load_obj_queue(cache_t *cache, FILE *f, cache_obj_t **head, cache_obj_t **tail) {
+  int64_t n_obj;
+  if (fread(&n_obj, sizeof(n_obj), 1, f) != 1 || n_obj < 0) return false;
+
+  request_t *req = new_request();
+  cache_obj_t obj_saved;
+  bool success = true;
+  for (int64_t i = 0; i < n_obj; i++) {
+    if (fread(&obj_saved, sizeof(cache_obj_t), 1, f) != 1) {
+      success = false;
+      break;
+    }
+
+    req->obj_id = obj_saved.obj_id;
+    req->obj_size = obj_saved.obj_size;
+    cache_obj_t *obj = hashtable_insert(cache->hashtable, req);
+    /* keep the hash chain of the new object, restore everything else */
+    cache_obj_t *hash_next = obj->hash_next;
+    memcpy(obj, &obj_saved, sizeof(cache_obj_t));
+    obj->hash_next = hash_next;
+    obj->queue.prev = NULL;
+    obj->queue.next = NULL;
+    append_obj_to_tail(head, tail, obj);
+  }
+  free_request(req);
+
+  return success;
+}
+
+bool cache_save_ring_queue(const struct ring_queue *rq, FILE *f) {
+  if (fwrite(&rq->n_obj, sizeof(rq->n_obj), 1, f) != 1) return false;
+  for (const cache_obj_t *obj = ring_queue_newest(rq); obj != NULL; obj = ring_queue_older(rq, obj)) {
+    if (fwrite(obj, sizeof(cache_obj_t), 1, f) != 1) return false;
+  }
+
+  return true;
+}
+
+bool cache_load_ring_queue(cache_t *cache, FILE *f, struct ring_queue *rq) {
+  cache_obj_t *head = NULL, *tail = NULL;
+  bool success = cache_load_obj_queue(cache, f, &head, &tail);
+
+  /* push from the oldest, ring_pos shares the memory with queue.prev */
+  cache_obj_t *obj = tail;
+  while (obj != NULL) {
+    cache_obj_t *newer = obj->queue.prev;
+    ring_queue_push(rq, obj);
+    obj = newer;
+  }
+
+  return success;
+}
+
+bool cache_save_state(const cache_t *cache, FILE *f) {
+  if (cache->save_state == NULL) {
+    WARN("%s does not support checkpoint\n", cache->cache_name);
+    return false;
+  }
+
+  bool success = fwrite(&cache->n_req, sizeof(cache->n_req), 1, f) == 1 &&
+                 fwrite(&cache->n_obj, sizeof(cache->n_obj), 1, f) == 1 &&
+                 fwrite(&cache->occupied_byte, sizeof(cache->occupied_byte), 1, f) == 1;
+
+  return success && cache->save_state(cache, f);
+}
+
+bool cache_load_state(cache_t *cache, FILE *f) {
+  if (cache->load_state == NULL) {
+    WARN("%s does not support checkpoint\n", cache->cache_name);
+    return false;
+  }
+
+  if (cache->hashtable->n_obj != 0) {
+    WARN("%s is not empty, cannot load checkpoint\n", cache->cache_name);
+    return false;
+  }
+
+  bool success = fread(&cache->n_req, sizeof(cache->n_req), 1, f) == 1 &&
+                 fread(&cache->n_obj, sizeof(cache->n_obj), 1, f) == 1 &&
+                 fread(&cache->occupied_byte, sizeof(cache->occupied_byte), 1, f) == 1;
+  cache->to_evict_candidate = NULL;
+  cache->to_evict_candidate_gen_vtime = -1;
+
+  return success && cache->load_state(cache, f);
+}
+
+bool cache_save_checkpoint(const cache_t *cache, const char *path) {
+  if (cache->save_state == NULL || cache->checkpoint_algo == NULL) {
+    WARN("%s does not support checkpoint\n", cache->cache_name);
+    return false;
+  }
+
+  if (cache->admissioner != NULL || cache->prefetcher != NULL) {
+    WARN("the state of the admission and prefetching algorithm of %s is not saved in checkpoint\n",
+         cache->cache_name);
+  }
+
+  FILE *f = fopen(path, "wb");
+  if (f == NULL) {
+    WARN("cannot open checkpoint %s: %s\n", path, strerror(errno));
+    return false;
+  }
+
+  checkpoint_header_t header;
+  memset(&header, 0, sizeof(header));
+  memcpy(header.magic, CHECKPOINT_MAGIC, sizeof(CHECKPOINT_MAGIC));
+  header.version = CHECKPOINT_VERSION;
+  header.obj_struct_size = (int32_t)sizeof(cache_obj_t);
+  strncpy(header.algo, cache->checkpoint_algo, CACHE_NAME_ARRAY_LEN - 1);
+  memcpy(header.cache_name, cache->cache_name, CACHE_NAME_ARRAY_LEN);
+  memcpy(header.init_params, cache->init_params, CACHE_INIT_PARAMS_LEN);
+  header.cache_size = cache->cache_size;
+
+  bool success = fwrite(&header, sizeof(header), 1, f) == 1 && cache_save_state(cache, f);
+  success = (fclose(f) == 0) && success;
+  if (!success) {
+    WARN("fail to write checkpoint %s\n", path);
+    remove(path);
+    return false;
+  }
+
+  INFO("save %s (size %ld, %ld objects) to checkpoint %s\n", cache->cache_name, (long)cache->cache_size,
+       (long)cache->get_n_obj(cache), path);
+  return true;
+}
+
+bool cache_load_checkpoint(cache_t *cache, const char *path) {
+  FILE *f = fopen(path, "rb");
+  if (f == NULL) {
+    WARN("cannot open checkpoint %s: %s\n", path, strerror(errno));
+    return false;
+  }
+
+  checkpoint_header_t header;
+  if (fread(&header, sizeof(header), 1, f) != 1 || memcmp(header.magic, CHECKPOINT_MAGIC, sizeof(CHECKPOINT_MAGIC)) != 0 ||
+      header.version != CHECKPOINT_VERSION) {
+    WARN("%s is not a valid cache checkpoint\n", path);
+    fclose(f);
+    return false;
+  }
+
+  if (header.obj_struct_size != (int32_t)sizeof(cache_obj_t)) {
+    WARN("checkpoint %s is created with different compile options, object size %d vs %d\n", path,
+          (int)header.obj_struct_size, (int)sizeof(cache_obj_t));
+    fclose(f);
+    return false;
+  }
+
+  /* the same algorithm may use different parameters, which are checked by
+   * load_state */
+  header.algo[CACHE_NAME_ARRAY_LEN - 1] = '\0';
+  header.cache_name[CACHE_NAME_ARRAY_LEN - 1] = '\0';
+  if (cache->checkpoint_algo == NULL || strcmp(header.algo, cache->checkpoint_algo) != 0 ||
+      header.cache_size != cache->cache_size) {
+    WARN("checkpoint %s is created by %s (size %ld), cannot be loaded into %s (size %ld)\n", path, header.cache_name,
+          (long)header.cache_size, cache->cache_name, (long)cache->cache_size);
+    fclose(f);
+    return false;
+  }
+
+  if (strcmp(header.cache_name, cache->cache_name) != 0) {
+    INFO("load the checkpoint of %s into %s\n", header.cache_name, cache->cache_name);
+  }
+
+  bool success = cache_load_state(cache, f);
+  fclose(f);
+  if (!success) {
+    WARN("fail to load checkpoint %s, the file may be truncated\n", path);
+    return false;
+  }
+
+  cache->restored_from_checkpoint = true;
+  INFO("load %s (size %ld, %ld objects) from checkpoint %s\n", cache->cache_name, (long)cache->cache_size,
+       (long)cache->get_n_obj(cache), path);
+  return true;
+}
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,341 @@
+//
+//  record the count and the sampled CPU cost of cache operations,
+//  see cacheOpStat.h
+//
+//  cacheOpStat.c
+//  libCacheSim
+//
+
+#include "../include/libCacheSim/cacheOpStat.h"
+
+#include "../dataStructure/hashtable/hashtable.h"
+
+#ifdef ENABLE_CACHE_OP_STAT
+#include <errno.h>
+#include <time.h>
+#include <unistd.h>
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+#if defined(__linux__)
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#endif
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+const char *g_cache_op_names[N_CACHE_OP] = {"get", "find", "insert", "evict", "to_evict", "remove"};
+
+#ifdef ENABLE_CACHE_OP_STAT
+
+#define OP_STAT(cache) ((cache)->op_stat)
+
+// ***********************************************************************
+// ****                                                               ****
+// ****                  cycle and perf_event counters                ****
+// ****                                                               ****
+// ***********************************************************************
+
+static inline uint64_t _read_cycles(void) {
+#if defined(__x86_64__) || defined(__i386__)
+  return __rdtsc();
+#elif defined(__aarch64__)
+  uint64_t v;
+  __asm__ __volatile__("mrs %0, cntvct_el0" : "=r"(v));
+  return v;
+#else
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+#endif
+}
+
+#if defined(__linux__)
+static int _open_perf_event(uint64_t config, int group_fd) {
+  struct perf_event_attr attr;
+  memset(&attr, 0, sizeof(attr));
+  attr.type = PERF_TYPE_HARDWARE;
+  attr.size = sizeof(attr);
+  attr.config = config;
+  attr.exclude_kernel = 1;
+  attr.exclude_hv = 1;
+  attr.read_format = PERF_FORMAT_GROUP;
+  /* measure the calling thread on any CPU */
+  return (int)syscall(__NR_perf_event_open, &attr, 0, -1, group_fd, 0);
+}
+
+/* the counters are per thread, so they are opened by the thread that runs
+ * the cache at the first sampled call */
+static bool _open_perf_events(cache_op_stat_t *stat) {
+  static const uint64_t configs[N_CACHE_OP_PERF_EVENT] = {PERF_COUNT_HW_CACHE_MISSES, PERF_COUNT_HW_BRANCH_MISSES};
+
+  for (int i = 0; i < N_CACHE_OP_PERF_EVENT; i++) {
+    stat->perf_fds[i] = _open_perf_event(configs[i], i == 0 ? -1 : stat->perf_fds[0]);
+    if (stat->perf_fds[i] < 0) {
+      WARN("cannot open perf_event counter, the cache misses and branch misses are not recorded: %s\n",
+           strerror(errno));
+      for (int j = 0; j < i; j++) {
+        close(stat->perf_fds[j]);
+        stat->perf_fds[j] = -1;
+      }
+      stat->perf_fds[i] = -1;
+      return false;
+    }
+  }
+
+  return true;
+}
+
+static inline bool _read_perf_events(cache_op_stat_t *stat, uint64_t *values) {
+  if (unlikely(stat->perf_fds[0] < 0)) {
+    if (stat->perf_event_failed || !_open_perf_events(stat)) {
+      stat->perf_event_failed = true;
+      return false;
+    }
+  }
+
+  /* {nr, values[nr]} with PERF_FORMAT_GROUP */
+  uint64_t buf[1 + N_CACHE_OP_PERF_EVENT];
+  if (read(stat->perf_fds[0], buf, sizeof(buf)) != (ssize_t)sizeof(buf)) {
+    return false;
+  }
+  memcpy(values, buf + 1, sizeof(uint64_t) * N_CACHE_OP_PERF_EVENT);
+  return true;
+}
+#else
+static inline bool _read_perf_events(cache_op_stat_t *stat, uint64_t *values) {
+  if (!stat->perf_event_failed) {
+    WARN("perf_event is only supported on Linux\n");
+    stat->perf_event_failed = true;
+  }
+  return false;
+}
+#endif
+
+// ***********************************************************************
+// ****                                                               ****
+// ****                       operation wrappers                      ****
+// ****                                                               ****
+// ***********************************************************************
+
+typedef struct {
+  uint64_t start_cycles;
+  uint64_t perf_start[N_CACHE_OP_PERF_EVENT];
+  bool sampled;
+  bool perf_valid;
+} op_sample_t;
+
+static inline void _op_start(cache_op_stat_t *stat, const cache_op_e op, op_sample_t *sample) {
+  cache_op_counter_t *counter = &stat->ops[op];
+  sample->sampled = ((uint64_t)(counter->n_call++) & stat->sample_mask) == 0;
+  if (likely(!sample->sampled)) {
+    return;
+  }
+
+  sample->perf_valid = stat->perf_event_enabled && _read_perf_events(stat, sample->perf_start);
+  sample->start_cycles = _read_cycles();
+}
+
+static inline void _op_end(cache_op_stat_t *stat, const cache_op_e op, op_sample_t *sample) {
+  if (likely(!sample->sampled)) {
+    return;
+  }
+
+  uint64_t cycles = _read_cycles() - sample->start_cycles;
+  cache_op_counter_t *counter = &stat->ops[op];
+  counter->n_sampled += 1;
+  counter->sampled_cycles += cycles;
+  if (cycles > counter->max_cycles) counter->max_cycles = cycles;
+
+  uint64_t perf_end[N_CACHE_OP_PERF_EVENT];
+  if (sample->perf_valid && _read_perf_events(stat, perf_end)) {
+    for (int i = 0; i < N_CACHE_OP_PERF_EVENT; i++) {
+      counter->perf_cnt[i] += perf_end[i] - sample->perf_start[i];
+    }
+  }
+}
+
+static bool _op_stat_get(cache_t *cache, const request_t *req) {
+  cache_op_stat_t *stat = OP_STAT(cache);
+  op_sample_t sample;
+  _op_start(stat, CACHE_OP_GET, &sample);
+  bool hit = stat->get(cache, req);
+  _op_end(stat, CACHE_OP_GET, &sample);
+  return hit;
+}
+
+static cache_obj_t *_op_stat_find(cache_t *cache, const request_t *req, const bool update_cache) {
+  cache_op_stat_t *stat = OP_STAT(cache);
+  op_sample_t sample;
+  _op_start(stat, CACHE_OP_FIND, &sample);
+  cache_obj_t *obj = stat->find(cache, req, update_cache);
+  _op_end(stat, CACHE_OP_FIND, &sample);
+  return obj;
+}
+
+static cache_obj_t *_op_stat_insert(cache_t *cache, const request_t *req) {
+  cache_op_stat_t *stat = OP_STAT(cache);
+  op_sample_t sample;
+  _op_start(stat, CACHE_OP_INSERT, &sample);
+  cache_obj_t *obj = stat->insert(cache, req);
+  _op_end(stat, CACHE_OP_INSERT, &sample);
+  return obj;
+}
+
+static void _op_stat_evict(cache_t *cache, const request_t *req) {
+  cache_op_stat_t *stat = OP_STAT(cache);
+  op_sample_t sample;
+  _op_start(stat, CACHE_OP_EVICT, &sample);
+  stat->evict(cache, req);
+  _op_end(stat, CACHE_OP_EVICT, &sample);
+}
+
+static cache_obj_t *_op_stat_to_evict(cache_t *cache, const request_t *req) {
+  cache_op_stat_t *stat = OP_STAT(cache);
+  op_sample_t sample;
+  _op_start(stat, CACHE_OP_TO_EVICT, &sample);
+  cache_obj_t *obj = stat->to_evict(cache, req);
+  _op_end(stat, CACHE_OP_TO_EVICT, &sample);
+  return obj;
+}
+
+static bool _op_stat_remove(cache_t *cache, const obj_id_t obj_id) {
+  cache_op_stat_t *stat = OP_STAT(cache);
+  op_sample_t sample;
+  _op_start(stat, CACHE_OP_REMOVE, &sample);
+  bool removed = stat->remove(cache, obj_id);
+  _op_end(stat, CACHE_OP_REMOVE, &sample);
+  return removed;
+}
+
+// ***********************************************************************
+// ****                                                               ****
+// ****                       user facing functions                   ****
+// ****                                                               ****
+// ***********************************************************************
+
+bool cache_enable_op_stat(cache_t *cache, int sample_shift, bool use_perf_event) {
+  if (cache->op_stat != NULL) {
+    WARN("%s operation stat is already enabled\n", cache->cache_name);
+    return true;
+  }
+
+  if (sample_shift < 0 || sample_shift > 30) {
+    ERROR("sample shift must be in [0, 30], %d\n", sample_shift);
+  }
+
+  cache_op_stat_t *stat = my_malloc(cache_op_stat_t);
+  memset(stat, 0, sizeof(cache_op_stat_t));
+  stat->sample_mask = (1ULL << sample_shift) - 1;
+  stat->perf_event_enabled = use_perf_event;
+  for (int i = 0; i < N_CACHE_OP_PERF_EVENT; i++) {
+    stat->perf_fds[i] = -1;
+  }
+
+  /* some algorithms do not implement all operations, e.g., to_evict */
+  stat->get = cache->get;
+  stat->find = cache->find;
+  stat->insert = cache->insert;
+  stat->evict = cache->evict;
+  stat->to_evict = cache->to_evict;
+  stat->remove = cache->remove;
+  if (cache->get != NULL) cache->get = _op_stat_get;
+  if (cache->find != NULL) cache->find = _op_stat_find;
+  if (cache->insert != NULL) cache->insert = _op_stat_insert;
+  if (cache->evict != NULL) cache->evict = _op_stat_evict;
+  if (cache->to_evict != NULL) cache->to_evict = _op_stat_to_evict;
+  if (cache->remove != NULL) cache->remove = _op_stat_remove;
+
+  cache->op_stat = stat;
+  return true;
+}
+
+const cache_op_stat_t *cache_get_op_stat(const cache_t *cache) {
+  cache_op_stat_t *stat = cache->op_stat;
+  if (stat == NULL) {
+    return NULL;
+  }
+
+#if HASHTABLE_VER == 2
+  const hashtable_t *hashtable = cache->hashtable;
+  stat->hashtable.n_lookup = hashtable->n_lookup;
+  stat->hashtable.n_lookup_step = hashtable->n_lookup_step;
+  stat->hashtable.max_chain_len = hashtable->max_chain_len;
+  stat->hashtable.n_expand = hashtable->n_expand;
+  stat->hashtable.n_shrink = hashtable->n_shrink;
+#endif
+
+  return stat;
+}
+
+void cache_print_op_stat(const cache_t *cache) {
+  const cache_op_stat_t *stat = cache_get_op_stat(cache);
+  if (stat == NULL) {
+    return;
+  }
+
+  int64_t n_req = MAX(cache->n_req, 1);
+  printf("%s operation stat (1 in %llu calls timed):\n", cache->cache_name,
+         (unsigned long long)stat->sample_mask + 1);
+  for (int i = 0; i < N_CACHE_OP; i++) {
+    const cache_op_counter_t *counter = &stat->ops[i];
+    if (counter->n_call == 0) {
+      continue;
+    }
+
+    int64_t n_sampled = MAX(counter->n_sampled, 1);
+    printf("%10s: %12lld calls (%.4lf/req), avg %8.1lf cycles, max %10llu cycles", g_cache_op_names[i],
+           (long long)counter->n_call, (double)counter->n_call / (double)n_req,
+           (double)counter->sampled_cycles / (double)n_sampled, (unsigned long long)counter->max_cycles);
+    if (stat->perf_event_enabled && !stat->perf_event_failed) {
+      printf(", %.2lf cache miss, %.2lf branch miss per call",
+             (double)counter->perf_cnt[CACHE_OP_PERF_CACHE_MISS] / (double)n_sampled,
+             (double)counter->perf_cnt[CACHE_OP_PERF_BRANCH_MISS] / (double)n_sampled);
+    }
+    printf("\n");
+  }
+
+  if (stat->hashtable.n_lookup > 0) {
+    printf("%10s: %12lld lookups, avg chain length %.2lf, max chain length %lld, %lld expansions, %lld shrinks\n",
+           "hashtable", (long long)stat->hashtable.n_lookup,
+           (double)stat->hashtable.n_lookup_step / (double)stat->hashtable.n_lookup,
+           (long long)stat->hashtable.max_chain_len, (long long)stat->hashtable.n_expand,
+           (long long)stat->hashtable.n_shrink);
+  }
+}
+
+void cache_free_op_stat(cache_t *cache) {
+  cache_op_stat_t *stat = cache->op_stat;
+  if (stat == NULL) {
+    return;
+  }
+
+  for (int i = N_CACHE_OP_PERF_EVENT - 1; i >= 0; i--) {
+    if (stat->perf_fds[i] >= 0) close(stat->perf_fds[i]);
+  }
+  my_free(sizeof(cache_op_stat_t), stat);
+  cache->op_stat = NULL;
+}
+
+#else
+
+bool cache_enable_op_stat(cache_t *cache, int sample_shift, bool use_perf_event) {
+  WARN_ONCE("libCacheSim is compiled without ENABLE_CACHE_OP_STAT, operation stat is not recorded\n");
+  return false;
+}
+
+const cache_op_stat_t *cache_get_op_stat(const cache_t *cache) { return NULL; }
+
+void cache_print_op_stat(const cache_t *cache) {}
+
+void cache_free_op_stat(cache_t *cache) {}
+
+#endif /* ENABLE_CACHE_OP_STAT */
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,129 @@
+//
+//  concurrent Clock, a hit increases the counter of the object with only the
+//  bucket lock held, the eviction checks the tail under the eviction lock,
+//  decreases the counter and moves the object to the head if the counter is
+//  positive, otherwise evicts it
+//
+//  ConcurrentClock.c
+//  libCacheSim
+//
+
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+
+#include "../../include/libCacheSim/logging.h"
+#include "concurrentCacheInternal.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+static const char *DEFAULT_PARAMS = "n-bit-counter=1";
+
+typedef struct {
+  cc_base_t base;
+  cc_queue_t q;
+  int n_bit_counter;
+  uint8_t max_freq;
+} ConcurrentClock_params_t;
+
+static void ConcurrentClock_parse_params(ConcurrentClock_params_t *params, const char *cache_specific_params);
+
+static void ConcurrentClock_on_hit(cc_base_t *base, cc_obj_t *obj) {
+  ConcurrentClock_params_t *params = (ConcurrentClock_params_t *)base;
+  cc_incr_freq(obj, params->max_freq);
+}
+
+static bool ConcurrentClock_evict(cc_base_t *base) {
+  ConcurrentClock_params_t *params = (ConcurrentClock_params_t *)base;
+  cc_obj_t *obj = params->q.tail;
+  if (obj == NULL) return false;
+
+  while (cc_decr_freq(obj) > 0) {
+    cc_queue_move_to_head(&params->q, obj);
+    obj = params->q.tail;
+  }
+
+  cc_queue_remove(&params->q, obj);
+  cc_evict_obj(base, obj);
+  return true;
+}
+
+static void ConcurrentClock_insert(cc_base_t *base, cc_obj_t *obj) {
+  ConcurrentClock_params_t *params = (ConcurrentClock_params_t *)base;
+  cc_queue_prepend(&params->q, obj);
+}
+
+concurrent_cache_t *ConcurrentClock_init(const common_cache_params_t ccache_params,
+                                         const char *cache_specific_params) {
+  ConcurrentClock_params_t *params = calloc(1, sizeof(ConcurrentClock_params_t));
+  ConcurrentClock_parse_params(params, DEFAULT_PARAMS);
+  if (cache_specific_params != NULL) {
+    ConcurrentClock_parse_params(params, cache_specific_params);
+  }
+
+  concurrent_cache_t *cache = cc_struct_init("ConcurrentClock", ccache_params, &params->base);
+  params->base.on_hit = ConcurrentClock_on_hit;
+  params->base.evict = ConcurrentClock_evict;
+  params->base.insert = ConcurrentClock_insert;
+
+  if (params->n_bit_counter != 1) {
+    snprintf(cache->cache_name, CACHE_NAME_ARRAY_LEN, "ConcurrentClock-%d", params->n_bit_counter);
+  }
+
+  return cache;
+}
+
+// ***********************************************************************
+// ****                                                               ****
+// ****                  parameter set up functions                   ****
+// ****                                                               ****
+// ***********************************************************************
+static const char *ConcurrentClock_current_params(ConcurrentClock_params_t *params) {
+  static __thread char params_str[128];
+  snprintf(params_str, 128, "n-bit-counter=%d\n", params->n_bit_counter);
+
+  return params_str;
+}
+
+static void ConcurrentClock_parse_params(ConcurrentClock_params_t *params, const char *cache_specific_params) {
+  char *params_str = strdup(cache_specific_params);
+  char *old_params_str = params_str;
+  char *end;
+
+  while (params_str != NULL && params_str[0] != '\0') {
+    /* different parameters are separated by comma,
+     * key and value are separated by = */
+    char *key = strsep((char **)&params_str, "=");
+    char *value = strsep((char **)&params_str, ",");
+
+    // skip the white space
+    while (params_str != NULL && *params_str == ' ') {
+      params_str++;
+    }
+
+    if (strcasecmp(key, "n-bit-counter") == 0) {
+      params->n_bit_counter = (int)strtol(value, &end, 0);
+      if (params->n_bit_counter < 1 || params->n_bit_counter > 7) {
+        ERROR("n-bit-counter should be in [1, 7], find %d\n", params->n_bit_counter);
+      }
+      params->max_freq = (uint8_t)((1 << params->n_bit_counter) - 1);
+      if (strlen(end) > 2) {
+        ERROR("param parsing error, find string \"%s\" after number\n", end);
+      }
+    } else if (strcasecmp(key, "print") == 0) {
+      printf("current parameters: %s\n", ConcurrentClock_current_params(params));
+      exit(0);
+    } else {
+      ERROR("ConcurrentClock does not have parameter %s, example parameters %s\n", key,
+            ConcurrentClock_current_params(params));
+      exit(1);
+    }
+  }
+  free(old_params_str);
+}
+
+#ifdef __cplusplus
+}
+#endif
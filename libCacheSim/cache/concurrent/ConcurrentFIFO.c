@@ -0,0 +1,58 @@
+//
+//  concurrent FIFO, a hit only takes the bucket lock and does not update any
+//  metadata, a miss inserts at the head and evicts from the tail under the
+//  eviction lock
+//
+//  ConcurrentFIFO.c
+//  libCacheSim
+//
+
+#include <stdlib.h>
+
+#include "../../include/libCacheSim/logging.h"
+#include "concurrentCacheInternal.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct {
+  cc_base_t base;
+  cc_queue_t q;
+} ConcurrentFIFO_params_t;
+
+static void ConcurrentFIFO_on_hit(cc_base_t *base, cc_obj_t *obj) {}
+
+static bool ConcurrentFIFO_evict(cc_base_t *base) {
+  ConcurrentFIFO_params_t *params = (ConcurrentFIFO_params_t *)base;
+  cc_obj_t *obj = params->q.tail;
+  if (obj == NULL) return false;
+
+  cc_queue_remove(&params->q, obj);
+  cc_evict_obj(base, obj);
+  return true;
+}
+
+static void ConcurrentFIFO_insert(cc_base_t *base, cc_obj_t *obj) {
+  ConcurrentFIFO_params_t *params = (ConcurrentFIFO_params_t *)base;
+  cc_queue_prepend(&params->q, obj);
+}
+
+concurrent_cache_t *ConcurrentFIFO_init(const common_cache_params_t ccache_params,
+                                        const char *cache_specific_params) {
+  if (cache_specific_params != NULL && cache_specific_params[0] != '\0') {
+    ERROR("ConcurrentFIFO does not have parameters, find %s\n", cache_specific_params);
+  }
+
+  ConcurrentFIFO_params_t *params = calloc(1, sizeof(ConcurrentFIFO_params_t));
+  concurrent_cache_t *cache = cc_struct_init("ConcurrentFIFO", ccache_params, &params->base);
+  params->base.on_hit = ConcurrentFIFO_on_hit;
+  params->base.evict = ConcurrentFIFO_evict;
+  params->base.insert = ConcurrentFIFO_insert;
+
+  return cache;
+}
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,270 @@
+//
+//  concurrent S3FIFO, a hit increases the frequency of the object with only
+//  the bucket lock held, the small, main and ghost queues are updated under
+//  the eviction lock
+//
+//  the ghost queue is a set-associative table of the object ids evicted from
+//  the small queue, each entry records the bytes inserted into the ghost
+//  before it, so an entry is in the ghost if fewer than ghost_size bytes are
+//  inserted after it, which is close to a FIFO ghost queue except that the
+//  bytes of the entries removed on ghost hits are not given back, and an
+//  entry can be replaced early when its set is full
+//
+//  ConcurrentS3FIFO.c
+//  libCacheSim
+//
+
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+
+#include "../../include/libCacheSim/logging.h"
+#include "concurrentCacheInternal.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+static const char *DEFAULT_PARAMS = "small-size-ratio=0.10,ghost-size-ratio=0.90,move-to-main-threshold=2";
+
+#define GHOST_N_WAY 4
+
+typedef struct {
+  obj_id_t obj_id;
+  /* the ghost clock when the entry is inserted */
+  int64_t ghost_clock;
+  bool valid;
+} ghost_entry_t;
+
+typedef struct {
+  cc_base_t base;
+  cc_queue_t small;
+  cc_queue_t main;
+
+  ghost_entry_t *ghost;
+  uint64_t ghost_set_mask;
+  /* the bytes inserted into the ghost */
+  int64_t ghost_clock;
+
+  int64_t small_size;
+  int64_t main_size;
+  int64_t ghost_size;
+
+  double small_size_ratio;
+  double ghost_size_ratio;
+  int move_to_main_threshold;
+
+  /* set by on_miss and used by insert in the same eviction lock section */
+  bool hit_on_ghost;
+  bool has_evicted;
+} ConcurrentS3FIFO_params_t;
+
+static void ConcurrentS3FIFO_parse_params(ConcurrentS3FIFO_params_t *params, const char *cache_specific_params);
+
+/* the entry and the entries inserted after it fit in the ghost */
+static inline bool ghost_entry_alive(const ConcurrentS3FIFO_params_t *params, const ghost_entry_t *entry) {
+  return entry->valid && params->ghost_clock - entry->ghost_clock <= params->ghost_size;
+}
+
+static inline ghost_entry_t *ghost_set(ConcurrentS3FIFO_params_t *params, const obj_id_t obj_id) {
+  uint64_t hv = (uint64_t)obj_id * 0x9e3779b97f4a7c15ULL;
+  return &params->ghost[((hv >> 32) & params->ghost_set_mask) * GHOST_N_WAY];
+}
+
+static ghost_entry_t *ghost_find(ConcurrentS3FIFO_params_t *params, const obj_id_t obj_id) {
+  ghost_entry_t *set = ghost_set(params, obj_id);
+  for (int i = 0; i < GHOST_N_WAY; i++) {
+    if (set[i].obj_id == obj_id && ghost_entry_alive(params, &set[i])) {
+      return &set[i];
+    }
+  }
+  return NULL;
+}
+
+static void ConcurrentS3FIFO_on_hit(cc_base_t *base, cc_obj_t *obj) {
+  /* the frequency is capped at 3 as in S3FIFO */
+  cc_incr_freq(obj, 3);
+}
+
+static void ConcurrentS3FIFO_on_miss(cc_base_t *base, cc_obj_t *obj) {
+  ConcurrentS3FIFO_params_t *params = (ConcurrentS3FIFO_params_t *)base;
+  ghost_entry_t *entry = ghost_find(params, obj->obj_id);
+  params->hit_on_ghost = entry != NULL;
+  if (entry != NULL) {
+    entry->valid = false;
+  }
+}
+
+static void ConcurrentS3FIFO_insert_ghost(ConcurrentS3FIFO_params_t *params, const cc_obj_t *obj) {
+  if (params->ghost_size <= 0) return;
+  /* an object already in the ghost keeps its position */
+  if (ghost_find(params, obj->obj_id) != NULL) return;
+
+  /* use a dead entry or replace the oldest one in the set */
+  ghost_entry_t *set = ghost_set(params, obj->obj_id);
+  ghost_entry_t *entry = &set[0];
+  for (int i = 0; i < GHOST_N_WAY; i++) {
+    if (!ghost_entry_alive(params, &set[i])) {
+      entry = &set[i];
+      break;
+    }
+    if (set[i].ghost_clock < entry->ghost_clock) {
+      entry = &set[i];
+    }
+  }
+
+  entry->obj_id = obj->obj_id;
+  entry->ghost_clock = params->ghost_clock;
+  entry->valid = true;
+  params->ghost_clock += obj->obj_size;
+}
+
+static void ConcurrentS3FIFO_evict_small(ConcurrentS3FIFO_params_t *params) {
+  while (params->small.tail != NULL) {
+    cc_obj_t *obj = params->small.tail;
+    cc_queue_remove(&params->small, obj);
+
+    if (cc_load_freq(obj) >= params->move_to_main_threshold) {
+      cc_store_freq(obj, 0);
+      cc_queue_prepend(&params->main, obj);
+    } else {
+      ConcurrentS3FIFO_insert_ghost(params, obj);
+      cc_evict_obj(&params->base, obj);
+      return;
+    }
+  }
+}
+
+static void ConcurrentS3FIFO_evict_main(ConcurrentS3FIFO_params_t *params) {
+  while (params->main.tail != NULL) {
+    cc_obj_t *obj = params->main.tail;
+    if (cc_decr_freq(obj) > 0) {
+      cc_queue_move_to_head(&params->main, obj);
+    } else {
+      cc_queue_remove(&params->main, obj);
+      cc_evict_obj(&params->base, obj);
+      return;
+    }
+  }
+}
+
+static bool ConcurrentS3FIFO_evict(cc_base_t *base) {
+  ConcurrentS3FIFO_params_t *params = (ConcurrentS3FIFO_params_t *)base;
+  if (params->small.tail == NULL && params->main.tail == NULL) return false;
+
+  params->has_evicted = true;
+  if (params->main.n_byte > params->main_size || params->small.n_byte == 0) {
+    ConcurrentS3FIFO_evict_main(params);
+  } else {
+    ConcurrentS3FIFO_evict_small(params);
+  }
+  return true;
+}
+
+static void ConcurrentS3FIFO_insert(cc_base_t *base, cc_obj_t *obj) {
+  ConcurrentS3FIFO_params_t *params = (ConcurrentS3FIFO_params_t *)base;
+
+  if (params->hit_on_ghost ||
+      (!params->has_evicted && params->small.n_byte >= params->small_size)) {
+    cc_queue_prepend(&params->main, obj);
+  } else {
+    cc_queue_prepend(&params->small, obj);
+  }
+  params->hit_on_ghost = false;
+}
+
+static void ConcurrentS3FIFO_free(concurrent_cache_t *cache) {
+  ConcurrentS3FIFO_params_t *params = (ConcurrentS3FIFO_params_t *)cache->cc_params;
+  free(params->ghost);
+  cc_struct_free(cache);
+}
+
+concurrent_cache_t *ConcurrentS3FIFO_init(const common_cache_params_t ccache_params,
+                                          const char *cache_specific_params) {
+  ConcurrentS3FIFO_params_t *params = calloc(1, sizeof(ConcurrentS3FIFO_params_t));
+  ConcurrentS3FIFO_parse_params(params, DEFAULT_PARAMS);
+  if (cache_specific_params != NULL) {
+    ConcurrentS3FIFO_parse_params(params, cache_specific_params);
+  }
+
+  concurrent_cache_t *cache = cc_struct_init("ConcurrentS3FIFO", ccache_params, &params->base);
+  cache->cache_free = ConcurrentS3FIFO_free;
+  params->base.on_hit = ConcurrentS3FIFO_on_hit;
+  params->base.on_miss = ConcurrentS3FIFO_on_miss;
+  params->base.evict = ConcurrentS3FIFO_evict;
+  params->base.insert = ConcurrentS3FIFO_insert;
+
+  params->small_size = (int64_t)(ccache_params.cache_size * params->small_size_ratio);
+  params->main_size = ccache_params.cache_size - params->small_size;
+  params->ghost_size = (int64_t)(ccache_params.cache_size * params->ghost_size_ratio);
+  params->base.max_obj_size = params->small_size;
+
+  /* as many entries as the hash table buckets */
+  int ghost_hashpower = MIN(MAX(ccache_params.hashpower, 4), 30);
+  params->ghost = calloc(1ULL << ghost_hashpower, sizeof(ghost_entry_t));
+  params->ghost_set_mask = (1ULL << ghost_hashpower) / GHOST_N_WAY - 1;
+
+  snprintf(cache->cache_name, CACHE_NAME_ARRAY_LEN, "ConcurrentS3FIFO-%.4lf-%d", params->small_size_ratio,
+           params->move_to_main_threshold);
+
+  return cache;
+}
+
+// ***********************************************************************
+// ****                                                               ****
+// ****                  parameter set up functions                   ****
+// ****                                                               ****
+// ***********************************************************************
+static const char *ConcurrentS3FIFO_current_params(ConcurrentS3FIFO_params_t *params) {
+  static __thread char params_str[128];
+  snprintf(params_str, 128, "small-size-ratio=%.4lf,ghost-size-ratio=%.4lf,move-to-main-threshold=%d\n",
+           params->small_size_ratio, params->ghost_size_ratio, params->move_to_main_threshold);
+  return params_str;
+}
+
+static void ConcurrentS3FIFO_parse_params(ConcurrentS3FIFO_params_t *params, const char *cache_specific_params) {
+  char *params_str = strdup(cache_specific_params);
+  char *old_params_str = params_str;
+  char *end;
+
+  while (params_str != NULL && params_str[0] != '\0') {
+    /* different parameters are separated by comma,
+     * key and value are separated by = */
+    char *key = strsep((char **)&params_str, "=");
+    char *value = strsep((char **)&params_str, ",");
+
+    // skip the white space
+    while (params_str != NULL && *params_str == ' ') {
+      params_str++;
+    }
+
+    if (strcasecmp(key, "small-size-ratio") == 0) {
+      params->small_size_ratio = strtod(value, &end);
+      if (strlen(end) > 2) {
+        ERROR("param parsing error, find string \"%s\" after number\n", end);
+      }
+    } else if (strcasecmp(key, "ghost-size-ratio") == 0) {
+      params->ghost_size_ratio = strtod(value, &end);
+      if (strlen(end) > 2) {
+        ERROR("param parsing error, find string \"%s\" after number\n", end);
+      }
+    } else if (strcasecmp(key, "move-to-main-threshold") == 0) {
+      params->move_to_main_threshold = (int)strtol(value, &end, 0);
+      if (strlen(end) > 2) {
+        ERROR("param parsing error, find string \"%s\" after number\n", end);
+      }
+    } else if (strcasecmp(key, "print") == 0) {
+      printf("current parameters: %s\n", ConcurrentS3FIFO_current_params(params));
+      exit(0);
+    } else {
+      ERROR("ConcurrentS3FIFO does not have parameter %s, example parameters %s\n", key,
+            ConcurrentS3FIFO_current_params(params));
+      exit(1);
+    }
+  }
+  free(old_params_str);
+}
+
+#ifdef __cplusplus
+}
+#endif
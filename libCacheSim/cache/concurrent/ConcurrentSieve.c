@@ -0,0 +1,72 @@
+//
+//  concurrent Sieve, a hit sets the visited bit of the object with only the
+//  bucket lock held, the hand scans from the tail towards the head under the
+//  eviction lock, clears the visited bits and evicts the first unvisited
+//  object without moving any object, which is why Sieve needs no lock on hit
+//
+//  ConcurrentSieve.c
+//  libCacheSim
+//
+
+#include <stdlib.h>
+
+#include "../../include/libCacheSim/logging.h"
+#include "concurrentCacheInternal.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct {
+  cc_base_t base;
+  cc_queue_t q;
+  /* the next object to check, NULL means the tail */
+  cc_obj_t *hand;
+} ConcurrentSieve_params_t;
+
+static void ConcurrentSieve_on_hit(cc_base_t *base, cc_obj_t *obj) {
+  /* read before write so that hot objects are not written on every hit */
+  if (cc_load_freq(obj) == 0) {
+    cc_store_freq(obj, 1);
+  }
+}
+
+static bool ConcurrentSieve_evict(cc_base_t *base) {
+  ConcurrentSieve_params_t *params = (ConcurrentSieve_params_t *)base;
+  if (params->q.tail == NULL) return false;
+
+  cc_obj_t *obj = params->hand == NULL ? params->q.tail : params->hand;
+  /* a hit between the load and the store would be lost, so swap the bit */
+  while (atomic_exchange_explicit(&obj->freq, 0, memory_order_relaxed) > 0) {
+    obj = obj->prev == NULL ? params->q.tail : obj->prev;
+  }
+
+  params->hand = obj->prev;
+  cc_queue_remove(&params->q, obj);
+  cc_evict_obj(base, obj);
+  return true;
+}
+
+static void ConcurrentSieve_insert(cc_base_t *base, cc_obj_t *obj) {
+  ConcurrentSieve_params_t *params = (ConcurrentSieve_params_t *)base;
+  cc_queue_prepend(&params->q, obj);
+}
+
+concurrent_cache_t *ConcurrentSieve_init(const common_cache_params_t ccache_params,
+                                         const char *cache_specific_params) {
+  if (cache_specific_params != NULL && cache_specific_params[0] != '\0') {
+    ERROR("ConcurrentSieve does not have parameters, find %s\n", cache_specific_params);
+  }
+
+  ConcurrentSieve_params_t *params = calloc(1, sizeof(ConcurrentSieve_params_t));
+  concurrent_cache_t *cache = cc_struct_init("ConcurrentSieve", ccache_params, &params->base);
+  params->base.on_hit = ConcurrentSieve_on_hit;
+  params->base.evict = ConcurrentSieve_evict;
+  params->base.insert = ConcurrentSieve_insert;
+
+  return cache;
+}
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,245 @@
+//
+//  the hash table, get and eviction shared by the concurrent caches
+//
+//  concurrentCache.c
+//  libCacheSim
+//
+
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+
+#include "../../include/libCacheSim/logging.h"
+#include "../../utils/include/mymath.h"
+#include "concurrentCacheInternal.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+static inline uint64_t cc_hash(const obj_id_t obj_id) { return mix64((uint64_t)obj_id); }
+
+/* the lock of a bucket, a bucket always uses the same lock because the
+ * number of locks is a power of 2 no larger than the number of buckets */
+static inline pthread_mutex_t *cc_bucket_lock(const cc_hashtable_t *hashtable, const uint64_t bucket) {
+  return &hashtable->locks[bucket & hashtable->lock_mask].lock;
+}
+
+static inline cc_obj_t *cc_bucket_find(const cc_hashtable_t *hashtable, const uint64_t bucket,
+                                       const obj_id_t obj_id) {
+  cc_obj_t *obj = hashtable->buckets[bucket];
+  while (obj != NULL && obj->obj_id != obj_id) {
+    obj = obj->hash_next;
+  }
+  return obj;
+}
+
+static int64_t cc_get_occupied_byte(const concurrent_cache_t *cache) {
+  cc_base_t *base = (cc_base_t *)cache->cc_params;
+  return atomic_load_explicit(&base->occupied_byte, memory_order_relaxed);
+}
+
+static int64_t cc_get_n_obj(const concurrent_cache_t *cache) {
+  cc_base_t *base = (cc_base_t *)cache->cc_params;
+  return atomic_load_explicit(&base->n_obj, memory_order_relaxed);
+}
+
+concurrent_cache_t *cc_struct_init(const char *name, const common_cache_params_t ccache_params, cc_base_t *base) {
+  concurrent_cache_t *cache = calloc(1, sizeof(concurrent_cache_t));
+  cache->get = cc_get_base;
+  cache->get_occupied_byte = cc_get_occupied_byte;
+  cache->get_n_obj = cc_get_n_obj;
+  cache->cache_free = cc_struct_free;
+  cache->cache_size = ccache_params.cache_size;
+  cache->cc_params = base;
+  snprintf(cache->cache_name, CACHE_NAME_ARRAY_LEN, "%s", name);
+
+  /* the hash table does not grow because resizing needs all bucket locks */
+  int hashpower = ccache_params.hashpower;
+  if (hashpower < 4) hashpower = 4;
+  if (hashpower > 30) hashpower = 30;
+  uint64_t n_bucket = 1ULL << hashpower;
+  uint64_t n_lock = n_bucket < CC_MAX_N_LOCK ? n_bucket : CC_MAX_N_LOCK;
+
+  cc_hashtable_t *hashtable = &base->hashtable;
+  hashtable->buckets = calloc(n_bucket, sizeof(cc_obj_t *));
+  hashtable->bucket_mask = n_bucket - 1;
+  if (posix_memalign((void **)&hashtable->locks, 64, sizeof(cc_lock_t) * n_lock) != 0) {
+    ERROR("cannot allocate %lu bucket locks\n", (unsigned long)n_lock);
+  }
+  hashtable->lock_mask = n_lock - 1;
+  for (uint64_t i = 0; i < n_lock; i++) {
+    pthread_mutex_init(&hashtable->locks[i].lock, NULL);
+  }
+
+  pthread_mutex_init(&base->evict_lock, NULL);
+  atomic_init(&base->pending, NULL);
+  atomic_init(&base->n_pending, 0);
+  atomic_init(&base->occupied_byte, 0);
+  atomic_init(&base->n_obj, 0);
+  base->cache_size = ccache_params.cache_size;
+  base->max_obj_size = ccache_params.cache_size;
+
+  return cache;
+}
+
+/**
+ * @brief free the objects, the hash table and the state of the cache,
+ * no thread can use the cache when it is freed
+ *
+ * @param cache
+ */
+void cc_struct_free(concurrent_cache_t *cache) {
+  cc_base_t *base = (cc_base_t *)cache->cc_params;
+  cc_hashtable_t *hashtable = &base->hashtable;
+  for (uint64_t i = 0; i <= hashtable->bucket_mask; i++) {
+    cc_obj_t *obj = hashtable->buckets[i];
+    while (obj != NULL) {
+      cc_obj_t *next = obj->hash_next;
+      free(obj);
+      obj = next;
+    }
+  }
+  for (uint64_t i = 0; i <= hashtable->lock_mask; i++) {
+    pthread_mutex_destroy(&hashtable->locks[i].lock);
+  }
+  pthread_mutex_destroy(&base->evict_lock);
+  free(hashtable->buckets);
+  free(hashtable->locks);
+  free(base);
+  free(cache);
+}
+
+static inline void cc_push_pending(cc_base_t *base, cc_obj_t *obj) {
+  cc_obj_t *head = atomic_load_explicit(&base->pending, memory_order_relaxed);
+  do {
+    obj->next = head;
+  } while (!atomic_compare_exchange_weak_explicit(&base->pending, &head, obj, memory_order_release,
+                                                  memory_order_relaxed));
+}
+
+/* insert the pending objects in the order of the misses, the caller holds
+ * the eviction lock */
+static void cc_insert_pending(cc_base_t *base) {
+  cc_obj_t *obj = atomic_exchange_explicit(&base->pending, NULL, memory_order_acquire);
+  /* the stack has the last miss on the top */
+  cc_obj_t *first = NULL;
+  int64_t n_obj = 0;
+  while (obj != NULL) {
+    cc_obj_t *next = obj->next;
+    obj->next = first;
+    first = obj;
+    obj = next;
+    n_obj += 1;
+  }
+  atomic_fetch_sub_explicit(&base->n_pending, n_obj, memory_order_relaxed);
+
+  while (first != NULL) {
+    obj = first;
+    first = obj->next;
+    if (base->on_miss != NULL) {
+      base->on_miss(base, obj);
+    }
+    while (atomic_load_explicit(&base->occupied_byte, memory_order_relaxed) > base->cache_size) {
+      if (!base->evict(base)) break;
+    }
+    base->insert(base, obj);
+  }
+}
+
+bool cc_get_base(concurrent_cache_t *cache, const request_t *req) {
+  cc_base_t *base = (cc_base_t *)cache->cc_params;
+  cc_hashtable_t *hashtable = &base->hashtable;
+  uint64_t bucket = cc_hash(req->obj_id) & hashtable->bucket_mask;
+  pthread_mutex_t *bucket_lock = cc_bucket_lock(hashtable, bucket);
+
+  pthread_mutex_lock(bucket_lock);
+  cc_obj_t *obj = cc_bucket_find(hashtable, bucket, req->obj_id);
+  if (obj != NULL) {
+    base->on_hit(base, obj);
+    pthread_mutex_unlock(bucket_lock);
+    return true;
+  }
+  pthread_mutex_unlock(bucket_lock);
+
+  if (req->obj_size > base->max_obj_size) {
+    return false;
+  }
+
+  obj = malloc(sizeof(cc_obj_t));
+  memset(obj, 0, sizeof(cc_obj_t));
+  obj->obj_id = req->obj_id;
+  obj->obj_size = req->obj_size;
+
+  /* another thread may have inserted the object after the lookup */
+  pthread_mutex_lock(bucket_lock);
+  if (cc_bucket_find(hashtable, bucket, req->obj_id) != NULL) {
+    pthread_mutex_unlock(bucket_lock);
+    free(obj);
+    return false;
+  }
+  obj->hash_next = hashtable->buckets[bucket];
+  hashtable->buckets[bucket] = obj;
+  pthread_mutex_unlock(bucket_lock);
+
+  /* reserve the space before evicting, so that concurrent misses evict for
+   * each other instead of all passing the size check, the cache can still
+   * be over the size when the queues are empty because all objects are being
+   * inserted, which only happens when the cache holds few objects */
+  atomic_fetch_add_explicit(&base->occupied_byte, obj->obj_size, memory_order_relaxed);
+  atomic_fetch_add_explicit(&base->n_obj, 1, memory_order_relaxed);
+
+  /* if another thread holds the eviction lock, it inserts the object, the
+   * holder checks the stack again after unlocking and the fences order the
+   * push before the trylock and the unlock before the check, so an object
+   * is not left in the stack when all threads fail to get the lock */
+  cc_push_pending(base, obj);
+  bool wait = atomic_fetch_add_explicit(&base->n_pending, 1, memory_order_relaxed) >= CC_MAX_N_PENDING;
+  atomic_thread_fence(memory_order_seq_cst);
+  while (atomic_load_explicit(&base->pending, memory_order_relaxed) != NULL &&
+         (wait ? pthread_mutex_lock(&base->evict_lock) : pthread_mutex_trylock(&base->evict_lock)) == 0) {
+    wait = false;
+    cc_insert_pending(base);
+    pthread_mutex_unlock(&base->evict_lock);
+    atomic_thread_fence(memory_order_seq_cst);
+  }
+
+  return false;
+}
+
+void cc_evict_obj(cc_base_t *base, cc_obj_t *obj) {
+  cc_hashtable_t *hashtable = &base->hashtable;
+  uint64_t bucket = cc_hash(obj->obj_id) & hashtable->bucket_mask;
+  pthread_mutex_t *bucket_lock = cc_bucket_lock(hashtable, bucket);
+
+  pthread_mutex_lock(bucket_lock);
+  cc_obj_t **pp = &hashtable->buckets[bucket];
+  while (*pp != obj) {
+    DEBUG_ASSERT(*pp != NULL);
+    pp = &(*pp)->hash_next;
+  }
+  *pp = obj->hash_next;
+  pthread_mutex_unlock(bucket_lock);
+
+  atomic_fetch_sub_explicit(&base->occupied_byte, obj->obj_size, memory_order_relaxed);
+  atomic_fetch_sub_explicit(&base->n_obj, 1, memory_order_relaxed);
+  free(obj);
+}
+
+concurrent_cache_t *create_concurrent_cache(const char *algo, const common_cache_params_t ccache_params,
+                                            const char *cache_specific_params) {
+  if (strcasecmp(algo, "fifo") == 0) {
+    return ConcurrentFIFO_init(ccache_params, cache_specific_params);
+  } else if (strcasecmp(algo, "clock") == 0) {
+    return ConcurrentClock_init(ccache_params, cache_specific_params);
+  } else if (strcasecmp(algo, "sieve") == 0) {
+    return ConcurrentSieve_init(ccache_params, cache_specific_params);
+  } else if (strcasecmp(algo, "s3fifo") == 0 || strcasecmp(algo, "s3-fifo") == 0) {
+    return ConcurrentS3FIFO_init(ccache_params, cache_specific_params);
+  }
+  return NULL;
+}
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,190 @@
+#pragma once
+//
+//  the building blocks shared by the concurrent caches
+//
+//  an object is found through a chained hash table, each bucket is protected
+//  by one of the striped locks, a hit only takes the lock of the bucket and
+//  updates the frequency of the object with atomic operations, the queues are
+//  protected by one eviction lock, the lock order is eviction lock -> bucket
+//  lock, and an object is only freed after it is removed from the hash table
+//  while holding its bucket lock, so a thread that finds an object under the
+//  bucket lock never sees a freed object
+//
+//  a miss does not wait for the eviction lock, it pushes the new object to a
+//  pending stack and tries the lock, the thread that gets the lock inserts
+//  all pending objects in the order of the misses, so when many threads
+//  miss at the same time, one of them evicts and inserts for the others,
+//  the pending objects are not evicted, so a miss waits for the lock when
+//  there are CC_MAX_N_PENDING pending objects, which bounds how much the
+//  cache can exceed its size, e.g., when the lock holder is descheduled
+//
+//  concurrentCacheInternal.h
+//  libCacheSim
+//
+
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdint.h>
+
+#include "../../include/libCacheSim/concurrentCache.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* the max number of bucket locks */
+#define CC_MAX_N_LOCK 4096
+/* the max number of pending objects before a miss waits for the eviction
+ * lock */
+#define CC_MAX_N_PENDING 32
+
+typedef struct cc_obj {
+  struct cc_obj *hash_next;
+  /* prev is towards the head and next is towards the tail */
+  struct cc_obj *prev;
+  /* links the pending stack before the object is inserted into a queue */
+  struct cc_obj *next;
+  obj_id_t obj_id;
+  int64_t obj_size;
+  /* set by hits without the eviction lock */
+  _Atomic uint8_t freq;
+} cc_obj_t;
+
+typedef struct {
+  cc_obj_t *head;
+  cc_obj_t *tail;
+  int64_t n_obj;
+  int64_t n_byte;
+} cc_queue_t;
+
+/* each lock uses its own cache line */
+typedef struct {
+  pthread_mutex_t lock;
+} __attribute__((aligned(64))) cc_lock_t;
+
+typedef struct {
+  cc_obj_t **buckets;
+  uint64_t bucket_mask;
+  cc_lock_t *locks;
+  uint64_t lock_mask;
+} cc_hashtable_t;
+
+struct cc_base;
+typedef struct cc_base cc_base_t;
+
+struct cc_base {
+  cc_hashtable_t hashtable;
+
+  /* called with the bucket lock of the object held */
+  void (*on_hit)(cc_base_t *base, cc_obj_t *obj);
+  /* the functions below are called with the eviction lock held,
+   * on_miss is optional and is called before evicting */
+  void (*on_miss)(cc_base_t *base, cc_obj_t *obj);
+  /* evict one object or move objects between queues,
+   * return false if there is no object in the queues */
+  bool (*evict)(cc_base_t *base);
+  void (*insert)(cc_base_t *base, cc_obj_t *obj);
+
+  /* larger objects are not inserted */
+  int64_t max_obj_size;
+  int64_t cache_size;
+
+  pthread_mutex_t evict_lock __attribute__((aligned(64)));
+  /* the objects in the hash table that are not inserted into a queue yet */
+  _Atomic(cc_obj_t *) pending __attribute__((aligned(64)));
+  _Atomic int64_t n_pending;
+  /* includes the bytes reserved by the objects being inserted */
+  _Atomic int64_t occupied_byte __attribute__((aligned(64)));
+  _Atomic int64_t n_obj;
+};
+
+/**
+ * @brief initialize the fields shared by all concurrent caches, the policy
+ * state embeds cc_base_t as the first field and is stored in cc_params
+ *
+ * @param name the name of the algorithm
+ * @param ccache_params
+ * @param base the state of the cache
+ */
+concurrent_cache_t *cc_struct_init(const char *name, const common_cache_params_t ccache_params, cc_base_t *base);
+
+void cc_struct_free(concurrent_cache_t *cache);
+
+/**
+ * @brief the get shared by all concurrent caches, it looks up the object
+ * under the bucket lock, and on a miss, reserves the space, inserts the
+ * object into the hash table and the pending stack, and evicts and inserts
+ * the pending objects into the queues if it gets the eviction lock
+ */
+bool cc_get_base(concurrent_cache_t *cache, const request_t *req);
+
+/**
+ * @brief remove the object from the hash table and free it, the caller
+ * holds the eviction lock and has removed the object from its queue
+ */
+void cc_evict_obj(cc_base_t *base, cc_obj_t *obj);
+
+static inline void cc_queue_prepend(cc_queue_t *q, cc_obj_t *obj) {
+  obj->prev = NULL;
+  obj->next = q->head;
+  if (q->head != NULL) {
+    q->head->prev = obj;
+  } else {
+    q->tail = obj;
+  }
+  q->head = obj;
+  q->n_obj += 1;
+  q->n_byte += obj->obj_size;
+}
+
+static inline void cc_queue_remove(cc_queue_t *q, cc_obj_t *obj) {
+  if (obj->prev != NULL) {
+    obj->prev->next = obj->next;
+  } else {
+    q->head = obj->next;
+  }
+  if (obj->next != NULL) {
+    obj->next->prev = obj->prev;
+  } else {
+    q->tail = obj->prev;
+  }
+  obj->prev = obj->next = NULL;
+  q->n_obj -= 1;
+  q->n_byte -= obj->obj_size;
+}
+
+static inline void cc_queue_move_to_head(cc_queue_t *q, cc_obj_t *obj) {
+  if (q->head == obj) return;
+  cc_queue_remove(q, obj);
+  cc_queue_prepend(q, obj);
+}
+
+static inline uint8_t cc_load_freq(const cc_obj_t *obj) {
+  return atomic_load_explicit(&((cc_obj_t *)obj)->freq, memory_order_relaxed);
+}
+
+static inline void cc_store_freq(cc_obj_t *obj, uint8_t freq) {
+  atomic_store_explicit(&obj->freq, freq, memory_order_relaxed);
+}
+
+/* increase the frequency up to max_freq, the frequency is only written if it
+ * changes, so that hot objects do not bounce their cache line between cores */
+static inline void cc_incr_freq(cc_obj_t *obj, uint8_t max_freq) {
+  uint8_t freq = cc_load_freq(obj);
+  while (freq < max_freq && !atomic_compare_exchange_weak_explicit(&obj->freq, &freq, freq + 1,
+                                                                    memory_order_relaxed, memory_order_relaxed)) {
+  }
+}
+
+/* decrease the frequency by one if it is positive, return the old value */
+static inline uint8_t cc_decr_freq(cc_obj_t *obj) {
+  uint8_t freq = cc_load_freq(obj);
+  while (freq > 0 && !atomic_compare_exchange_weak_explicit(&obj->freq, &freq, freq - 1, memory_order_relaxed,
+                                                             memory_order_relaxed)) {
+  }
+  return freq;
+}
+
+#ifdef __cplusplus
+}
+#endif
@@ -67,6 +67,8 @@ static cache_obj_t *ARC_insert(cache_t *cache, const request_t *req);
 static cache_obj_t *ARC_to_evict(cache_t *cache, const request_t *req);
 static void ARC_evict(cache_t *cache, const request_t *req);
 static bool ARC_remove(cache_t *cache, const obj_id_t obj_id);
+static bool ARC_save_state(const cache_t *cache, FILE *f);
+static bool ARC_load_state(cache_t *cache, FILE *f);
 
 /* internal functions */
 /* this is the case IV in the paper */
@@ -111,6 +113,9 @@ cache_t *ARC_init(const common_cache_params_t ccache_params,
   cache->can_insert = cache_can_insert_default;
   cache->get_occupied_byte = cache_get_occupied_byte_default;
   cache->get_n_obj = cache_get_n_obj_default;
+  cache->save_state = ARC_save_state;
+  cache->load_state = ARC_load_state;
+  cache->checkpoint_algo = __func__;
 
   if (ccache_params.consider_obj_metadata) {
     // two pointer + ghost metadata
@@ -597,6 +602,57 @@ static void _ARC_evict_miss_on_all_queues(cache_t *cache,
   }
 }
 
+// ***********************************************************************
+// ****                                                               ****
+// ****                     checkpoint functions                      ****
+// ****                                                               ****
+// ***********************************************************************
+/**
+ * @brief save the four queues and the adaptation state, the ghost entries
+ * are restored into the hash table but are not counted in n_obj
+ *
+ * @param cache
+ * @param f
+ * @return whether the state is written
+ */
+static bool ARC_save_state(const cache_t *cache, FILE *f) {
+  ARC_params_t *params = (ARC_params_t *)(cache->eviction_params);
+  return fwrite(&params->L1_data_size, sizeof(int64_t), 1, f) == 1 &&
+         fwrite(&params->L2_data_size, sizeof(int64_t), 1, f) == 1 &&
+         fwrite(&params->L1_ghost_size, sizeof(int64_t), 1, f) == 1 &&
+         fwrite(&params->L2_ghost_size, sizeof(int64_t), 1, f) == 1 &&
+         fwrite(&params->p, sizeof(double), 1, f) == 1 &&
+         fwrite(&params->curr_obj_in_L1_ghost, sizeof(bool), 1, f) == 1 &&
+         fwrite(&params->curr_obj_in_L2_ghost, sizeof(bool), 1, f) == 1 &&
+         fwrite(&params->vtime_last_req_in_ghost, sizeof(int64_t), 1, f) ==
+             1 &&
+         cache_save_obj_queue(params->L1_data_head, f) &&
+         cache_save_obj_queue(params->L1_ghost_head, f) &&
+         cache_save_obj_queue(params->L2_data_head, f) &&
+         cache_save_obj_queue(params->L2_ghost_head, f);
+}
+
+static bool ARC_load_state(cache_t *cache, FILE *f) {
+  ARC_params_t *params = (ARC_params_t *)(cache->eviction_params);
+  return fread(&params->L1_data_size, sizeof(int64_t), 1, f) == 1 &&
+         fread(&params->L2_data_size, sizeof(int64_t), 1, f) == 1 &&
+         fread(&params->L1_ghost_size, sizeof(int64_t), 1, f) == 1 &&
+         fread(&params->L2_ghost_size, sizeof(int64_t), 1, f) == 1 &&
+         fread(&params->p, sizeof(double), 1, f) == 1 &&
+         fread(&params->curr_obj_in_L1_ghost, sizeof(bool), 1, f) == 1 &&
+         fread(&params->curr_obj_in_L2_ghost, sizeof(bool), 1, f) == 1 &&
+         fread(&params->vtime_last_req_in_ghost, sizeof(int64_t), 1, f) ==
+             1 &&
+         cache_load_obj_queue(cache, f, &params->L1_data_head,
+                              &params->L1_data_tail) &&
+         cache_load_obj_queue(cache, f, &params->L1_ghost_head,
+                              &params->L1_ghost_tail) &&
+         cache_load_obj_queue(cache, f, &params->L2_data_head,
+                              &params->L2_data_tail) &&
+         cache_load_obj_queue(cache, f, &params->L2_ghost_head,
+                              &params->L2_ghost_tail);
+}
+
 // ***********************************************************************
 // ****                                                               ****
 // ****                parameter set up functions                     ****
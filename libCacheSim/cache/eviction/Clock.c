@@ -11,6 +11,7 @@
 //
 
 #include "../../dataStructure/hashtable/hashtable.h"
+#include "../../dataStructure/ringQueue.h"
 #include "../../include/libCacheSim/evictionAlgo.h"
 
 #ifdef __cplusplus
@@ -36,6 +37,8 @@ static cache_obj_t *Clock_insert(cache_t *cache, const request_t *req);
 static cache_obj_t *Clock_to_evict(cache_t *cache, const request_t *req);
 static void Clock_evict(cache_t *cache, const request_t *req);
 static bool Clock_remove(cache_t *cache, const obj_id_t obj_id);
+static bool Clock_save_state(const cache_t *cache, FILE *f);
+static bool Clock_load_state(cache_t *cache, FILE *f);
 
 // ***********************************************************************
 // ****                                                               ****
@@ -47,7 +50,8 @@ static bool Clock_remove(cache_t *cache, const obj_id_t obj_id);
  * @brief initialize a Clock cache
  *
  * @param ccache_params some common cache parameters
- * @param cache_specific_params Clock specific parameters as a string
+ * @param cache_specific_params Clock specific parameters as a string,
+ * queue=ring uses a ring queue instead of the linked list
  */
 cache_t *Clock_init(const common_cache_params_t ccache_params, const char *cache_specific_params) {
   cache_t *cache = cache_struct_init("Clock", ccache_params, cache_specific_params);
@@ -62,6 +66,9 @@ cache_t *Clock_init(const common_cache_params_t ccache_params, const char *cache
   cache->get_n_obj = cache_get_n_obj_default;
   cache->get_occupied_byte = cache_get_occupied_byte_default;
   cache->to_evict = Clock_to_evict;
+  cache->save_state = Clock_save_state;
+  cache->load_state = Clock_load_state;
+  cache->checkpoint_algo = __func__;
   cache->obj_md_size = 0;
 
 #ifdef USE_BELADY
@@ -94,6 +101,10 @@ cache_t *Clock_init(const common_cache_params_t ccache_params, const char *cache
  * @param cache
  */
 static void Clock_free(cache_t *cache) {
+  Clock_params_t *params = (Clock_params_t *)cache->eviction_params;
+  if (params->ring != NULL) {
+    free_ring_queue(params->ring);
+  }
   free(cache->eviction_params);
   cache_struct_free(cache);
 }
@@ -164,7 +175,11 @@ static cache_obj_t *Clock_insert(cache_t *cache, const request_t *req) {
   Clock_params_t *params = (Clock_params_t *)cache->eviction_params;
 
   cache_obj_t *obj = cache_insert_base(cache, req);
-  prepend_obj_to_head(&params->q_head, &params->q_tail, obj);
+  if (params->ring != NULL) {
+    ring_queue_push(params->ring, obj);
+  } else {
+    prepend_obj_to_head(&params->q_head, &params->q_tail, obj);
+  }
 
   obj->clock.freq = params->init_freq;
 #ifdef USE_BELADY
@@ -188,6 +203,18 @@ static cache_obj_t *Clock_to_evict(cache_t *cache, const request_t *req) {
   Clock_params_t *params = (Clock_params_t *)cache->eviction_params;
 
   int n_round = 0;
+  if (params->ring != NULL) {
+    cache_obj_t *obj_to_evict = ring_queue_oldest(params->ring);
+    while (obj_to_evict->clock.freq - n_round >= 1) {
+      obj_to_evict = ring_queue_newer(params->ring, obj_to_evict);
+      if (obj_to_evict == NULL) {
+        obj_to_evict = ring_queue_oldest(params->ring);
+        n_round += 1;
+      }
+    }
+    return obj_to_evict;
+  }
+
   cache_obj_t *obj_to_evict = params->q_tail;
 #ifdef USE_BELADY
   while (obj_to_evict->next_access_vtime != INT64_MAX) {
@@ -216,6 +243,25 @@ static cache_obj_t *Clock_to_evict(cache_t *cache, const request_t *req) {
 static void Clock_evict(cache_t *cache, const request_t *req) {
   Clock_params_t *params = (Clock_params_t *)cache->eviction_params;
 
+  if (params->ring != NULL) {
+    /* the hand is the oldest slot, a reinserted object is moved to the
+     * newest end, so the hand scans the array sequentially */
+    ring_queue_t *ring = params->ring;
+    cache_obj_t *obj_to_evict = ring_queue_oldest(ring);
+    while (obj_to_evict->clock.freq >= 1) {
+      obj_to_evict->clock.freq -= 1;
+      params->n_obj_rewritten += 1;
+      params->n_byte_rewritten += obj_to_evict->obj_size;
+      ring_queue_remove(ring, obj_to_evict);
+      ring_queue_push(ring, obj_to_evict);
+      obj_to_evict = ring_queue_oldest(ring);
+    }
+
+    ring_queue_remove(ring, obj_to_evict);
+    cache_evict_base(cache, obj_to_evict, true);
+    return;
+  }
+
   cache_obj_t *obj_to_evict = params->q_tail;
   while (obj_to_evict->clock.freq >= 1) {
     obj_to_evict->clock.freq -= 1;
@@ -248,7 +294,11 @@ static void Clock_remove_obj(cache_t *cache, cache_obj_t *obj) {
   Clock_params_t *params = (Clock_params_t *)cache->eviction_params;
 
   DEBUG_ASSERT(obj != NULL);
-  remove_obj_from_list(&params->q_head, &params->q_tail, obj);
+  if (params->ring != NULL) {
+    ring_queue_remove(params->ring, obj);
+  } else {
+    remove_obj_from_list(&params->q_head, &params->q_tail, obj);
+  }
   cache_remove_obj_base(cache, obj, true);
 }
 
@@ -276,6 +326,51 @@ static bool Clock_remove(cache_t *cache, const obj_id_t obj_id) {
   return true;
 }
 
+// ***********************************************************************
+// ****                                                               ****
+// ****                     checkpoint functions                      ****
+// ****                                                               ****
+// ***********************************************************************
+/**
+ * @brief save the clock queue with the frequency of each object,
+ * the objects are written from head to tail, so the hand (tail) position is
+ * kept
+ *
+ * @param cache
+ * @param f
+ * @return whether the state is written
+ */
+static bool Clock_save_state(const cache_t *cache, FILE *f) {
+  Clock_params_t *params = (Clock_params_t *)cache->eviction_params;
+  return fwrite(&params->n_obj_rewritten, sizeof(params->n_obj_rewritten), 1, f) == 1 &&
+         fwrite(&params->n_byte_rewritten, sizeof(params->n_byte_rewritten), 1, f) == 1 &&
+         (params->ring != NULL ? cache_save_ring_queue(params->ring, f) : cache_save_obj_queue(params->q_head, f));
+}
+
+static bool Clock_load_state(cache_t *cache, FILE *f) {
+  Clock_params_t *params = (Clock_params_t *)cache->eviction_params;
+  if (fread(&params->n_obj_rewritten, sizeof(params->n_obj_rewritten), 1, f) != 1 ||
+      fread(&params->n_byte_rewritten, sizeof(params->n_byte_rewritten), 1, f) != 1) {
+    return false;
+  }
+  if (params->ring != NULL) {
+    if (!cache_load_ring_queue(cache, f, params->ring)) {
+      return false;
+    }
+  } else if (!cache_load_obj_queue(cache, f, &params->q_head, &params->q_tail)) {
+    return false;
+  }
+
+  /* the frequency is capped by the counter, which may be smaller in the
+   * cache that loads the checkpoint */
+  cache_obj_t *obj = params->ring != NULL ? ring_queue_newest(params->ring) : params->q_head;
+  while (obj != NULL) {
+    if (obj->clock.freq > params->max_freq) obj->clock.freq = params->max_freq;
+    obj = params->ring != NULL ? ring_queue_older(params->ring, obj) : obj->queue.next;
+  }
+  return true;
+}
+
 // ***********************************************************************
 // ****                                                               ****
 // ****                  parameter set up functions                   ****
@@ -283,7 +378,8 @@ static bool Clock_remove(cache_t *cache, const obj_id_t obj_id) {
 // ***********************************************************************
 static const char *Clock_current_params(cache_t *cache, Clock_params_t *params) {
   static __thread char params_str[128];
-  snprintf(params_str, 128, "n-bit-counter=%d\n", params->n_bit_counter);
+  snprintf(params_str, 128, "n-bit-counter=%d,queue=%s\n", params->n_bit_counter,
+           params->ring != NULL ? "ring" : "list");
 
   return params_str;
 }
@@ -316,6 +412,16 @@ static void Clock_parse_params(cache_t *cache, const char *cache_specific_params
       if (strlen(end) > 2) {
         ERROR("param parsing error, find string \"%s\" after number\n", end);
       }
+    } else if (strcasecmp(key, "queue") == 0) {
+      if (strcasecmp(value, "ring") == 0) {
+        if (params->ring == NULL) params->ring = create_ring_queue();
+      } else if (strcasecmp(value, "list") == 0) {
+        if (params->ring != NULL) free_ring_queue(params->ring);
+        params->ring = NULL;
+      } else {
+        ERROR("Clock queue can be list or ring, but got %s\n", value);
+        exit(1);
+      }
     } else if (strcasecmp(key, "print") == 0) {
       printf("current parameters: %s\n", Clock_current_params(cache, params));
       exit(0);
@@ -1,49 +1,54 @@
 #include "EvolveComplete.h"
 
 #include <algorithm>
-#include <list>
 
 void EvolveComplete::update_metadata_access(const cache_t *cache,
                                             cache_obj_t *obj) {
-  // Find the associated object metadata in the map.
-  std::shared_ptr<EvolveComplete_obj_metadata_t> obj_metadata_ptr;
-  auto it = obj_metadata_map.find(obj->obj_id);
-  if (it != obj_metadata_map.end()) {
-    obj_metadata_ptr = it->second;
-  } else {
-    // Object not found in the metadata map, nothing to update.
-    VERBOSE("Object %lu not found in metadata map.\n", obj->obj_id);
-    return;
-  }
+  // Find the associated object metadata in the pool.
+  int32_t md_idx = obj->evolve_complete.md_idx;
+  EvolveComplete_obj_metadata_t &md = obj_metadata[md_idx];
 
-  // Object found, update count metadata of obj and of the cache.
-  int32_t prev_count = obj_metadata_ptr->count;
-  obj_metadata_ptr->count += 1;
-  this->update_counts(obj_metadata_ptr->count);
-  this->remove_count(prev_count);
+  // Update count metadata of obj and of the cache.
+  this->increment_count(md.count);
+  md.count += 1;
 
   // Recompute the count statistics.
   this->calculate_counts_percentiles();
 
   // Compute the delta between current access and last access time.
-  int32_t delta = cache->n_req - obj_metadata_ptr->last_access_vtime;
-  obj_metadata_ptr->add_delta(delta);
+  int32_t delta = cache->n_req - md.last_access_vtime;
+  add_delta(md, &deltas[md_idx * num_deltas], delta);
 
   // Update the last access time of the object.
-  obj_metadata_ptr->last_access_vtime = cache->n_req;
+  md.last_access_vtime = cache->n_req;
 }
 
 void EvolveComplete::update_metadata_insert(const cache_t *cache, cache_obj_t *obj) {
-  // Add the object metadata to the map.
-  int64_t obj_size = obj->obj_size;
-  auto obj_metadata = std::make_shared<EvolveComplete_obj_metadata_t>(
-      1, cache->n_req, obj_size);
-  obj_metadata_map[obj->obj_id] = obj_metadata;
+  // Take a slot from the pool for the object metadata.
+  int32_t md_idx;
+  if (!free_slots.empty()) {
+    md_idx = free_slots.back();
+    free_slots.pop_back();
+  } else {
+    md_idx = obj_metadata.size();
+    obj_metadata.emplace_back();
+    deltas.resize(deltas.size() + num_deltas);
+  }
+  obj->evolve_complete.md_idx = md_idx;
+
+  EvolveComplete_obj_metadata_t &md = obj_metadata[md_idx];
+  md.obj_id = obj->obj_id;
+  md.count = 1;
+  md.last_access_vtime = cache->n_req;
+  md.size = obj->obj_size;
+  md.age = cache->n_req;
+  md.n_delta = 0;
+  md.delta_head = 0;
 
   // Update the counts, ages, and sizes lists.
-  this->update_counts(obj_metadata->count);
-  this->update_ages(cache->n_req);
-  this->update_sizes(obj_metadata->size);
+  this->update_counts(md.count);
+  this->update_ages(md.age);
+  this->update_sizes(md.size);
 
   // Recompute the count, age, and size statistics.
   this->calculate_counts_percentiles();
@@ -51,28 +56,31 @@ void EvolveComplete::update_metadata_insert(const cache_t *cache, cache_obj_t *o
 }
 
 void EvolveComplete::update_metadata_evict(const cache_t *cache, cache_obj_t *obj) {
-  // Find the associated object metadata in the map.
-  std::shared_ptr<EvolveComplete_obj_metadata_t> obj_metadata_ptr;
-  auto it = obj_metadata_map.find(obj->obj_id);
-  if (it != obj_metadata_map.end()) {
-    obj_metadata_ptr = it->second;
-  } else {
-    // Object not found in the metadata map, nothing to update.
-    VERBOSE("Object %lu not found in metadata map.\n", obj->obj_id);
-    return;
-  }
-
-  // Remove the object metadata from the map and add it to the evicted list.
-  evicted_obj_metadata.push_back(obj_metadata_ptr);
-  if (evicted_obj_metadata.size() > history_size) {
-    evicted_obj_metadata.pop_front();  // Keep only the last 'history_size' evictions
+  // Find the associated object metadata in the pool.
+  int32_t md_idx = obj->evolve_complete.md_idx;
+  EvolveComplete_obj_metadata_t &md = obj_metadata[md_idx];
+
+  // Copy the object metadata to the history of evicted objects, the oldest
+  // evicted object is overwritten when the history is full.
+  if (history_size > 0) {
+    int32_t pos;
+    if ((size_t)n_evicted < history_size) {
+      pos = (evicted_head + n_evicted) % history_size;
+      n_evicted += 1;
+    } else {
+      pos = evicted_head;
+      evicted_head = (evicted_head + 1) % history_size;
+    }
+    evicted_obj_metadata[pos] = md;
+    std::copy_n(&deltas[md_idx * num_deltas], num_deltas,
+                &evicted_deltas[pos * num_deltas]);
   }
-  obj_metadata_map.erase(obj->obj_id);
+  free_slots.push_back(md_idx);
 
   // Remove the counts, ages, and sizes from the lists.
-  this->remove_count(obj_metadata_ptr->count);
-  this->remove_age(cache->n_req);
-  this->remove_size(obj_metadata_ptr->size);
+  this->remove_count(md.count);
+  this->remove_age(md.age);
+  this->remove_size(md.size);
 
   // Recompute the count, age, and size statistics.
   this->calculate_counts_percentiles();
@@ -83,11 +91,11 @@ void EvolveComplete::calculate_counts_percentiles() {
   if (counts.empty()) {
     count_p5 = count_p25 = count_p50 = count_p75 = count_p95 = 0;
   } else {
-    count_p5 = *(std::next(counts.begin(), counts.size() * 0.05));
-    count_p25 = *(std::next(counts.begin(), counts.size() * 0.25));
-    count_p50 = *(std::next(counts.begin(), counts.size() * 0.50));
-    count_p75 = *(std::next(counts.begin(), counts.size() * 0.75));
-    count_p95 = *(std::next(counts.begin(), counts.size() * 0.95));
+    count_p5 = counts[(size_t)(counts.size() * 0.05)];
+    count_p25 = counts[(size_t)(counts.size() * 0.25)];
+    count_p50 = counts[(size_t)(counts.size() * 0.50)];
+    count_p75 = counts[(size_t)(counts.size() * 0.75)];
+    count_p95 = counts[(size_t)(counts.size() * 0.95)];
   }
 }
 
@@ -95,20 +103,20 @@ void EvolveComplete::calculate_ages_sizes_percentiles() {
   if (ages.empty()) {
     age_p5 = age_p25 = age_p50 = age_p75 = age_p95 = 0;
   } else {
-    age_p5 = *(std::next(ages.begin(), ages.size() * 0.05));
-    age_p25 = *(std::next(ages.begin(), ages.size() * 0.25));
-    age_p50 = *(std::next(ages.begin(), ages.size() * 0.50));
-    age_p75 = *(std::next(ages.begin(), ages.size() * 0.75));
-    age_p95 = *(std::next(ages.begin(), ages.size() * 0.95));
+    age_p5 = ages[(size_t)(ages.size() * 0.05)];
+    age_p25 = ages[(size_t)(ages.size() * 0.25)];
+    age_p50 = ages[(size_t)(ages.size() * 0.50)];
+    age_p75 = ages[(size_t)(ages.size() * 0.75)];
+    age_p95 = ages[(size_t)(ages.size() * 0.95)];
   }
 
   if (sizes.empty()) {
     size_p5 = size_p25 = size_p50 = size_p75 = size_p95 = 0;
   } else {
-    size_p5 = *(std::next(sizes.begin(), sizes.size() * 0.05));
-    size_p25 = *(std::next(sizes.begin(), sizes.size() * 0.25));
-    size_p50 = *(std::next(sizes.begin(), sizes.size() * 0.50));
-    size_p75 = *(std::next(sizes.begin(), sizes.size() * 0.75));
-    size_p95 = *(std::next(sizes.begin(), sizes.size() * 0.95));
+    size_p5 = sizes[(size_t)(sizes.size() * 0.05)];
+    size_p25 = sizes[(size_t)(sizes.size() * 0.25)];
+    size_p50 = sizes[(size_t)(sizes.size() * 0.50)];
+    size_p75 = sizes[(size_t)(sizes.size() * 0.75)];
+    size_p95 = sizes[(size_t)(sizes.size() * 0.95)];
   }
 }
@@ -1,16 +1,19 @@
 #pragma once
 
-#include <list>
-#include <memory>
-#include <unordered_map>
+#include <algorithm>
+#include <vector>
 
 #include "../../../dataStructure/hashtable/hashtable.h"
 #include "../../../include/libCacheSim/evictionAlgo.h"
 
 class EvolveComplete {
  public:
+  // Number of deltas recorded for each object
+  static const int32_t num_deltas = 20;
+
   class EvolveComplete_obj_metadata_t {
    public:
+    obj_id_t obj_id;
     int32_t count;              // Number of times the object has been accessed
     int64_t last_access_vtime;  // Last time the object was accessed
 
@@ -18,38 +21,32 @@ class EvolveComplete {
     int64_t size;  // Size of the object in bytes
     int64_t age;   // Age (virtual) of the object in the cache
 
-    const size_t num_deltas;    // Number of deltas recorded for the object
-    std::list<int32_t> deltas;  // List of last num_deltas deltas for the object
-
-    EvolveComplete_obj_metadata_t(int32_t c, int64_t l, int64_t s,
-                                  int32_t d = 20)
-        : count(c), last_access_vtime(l), size(s), age(l), num_deltas(d) {
-      deltas = std::list<int32_t>();
-    }
-
-    ~EvolveComplete_obj_metadata_t() { deltas.clear(); }
-
-    void add_delta(int32_t delta) {
-      deltas.push_back(delta);
-      if (deltas.size() > num_deltas) {
-        deltas.pop_front();  // Keep only the last 20 deltas
-      }
-    }
+    // The deltas of the object are a ring buffer of num_deltas entries in a
+    // pool, see get_delta
+    int32_t n_delta;     // Number of deltas recorded, at most num_deltas
+    int32_t delta_head;  // Position of the oldest delta in the ring buffer
   };
 
-  // Keep a hashmap of object id to its metadata.
-  std::unordered_map<obj_id_t, std::shared_ptr<EvolveComplete_obj_metadata_t>>
-      obj_metadata_map;
+  // The metadata of all objects in the cache, an object finds its slot
+  // through obj->evolve_complete.md_idx, the slots of the evicted objects are
+  // reused. The deltas of slot i are deltas[i * num_deltas, (i + 1) *
+  // num_deltas).
+  std::vector<EvolveComplete_obj_metadata_t> obj_metadata;
+  std::vector<int32_t> deltas;
+  std::vector<int32_t> free_slots;
 
-  // Keep track of the metadata of recently evicted objects.
-  std::list<std::shared_ptr<EvolveComplete_obj_metadata_t>>
-      evicted_obj_metadata;
+  // Keep track of the metadata of recently evicted objects in a ring buffer
+  // of history_size entries, see get_evicted_obj_metadata.
+  std::vector<EvolveComplete_obj_metadata_t> evicted_obj_metadata;
+  std::vector<int32_t> evicted_deltas;
   const size_t history_size;  // Number of evicted objects to keep track of
+  int32_t n_evicted;          // Number of evicted objects in the history
+  int32_t evicted_head;       // Position of the oldest evicted object
 
-  // List to store the counts, ages, and size, of all objects in the cache.
-  std::list<int32_t> counts;
-  std::list<int64_t> ages;
-  std::list<int64_t> sizes;
+  // Sorted vectors of the counts, ages, and size, of all objects in the cache.
+  std::vector<int32_t> counts;
+  std::vector<int64_t> ages;
+  std::vector<int64_t> sizes;
 
   // Statistics for the cache -- need to be updated after each access.
   int32_t count_p5, count_p25, count_p50, count_p75, count_p95;
@@ -60,9 +57,50 @@ class EvolveComplete {
   int64_t size_p5, size_p25, size_p50, size_p75, size_p95;
 
   // Functions
-  EvolveComplete(int32_t h = 100) : history_size(h) {};
+  EvolveComplete(int32_t h = 100)
+      : evicted_obj_metadata(h),
+        evicted_deltas(h * num_deltas),
+        history_size(h),
+        n_evicted(0),
+        evicted_head(0) {};
   ~EvolveComplete() {}
 
+  /**
+   * @brief the metadata of an object in the cache
+   */
+  EvolveComplete_obj_metadata_t &get_obj_metadata(const cache_obj_t *obj) {
+    return obj_metadata[obj->evolve_complete.md_idx];
+  }
+
+  /**
+   * @brief the i-th oldest delta of an object in the cache
+   * @param obj
+   * @param i from 0 to n_delta - 1
+   */
+  int32_t get_delta(const cache_obj_t *obj, int32_t i) const {
+    int32_t md_idx = obj->evolve_complete.md_idx;
+    const EvolveComplete_obj_metadata_t &md = obj_metadata[md_idx];
+    return deltas[md_idx * num_deltas + (md.delta_head + i) % num_deltas];
+  }
+
+  /**
+   * @brief the metadata of the i-th oldest evicted object
+   * @param i from 0 to n_evicted - 1
+   */
+  const EvolveComplete_obj_metadata_t &get_evicted_obj_metadata(
+      int32_t i) const {
+    return evicted_obj_metadata[(evicted_head + i) % history_size];
+  }
+
+  /**
+   * @brief the j-th oldest delta of the i-th oldest evicted object
+   */
+  int32_t get_evicted_delta(int32_t i, int32_t j) const {
+    int32_t pos = (evicted_head + i) % history_size;
+    const EvolveComplete_obj_metadata_t &md = evicted_obj_metadata[pos];
+    return evicted_deltas[pos * num_deltas + (md.delta_head + j) % num_deltas];
+  }
+
   /**
    * @brief update the metadata of the cache when the object is accessed.
    *
@@ -102,6 +140,32 @@ class EvolveComplete {
   void update_metadata_evict(const cache_t *cache, cache_obj_t *obj);
 
  private:
+  /**
+   * @brief Helper function to add a delta to the ring buffer of an object,
+   * the oldest delta is overwritten when the ring buffer is full.
+   */
+  static void add_delta(EvolveComplete_obj_metadata_t &md, int32_t *ring,
+                        int32_t delta) {
+    if (md.n_delta < num_deltas) {
+      ring[(md.delta_head + md.n_delta) % num_deltas] = delta;
+      md.n_delta += 1;
+    } else {
+      ring[md.delta_head] = delta;
+      md.delta_head = (md.delta_head + 1) % num_deltas;
+    }
+  }
+
+  /**
+   * @brief Helper function to update the counts with an incremented count.
+   * The last copy of the old count becomes the new count, which keeps the
+   * counts sorted without moving elements.
+   * @param prev_count The count before the access.
+   */
+  void increment_count(int32_t prev_count) {
+    auto it = std::upper_bound(counts.begin(), counts.end(), prev_count);
+    *(it - 1) += 1;
+  }
+
   /**
    * @brief Helper function to update the counts list with the new count.
    * @param count The new count to be added.
@@ -129,7 +193,7 @@ class EvolveComplete {
    * @brief Helper function to update the ages list with the new age.
    * @param age The new age to be added.
    */
-  void update_ages(int32_t age) {
+  void update_ages(int64_t age) {
     auto it = std::lower_bound(ages.begin(), ages.end(), age);
     ages.insert(it, age);
   }
@@ -139,7 +203,7 @@ class EvolveComplete {
    * @param age The age to be removed.
    * @return The number of ages removed (0 or 1).
    */
-  int32_t remove_age(int32_t age) {
+  int32_t remove_age(int64_t age) {
     auto it = std::lower_bound(ages.begin(), ages.end(), age);
     if (it != ages.end() && *it == age) {
       ages.erase(it);
@@ -152,7 +216,7 @@ class EvolveComplete {
    * @brief Helper function to update the sizes list with the new size.
    * @param size The new size to be added.
    */
-  void update_sizes(int32_t size) {
+  void update_sizes(int64_t size) {
     auto it = std::lower_bound(sizes.begin(), sizes.end(), size);
     sizes.insert(it, size);
   }
@@ -162,7 +226,7 @@ class EvolveComplete {
    * @param size The size to be removed.
    * @return The number of sizes removed (0 or 1).
    */
-  int32_t remove_size(int32_t size) {
+  int32_t remove_size(int64_t size) {
     auto it = std::lower_bound(sizes.begin(), sizes.end(), size);
     if (it != sizes.end() && *it == size) {
       sizes.erase(it);
@@ -187,13 +251,10 @@ class EvolveComplete {
 /** @brief EvolveComplete eviction parameters structure
  *
  * This structure contains the parameters for the EvolveComplete eviction
- * algorithm. It includes a linked list of cache objects, head and tail
- * pointers, and metadata.
+ * algorithm. It includes head and tail pointers of a linked list of cache
+ * objects, and metadata.
  */
 typedef struct {
-  // Keep all objects in a linked list
-  std::list<cache_obj_t *> q_list;
-
   // Head and tail of the linked list
   cache_obj_t *q_head;
   cache_obj_t *q_tail;
@@ -205,4 +266,4 @@ typedef struct {
 } EvolveComplete_params_t;
 
 /* internal function -- LLM generated code should be here */
-cache_obj_t *EvolveComplete_llm(cache_t *cache);
\ No newline at end of file
+cache_obj_t *EvolveComplete_llm(cache_t *cache);
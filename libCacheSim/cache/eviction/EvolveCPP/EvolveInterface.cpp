@@ -88,7 +88,8 @@ static void EvolveComplete_free(cache_t *cache) {
   // Free the frequency map before freeing the cache.
   EvolveComplete_params_t *params =
       (EvolveComplete_params_t *)(cache->eviction_params);
-  my_free(sizeof(EvolveComplete_params_t), params);
+  delete static_cast<EvolveComplete *>(params->EvolveComplete_metadata);
+  delete params;
   cache_struct_free(cache);
 }
 
@@ -143,11 +144,12 @@ static cache_obj_t *EvolveComplete_find(cache_t *cache, const request_t *req,
     auto *evolve_metadata =
         static_cast<EvolveComplete *>(params->EvolveComplete_metadata);
     printf("EvolveComplete_find: metadata map size = %lu\n",
-           evolve_metadata->obj_metadata_map.size());
+           evolve_metadata->obj_metadata.size() -
+               evolve_metadata->free_slots.size());
 
     // Print the size of the history of evicted objects.
     printf("EvolveComplete_find: evicted objects history size = %lu\n",
-           evolve_metadata->evicted_obj_metadata.size());
+           (unsigned long)evolve_metadata->n_evicted);
   }
 
   EvolveComplete_params_t *params =
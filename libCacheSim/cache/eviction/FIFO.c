@@ -10,6 +10,7 @@
 //
 
 #include "../../dataStructure/hashtable/hashtable.h"
+#include "../../dataStructure/ringQueue.h"
 #include "../../include/libCacheSim/evictionAlgo.h"
 
 #ifdef __cplusplus
@@ -32,6 +33,8 @@ static cache_obj_t *FIFO_insert(cache_t *cache, const request_t *req);
 static cache_obj_t *FIFO_to_evict(cache_t *cache, const request_t *req);
 static void FIFO_evict(cache_t *cache, const request_t *req);
 static bool FIFO_remove(cache_t *cache, const obj_id_t obj_id);
+static bool FIFO_save_state(const cache_t *cache, FILE *f);
+static bool FIFO_load_state(cache_t *cache, FILE *f);
 
 // ***********************************************************************
 // ****                                                               ****
@@ -41,10 +44,11 @@ static bool FIFO_remove(cache_t *cache, const obj_id_t obj_id);
 // ***********************************************************************
 
 /**
- * @brief initialize a ARC cache
+ * @brief initialize a FIFO cache
  *
  * @param ccache_params some common cache parameters
- * @param cache_specific_params ARC specific parameters, should be NULL
+ * @param cache_specific_params FIFO specific parameters, queue=ring uses a
+ * ring queue instead of the linked list
  */
 cache_t *FIFO_init(const common_cache_params_t ccache_params,
                    const char *cache_specific_params) {
@@ -60,12 +64,20 @@ cache_t *FIFO_init(const common_cache_params_t ccache_params,
   cache->get_occupied_byte = cache_get_occupied_byte_default;
   cache->get_n_obj = cache_get_n_obj_default;
   cache->can_insert = cache_can_insert_default;
+  cache->save_state = FIFO_save_state;
+  cache->load_state = FIFO_load_state;
+  cache->checkpoint_algo = __func__;
   cache->obj_md_size = 0;
 
   cache->eviction_params = malloc(sizeof(FIFO_params_t));
   FIFO_params_t *params = (FIFO_params_t *)cache->eviction_params;
   params->q_head = NULL;
   params->q_tail = NULL;
+  params->ring = NULL;
+
+  if (cache_specific_params != NULL) {
+    FIFO_parse_params(cache, cache_specific_params);
+  }
 
   return cache;
 }
@@ -76,6 +88,10 @@ cache_t *FIFO_init(const common_cache_params_t ccache_params,
  * @param cache
  */
 static void FIFO_free(cache_t *cache) {
+  FIFO_params_t *params = (FIFO_params_t *)cache->eviction_params;
+  if (params->ring != NULL) {
+    free_ring_queue(params->ring);
+  }
   free(cache->eviction_params);
   cache_struct_free(cache);
 }
@@ -137,7 +153,11 @@ static cache_obj_t *FIFO_find(cache_t *cache, const request_t *req,
 static cache_obj_t *FIFO_insert(cache_t *cache, const request_t *req) {
   FIFO_params_t *params = (FIFO_params_t *)cache->eviction_params;
   cache_obj_t *obj = cache_insert_base(cache, req);
-  prepend_obj_to_head(&params->q_head, &params->q_tail, obj);
+  if (params->ring != NULL) {
+    ring_queue_push(params->ring, obj);
+  } else {
+    prepend_obj_to_head(&params->q_head, &params->q_tail, obj);
+  }
 
   return obj;
 }
@@ -154,6 +174,9 @@ static cache_obj_t *FIFO_insert(cache_t *cache, const request_t *req) {
  */
 static cache_obj_t *FIFO_to_evict(cache_t *cache, const request_t *req) {
   FIFO_params_t *params = (FIFO_params_t *)cache->eviction_params;
+  if (params->ring != NULL) {
+    return ring_queue_oldest(params->ring);
+  }
   return params->q_tail;
 }
 
@@ -168,6 +191,14 @@ static cache_obj_t *FIFO_to_evict(cache_t *cache, const request_t *req) {
  */
 static void FIFO_evict(cache_t *cache, const request_t *req) {
   FIFO_params_t *params = (FIFO_params_t *)cache->eviction_params;
+  if (params->ring != NULL) {
+    cache_obj_t *obj_to_evict = ring_queue_oldest(params->ring);
+    DEBUG_ASSERT(obj_to_evict != NULL);
+    ring_queue_remove(params->ring, obj_to_evict);
+    cache_evict_base(cache, obj_to_evict, true);
+    return;
+  }
+
   cache_obj_t *obj_to_evict = params->q_tail;
   DEBUG_ASSERT(params->q_tail != NULL);
 
@@ -208,18 +239,85 @@ static bool FIFO_remove(cache_t *cache, const obj_id_t obj_id) {
 
   FIFO_params_t *params = (FIFO_params_t *)cache->eviction_params;
 
-  remove_obj_from_list(&params->q_head, &params->q_tail, obj);
+  if (params->ring != NULL) {
+    ring_queue_remove(params->ring, obj);
+  } else {
+    remove_obj_from_list(&params->q_head, &params->q_tail, obj);
+  }
   cache_remove_obj_base(cache, obj, true);
 
   return true;
 }
 
+// ***********************************************************************
+// ****                                                               ****
+// ****                     checkpoint functions                      ****
+// ****                                                               ****
+// ***********************************************************************
+/**
+ * @brief save the FIFO queue from head (newest) to tail (oldest)
+ *
+ * @param cache
+ * @param f
+ * @return whether the state is written
+ */
+static bool FIFO_save_state(const cache_t *cache, FILE *f) {
+  FIFO_params_t *params = (FIFO_params_t *)cache->eviction_params;
+  if (params->ring != NULL) {
+    return cache_save_ring_queue(params->ring, f);
+  }
+  return cache_save_obj_queue(params->q_head, f);
+}
+
+static bool FIFO_load_state(cache_t *cache, FILE *f) {
+  FIFO_params_t *params = (FIFO_params_t *)cache->eviction_params;
+  if (params->ring != NULL) {
+    return cache_load_ring_queue(cache, f, params->ring);
+  }
+  return cache_load_obj_queue(cache, f, &params->q_head, &params->q_tail);
+}
+
+// ***********************************************************************
+// ****                                                               ****
+// ****                  parameter set up functions                   ****
+// ****                                                               ****
+// ***********************************************************************
 static void FIFO_parse_params(cache_t *cache,
                               const char *cache_specific_params) {
-  if (cache_specific_params != NULL) {
-    ERROR("FIFO does not support any cache specific parameters\n");
-    exit(1);
+  FIFO_params_t *params = (FIFO_params_t *)cache->eviction_params;
+  char *params_str = strdup(cache_specific_params);
+  char *old_params_str = params_str;
+
+  while (params_str != NULL && params_str[0] != '\0') {
+    /* different parameters are separated by comma,
+     * key and value are separated by = */
+    char *key = strsep((char **)&params_str, "=");
+    char *value = strsep((char **)&params_str, ",");
+
+    // skip the white space
+    while (params_str != NULL && *params_str == ' ') {
+      params_str++;
+    }
+
+    if (strcasecmp(key, "queue") == 0) {
+      if (strcasecmp(value, "ring") == 0) {
+        if (params->ring == NULL) params->ring = create_ring_queue();
+      } else if (strcasecmp(value, "list") == 0) {
+        if (params->ring != NULL) free_ring_queue(params->ring);
+        params->ring = NULL;
+      } else {
+        ERROR("FIFO queue can be list or ring, but got %s\n", value);
+        exit(1);
+      }
+    } else if (strcasecmp(key, "print") == 0) {
+      printf("current parameters: queue=%s\n", params->ring != NULL ? "ring" : "list");
+      exit(0);
+    } else {
+      ERROR("%s does not have parameter %s, example parameters queue=ring\n", cache->cache_name, key);
+      exit(1);
+    }
   }
+  free(old_params_str);
 }
 
 #ifdef __cplusplus
@@ -35,6 +35,7 @@ static cache_obj_t *GLCache_insert(cache_t *cache, const request_t *req);
 static cache_obj_t *GLCache_to_evict(cache_t *cache, const request_t *req);
 static void GLCache_evict(cache_t *cache, const request_t *req);
 static bool GLCache_remove(cache_t *cache, const obj_id_t obj_id);
+static bool GLCache_prepare_fork(cache_t *cache);
 
 static void set_default_params(GLCache_params_t *params) {
   params->segment_size = 100;
@@ -42,6 +43,7 @@ static void set_default_params(GLCache_params_t *params) {
   params->rank_intvl = 0.02;
   params->merge_consecutive_segs = true;
   params->retrain_intvl = 86400;
+  params->async_train = true;
   params->train_source_y = TRAIN_Y_FROM_ONLINE;
   params->type = LOGCACHE_LEARNED;
 
@@ -53,7 +55,7 @@ const char *GLCache_default_params(void) {
   return "segment-size=100, n-merge=2, "
          "type=learned, rank-intvl=0.02,"
          "merge-consecutive-segs=true, train-source-y=online,"
-         "retrain-intvl=86400";
+         "retrain-intvl=86400, async-train=true";
 }
 
 static void GLCache_parse_init_params(const char *cache_specific_params,
@@ -76,6 +78,8 @@ static void GLCache_parse_init_params(const char *cache_specific_params,
       params->merge_consecutive_segs = atoi(value);
     } else if (strcasecmp(key, "retrain-intvl") == 0) {
       params->retrain_intvl = atoi(value);
+    } else if (strcasecmp(key, "async-train") == 0) {
+      params->async_train = strcasecmp(value, "true") == 0 || strcmp(value, "1") == 0;
     } else if (strcasecmp(key, "train-source-y") == 0) {
       if (strcasecmp(value, "online") == 0) {
         params->train_source_y = TRAIN_Y_FROM_ONLINE;
@@ -188,14 +192,16 @@ cache_t *GLCache_init(const common_cache_params_t ccache_params,
   cache->to_evict = NULL;
   cache->evict = GLCache_evict;
   cache->remove = GLCache_remove;
+  cache->prepare_fork = GLCache_prepare_fork;
 
   INFO(
       "%s, %.0lfMB, segment_size %d, training_interval %d, source %d, "
       "rank interval %.2lf, merge consecutive segments %d, "
-      "merge %d segments\n",
+      "merge %d segments, async training %d\n",
       GLCache_type_names[params->type], (double)cache->cache_size / 1048576.0,
       params->segment_size, params->retrain_intvl, params->train_source_y,
-      params->rank_intvl, params->merge_consecutive_segs, params->n_merge);
+      params->rank_intvl, params->merge_consecutive_segs, params->n_merge,
+      params->async_train);
   return cache;
 }
 
@@ -206,6 +212,7 @@ cache_t *GLCache_init(const common_cache_params_t ccache_params,
  */
 static void GLCache_free(cache_t *cache) {
   GLCache_params_t *params = cache->eviction_params;
+  cancel_train_job(cache);
   bucket_t *bkt = &params->train_bucket;
   segment_t *seg = bkt->first_seg, *next_seg;
 
@@ -252,6 +259,19 @@ static void GLCache_free(cache_t *cache) {
   cache_struct_free(cache);
 }
 
+/**
+ * @brief the training thread is not copied to a forked child, which would
+ * wait for a model that is never trained, so the background training is
+ * finished and its model installed before forking, the parent and the
+ * children continue with the same model
+ *
+ * @param cache
+ */
+static bool GLCache_prepare_fork(cache_t *cache) {
+  wait_trained_model(cache);
+  return true;
+}
+
 /**
  * @brief this function is the user facing API
  * it performs the following logic
@@ -280,9 +300,17 @@ static bool GLCache_get(cache_t *cache, const request_t *req) {
       params->type == LOGCACHE_ITEM_ORACLE) {
     /* generate training data by taking a snapshot */
     learner_t *l = &params->learner;
-    if (l->last_train_rtime > 0 &&
+    if (l->train_job != NULL) {
+      install_trained_model(cache);
+    }
+    /* a new model is not trained before the previous one is installed */
+    if (l->last_train_rtime > 0 && l->train_job == NULL &&
         params->curr_rtime - l->last_train_rtime >= params->retrain_intvl + 1) {
-      train(cache);
+      if (params->async_train) {
+        train_async(cache);
+      } else {
+        train(cache);
+      }
       snapshot_segs_to_training_data(cache);
     }
   }
@@ -1,5 +1,7 @@
 #pragma once
 
+#include <pthread.h>
+#include <stdatomic.h>
 #include <xgboost/c_api.h>
 
 #include "../../../include/libCacheSim/cache.h"
@@ -44,6 +46,27 @@ typedef struct {
   int64_t last_hour_window_ts;
 } seg_feature_t;
 
+/* a model trained on a background thread from a copy of the training data,
+ * the simulation keeps using the previous model until the job is done */
+typedef struct train_job {
+  pthread_t thread;
+  _Atomic bool done;
+
+  feature_t *train_x;
+  train_y_t *train_y;
+  feature_t *valid_x;
+  train_y_t *valid_y;
+  int n_feature;
+  int n_train_samples;
+  int n_valid_samples;
+
+  /* the result */
+  BoosterHandle booster;
+  DMatrixHandle train_dm;
+  DMatrixHandle valid_dm;
+  int n_trees;
+} train_job_t;
+
 typedef struct learner {
   int64_t last_train_rtime;
 
@@ -73,6 +96,8 @@ typedef struct learner {
   int32_t valid_matrix_n_row;
   int32_t inf_matrix_n_row;
 
+  /* the training job in progress, NULL if there is none */
+  train_job_t *train_job;
 } learner_t;
 
 typedef struct cache_state {
@@ -180,6 +205,9 @@ typedef struct {
   // lowest utility) or we merge non-consecutive segments based on ranking
   bool merge_consecutive_segs;
   int retrain_intvl;
+  /* train on a background thread, the result depends on the timing of the
+   * threads, set to false for reproducible results */
+  bool async_train;
   train_source_e train_source_y;
   GLCache_type_e type;
   double rank_intvl;
@@ -277,6 +305,18 @@ void seg_hit_update(GLCache_params_t *params, cache_obj_t *cache_obj);
 /************* learning *****************/
 void train(cache_t *cache);
 
+/* start training on a background thread */
+void train_async(cache_t *cache);
+
+/* install the model if the background training is done */
+void install_trained_model(cache_t *cache);
+
+/* wait for the background training and install the model */
+void wait_trained_model(cache_t *cache);
+
+/* wait for the background training and free its model */
+void cancel_train_job(cache_t *cache);
+
 void inference(cache_t *cache);
 
 /************* data preparation *****************/
@@ -286,6 +326,13 @@ void update_train_y(GLCache_params_t *params, cache_obj_t *cache_obj);
 
 void prepare_training_data(cache_t *cache);
 
+/* copy the training data to the job for background training */
+void prepare_training_data_async(cache_t *cache, train_job_t *job);
+
+void create_training_dmatrix(const feature_t *train_x, const train_y_t *train_y, int n_train_samples,
+                             const feature_t *valid_x, const train_y_t *valid_y, int n_valid_samples,
+                             int n_feature, DMatrixHandle *train_dm, DMatrixHandle *valid_dm);
+
 bool prepare_one_row(cache_t *cache, segment_t *curr_seg, bool training_data,
                      feature_t *x, train_y_t *y);
 
@@ -265,21 +265,16 @@ static int cmp_train_y(const void *p1, const void *p2) {
     return -1;
 }
 
-static void prepare_training_data_per_package(cache_t *cache) {
-  GLCache_params_t *params = cache->eviction_params;
-  learner_t *learner = &params->learner;
+void create_training_dmatrix(const feature_t *train_x, const train_y_t *train_y, int n_train_samples,
+                             const feature_t *valid_x, const train_y_t *valid_y, int n_valid_samples,
+                             int n_feature, DMatrixHandle *train_dm, DMatrixHandle *valid_dm) {
+  safe_call(XGDMatrixCreateFromMat(train_x, n_train_samples, n_feature, -2, train_dm));
 
-  safe_call(XGDMatrixCreateFromMat(learner->train_x, learner->n_train_samples,
-                                   learner->n_feature, -2, &learner->train_dm));
+  safe_call(XGDMatrixCreateFromMat(valid_x, n_valid_samples, n_feature, -2, valid_dm));
 
-  safe_call(XGDMatrixCreateFromMat(learner->valid_x, learner->n_valid_samples,
-                                   learner->n_feature, -2, &learner->valid_dm));
+  safe_call(XGDMatrixSetFloatInfo(*train_dm, "label", train_y, n_train_samples));
 
-  safe_call(XGDMatrixSetFloatInfo(learner->train_dm, "label", learner->train_y,
-                                  learner->n_train_samples));
-
-  safe_call(XGDMatrixSetFloatInfo(learner->valid_dm, "label", learner->valid_y,
-                                  learner->n_valid_samples));
+  safe_call(XGDMatrixSetFloatInfo(*valid_dm, "label", valid_y, n_valid_samples));
 
 #if OBJECTIVE == LTR
   // set group used for MAP and NDCG
@@ -298,15 +293,15 @@ static void prepare_training_data_per_package(cache_t *cache) {
   snprintf(
       str_n_valid_sample, sizeof(str_n_valid_sample),
       "{\"data\": [%llu],\"shape\": [1],\"typestr\": \"<u4\",\"version\": 3}",
-      (unsigned long long)(uintptr_t)&learner->n_valid_samples);
-  safe_call(
-      XGDMatrixSetUIntInfo(learner->train_dm, "group", str_n_valid_sample));
-  safe_call(
-      XGDMatrixSetUIntInfo(learner->valid_dm, "group", str_n_valid_sample));
+      (unsigned long long)(uintptr_t)&n_valid_samples);
+  safe_call(XGDMatrixSetUIntInfo(*train_dm, "group", str_n_valid_sample));
+  safe_call(XGDMatrixSetUIntInfo(*valid_dm, "group", str_n_valid_sample));
 #endif
 }
 
-void prepare_training_data(cache_t *cache) {
+/* move the non-empty rows to the front of the training data and split out
+ * the validation data, return the number of training and validation rows */
+static void compact_training_data(cache_t *cache, int *n_train_rows, int *n_valid_rows) {
   GLCache_params_t *params = cache->eviction_params;
   learner_t *learner = &params->learner;
   int i;
@@ -456,18 +451,58 @@ void prepare_training_data(cache_t *cache) {
   fprintf(ofile_cmp_y, "#####################################\n");
 #endif
 
-#ifdef TRAIN_KEEP_HALF
-  int original_n_train_samples = learner->n_train_samples;
+  *n_train_rows = pos_in_train_data;
+  *n_valid_rows = pos_in_valid_data;
+}
+
+void prepare_training_data(cache_t *cache) {
+  GLCache_params_t *params = cache->eviction_params;
+  learner_t *learner = &params->learner;
+
+  int n_train_rows, n_valid_rows;
+  compact_training_data(cache, &n_train_rows, &n_valid_rows);
+
+  create_training_dmatrix(learner->train_x, learner->train_y, n_train_rows, learner->valid_x, learner->valid_y,
+                          n_valid_rows, learner->n_feature, &learner->train_dm, &learner->valid_dm);
+#ifndef TRAIN_KEEP_HALF
+  learner->n_train_samples = n_train_rows;
 #endif
-  learner->n_train_samples = pos_in_train_data;
-  learner->n_valid_samples = pos_in_valid_data;
+  learner->n_valid_samples = n_valid_rows;
 
-  prepare_training_data_per_package(cache);
-#ifdef TRAIN_KEEP_HALF
-  learner->n_train_samples = original_n_train_samples;
+#ifdef DUMP_TRAINING_DATA
+  dump_training_data(cache);
 #endif
 
+  clean_training_segs(cache);
+}
+
+void prepare_training_data_async(cache_t *cache, train_job_t *job) {
+  GLCache_params_t *params = cache->eviction_params;
+  learner_t *learner = &params->learner;
+
+  int n_train_rows, n_valid_rows;
+  compact_training_data(cache, &n_train_rows, &n_valid_rows);
+
+  /* the training data of the learner is overwritten by the next snapshot,
+   * so the job trains on a copy */
+  int n_feature = learner->n_feature;
+  job->n_feature = n_feature;
+  job->n_train_samples = n_train_rows;
+  job->n_valid_samples = n_valid_rows;
+  job->train_x = my_malloc_n(feature_t, MAX(n_train_rows, 1) * n_feature);
+  job->train_y = my_malloc_n(train_y_t, MAX(n_train_rows, 1));
+  job->valid_x = my_malloc_n(feature_t, MAX(n_valid_rows, 1) * n_feature);
+  job->valid_y = my_malloc_n(train_y_t, MAX(n_valid_rows, 1));
+  memcpy(job->train_x, learner->train_x, sizeof(feature_t) * n_train_rows * n_feature);
+  memcpy(job->train_y, learner->train_y, sizeof(train_y_t) * n_train_rows);
+  memcpy(job->valid_x, learner->valid_x, sizeof(feature_t) * n_valid_rows * n_feature);
+  memcpy(job->valid_y, learner->valid_y, sizeof(train_y_t) * n_valid_rows);
+
 #ifdef DUMP_TRAINING_DATA
+#ifndef TRAIN_KEEP_HALF
+  learner->n_train_samples = n_train_rows;
+#endif
+  learner->n_valid_samples = n_valid_rows;
   dump_training_data(cache);
 #endif
 
@@ -1,5 +1,6 @@
 
 #include <math.h>
+#include <pthread.h>
 #include <xgboost/c_api.h>
 
 #include "GLCacheInternal.h"
@@ -19,52 +20,40 @@ static void debug_print_feature_matrix(const DMatrixHandle handle,
   printf("\n");
 }
 
-static void train_xgboost(cache_t *cache) {
-  GLCache_params_t *params = cache->eviction_params;
-  learner_t *learner = &params->learner;
-
-  if (learner->n_train != 0) {
-    safe_call(XGBoosterFree(learner->booster));
-    safe_call(XGDMatrixFree(learner->train_dm));
-    safe_call(XGDMatrixFree(learner->valid_dm));
-  }
-
-  prepare_training_data(cache);
-  // debug_print_feature_matrix(learner->train_dm, 20);
-
-  DMatrixHandle eval_dmats[2] = {learner->train_dm, learner->valid_dm};
+/* train a model until the validation loss is stable or N_TRAIN_ITER rounds */
+static void boost_model(DMatrixHandle train_dm, DMatrixHandle valid_dm,
+                        int n_valid_samples, BoosterHandle *booster_out,
+                        int *n_trees) {
+  DMatrixHandle eval_dmats[2] = {train_dm, valid_dm};
   static const char *eval_names[2] = {"train", "valid"};
   const char *eval_result;
   double train_loss, valid_loss, last_valid_loss = 0;
   int n_stable_iter = 0;
 
-  safe_call(XGBoosterCreate(eval_dmats, 1, &learner->booster));
-  safe_call(XGBoosterSetParam(learner->booster, "booster", "gbtree"));
-  safe_call(XGBoosterSetParam(learner->booster, "verbosity", "1"));
-  safe_call(XGBoosterSetParam(learner->booster, "nthread", "1"));
+  BoosterHandle booster;
+  safe_call(XGBoosterCreate(eval_dmats, 1, &booster));
+  safe_call(XGBoosterSetParam(booster, "booster", "gbtree"));
+  safe_call(XGBoosterSetParam(booster, "verbosity", "1"));
+  safe_call(XGBoosterSetParam(booster, "nthread", "1"));
 #if OBJECTIVE == REG
-  safe_call(
-      XGBoosterSetParam(learner->booster, "objective", "reg:squarederror"));
+  safe_call(XGBoosterSetParam(booster, "objective", "reg:squarederror"));
 #elif OBJECTIVE == LTR
-  safe_call(XGBoosterSetParam(learner->booster, "objective", "rank:pairwise"));
+  safe_call(XGBoosterSetParam(booster, "objective", "rank:pairwise"));
 #endif
 
   for (int i = 0; i < N_TRAIN_ITER; ++i) {
     // Update the model performance for each iteration
-    safe_call(XGBoosterUpdateOneIter(learner->booster, i, learner->train_dm));
-    if (learner->n_valid_samples < 10) continue;
-    safe_call(XGBoosterEvalOneIter(learner->booster, i, eval_dmats, eval_names,
-                                   2, &eval_result));
+    safe_call(XGBoosterUpdateOneIter(booster, i, train_dm));
+    if (n_valid_samples < 10) continue;
+    safe_call(XGBoosterEvalOneIter(booster, i, eval_dmats, eval_names, 2,
+                                   &eval_result));
 #if OBJECTIVE == REG
     char *train_pos = strstr(eval_result, "train-rmse:") + 11;
     char *valid_pos = strstr(eval_result, "valid-rmse") + 11;
     train_loss = strtof(train_pos, NULL);
     valid_loss = strtof(valid_pos, NULL);
 
-    // DEBUG("%.2lf hour, cache size %.2lf MB, iter %d, train loss %.4lf, valid
-    // loss %.4lf\n",
-    //     (double) params->curr_rtime / 3600.0,
-    //     (double) cache->cache_size / 1024.0 / 1024.0,
+    // DEBUG("iter %d, train loss %.4lf, valid loss %.4lf\n",
     //     i, train_loss, valid_loss);
 
     if (fabs(last_valid_loss - valid_loss) / valid_loss < 0.01) {
@@ -85,9 +74,28 @@ static void train_xgboost(cache_t *cache) {
 #endif
   }
 #ifndef __APPLE__
-  safe_call(XGBoosterBoostedRounds(learner->booster, &learner->n_trees));
+  safe_call(XGBoosterBoostedRounds(booster, n_trees));
 #endif
 
+  *booster_out = booster;
+}
+
+static void train_xgboost(cache_t *cache) {
+  GLCache_params_t *params = cache->eviction_params;
+  learner_t *learner = &params->learner;
+
+  if (learner->n_train != 0) {
+    safe_call(XGBoosterFree(learner->booster));
+    safe_call(XGDMatrixFree(learner->train_dm));
+    safe_call(XGDMatrixFree(learner->valid_dm));
+  }
+
+  prepare_training_data(cache);
+  // debug_print_feature_matrix(learner->train_dm, 20);
+
+  boost_model(learner->train_dm, learner->valid_dm, learner->n_valid_samples,
+              &learner->booster, &learner->n_trees);
+
   DEBUG(
       "%.2lf hour, cache size %.2lf MB, vtime %ld, train/valid %d/%d samples, "
       "%d trees, "
@@ -130,3 +138,108 @@ void train(cache_t *cache) {
   params->learner.n_train_samples = 0;
   params->learner.n_valid_samples = 0;
 }
+
+static void *train_job_run(void *arg) {
+  train_job_t *job = (train_job_t *)arg;
+
+  create_training_dmatrix(job->train_x, job->train_y, job->n_train_samples,
+                          job->valid_x, job->valid_y, job->n_valid_samples,
+                          job->n_feature, &job->train_dm, &job->valid_dm);
+  boost_model(job->train_dm, job->valid_dm, job->n_valid_samples,
+              &job->booster, &job->n_trees);
+
+  atomic_store_explicit(&job->done, true, memory_order_release);
+  return NULL;
+}
+
+static void free_train_job(train_job_t *job) {
+  my_free(sizeof(feature_t) * job->n_train_samples * job->n_feature,
+          job->train_x);
+  my_free(sizeof(train_y_t) * job->n_train_samples, job->train_y);
+  my_free(sizeof(feature_t) * job->n_valid_samples * job->n_feature,
+          job->valid_x);
+  my_free(sizeof(train_y_t) * job->n_valid_samples, job->valid_y);
+  my_free(sizeof(train_job_t), job);
+}
+
+void train_async(cache_t *cache) {
+  GLCache_params_t *params = (GLCache_params_t *)cache->eviction_params;
+  learner_t *learner = &params->learner;
+  DEBUG_ASSERT(learner->train_job == NULL);
+
+  train_job_t *job = my_malloc(train_job_t);
+  memset(job, 0, sizeof(train_job_t));
+  atomic_init(&job->done, false);
+  prepare_training_data_async(cache, job);
+
+  if (pthread_create(&job->thread, NULL, train_job_run, job) != 0) {
+    ERROR("cannot create GLCache training thread\n");
+  }
+  learner->train_job = job;
+
+  /* the snapshot for the next model starts now, the same as train */
+  learner->last_train_rtime = params->curr_rtime;
+  learner->n_train_samples = 0;
+  learner->n_valid_samples = 0;
+}
+
+/* join the training thread and replace the model with the trained one */
+static void install_job_model(cache_t *cache) {
+  GLCache_params_t *params = (GLCache_params_t *)cache->eviction_params;
+  learner_t *learner = &params->learner;
+  train_job_t *job = learner->train_job;
+
+  pthread_join(job->thread, NULL);
+
+  /* only the simulation thread uses the model, so the previous model can be
+   * freed once it is replaced */
+  if (learner->n_train > 0) {
+    safe_call(XGBoosterFree(learner->booster));
+    safe_call(XGDMatrixFree(learner->train_dm));
+    safe_call(XGDMatrixFree(learner->valid_dm));
+  }
+  learner->booster = job->booster;
+  learner->train_dm = job->train_dm;
+  learner->valid_dm = job->valid_dm;
+  learner->n_trees = job->n_trees;
+  learner->n_train = MAX(learner->n_train, 0) + 1;
+
+  DEBUG(
+      "%.2lf hour, cache size %.2lf MB, vtime %ld, install model trained on "
+      "train/valid %d/%d samples, %d trees\n",
+      (double)params->curr_rtime / 3600.0,
+      (double)cache->cache_size / 1024.0 / 1024.0, (long)params->curr_vtime,
+      job->n_train_samples, job->n_valid_samples, job->n_trees);
+
+  free_train_job(job);
+  learner->train_job = NULL;
+}
+
+void install_trained_model(cache_t *cache) {
+  GLCache_params_t *params = (GLCache_params_t *)cache->eviction_params;
+  train_job_t *job = params->learner.train_job;
+
+  if (!atomic_load_explicit(&job->done, memory_order_acquire)) return;
+  install_job_model(cache);
+}
+
+void wait_trained_model(cache_t *cache) {
+  GLCache_params_t *params = (GLCache_params_t *)cache->eviction_params;
+  if (params->learner.train_job == NULL) return;
+
+  install_job_model(cache);
+}
+
+void cancel_train_job(cache_t *cache) {
+  GLCache_params_t *params = (GLCache_params_t *)cache->eviction_params;
+  learner_t *learner = &params->learner;
+  train_job_t *job = learner->train_job;
+  if (job == NULL) return;
+
+  pthread_join(job->thread, NULL);
+  safe_call(XGBoosterFree(job->booster));
+  safe_call(XGDMatrixFree(job->train_dm));
+  safe_call(XGDMatrixFree(job->valid_dm));
+  free_train_job(job);
+  learner->train_job = NULL;
+}
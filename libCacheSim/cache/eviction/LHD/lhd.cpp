@@ -2,6 +2,7 @@
 
 #include <sstream>
 
+#include "../../../dataStructure/hashtable/hashtable.h"
 #include "../../../utils/include/mymath.h"
 #include "constants.hpp"
 
@@ -11,7 +12,7 @@ LHD::LHD(int _associativity, int _admissions, cache_t* _cache)
     : ASSOCIATIVITY(_associativity),
       ADMISSIONS(_admissions),
       cache(_cache),
-      recentlyAdmitted(ADMISSIONS, INVALID_CANDIDATE) {
+      recentlyAdmitted(ADMISSIONS, (obj_id_t)INVALID_CANDIDATE.id) {
   nextReconfiguration = ACCS_PER_RECONFIGURATION;
   explorerBudget = cache->cache_size * EXPLORER_BUDGET_FRACTION;
 
@@ -20,22 +21,22 @@ LHD::LHD(int _associativity, int _admissions, cache_t* _cache)
     auto& cl = classes.back();
     cl.hits.resize(MAX_AGE, 0);
     cl.evictions.resize(MAX_AGE, 0);
-    cl.hitDensities.resize(MAX_AGE, 0);
   }
+  hitDensities.resize(NUM_CLASSES * MAX_AGE, 0);
+  sampleIdx.resize(ASSOCIATIVITY + ADMISSIONS);
+  sampleAge.resize(ASSOCIATIVITY + ADMISSIONS);
+  sampleRank.resize(ASSOCIATIVITY + ADMISSIONS);
 
   // Initialize policy to ~GDSF by default.
   // jason: why is this GDSF? and why the index of class is used in density
   for (uint32_t c = 0; c < NUM_CLASSES; c++) {
     for (age_t a = 0; a < MAX_AGE; a++) {
-      classes[c].hitDensities[a] = 1. * (c + 1) / (a + 1);
+      hitDensities[c * MAX_AGE + a] = 1. * (c + 1) / (a + 1);
     }
   }
 }
 
-candidate_t LHD::rank(const request_t* req) {
-  uint64_t victim = -1;
-  rank_t victimRank = std::numeric_limits<rank_t>::max();
-
+cache_obj_t* LHD::rank(const request_t* req) {
   // Sample few candidates early in the trace so that we converge
   // quickly to a reasonable policy.
   //
@@ -44,31 +45,39 @@ candidate_t LHD::rank(const request_t* req) {
   // system.
   uint32_t candidates = (numReconfigurations > 50) ? ASSOCIATIVITY : 8;
 
+  // collect the sampled tags and the recently admitted tags first, then rank
+  // them in passes over the flat tag arrays
+  uint32_t n = 0;
   for (uint32_t i = 0; i < candidates; i++) {
-    auto idx = next_rand() % tags.size();
-    auto& tag = tags[idx];
-    rank_t rank = getHitDensity(tag);
-
-    if (rank < victimRank) {
-      victim = idx;
-      victimRank = rank;
-    }
+    sampleIdx[n++] = next_rand() % tags.obj.size();
   }
 
   for (uint32_t i = 0; i < ADMISSIONS; i++) {
-    auto itr = indices.find(recentlyAdmitted[i]);
-    if (itr == indices.end()) {
+    if (recentlyAdmitted[i] == (obj_id_t)INVALID_CANDIDATE.id) {
+      continue;
+    }
+    cache_obj_t* obj =
+        hashtable_find_obj_id(cache->hashtable, recentlyAdmitted[i]);
+    if (obj == NULL) {
       continue;
     }
+    sampleIdx[n++] = obj->lhd.tag_idx;
+  }
 
-    auto idx = itr->second;
-    auto& tag = tags[idx];
-    assert(tag.id == recentlyAdmitted[i]);
-    rank_t rank = getHitDensity(tag);
+  for (uint32_t i = 0; i < n; i++) {
+    sampleAge[i] = getAge(sampleIdx[i]);
+  }
+
+  for (uint32_t i = 0; i < n; i++) {
+    sampleRank[i] = getHitDensity(sampleIdx[i], sampleAge[i]);
+  }
 
-    if (rank < victimRank) {
-      victim = idx;
-      victimRank = rank;
+  uint64_t victim = -1;
+  rank_t victimRank = std::numeric_limits<rank_t>::max();
+  for (uint32_t i = 0; i < n; i++) {
+    if (sampleRank[i] < victimRank) {
+      victim = sampleIdx[i];
+      victimRank = sampleRank[i];
     }
   }
 
@@ -77,55 +86,54 @@ candidate_t LHD::rank(const request_t* req) {
   ewmaVictimHitDensity =
       EWMA_DECAY * ewmaVictimHitDensity + (1 - EWMA_DECAY) * victimRank;
 
-  return tags[victim].id;
+  return tags.obj[victim];
 }
 
-void LHD::update(candidate_t id, const request_t* req) {
-  auto itr = indices.find(id);
-  bool insert = (itr == indices.end());
-
-  Tag* tag;
+void LHD::update(cache_obj_t* obj, const request_t* req, bool insert) {
+  uint32_t idx;
   if (insert) {
-    tags.push_back(Tag{});
-    tag = &tags.back();
-    indices[id] = tags.size() - 1;
+    idx = tags.obj.size();
+    tags.push_back();
+    obj->lhd.tag_idx = idx;
 
-    tag->lastLastHitAge = MAX_AGE;
-    tag->lastHitAge = 0;
-    tag->id = id;
+    tags.lastLastHitAge[idx] = MAX_AGE;
+    tags.lastHitAge[idx] = 0;
+    tags.obj[idx] = obj;
   } else {
-    tag = &tags[itr->second];
-    assert(tag->id == id);
-    auto age = getAge(*tag);
-    auto& cl = getClass(*tag);
+    idx = obj->lhd.tag_idx;
+    assert(tags.obj[idx] == obj);
+    auto age = getAge(idx);
+    auto& cl = classes[tags.classId[idx]];
     cl.hits[age] += 1;
 
-    if (tag->explorer) {
-      explorerBudget += tag->size;
+    if (tags.explorer[idx]) {
+      explorerBudget += tags.size[idx];
     }
 
-    tag->lastLastHitAge = tag->lastHitAge;
-    tag->lastHitAge = age;
+    tags.lastLastHitAge[idx] = tags.lastHitAge[idx];
+    tags.lastHitAge[idx] = age;
   }
 
-  tag->timestamp = timestamp;
-  tag->app = DEFAULT_APP_ID % APP_CLASSES;
-  tag->size = req->obj_size;
+  tags.timestamp[idx] = timestamp;
+  tags.classId[idx] =
+      getClassId(tags.lastHitAge[idx], tags.lastLastHitAge[idx]);
+  tags.size[idx] = req->obj_size;
 
   // with some probability, some candidates will never be evicted
   // ... but limit how many resources we spend on doing this
   bool explore = (next_rand() % EXPLORE_INVERSE_PROBABILITY) == 0;
   if (explore && explorerBudget > 0 && numReconfigurations < 50) {
-    tag->explorer = true;
-    explorerBudget -= tag->size;
+    tags.explorer[idx] = true;
+    explorerBudget -= tags.size[idx];
   } else {
-    tag->explorer = false;
+    tags.explorer[idx] = false;
   }
 
   // If this candidate looks like something that should be
   // evicted, track it.
-  if (insert && !explore && getHitDensity(*tag) < ewmaVictimHitDensity) {
-    recentlyAdmitted[recentlyAdmittedHead++ % ADMISSIONS] = id;
+  if (insert && !explore &&
+      getHitDensity(idx, getAge(idx)) < ewmaVictimHitDensity) {
+    recentlyAdmitted[recentlyAdmittedHead++ % ADMISSIONS] = obj->obj_id;
   }
 
   ++timestamp;
@@ -137,30 +145,21 @@ void LHD::update(candidate_t id, const request_t* req) {
   }
 }
 
-void LHD::replaced(candidate_t id) {
-  auto itr = indices.find(id);
-  assert(itr != indices.end());
-  auto index = itr->second;
+void LHD::replaced(cache_obj_t* obj) {
+  uint32_t idx = obj->lhd.tag_idx;
+  assert(tags.obj[idx] == obj);
 
   // Record stats before removing item
-  auto& tag = tags[index];
-  assert(tag.id == id);
-  auto age = getAge(tag);
-  auto& cl = getClass(tag);
+  auto age = getAge(idx);
+  auto& cl = classes[tags.classId[idx]];
   cl.evictions[age] += 1;
 
-  if (tag.explorer) {
-    explorerBudget += tag.size;
+  if (tags.explorer[idx]) {
+    explorerBudget += tags.size[idx];
   }
 
-  // Remove tag for replaced item and update index
-  indices.erase(itr);
-  tags[index] = tags.back();
-  tags.pop_back();
-
-  if (index < tags.size()) {
-    indices[tags[index].id] = index;
-  }
+  // Remove tag for replaced item and update the index of the moved tag
+  tags.remove(idx);
 }
 
 void LHD::reconfigure() {
@@ -178,13 +177,12 @@ void LHD::reconfigure() {
 
   // Just printfs ...
   for (uint32_t c = 0; c < classes.size(); c++) {
-    auto& cl = classes[c];
     // printf("Class %d | hits %g, evictions %g, hitRate %g\n",
     //        c,
     //        cl.totalHits, cl.totalEvictions,
     //        cl.totalHits / (cl.totalHits + cl.totalEvictions));
 
-    dumpClassRanks(cl);
+    dumpClassRanks(c);
   }
   //    printf("LHD | hits %g, evictions %g, hitRate %g | overflows %lu (%g) |
   //    cumulativeHitRate nan\n",
@@ -228,29 +226,30 @@ void LHD::modelHitDensity() {
       lifetimeUnconditioned += totalEvents;
 
       if (totalEvents > 1e-5) {
-        classes[c].hitDensities[a] = totalHits / lifetimeUnconditioned;
+        hitDensities[c * MAX_AGE + a] = totalHits / lifetimeUnconditioned;
       } else {
-        classes[c].hitDensities[a] = 0.;
+        hitDensities[c * MAX_AGE + a] = 0.;
       }
     }
   }
 }
 
-void LHD::dumpClassRanks(Class& cl) {
+void LHD::dumpClassRanks(uint32_t c) {
   if (!DUMP_RANKS) {
     return;
   }
+  auto& cl = classes[c];
 
   // float objectAvgSize = cl.sizeAccumulator / cl.totalHits; // +
   // cl.totalEvictions);
-  float objectAvgSize = 1. * cache->occupied_byte / sizeMap.size();
+  float objectAvgSize = 1. * cache->occupied_byte / tags.obj.size();
   rank_t left;
 
   left = cl.totalHits + cl.totalEvictions;
   std::cout << "Ranks for avg object (" << objectAvgSize << "): ";
   for (age_t a = 0; a < MAX_AGE; a++) {
     std::stringstream rankStr;
-    rank_t density = cl.hitDensities[a] / objectAvgSize;
+    rank_t density = hitDensities[c * MAX_AGE + a] / objectAvgSize;
     rankStr << density << ", ";
     std::cout << rankStr.str();
 
@@ -300,7 +299,7 @@ void LHD::adaptAgeCoarsening() {
   ewmaNumObjects *= EWMA_DECAY;
   ewmaNumObjectsMass *= EWMA_DECAY;
 
-  ewmaNumObjects += sizeMap.size();
+  ewmaNumObjects += tags.obj.size();
   ewmaNumObjectsMass += 1.;
 
   rank_t numObjects = ewmaNumObjects / ewmaNumObjectsMass;
@@ -17,16 +17,50 @@ class LHD {
   typedef uint64_t age_t;
   typedef float rank_t;
 
-  // info we track about each object
-  struct Tag {
-    age_t timestamp;
-    age_t lastHitAge;
-    age_t lastLastHitAge;
-    uint32_t app;
-
-    candidate_t id;
-    rank_t size;  // stored redundantly with cache
-    bool explorer;
+  // info we track about each object, stored as struct-of-arrays so that
+  // ranking a sample reads only the fields it needs; an object finds its
+  // tag through obj->lhd.tag_idx
+  struct Tags {
+    std::vector<timestamp_t> timestamp;
+    std::vector<age_t> lastHitAge;
+    std::vector<age_t> lastLastHitAge;
+    // getClassId of the tag, changes only when the tag is updated
+    std::vector<uint32_t> classId;
+    std::vector<rank_t> size;  // stored redundantly with cache
+    std::vector<uint8_t> explorer;
+    std::vector<cache_obj_t *> obj;
+
+    void push_back() {
+      timestamp.push_back(0);
+      lastHitAge.push_back(0);
+      lastLastHitAge.push_back(0);
+      classId.push_back(0);
+      size.push_back(0);
+      explorer.push_back(0);
+      obj.push_back(nullptr);
+    }
+
+    // move the last tag to idx and drop the last slot
+    void remove(uint32_t idx) {
+      uint32_t last = obj.size() - 1;
+      if (idx != last) {
+        timestamp[idx] = timestamp[last];
+        lastHitAge[idx] = lastHitAge[last];
+        lastLastHitAge[idx] = lastLastHitAge[last];
+        classId[idx] = classId[last];
+        size[idx] = size[last];
+        explorer[idx] = explorer[last];
+        obj[idx] = obj[last];
+        obj[idx]->lhd.tag_idx = idx;
+      }
+      timestamp.pop_back();
+      lastHitAge.pop_back();
+      lastLastHitAge.pop_back();
+      classId.pop_back();
+      size.pop_back();
+      explorer.pop_back();
+      obj.pop_back();
+    }
   };
 
   // info we track about each class of objects
@@ -35,29 +69,30 @@ class LHD {
     std::vector<rank_t> evictions;
     rank_t totalHits = 0;
     rank_t totalEvictions = 0;
-
-    std::vector<rank_t> hitDensities;
   };
 
   LHD(int _associativity, int _admissions, cache_t *cache);
   ~LHD() {}
 
-  // called whenever and object is referenced
-  void update(candidate_t id, const request_t *req);
+  // called whenever and object is referenced, insert is true if the object
+  // has just been inserted
+  void update(cache_obj_t *obj, const request_t *req, bool insert);
 
   // called when an object is evicted
-  void replaced(candidate_t id);
+  void replaced(cache_obj_t *obj);
+
+  // called when an object is removed by the user, does not update the stats
+  void removed(cache_obj_t *obj) { tags.remove(obj->lhd.tag_idx); }
 
   // called to find a victim upon a cache miss
-  candidate_t rank(const request_t *req);
+  cache_obj_t *rank(const request_t *req);
 
   void dumpStats(LHDCache::Cache *cache_params) {}
 
-  std::unordered_map<candidate_t, uint32_t> sizeMap;
-  // object metadata; indices maps object id -> metadata
-  std::vector<Tag> tags;
+  Tags tags;
   std::vector<Class> classes;
-  std::unordered_map<candidate_t, uint64_t> indices;
+  // the hit density of class c at age a is hitDensities[c * MAX_AGE + a]
+  std::vector<rank_t> hitDensities;
 
  private:
   // CONSTANTS ///////////////////////////
@@ -122,10 +157,15 @@ class LHD {
   //  misc::Rand rand;
 
   // see ADMISSIONS above
-  std::vector<candidate_t> recentlyAdmitted;
+  std::vector<obj_id_t> recentlyAdmitted;
   int recentlyAdmittedHead = 0;
   rank_t ewmaVictimHitDensity = 0;
 
+  // the tags sampled by rank and their ranks
+  std::vector<uint32_t> sampleIdx;
+  std::vector<age_t> sampleAge;
+  std::vector<rank_t> sampleRank;
+
   int64_t explorerBudget = 0;
 
   // METHODS /////////////////////////////
@@ -143,37 +183,16 @@ class LHD {
     return log;
   }
 
-  inline uint32_t getClassId(const Tag &tag) const {
-    uint32_t hitAgeId = hitAgeClass(tag.lastHitAge + tag.lastLastHitAge);
-    // uint32_t hitAgeId = hitAgeClass(tag.lastHitAge);
-    return tag.app * HIT_AGE_CLASSES + hitAgeId;
-  }
-
-  inline uint32_t getClassIdBySize(const Tag &tag) const {
-    uint32_t hitSizeId = 0;
-    uint64_t size = (uint64_t)tag.size;
-    return tag.app * HIT_AGE_CLASSES + ((uint64_t)log(size)) % HIT_AGE_CLASSES;
-  }
-
-  inline uint32_t getClassIdBySizeAndAge(const Tag &tag) const {
-    if (tag.lastHitAge == 0) return getClassIdBySize(tag);
-
-    uint32_t hitSizeId = 0;
-    uint64_t size = (uint64_t)tag.size;
-    return tag.app * HIT_AGE_CLASSES +
-           ((uint64_t)log(size) + (uint64_t)log(tag.lastHitAge)) %
-               HIT_AGE_CLASSES;
-  }
-
-  inline Class &getClass(const Tag &tag) {
-    // return classes[getClassIdBySizeAndAge(tag)];
-    // return classes[getClassIdBySize(tag)];
-    return classes[getClassId(tag)];
+  inline uint32_t getClassId(age_t lastHitAge, age_t lastLastHitAge) const {
+    uint32_t hitAgeId = hitAgeClass(lastHitAge + lastLastHitAge);
+    // uint32_t hitAgeId = hitAgeClass(lastHitAge);
+    uint32_t app = DEFAULT_APP_ID % APP_CLASSES;
+    return app * HIT_AGE_CLASSES + hitAgeId;
   }
 
-  inline age_t getAge(Tag tag) {
+  inline age_t getAge(uint32_t idx) {
     timestamp_t age =
-        (timestamp - (timestamp_t)tag.timestamp) >> ageCoarseningShift;
+        (timestamp - tags.timestamp[idx]) >> ageCoarseningShift;
 
     if (age >= MAX_AGE) {
       ++overflows;
@@ -183,18 +202,17 @@ class LHD {
     }
   }
 
-  inline rank_t getHitDensity(const Tag &tag) {
-    auto age = getAge(tag);
+  inline rank_t getHitDensity(uint32_t idx, age_t age) const {
     if (age == MAX_AGE - 1) {
       return std::numeric_limits<rank_t>::lowest();
     }
-    auto &cl = getClass(tag);
 #ifdef BYTE_MISS_RATIO
-    rank_t density = cl.hitDensities[age];
+    rank_t density = hitDensities[tags.classId[idx] * MAX_AGE + age];
 #else
-    rank_t density = cl.hitDensities[age] / tag.size;
+    rank_t density =
+        hitDensities[tags.classId[idx] * MAX_AGE + age] / tags.size[idx];
 #endif
-    if (tag.explorer) {
+    if (tags.explorer[idx]) {
       density += 1.;
     }
     return density;
@@ -204,7 +222,7 @@ class LHD {
   void adaptAgeCoarsening();
   void updateClass(Class &cl);
   void modelHitDensity();
-  void dumpClassRanks(Class &cl);
+  void dumpClassRanks(uint32_t c);
 };
 
 }  // namespace repl
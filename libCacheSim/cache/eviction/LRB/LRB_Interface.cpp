@@ -19,6 +19,10 @@ extern "C" {
 typedef struct {
   void *LRB_cache;
   char *objective;
+  // the number of candidates LRB evicts from one prediction
+  int eviction_batch;
+  // the number of LightGBM threads used to score the candidates
+  int inference_threads;
   SimpleRequest lrb_req;
 
   pair<uint64_t, uint32_t> to_evict_pair;
@@ -94,11 +98,13 @@ cache_t *LRB_init(const common_cache_params_t ccache_params,
 
   LRB_params_t *params = my_malloc(LRB_params_t);
   cache->eviction_params = params;
+  params->objective = NULL;
+  params->eviction_batch = 1;
+  params->inference_threads = 1;
 
+  LRB_parse_params(cache, DEFAULT_PARAMS);
   if (cache_specific_params != NULL) {
     LRB_parse_params(cache, cache_specific_params);
-  } else {
-    LRB_parse_params(cache, DEFAULT_PARAMS);
   }
 
   auto *lrb = new lrb::LRBCache();
@@ -109,6 +115,8 @@ cache_t *LRB_init(const common_cache_params_t ccache_params,
   std::map<string, string> params_map;
 
   params_map["objective"] = params->objective;
+  params_map["eviction_batch"] = std::to_string(params->eviction_batch);
+  params_map["inference_threads"] = std::to_string(params->inference_threads);
 
   if (strcmp(params->objective, "object-miss-ratio") == 0) {
     snprintf(cache->cache_name, CACHE_NAME_ARRAY_LEN, "%s", "LRB-OMR");
@@ -307,7 +315,10 @@ static int64_t LRB_get_occupied_byte(const cache_t *cache) {
 // ***********************************************************************
 static const char *LRB_current_params(cache_t *cache, LRB_params_t *params) {
   static __thread char params_str[128];
-  int n = snprintf(params_str, 128, "objective=%s", params->objective);
+  int n = snprintf(params_str, 128,
+                   "objective=%s, eviction-batch=%d, inference-threads=%d",
+                   params->objective, params->eviction_batch,
+                   params->inference_threads);
 
   snprintf(cache->cache_name + n, 128 - n, "\n");
 
@@ -332,10 +343,21 @@ static void LRB_parse_params(cache_t *cache,
     }
 
     if (strcasecmp(key, "objective") == 0) {
+      free(params->objective);
       params->objective = strdup(value);
       if (params->objective == NULL) {
         ERROR("out of memory %s\n", strerror(errno));
       }
+    } else if (strcasecmp(key, "eviction-batch") == 0) {
+      params->eviction_batch = (int)strtol(value, &end, 0);
+      if (params->eviction_batch <= 0) {
+        ERROR("LRB eviction-batch should be positive, get %s\n", value);
+      }
+    } else if (strcasecmp(key, "inference-threads") == 0) {
+      params->inference_threads = (int)strtol(value, &end, 0);
+      if (params->inference_threads <= 0) {
+        ERROR("LRB inference-threads should be positive, get %s\n", value);
+      }
     } else if (strcasecmp(key, "print") == 0) {
       printf("current parameters: %s\n", LRB_current_params(cache, params));
       exit(0);
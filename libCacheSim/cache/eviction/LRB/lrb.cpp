@@ -35,7 +35,7 @@ void LRBCache::train() {
   LGBM_BoosterCreate(trainData, map_to_string(training_params).c_str(),
                      &booster);
   // train
-  for (int i = 0; i < stoi(training_params["num_iterations"]); i++) {
+  for (int i = 0; i < n_iteration; i++) {
     int isFinished;
     LGBM_BoosterUpdateOneIter(booster, &isFinished);
     if (isFinished) {
@@ -44,14 +44,15 @@ void LRBCache::train() {
   }
 
   int64_t len;
-  vector<double> result(training_data->indptr.size() - 1);
+  vector<double> &result = training_scores;
+  result.resize(training_data->indptr.size() - 1);
   LGBM_BoosterPredictForCSR(
       booster, static_cast<void *>(training_data->indptr.data()),
       C_API_DTYPE_INT32, training_data->indices.data(),
       static_cast<void *>(training_data->data.data()), C_API_DTYPE_FLOAT64,
       training_data->indptr.size(), training_data->data.size(),
       n_feature,  // remove future t
-      C_API_PREDICT_NORMAL, 0, atoi(training_params["num_iterations"].c_str()),
+      C_API_PREDICT_NORMAL, 0, n_iteration,
       map_to_string(training_params).c_str(), &len, result.data());
 
   double se = 0;
@@ -79,11 +80,11 @@ void LRBCache::sample() {
   if (is_from_in == true) {
     uint32_t pos = rand_idx % n_in;
     auto &meta = in_cache_metas[pos];
-    meta.emplace_sample(current_seq);
+    meta.emplace_sample(current_seq, sample_pool);
   } else {
     uint32_t pos = rand_idx % n_out;
     auto &meta = out_cache_metas[pos];
-    meta.emplace_sample(current_seq);
+    meta.emplace_sample(current_seq, sample_pool);
   }
 }
 
@@ -139,9 +140,11 @@ bool LRBCache::lookup(const SimpleRequest &req) {
     assert((!list_idx) || (negative_candidate_queue->find(forget_timestamp) !=
                            negative_candidate_queue->end()));
     // re-request
-    if (!meta._sample_times.empty()) {
+    if (meta.has_sample()) {
       // mature
-      for (auto &sample_time : meta._sample_times) {
+      for (uint32_t i = meta._sample_head; i != null_idx;
+           i = sample_pool.nodes[i].next) {
+        uint32_t sample_time = sample_pool.nodes[i].sample_time;
         // don't use label within the first forget window because the data is
         // not static
         uint32_t future_distance = current_seq - sample_time;
@@ -155,21 +158,20 @@ bool LRBCache::lookup(const SimpleRequest &req) {
         train();
         training_data->clear();
       }
-      meta._sample_times.clear();
-      meta._sample_times.shrink_to_fit();
+      meta.clear_sample(sample_pool);
     }
 
     // make this update after update training, otherwise the last timestamp will
     // change
     meta.update(current_seq, n_extra_fields, max_hash_edc_idx, edc_windows,
-                hash_edc);
+                hash_edc, extra_pool);
     if (list_idx) {
       negative_candidate_queue->erase(forget_timestamp);
       negative_candidate_queue->insert({current_seq % memory_window, req.id});
       assert(negative_candidate_queue->find(current_seq % memory_window) !=
              negative_candidate_queue->end());
     } else {
-      auto *p = dynamic_cast<InCacheMeta *>(&meta);
+      auto *p = static_cast<InCacheMeta *>(&meta);
       p->p_last_request = in_cache_lru_queue.re_request(p->p_last_request);
     }
     // update negative_candidate_queue
@@ -202,11 +204,13 @@ void LRBCache::forget() {
     auto &meta = out_cache_metas[pos];
 
     // timeout mature
-    if (!meta._sample_times.empty()) {
+    if (meta.has_sample()) {
       // mature
       // todo: potential to overfill
       uint32_t future_distance = memory_window * 2;
-      for (auto &sample_time : meta._sample_times) {
+      for (uint32_t i = meta._sample_head; i != null_idx;
+           i = sample_pool.nodes[i].next) {
+        uint32_t sample_time = sample_pool.nodes[i].sample_time;
         // don't use label within the first forget window because the data is
         // not static
         training_data->emplace_back(meta, sample_time, future_distance,
@@ -219,8 +223,7 @@ void LRBCache::forget() {
         train();
         training_data->clear();
       }
-      meta._sample_times.clear();
-      meta._sample_times.shrink_to_fit();
+      meta.clear_sample(sample_pool);
     }
 
     assert(meta._key == forget_key);
@@ -267,10 +270,25 @@ void LRBCache::admit(const SimpleRequest &req) {
   }
 }
 
+bool LRBCache::next_pending_candidate(pair<uint64_t, uint32_t> &candidate) {
+  while (n_pending_candidate_used < pending_candidates.size()) {
+    auto &pending = pending_candidates[n_pending_candidate_used++];
+    // the position may have changed since rank, the past timestamp changes if
+    // the object is requested or evicted and admitted again
+    auto it = key_map.find(pending.first);
+    if (it == key_map.end() || it->second.list_idx) continue;
+    auto pos = it->second.list_pos;
+    if (in_cache_metas[pos]._past_timestamp != pending.second) continue;
+    candidate = {pending.first, pos};
+    return true;
+  }
+  return false;
+}
+
 pair<uint64_t, uint32_t> LRBCache::rank() {
   {
     // if not trained yet, or in_cache_lru past memory window, use LRU
-    auto &candidate_key = in_cache_lru_queue.dq.back();
+    auto candidate_key = in_cache_lru_queue.back();
     auto it = key_map.find(candidate_key);
     assert(it != key_map.end());
     auto pos = it->second.list_pos;
@@ -284,39 +302,43 @@ pair<uint64_t, uint32_t> LRBCache::rank() {
     }
   }
 
-  int32_t indptr[sample_rate + 1];
-  indptr[0] = 0;
-  int32_t indices[sample_rate * n_feature];
-  double data[sample_rate * n_feature];
-  int32_t past_timestamps[sample_rate];
-  uint64_t sizes[sample_rate];
+  pair<uint64_t, uint32_t> candidate;
+  if (next_pending_candidate(candidate)) return candidate;
 
-  unordered_set<uint64_t> key_set;
-  uint64_t keys[sample_rate];
-  uint32_t poses[sample_rate];
-  // next_past_timestamp, next_size = next_indptr - 1
+  uint32_t n_row = sample_rate * eviction_batch;
+  double *data = inference_data.data();
+  double *scores = inference_scores.data();
 
-  unsigned int idx_feature = 0;
-  unsigned int idx_row = 0;
+  // a position is not sampled twice unless the cache has too few objects
+  if (sample_mark.size() < in_cache_metas.size())
+    sample_mark.resize(in_cache_metas.size(), 0);
+  if (++rank_epoch == 0) {
+    fill(sample_mark.begin(), sample_mark.end(), 0);
+    rank_epoch = 1;
+  }
 
-  auto n_new_sample = sample_rate - idx_row;
-  int n_trials = 0;
-  while (idx_row != sample_rate) {
+  // the features not set are 0, which is how the sparse training data is read
+  fill(inference_data.begin(), inference_data.end(), 0);
+
+  unsigned int idx_row = 0;
+  uint32_t n_max_trial = 200 * eviction_batch;
+  uint32_t n_trials = 0;
+  while (idx_row != n_row) {
     n_trials++;
     uint32_t pos = _distribution(_generator) % in_cache_metas.size();
-    auto &meta = in_cache_metas[pos];
-    if (key_set.find(meta._key) != key_set.end() && n_trials < 200) {
+    if (sample_mark[pos] == rank_epoch && n_trials < n_max_trial) {
       continue;
     } else {
-      key_set.insert(meta._key);
+      sample_mark[pos] = rank_epoch;
     }
+    auto &meta = in_cache_metas[pos];
 
-    keys[idx_row] = meta._key;
-    poses[idx_row] = pos;
+    candidate_keys[idx_row] = meta._key;
+    candidate_poses[idx_row] = pos;
+    candidate_past_timestamps[idx_row] = meta._past_timestamp;
+    double *row = data + idx_row * n_feature;
     // fill in past_interval
-    indices[idx_feature] = 0;
-    data[idx_feature++] = current_seq - meta._past_timestamp;
-    past_timestamps[idx_row] = meta._past_timestamp;
+    row[0] = current_seq - meta._past_timestamp;
 
     uint8_t j = 0;
     uint32_t this_past_distance = 0;
@@ -330,57 +352,48 @@ pair<uint64_t, uint32_t> LRBCache::rank() {
         uint32_t &past_distance =
             meta._extra->_past_distances[past_distance_idx];
         this_past_distance += past_distance;
-        indices[idx_feature] = j + 1;
-        data[idx_feature++] = past_distance;
+        row[j + 1] = past_distance;
         if (this_past_distance < memory_window) {
           ++n_within;
         }
       }
     }
 
-    indices[idx_feature] = max_n_past_timestamps;
-    data[idx_feature++] = meta._size;
-    sizes[idx_row] = meta._size;
+    row[max_n_past_timestamps] = meta._size;
 
     for (uint k = 0; k < n_extra_fields; ++k) {
-      indices[idx_feature] = max_n_past_timestamps + k + 1;
-      data[idx_feature++] = meta._extra_features[k];
+      row[max_n_past_timestamps + k + 1] = meta._extra_features[k];
     }
 
-    indices[idx_feature] = max_n_past_timestamps + n_extra_fields + 1;
-    data[idx_feature++] = n_within;
+    row[max_n_past_timestamps + n_extra_fields + 1] = n_within;
 
     for (uint8_t k = 0; k < n_edc_feature; ++k) {
-      indices[idx_feature] = max_n_past_timestamps + n_extra_fields + 2 + k;
       uint32_t _distance_idx =
           min(uint32_t(current_seq - meta._past_timestamp) / edc_windows[k],
               max_hash_edc_idx);
+      double &feature = row[max_n_past_timestamps + n_extra_fields + 2 + k];
       if (meta._extra)
-        data[idx_feature++] = meta._extra->_edc[k] * hash_edc[_distance_idx];
+        feature = meta._extra->_edc[k] * hash_edc[_distance_idx];
       else
-        data[idx_feature++] = hash_edc[_distance_idx];
+        feature = hash_edc[_distance_idx];
     }
-    // remove future t
-    indptr[++idx_row] = idx_feature;
+    ++idx_row;
   }
 
   int64_t len;
-  double scores[sample_rate];
   system_clock::time_point timeBegin;
   // sample to measure inference time
   if (!(current_seq % 10000)) timeBegin = chrono::system_clock::now();
-  LGBM_BoosterPredictForCSR(
-      booster, static_cast<void *>(indptr), C_API_DTYPE_INT32, indices,
-      static_cast<void *>(data), C_API_DTYPE_FLOAT64, idx_row + 1, idx_feature,
-      n_feature,  // remove future t
-      C_API_PREDICT_NORMAL, 0, atoi(training_params["num_iterations"].c_str()),
-      map_to_string(inference_params).c_str(), &len, scores);
+  LGBM_BoosterPredictForMat(booster, static_cast<void *>(data),
+                            C_API_DTYPE_FLOAT64, n_row, n_feature, 1,
+                            C_API_PREDICT_NORMAL, 0, n_iteration,
+                            inference_params_str.c_str(), &len, scores);
   if (!(current_seq % 10000))
     inference_time = 0.95 * inference_time +
                      0.05 * chrono::duration_cast<chrono::microseconds>(
                                 chrono::system_clock::now() - timeBegin)
                                 .count();
-  for (int32_t i = sample_rate - n_new_sample; i < (int32_t)sample_rate; ++i) {
+  for (uint32_t i = 0; i < n_row; ++i) {
     // only monitor at the end of change interval
     if (scores[i] >= log1p(memory_window)) {
       ++obj_distribution[1];
@@ -390,18 +403,37 @@ pair<uint64_t, uint32_t> LRBCache::rank() {
   }
 
   if (objective == object_miss_ratio) {
-    for (uint i = 0; i < sample_rate; ++i) scores[i] *= sizes[i];
+    for (uint32_t i = 0; i < n_row; ++i)
+      scores[i] *= data[i * n_feature + max_n_past_timestamps];
   }
 
-  vector<int> index(sample_rate, 0);
-  for (size_t i = 0; i < index.size(); ++i) {
-    index[i] = i;
+  for (uint32_t i = 0; i < n_row; ++i) {
+    candidate_index[i] = i;
   }
 
-  sort(index.begin(), index.end(),
-       [&](const int &a, const int &b) { return (scores[a] > scores[b]); });
+  // sort all candidates instead of taking the max, so that the ties between
+  // equal scores are broken in the same way as the original LRB
+  sort(candidate_index.begin(), candidate_index.end(),
+       [&](const uint32_t &a, const uint32_t &b) {
+         return (scores[a] > scores[b]);
+       });
+  if (eviction_batch == 1) {
+    return {candidate_keys[candidate_index[0]],
+            candidate_poses[candidate_index[0]]};
+  }
+
+  // the first candidate is returned now, a candidate sampled twice when the
+  // cache is small is skipped by next_pending_candidate after its eviction
+  pending_candidates.clear();
+  n_pending_candidate_used = 1;
+  for (uint32_t i = 0; i < eviction_batch; ++i) {
+    uint32_t row = candidate_index[i];
+    pending_candidates.emplace_back(candidate_keys[row],
+                                    candidate_past_timestamps[row]);
+  }
 
-  return {keys[index[0]], poses[index[0]]};
+  uint32_t best = candidate_index[0];
+  return {candidate_keys[best], candidate_poses[best]};
 }
 
 void LRBCache::evict() {
@@ -418,11 +450,13 @@ void LRBCache::evict_with_candidate(pair<uint64_t, uint32_t> &epair) {
   auto &meta = in_cache_metas[old_pos];
   if (memory_window <= current_seq - meta._past_timestamp) {
     // must be the tail of lru
-    if (!meta._sample_times.empty()) {
+    if (meta.has_sample()) {
       // mature
       uint32_t future_distance =
           current_seq - meta._past_timestamp + memory_window;
-      for (auto &sample_time : meta._sample_times) {
+      for (uint32_t i = meta._sample_head; i != null_idx;
+           i = sample_pool.nodes[i].next) {
+        uint32_t sample_time = sample_pool.nodes[i].sample_time;
         // don't use label within the first forget window because the data is
         // not static
         training_data->emplace_back(meta, sample_time, future_distance,
@@ -435,14 +469,13 @@ void LRBCache::evict_with_candidate(pair<uint64_t, uint32_t> &epair) {
         train();
         training_data->clear();
       }
-      meta._sample_times.clear();
-      meta._sample_times.shrink_to_fit();
+      meta.clear_sample(sample_pool);
     }
 
-    in_cache_lru_queue.dq.erase(meta.p_last_request);
-    meta.p_last_request = in_cache_lru_queue.dq.end();
+    in_cache_lru_queue.erase(meta.p_last_request);
+    meta.p_last_request = in_cache_lru_queue.end();
     // above is suppose to be below, but to make sure the action is correct
-    meta.free();
+    meta.free(extra_pool, sample_pool);
     _currentSize -= meta._size;
     key_map.erase(key);
 
@@ -457,8 +490,8 @@ void LRBCache::evict_with_candidate(pair<uint64_t, uint32_t> &epair) {
     ++n_force_eviction;
   } else {
     // bring list 0 to list 1
-    in_cache_lru_queue.dq.erase(meta.p_last_request);
-    meta.p_last_request = in_cache_lru_queue.dq.end();
+    in_cache_lru_queue.erase(meta.p_last_request);
+    meta.p_last_request = in_cache_lru_queue.end();
     _currentSize -= meta._size;
     negative_candidate_queue->insert(
         {meta._past_timestamp % memory_window, meta._key});
@@ -480,7 +513,7 @@ void LRBCache::evict_with_candidate(pair<uint64_t, uint32_t> &epair) {
 void LRBCache::remove_from_outcache_metas(Meta &meta, unsigned int &pos,
                                           const uint64_t &key) {
   // free the actual content
-  meta.free();
+  meta.free(extra_pool, sample_pool);
   // TODO: can add a function to delete from a queue with (key, pos)
   // evict
   uint32_t tail_pos = out_cache_metas.size() - 1;
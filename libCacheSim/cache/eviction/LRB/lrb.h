@@ -10,7 +10,7 @@
 
 #include <cmath>
 #include <fstream>
-#include <list>
+#include <memory>
 #include <random>
 #include <sstream>
 #include <unordered_map>
@@ -35,19 +35,20 @@ static const uint8_t base_edc_window = 10;
 static const uint32_t batch_size = 131072;
 
 struct MetaExtra {
-  // vector overhead = 24 (8 pointer, 8 size, 8 allocation)
-  // 40 + 24 + 4*x + 1
-  // 65 byte at least
-  // 189 byte at most
+  // 40 + 4*31 + 1
+  // 165 byte
   // not 1 hit wonder
   float _edc[10];
-  vector<uint32_t> _past_distances;
+  uint32_t _past_distances[max_n_past_distances];
+  uint8_t _n_past_distance = 0;
   // the next index to put the distance
   uint8_t _past_distance_idx = 1;
 
-  MetaExtra(const uint32_t &distance, uint32_t max_hash_edc_idx,
+  void init(const uint32_t &distance, uint32_t max_hash_edc_idx,
             vector<uint32_t> &edc_windows, const vector<double> &hash_edc) {
-    _past_distances = vector<uint32_t>(1, distance);
+    _past_distances[0] = distance;
+    _n_past_distance = 1;
+    _past_distance_idx = 1;
     for (uint8_t i = 0; i < n_edc_feature; ++i) {
       uint32_t _distance_idx =
           min(uint32_t(distance / edc_windows[i]), max_hash_edc_idx);
@@ -58,11 +59,10 @@ struct MetaExtra {
   void update(const uint32_t &distance, uint32_t max_hash_edc_idx,
               vector<uint32_t> &edc_windows, const vector<double> &hash_edc) {
     uint8_t distance_idx = _past_distance_idx % max_n_past_distances;
-    if (_past_distances.size() < max_n_past_distances)
-      _past_distances.emplace_back(distance);
+    if (_n_past_distance < max_n_past_distances)
+      _past_distances[_n_past_distance++] = distance;
     else
       _past_distances[distance_idx] = distance;
-    assert(_past_distances.size() <= max_n_past_distances);
     _past_distance_idx = _past_distance_idx + (uint8_t)1;
     if (_past_distance_idx >= max_n_past_distances * 2)
       _past_distance_idx -= max_n_past_distances;
@@ -74,6 +74,65 @@ struct MetaExtra {
   }
 };
 
+// MetaExtra of all objects are allocated from chunks and recycled through a
+// free list, so an object that becomes a repeat object does not call new
+class MetaExtraPool {
+ public:
+  static const uint32_t chunk_size = 4096;
+
+  MetaExtra *alloc() {
+    if (free_list.empty()) {
+      chunks.emplace_back(new MetaExtra[chunk_size]);
+      MetaExtra *chunk = chunks.back().get();
+      free_list.reserve(free_list.size() + chunk_size);
+      for (uint32_t i = chunk_size; i > 0; --i) free_list.push_back(&chunk[i - 1]);
+    }
+    MetaExtra *extra = free_list.back();
+    free_list.pop_back();
+    return extra;
+  }
+
+  void release(MetaExtra *extra) { free_list.push_back(extra); }
+
+ private:
+  vector<unique_ptr<MetaExtra[]>> chunks;
+  vector<MetaExtra *> free_list;
+};
+
+static const uint32_t null_idx = UINT32_MAX;
+
+// the sample times of all objects are linked lists in one flat pool,
+// the nodes of the matured samples are reused by the next samples
+class SampleTimePool {
+ public:
+  struct Node {
+    uint32_t sample_time;
+    uint32_t next;
+  };
+  vector<Node> nodes;
+
+  uint32_t alloc(uint32_t sample_time) {
+    uint32_t idx;
+    if (free_head != null_idx) {
+      idx = free_head;
+      free_head = nodes[idx].next;
+    } else {
+      idx = nodes.size();
+      nodes.emplace_back();
+    }
+    nodes[idx] = {sample_time, null_idx};
+    return idx;
+  }
+
+  void release(uint32_t head, uint32_t tail) {
+    nodes[tail].next = free_head;
+    free_head = head;
+  }
+
+ private:
+  uint32_t free_head = null_idx;
+};
+
 class Meta {
  public:
   // 25 byte
@@ -82,7 +141,9 @@ class Meta {
   uint32_t _past_timestamp;
   uint16_t _extra_features[max_n_extra_feature];
   MetaExtra *_extra = nullptr;
-  vector<uint32_t> _sample_times;
+  // the samples in the SampleTimePool, in sampling order
+  uint32_t _sample_head = null_idx;
+  uint32_t _sample_tail = null_idx;
 
   Meta(const uint64_t &key, const uint64_t &size,
        const uint64_t &past_timestamp, const vector<uint16_t> &extra_features) {
@@ -95,21 +156,38 @@ class Meta {
 
   virtual ~Meta() = default;
 
-  void emplace_sample(uint32_t &sample_t) {
-    _sample_times.emplace_back(sample_t);
+  bool has_sample() const { return _sample_head != null_idx; }
+
+  void emplace_sample(uint32_t &sample_t, SampleTimePool &sample_pool) {
+    uint32_t idx = sample_pool.alloc(sample_t);
+    if (_sample_tail == null_idx)
+      _sample_head = idx;
+    else
+      sample_pool.nodes[_sample_tail].next = idx;
+    _sample_tail = idx;
+  }
+
+  void clear_sample(SampleTimePool &sample_pool) {
+    if (_sample_head == null_idx) return;
+    sample_pool.release(_sample_head, _sample_tail);
+    _sample_head = _sample_tail = null_idx;
   }
 
-  void free() { delete _extra; }
+  void free(MetaExtraPool &extra_pool, SampleTimePool &sample_pool) {
+    if (_extra) extra_pool.release(_extra);
+    _extra = nullptr;
+    clear_sample(sample_pool);
+  }
 
   void update(const uint32_t &past_timestamp, uint32_t n_extra_fields_params,
               uint32_t max_hash_edc_idx, vector<uint32_t> &edc_windows,
-              const vector<double> &hash_edc) {
+              const vector<double> &hash_edc, MetaExtraPool &extra_pool) {
     // distance
     uint32_t _distance = past_timestamp - _past_timestamp;
     assert(_distance);
     if (!_extra) {
-      _extra =
-          new MetaExtra(_distance, max_hash_edc_idx, edc_windows, hash_edc);
+      _extra = extra_pool.alloc();
+      _extra->init(_distance, max_hash_edc_idx, edc_windows, hash_edc);
     } else
       _extra->update(_distance, max_hash_edc_idx, edc_windows, hash_edc);
     // timestamp
@@ -118,54 +196,108 @@ class Meta {
 
   int feature_overhead() {
     int ret = sizeof(Meta);
-    if (_extra)
-      ret += sizeof(MetaExtra) - sizeof(_sample_times) +
-             _extra->_past_distances.capacity() * sizeof(uint32_t);
+    if (_extra) ret += sizeof(MetaExtra);
     return ret;
   }
 
-  int sample_overhead() {
-    return sizeof(_sample_times) + sizeof(uint32_t) * _sample_times.capacity();
+  int sample_overhead(const SampleTimePool &sample_pool) {
+    int ret = sizeof(_sample_head) + sizeof(_sample_tail);
+    for (uint32_t i = _sample_head; i != null_idx;
+         i = sample_pool.nodes[i].next)
+      ret += sizeof(SampleTimePool::Node);
+    return ret;
   }
 };
 
 class InCacheMeta : public Meta {
  public:
-  // pointer to lru0
-  list<int64_t>::const_iterator p_last_request;
+  // the node in in_cache_lru_queue
+  uint32_t p_last_request;
   // any change to functions?
 
   InCacheMeta(const uint64_t &key, const uint64_t &size,
               const uint64_t &past_timestamp,
-              const vector<uint16_t> &extra_features,
-              const list<int64_t>::const_iterator &it)
+              const vector<uint16_t> &extra_features, const uint32_t &it)
       : Meta(key, size, past_timestamp, extra_features) {
     p_last_request = it;
   };
 
-  InCacheMeta(const Meta &meta, const list<int64_t>::const_iterator &it)
-      : Meta(meta) {
+  InCacheMeta(const Meta &meta, const uint32_t &it) : Meta(meta) {
     p_last_request = it;
   };
 };
 
+// a doubly linked list over a flat node pool, a node index stays valid until
+// the node is erased, and the erased nodes are reused
 class InCacheLRUQueue {
  public:
-  list<int64_t> dq;
+  struct Node {
+    int64_t key;
+    uint32_t prev;
+    uint32_t next;
+  };
+  vector<Node> nodes;
 
   // the hashtable (location information is maintained outside, and assume it is
   // always correct)
-  list<int64_t>::const_iterator request(int64_t key) {
-    dq.emplace_front(key);
-    return dq.cbegin();
+  uint32_t request(int64_t key) {
+    uint32_t idx;
+    if (free_head != null_idx) {
+      idx = free_head;
+      free_head = nodes[idx].next;
+    } else {
+      idx = nodes.size();
+      nodes.emplace_back();
+    }
+    nodes[idx].key = key;
+    link_front(idx);
+    return idx;
   }
 
-  list<int64_t>::const_iterator re_request(list<int64_t>::const_iterator it) {
-    if (it != dq.cbegin()) {
-      dq.emplace_front(*it);
-      dq.erase(it);
+  uint32_t re_request(uint32_t it) {
+    if (it != head) {
+      unlink(it);
+      link_front(it);
     }
-    return dq.cbegin();
+    return it;
+  }
+
+  void erase(uint32_t it) {
+    unlink(it);
+    nodes[it].next = free_head;
+    free_head = it;
+  }
+
+  // the least recently requested key
+  int64_t back() const { return nodes[tail].key; }
+
+  uint32_t end() const { return null_idx; }
+
+ private:
+  uint32_t head = null_idx;
+  uint32_t tail = null_idx;
+  uint32_t free_head = null_idx;
+
+  void link_front(uint32_t idx) {
+    nodes[idx].prev = null_idx;
+    nodes[idx].next = head;
+    if (head != null_idx)
+      nodes[head].prev = idx;
+    else
+      tail = idx;
+    head = idx;
+  }
+
+  void unlink(uint32_t idx) {
+    Node &node = nodes[idx];
+    if (node.prev != null_idx)
+      nodes[node.prev].next = node.next;
+    else
+      head = node.next;
+    if (node.next != null_idx)
+      nodes[node.next].prev = node.prev;
+    else
+      tail = node.prev;
   }
 };
 
@@ -285,10 +417,31 @@ class LRBCache : public Cache {
   InCacheLRUQueue in_cache_lru_queue;
   shared_ptr<sparse_hash_map<uint64_t, uint64_t>> negative_candidate_queue;
   TrainingData *training_data;
+  MetaExtraPool extra_pool;
+  SampleTimePool sample_pool;
 
   // sample_size: use n_memorize keys + random choose (sample_rate - n_memorize)
   // keys
   uint sample_rate = 64;
+  // rank scores sample_rate * eviction_batch candidates in one prediction,
+  // and the best eviction_batch candidates are evicted by the next evictions
+  // unless they are requested before eviction
+  uint eviction_batch = 1;
+
+  // preallocated buffers of rank, the features are a dense row major matrix
+  vector<double> inference_data;
+  vector<double> inference_scores;
+  vector<uint64_t> candidate_keys;
+  vector<uint32_t> candidate_poses;
+  vector<uint32_t> candidate_past_timestamps;
+  vector<uint32_t> candidate_index;
+  // the pending candidates of the last rank, best first
+  vector<pair<uint64_t, uint32_t>> pending_candidates;
+  uint32_t n_pending_candidate_used = 0;
+  // in_cache_metas positions sampled in the current rank, marked by rank_epoch
+  vector<uint32_t> sample_mark;
+  uint32_t rank_epoch = 0;
+  vector<double> training_scores;
 
   double training_loss = 0;
   int32_t n_force_eviction = 0;
@@ -309,6 +462,9 @@ class LRBCache : public Cache {
   };
 
   unordered_map<string, string> inference_params;
+  // built once because LightGBM parses the parameter string on each call
+  string inference_params_str;
+  int n_iteration;
 
   enum ObjectiveT : uint8_t { byte_miss_ratio = 0, object_miss_ratio = 1 };
   ObjectiveT objective = object_miss_ratio;
@@ -342,6 +498,14 @@ class LRBCache : public Cache {
         training_params["learning_rate"] = it.second;
       } else if (it.first == "num_threads") {
         training_params["num_threads"] = it.second;
+      } else if (it.first == "inference_threads") {
+        inference_params["num_threads"] = it.second;
+      } else if (it.first == "eviction_batch") {
+        eviction_batch = stoul(it.second);
+        if (eviction_batch == 0) {
+          cerr << "error: eviction_batch must be positive" << endl;
+          abort();
+        }
       } else if (it.first == "num_leaves") {
         training_params["num_leaves"] = it.second;
       } else if (it.first == "byte_million_req") {
@@ -392,8 +556,20 @@ class LRBCache : public Cache {
       }
       training_params["categorical_feature"] = categorical_feature;
     }
-    inference_params = training_params;
+    for (auto &it : training_params) inference_params.insert(it);
+    inference_params_str = map_to_string(inference_params);
+    n_iteration = stoi(training_params["num_iterations"]);
     training_data = new TrainingData(n_feature, memory_window);
+
+    uint32_t n_row = sample_rate * eviction_batch;
+    inference_data.resize(n_row * n_feature);
+    inference_scores.resize(n_row);
+    candidate_keys.resize(n_row);
+    candidate_poses.resize(n_row);
+    candidate_past_timestamps.resize(n_row);
+    candidate_index.resize(n_row);
+    pending_candidates.reserve(eviction_batch);
+    training_scores.reserve(batch_size);
   }
 
   string map_to_string(unordered_map<string, string> &map) {
@@ -418,6 +594,10 @@ class LRBCache : public Cache {
   // sample, rank the 1st and return
   pair<uint64_t, uint32_t> rank();
 
+  // the next pending candidate that has not been requested since it was
+  // ranked, return false if there is none
+  bool next_pending_candidate(pair<uint64_t, uint32_t> &candidate);
+
   void train();
 
   void sample();
@@ -445,14 +625,14 @@ class LRBCache : public Cache {
       if (nullptr == meta._extra) {
         ++distribution[0];
       } else {
-        ++distribution[meta._extra->_past_distances.size()];
+        ++distribution[meta._extra->_n_past_distance];
       }
     }
     for (auto &meta : out_cache_metas) {
       if (nullptr == meta._extra) {
         ++distribution[0];
       } else {
-        ++distribution[meta._extra->_past_distances.size()];
+        ++distribution[meta._extra->_n_past_distance];
       }
     }
     return distribution;
@@ -33,6 +33,8 @@ static cache_obj_t *LRU_to_evict(cache_t *cache, const request_t *req);
 static void LRU_evict(cache_t *cache, const request_t *req);
 static bool LRU_remove(cache_t *cache, const obj_id_t obj_id);
 static void LRU_print_cache(const cache_t *cache);
+static bool LRU_save_state(const cache_t *cache, FILE *f);
+static bool LRU_load_state(cache_t *cache, FILE *f);
 
 // ***********************************************************************
 // ****                                                               ****
@@ -62,6 +64,9 @@ cache_t *LRU_init(const common_cache_params_t ccache_params,
   cache->can_insert = cache_can_insert_default;
   cache->get_n_obj = cache_get_n_obj_default;
   cache->print_cache = LRU_print_cache;
+  cache->save_state = LRU_save_state;
+  cache->load_state = LRU_load_state;
+  cache->checkpoint_algo = __func__;
 
   if (ccache_params.consider_obj_metadata) {
     cache->obj_md_size = 8 * 2;
@@ -265,6 +270,28 @@ static bool LRU_remove(cache_t *cache, const obj_id_t obj_id) {
   return true;
 }
 
+// ***********************************************************************
+// ****                                                               ****
+// ****                     checkpoint functions                      ****
+// ****                                                               ****
+// ***********************************************************************
+/**
+ * @brief save the LRU queue from the most recent to the least recent
+ *
+ * @param cache
+ * @param f
+ * @return whether the state is written
+ */
+static bool LRU_save_state(const cache_t *cache, FILE *f) {
+  LRU_params_t *params = (LRU_params_t *)cache->eviction_params;
+  return cache_save_obj_queue(params->q_head, f);
+}
+
+static bool LRU_load_state(cache_t *cache, FILE *f) {
+  LRU_params_t *params = (LRU_params_t *)cache->eviction_params;
+  return cache_load_obj_queue(cache, f, &params->q_head, &params->q_tail);
+}
+
 static void LRU_print_cache(const cache_t *cache) {
   LRU_params_t *params = (LRU_params_t *)cache->eviction_params;
   cache_obj_t *cur = params->q_head;
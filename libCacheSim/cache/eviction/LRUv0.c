@@ -118,8 +118,10 @@ static bool LRUv0_get(cache_t *cache, const request_t *req) {
   if (req->obj_size <= cache->cache_size) {
     if (!cache_hit) LRUv0_insert(cache, req);
 
-    while (cache->occupied_byte > cache->cache_size)
+    while (cache->occupied_byte > cache->cache_size) {
       LRUv0_evict(cache, req);
+      cache->n_evict += 1;
+    }
   } else {
     WARN("req %lld: obj size %ld larger than cache size %ld\n",
          (long long)req->obj_id, (long)req->obj_size, (long)cache->cache_size);
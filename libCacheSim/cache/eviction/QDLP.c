@@ -36,6 +36,9 @@ typedef struct {
   double fifo_size_ratio;
   double ghost_size_ratio;
   char main_cache_type[32];
+  /* the FIFOs and the FIFO, Clock or Sieve main cache use ring queues
+   * (queue=ring) */
+  bool use_ring_queue;
 
   request_t *req_local;
 } QDLP_params_t;
@@ -61,6 +64,8 @@ static bool QDLP_remove(cache_t *cache, const obj_id_t obj_id);
 static inline int64_t QDLP_get_occupied_byte(const cache_t *cache);
 static inline int64_t QDLP_get_n_obj(const cache_t *cache);
 static inline bool QDLP_can_insert(cache_t *cache, const request_t *req);
+static void QDLP_foreach_obj(cache_t *cache, cache_obj_iter_func_ptr iter_func,
+                             void *user_data);
 static void QDLP_parse_params(cache_t *cache,
                                 const char *cache_specific_params);
 
@@ -85,6 +90,7 @@ cache_t *QDLP_init(const common_cache_params_t ccache_params,
   cache->get_n_obj = QDLP_get_n_obj;
   cache->get_occupied_byte = QDLP_get_occupied_byte;
   cache->can_insert = QDLP_can_insert;
+  cache->foreach_obj = QDLP_foreach_obj;
 
   cache->obj_md_size = 0;
 
@@ -105,13 +111,14 @@ cache_t *QDLP_init(const common_cache_params_t ccache_params,
   int64_t fifo_ghost_cache_size =
       (int64_t)(ccache_params.cache_size * params->ghost_size_ratio);
 
+  const char *queue_params = params->use_ring_queue ? "queue=ring" : NULL;
   common_cache_params_t ccache_params_local = ccache_params;
   ccache_params_local.cache_size = fifo_cache_size;
-  params->fifo = FIFO_init(ccache_params_local, NULL);
+  params->fifo = FIFO_init(ccache_params_local, queue_params);
 
   if (fifo_ghost_cache_size > 0) {
     ccache_params_local.cache_size = fifo_ghost_cache_size;
-    params->fifo_ghost = FIFO_init(ccache_params_local, NULL);
+    params->fifo_ghost = FIFO_init(ccache_params_local, queue_params);
     snprintf(params->fifo_ghost->cache_name, CACHE_NAME_ARRAY_LEN,
              "FIFO-ghost");
   } else {
@@ -124,13 +131,17 @@ cache_t *QDLP_init(const common_cache_params_t ccache_params,
   } else if (strcasecmp(params->main_cache_type, "LHD") == 0) {
     params->main_cache = LHD_init(ccache_params_local, NULL);
   } else if (strcasecmp(params->main_cache_type, "clock") == 0) {
-    params->main_cache = Clock_init(ccache_params_local, NULL);
+    params->main_cache = Clock_init(ccache_params_local, queue_params);
   } else if (strcasecmp(params->main_cache_type, "sieve") == 0) {
-    params->main_cache = Sieve_init(ccache_params_local, NULL);
+    params->main_cache = Sieve_init(ccache_params_local, queue_params);
   } else if (strcasecmp(params->main_cache_type, "clock2") == 0) {
-    params->main_cache = Clock_init(ccache_params_local, "n-bit-counter=2");
+    params->main_cache = Clock_init(
+        ccache_params_local,
+        params->use_ring_queue ? "n-bit-counter=2,queue=ring" : "n-bit-counter=2");
   } else if (strcasecmp(params->main_cache_type, "clock3") == 0) {
-    params->main_cache = Clock_init(ccache_params_local, "n-bit-counter=3");
+    params->main_cache = Clock_init(
+        ccache_params_local,
+        params->use_ring_queue ? "n-bit-counter=3,queue=ring" : "n-bit-counter=3");
   } else if (strcasecmp(params->main_cache_type, "LRU") == 0) {
     params->main_cache = LRU_init(ccache_params_local, NULL);
   } else if (strcasecmp(params->main_cache_type, "LeCaR") == 0) {
@@ -140,7 +151,7 @@ cache_t *QDLP_init(const common_cache_params_t ccache_params,
   } else if (strcasecmp(params->main_cache_type, "twoQ") == 0) {
     params->main_cache = TwoQ_init(ccache_params_local, NULL);
   } else if (strcasecmp(params->main_cache_type, "FIFO") == 0) {
-    params->main_cache = FIFO_init(ccache_params_local, NULL);
+    params->main_cache = FIFO_init(ccache_params_local, queue_params);
   } else if (strcasecmp(params->main_cache_type, "SLRU") == 0) {
     params->main_cache = SLRU_init(ccache_params_local, NULL);
   } else if (strcasecmp(params->main_cache_type, "LIRS") == 0) {
@@ -360,6 +371,13 @@ static void QDLP_evict(cache_t *cache, const request_t *req) {
     params->n_byte_move_to_main += obj->obj_size;
 
     params->main_cache->get(params->main_cache, params->req_local);
+#ifdef SUPPORT_TTL
+    /* the object keeps its expiration time when it moves */
+    cache_obj_t *main_obj = main->find(main, params->req_local, false);
+    if (main_obj != NULL) {
+      main_obj->exp_time = obj->exp_time;
+    }
+#endif
 #if defined(TRACK_EVICTION_V_AGE)
     main->find(main, params->req_local, false)->create_time = obj->create_time;
   } else {
@@ -414,6 +432,17 @@ static inline int64_t QDLP_get_n_obj(const cache_t *cache) {
          params->main_cache->get_n_obj(params->main_cache);
 }
 
+/**
+ * @brief iterate over the objects in the FIFO and the main cache, the ghost
+ * entries are not objects in the cache
+ */
+static void QDLP_foreach_obj(cache_t *cache, cache_obj_iter_func_ptr iter_func,
+                             void *user_data) {
+  QDLP_params_t *params = (QDLP_params_t *)cache->eviction_params;
+  cache_foreach_obj(params->fifo, iter_func, user_data);
+  cache_foreach_obj(params->main_cache, iter_func, user_data);
+}
+
 static inline bool QDLP_can_insert(cache_t *cache, const request_t *req) {
   QDLP_params_t *params = (QDLP_params_t *)cache->eviction_params;
 
@@ -458,6 +487,12 @@ static void QDLP_parse_params(cache_t *cache,
       params->move_to_main_threshold = atoi(value);
     } else if (strcasecmp(key, "main-cache") == 0) {
       strncpy(params->main_cache_type, value, 30);
+    } else if (strcasecmp(key, "queue") == 0) {
+      if (strcasecmp(value, "ring") != 0 && strcasecmp(value, "list") != 0) {
+        ERROR("QDLP queue can be list or ring, but got %s\n", value);
+        exit(1);
+      }
+      params->use_ring_queue = strcasecmp(value, "ring") == 0;
     } else if (strcasecmp(key, "print") == 0) {
       printf("parameters: %s\n", QDLP_current_params(params));
       exit(0);
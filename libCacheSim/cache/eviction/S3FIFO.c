@@ -33,20 +33,6 @@
 extern "C" {
 #endif
 
-typedef struct {
-  cache_t *small_fifo;
-  cache_t *ghost_fifo;
-  cache_t *main_fifo;
-  bool hit_on_ghost;
-
-  int move_to_main_threshold;
-  double small_size_ratio;
-  double ghost_size_ratio;
-
-  bool has_evicted;
-  request_t *req_local;
-} S3FIFO_params_t;
-
 static const char *DEFAULT_CACHE_PARAMS = "small-size-ratio=0.10,ghost-size-ratio=0.90,move-to-main-threshold=2";
 
 // ***********************************************************************
@@ -62,6 +48,9 @@ static cache_obj_t *S3FIFO_insert(cache_t *cache, const request_t *req);
 static cache_obj_t *S3FIFO_to_evict(cache_t *cache, const request_t *req);
 static void S3FIFO_evict(cache_t *cache, const request_t *req);
 static bool S3FIFO_remove(cache_t *cache, const obj_id_t obj_id);
+static bool S3FIFO_save_state(const cache_t *cache, FILE *f);
+static bool S3FIFO_load_state(cache_t *cache, FILE *f);
+static void S3FIFO_foreach_obj(cache_t *cache, cache_obj_iter_func_ptr iter_func, void *user_data);
 static inline int64_t S3FIFO_get_occupied_byte(const cache_t *cache);
 static inline int64_t S3FIFO_get_n_obj(const cache_t *cache);
 static inline bool S3FIFO_can_insert(cache_t *cache, const request_t *req);
@@ -89,6 +78,10 @@ cache_t *S3FIFO_init(const common_cache_params_t ccache_params, const char *cach
   cache->get_n_obj = S3FIFO_get_n_obj;
   cache->get_occupied_byte = S3FIFO_get_occupied_byte;
   cache->can_insert = S3FIFO_can_insert;
+  cache->save_state = S3FIFO_save_state;
+  cache->load_state = S3FIFO_load_state;
+  cache->foreach_obj = S3FIFO_foreach_obj;
+  cache->checkpoint_algo = __func__;
 
   cache->obj_md_size = 0;
 
@@ -107,21 +100,22 @@ cache_t *S3FIFO_init(const common_cache_params_t ccache_params, const char *cach
   int64_t main_fifo_size = ccache_params.cache_size - small_fifo_size;
   int64_t ghost_fifo_size = (int64_t)(ccache_params.cache_size * params->ghost_size_ratio);
 
+  const char *fifo_params = params->use_ring_queue ? "queue=ring" : NULL;
   common_cache_params_t ccache_params_local = ccache_params;
   ccache_params_local.cache_size = small_fifo_size;
-  params->small_fifo = FIFO_init(ccache_params_local, NULL);
+  params->small_fifo = FIFO_init(ccache_params_local, fifo_params);
   params->has_evicted = false;
 
   if (ghost_fifo_size > 0) {
     ccache_params_local.cache_size = ghost_fifo_size;
-    params->ghost_fifo = FIFO_init(ccache_params_local, NULL);
+    params->ghost_fifo = FIFO_init(ccache_params_local, fifo_params);
     snprintf(params->ghost_fifo->cache_name, CACHE_NAME_ARRAY_LEN, "FIFO-ghost");
   } else {
     params->ghost_fifo = NULL;
   }
 
   ccache_params_local.cache_size = main_fifo_size;
-  params->main_fifo = FIFO_init(ccache_params_local, NULL);
+  params->main_fifo = FIFO_init(ccache_params_local, fifo_params);
 
   snprintf(cache->cache_name, CACHE_NAME_ARRAY_LEN, "S3FIFO-%.4lf-%d", params->small_size_ratio,
            params->move_to_main_threshold);
@@ -297,7 +291,12 @@ static void S3FIFO_evict_small(cache_t *cache, const request_t *req) {
     copy_cache_obj_to_request(params->req_local, obj_to_evict);
 
     if (obj_to_evict->S3FIFO.freq >= params->move_to_main_threshold) {
+#ifdef SUPPORT_TTL
+      /* the object keeps its expiration time when it moves */
+      main->insert(main, params->req_local)->exp_time = obj_to_evict->exp_time;
+#else
       main->insert(main, params->req_local);
+#endif
     } else {
       // insert to ghost
       if (ghost != NULL) {
@@ -321,6 +320,9 @@ static void S3FIFO_evict_main(cache_t *cache, const request_t *req) {
     cache_obj_t *obj_to_evict = main->to_evict(main, req);
     DEBUG_ASSERT(obj_to_evict != NULL);
     int freq = obj_to_evict->S3FIFO.freq;
+#ifdef SUPPORT_TTL
+    uint32_t exp_time = obj_to_evict->exp_time;
+#endif
     copy_cache_obj_to_request(params->req_local, obj_to_evict);
     if (freq >= 1) {
       // we need to evict first because the object to insert has the same obj_id
@@ -330,6 +332,9 @@ static void S3FIFO_evict_main(cache_t *cache, const request_t *req) {
       cache_obj_t *new_obj = main->insert(main, params->req_local);
       // clock with 2-bit counter
       new_obj->S3FIFO.freq = MIN(freq, 3) - 1;
+#ifdef SUPPORT_TTL
+      new_obj->exp_time = exp_time;
+#endif
 
     } else {
       bool removed = main->remove(main, obj_to_evict->obj_id);
@@ -403,6 +408,62 @@ static inline bool S3FIFO_can_insert(cache_t *cache, const request_t *req) {
   return req->obj_size <= params->small_fifo->cache_size && cache_can_insert_default(cache, req);
 }
 
+// ***********************************************************************
+// ****                                                               ****
+// ****                     checkpoint functions                      ****
+// ****                                                               ****
+// ***********************************************************************
+/**
+ * @brief save the small, ghost and main FIFO as sub-caches, the checkpoint
+ * can be loaded into an S3FIFO with a different move-to-main threshold, but
+ * the size of each queue must be the same
+ *
+ * @param cache
+ * @param f
+ * @return whether the state is written
+ */
+static bool S3FIFO_save_state(const cache_t *cache, FILE *f) {
+  S3FIFO_params_t *params = (S3FIFO_params_t *)cache->eviction_params;
+  int64_t queue_sizes[3] = {params->small_fifo->cache_size,
+                            params->ghost_fifo == NULL ? 0 : params->ghost_fifo->cache_size,
+                            params->main_fifo->cache_size};
+
+  return fwrite(queue_sizes, sizeof(queue_sizes), 1, f) == 1 &&
+         fwrite(&params->hit_on_ghost, sizeof(bool), 1, f) == 1 &&
+         fwrite(&params->has_evicted, sizeof(bool), 1, f) == 1 && cache_save_state(params->small_fifo, f) &&
+         (params->ghost_fifo == NULL || cache_save_state(params->ghost_fifo, f)) &&
+         cache_save_state(params->main_fifo, f);
+}
+
+static bool S3FIFO_load_state(cache_t *cache, FILE *f) {
+  S3FIFO_params_t *params = (S3FIFO_params_t *)cache->eviction_params;
+  int64_t queue_sizes[3];
+  if (fread(queue_sizes, sizeof(queue_sizes), 1, f) != 1) return false;
+
+  if (queue_sizes[0] != params->small_fifo->cache_size ||
+      queue_sizes[1] != (params->ghost_fifo == NULL ? 0 : params->ghost_fifo->cache_size) ||
+      queue_sizes[2] != params->main_fifo->cache_size) {
+    WARN("checkpoint uses queue sizes %ld/%ld/%ld, which are different from %s\n", (long)queue_sizes[0],
+          (long)queue_sizes[1], (long)queue_sizes[2], cache->cache_name);
+    return false;
+  }
+
+  return fread(&params->hit_on_ghost, sizeof(bool), 1, f) == 1 &&
+         fread(&params->has_evicted, sizeof(bool), 1, f) == 1 && cache_load_state(params->small_fifo, f) &&
+         (params->ghost_fifo == NULL || cache_load_state(params->ghost_fifo, f)) &&
+         cache_load_state(params->main_fifo, f);
+}
+
+/**
+ * @brief iterate over the objects in the small and main FIFO, the ghost
+ * entries are not objects in the cache
+ */
+static void S3FIFO_foreach_obj(cache_t *cache, cache_obj_iter_func_ptr iter_func, void *user_data) {
+  S3FIFO_params_t *params = (S3FIFO_params_t *)cache->eviction_params;
+  cache_foreach_obj(params->small_fifo, iter_func, user_data);
+  cache_foreach_obj(params->main_fifo, iter_func, user_data);
+}
+
 // ***********************************************************************
 // ****                                                               ****
 // ****                parameter set up functions                     ****
@@ -410,8 +471,9 @@ static inline bool S3FIFO_can_insert(cache_t *cache, const request_t *req) {
 // ***********************************************************************
 static const char *S3FIFO_current_params(S3FIFO_params_t *params) {
   static __thread char params_str[128];
-  snprintf(params_str, 128, "small-size-ratio=%.4lf,ghost-size-ratio=%.4lf,move-to-main-threshold=%d\n",
-           params->small_size_ratio, params->ghost_size_ratio, params->move_to_main_threshold);
+  snprintf(params_str, 128, "small-size-ratio=%.4lf,ghost-size-ratio=%.4lf,move-to-main-threshold=%d,queue=%s\n",
+           params->small_size_ratio, params->ghost_size_ratio, params->move_to_main_threshold,
+           params->use_ring_queue ? "ring" : "list");
   return params_str;
 }
 
@@ -438,6 +500,12 @@ static void S3FIFO_parse_params(cache_t *cache, const char *cache_specific_param
       params->ghost_size_ratio = strtod(value, NULL);
     } else if (strcasecmp(key, "move-to-main-threshold") == 0) {
       params->move_to_main_threshold = atoi(value);
+    } else if (strcasecmp(key, "queue") == 0) {
+      if (strcasecmp(value, "ring") != 0 && strcasecmp(value, "list") != 0) {
+        ERROR("S3FIFO queue can be list or ring, but got %s\n", value);
+        exit(1);
+      }
+      params->use_ring_queue = strcasecmp(value, "ring") == 0;
     } else if (strcasecmp(key, "print") == 0) {
       printf("parameters: %s\n", S3FIFO_current_params(params));
       exit(0);
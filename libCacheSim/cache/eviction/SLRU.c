@@ -19,15 +19,6 @@ extern "C" {
 #define DEBUG_MODE
 #undef DEBUG_MODE
 
-typedef struct SLRU_params {
-  cache_obj_t **lru_heads;
-  cache_obj_t **lru_tails;
-  int64_t *lru_n_bytes;
-  int64_t *lru_n_objs;
-  int64_t *lru_max_n_bytes;
-  int n_seg;
-} SLRU_params_t;
-
 // ***********************************************************************
 // ****                                                               ****
 // ****                   function declarations                       ****
@@ -42,6 +33,8 @@ static cache_obj_t *SLRU_insert(cache_t *cache, const request_t *req);
 static cache_obj_t *SLRU_to_evict(cache_t *cache, const request_t *req);
 static void SLRU_evict(cache_t *cache, const request_t *req);
 static bool SLRU_remove(cache_t *cache, const obj_id_t obj_id);
+static bool SLRU_save_state(const cache_t *cache, FILE *f);
+static bool SLRU_load_state(cache_t *cache, FILE *f);
 
 /* internal function */
 static void SLRU_promote_to_next_seg(cache_t *cache, const request_t *req,
@@ -113,6 +106,9 @@ cache_t *SLRU_init(const common_cache_params_t ccache_params,
   cache->remove = SLRU_remove;
   cache->to_evict = SLRU_to_evict;
   cache->can_insert = SLRU_can_insert;
+  cache->save_state = SLRU_save_state;
+  cache->load_state = SLRU_load_state;
+  cache->checkpoint_algo = __func__;
 
   if (ccache_params.consider_obj_metadata) {
     cache->obj_md_size = 8 * 2;
@@ -396,6 +392,56 @@ static bool SLRU_remove(cache_t *cache, const obj_id_t obj_id) {
   return true;
 }
 
+// ***********************************************************************
+// ****                                                               ****
+// ****                     checkpoint functions                      ****
+// ****                                                               ****
+// ***********************************************************************
+/**
+ * @brief save each segment from the lowest to the highest, the segment
+ * sizes can be different when loading, but the number of segments must be
+ * the same
+ *
+ * @param cache
+ * @param f
+ * @return whether the state is written
+ */
+static bool SLRU_save_state(const cache_t *cache, FILE *f) {
+  SLRU_params_t *params = (SLRU_params_t *)cache->eviction_params;
+  int32_t n_seg = params->n_seg;
+  if (fwrite(&n_seg, sizeof(n_seg), 1, f) != 1) return false;
+
+  for (int i = 0; i < params->n_seg; i++) {
+    if (fwrite(&params->lru_n_bytes[i], sizeof(int64_t), 1, f) != 1 ||
+        fwrite(&params->lru_n_objs[i], sizeof(int64_t), 1, f) != 1 ||
+        !cache_save_obj_queue(params->lru_heads[i], f)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+static bool SLRU_load_state(cache_t *cache, FILE *f) {
+  SLRU_params_t *params = (SLRU_params_t *)cache->eviction_params;
+  int32_t n_seg;
+  if (fread(&n_seg, sizeof(n_seg), 1, f) != 1) return false;
+  if (n_seg != params->n_seg) {
+    WARN("checkpoint has %d segments, but %s has %d segments\n", (int)n_seg,
+          cache->cache_name, params->n_seg);
+    return false;
+  }
+
+  for (int i = 0; i < params->n_seg; i++) {
+    if (fread(&params->lru_n_bytes[i], sizeof(int64_t), 1, f) != 1 ||
+        fread(&params->lru_n_objs[i], sizeof(int64_t), 1, f) != 1 ||
+        !cache_load_obj_queue(cache, f, &params->lru_heads[i],
+                              &params->lru_tails[i])) {
+      return false;
+    }
+  }
+  return true;
+}
+
 // ***********************************************************************
 // ****                                                               ****
 // ****                  parameter set up functions                   ****
@@ -0,0 +1,449 @@
+//
+//  Sharded cache, partition the objects into n shards by hashing the object
+//  id, each shard is an independent cache of cache_size / n_shard bytes,
+//  which is how many production caches are built
+//
+//  the cache can be used as any other cache, where get runs the shard
+//  serially, and it can be simulated in parallel using Sharded_submit, which
+//  sends the request to the worker thread of the shard through a
+//  single-producer single-consumer ring (spscRing.h), because each shard
+//  sees the same sequence of requests, the result is the same as the serial
+//  run (as long as the shard cache does not use random numbers)
+//
+//  cachesim ../data/trace.vscsi vscsi sharded 1gb -e "n-shard=16,shard-cache=sieve"
+//
+//  Sharded.c
+//  libCacheSim
+//
+
+#include <pthread.h>
+#include <stdatomic.h>
+
+#include "../../dataStructure/spscRing.h"
+#include "../../include/libCacheSim/evictionAlgo.h"
+#include "../../utils/include/mymath.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* a worker with an empty queue sleeps after yielding this many times, so
+ * that the workers do not use the CPU between the drain and the next
+ * submit */
+#define SHARD_YIELD_BEFORE_PARK 64
+#define SHARDED_MAX_N_SHARD 1024
+
+typedef struct {
+  spsc_ring_t ring;
+  cache_t *cache;
+  int32_t idx;
+
+  /* written by the worker, read by the producer after it reads the head */
+  int64_t n_miss;
+  int64_t n_miss_byte;
+
+  _Atomic bool stop;
+  pthread_t thread;
+} shard_t;
+
+typedef struct {
+  int n_shard;
+  char shard_cache_type[32];
+  bool parallel;
+  bool worker_started;
+
+  shard_t **shards;
+} Sharded_params_t;
+
+static const char *DEFAULT_CACHE_PARAMS = "n-shard=16,shard-cache=lru,parallel=true";
+
+// ***********************************************************************
+// ****                                                               ****
+// ****                   function declarations                       ****
+// ****                                                               ****
+// ***********************************************************************
+static void Sharded_free(cache_t *cache);
+static bool Sharded_get(cache_t *cache, const request_t *req);
+
+static cache_obj_t *Sharded_find(cache_t *cache, const request_t *req, const bool update_cache);
+static cache_obj_t *Sharded_insert(cache_t *cache, const request_t *req);
+static cache_obj_t *Sharded_to_evict(cache_t *cache, const request_t *req);
+static void Sharded_evict(cache_t *cache, const request_t *req);
+static bool Sharded_remove(cache_t *cache, const obj_id_t obj_id);
+static inline int64_t Sharded_get_occupied_byte(const cache_t *cache);
+static inline int64_t Sharded_get_n_obj(const cache_t *cache);
+static inline bool Sharded_can_insert(cache_t *cache, const request_t *req);
+static void Sharded_parse_params(cache_t *cache, const char *cache_specific_params);
+static void Sharded_stop_workers(Sharded_params_t *params);
+static bool Sharded_prepare_fork(cache_t *cache);
+
+// ***********************************************************************
+// ****                                                               ****
+// ****                   end user facing functions                   ****
+// ****                                                               ****
+// ***********************************************************************
+
+static cache_t *create_shard_cache(const char *cache_type, const common_cache_params_t ccache_params) {
+  if (strcasecmp(cache_type, "lru") == 0) {
+    return LRU_init(ccache_params, NULL);
+  } else if (strcasecmp(cache_type, "fifo") == 0) {
+    return FIFO_init(ccache_params, NULL);
+  } else if (strcasecmp(cache_type, "clock") == 0) {
+    return Clock_init(ccache_params, NULL);
+  } else if (strcasecmp(cache_type, "sieve") == 0) {
+    return Sieve_init(ccache_params, NULL);
+  } else if (strcasecmp(cache_type, "s3fifo") == 0) {
+    return S3FIFO_init(ccache_params, NULL);
+  } else if (strcasecmp(cache_type, "qdlp") == 0) {
+    return QDLP_init(ccache_params, NULL);
+  } else if (strcasecmp(cache_type, "arc") == 0) {
+    return ARC_init(ccache_params, NULL);
+  } else if (strcasecmp(cache_type, "twoQ") == 0) {
+    return TwoQ_init(ccache_params, NULL);
+  } else if (strcasecmp(cache_type, "slru") == 0) {
+    return SLRU_init(ccache_params, NULL);
+  } else if (strcasecmp(cache_type, "lirs") == 0) {
+    return LIRS_init(ccache_params, NULL);
+  } else if (strcasecmp(cache_type, "lfu") == 0) {
+    return LFU_init(ccache_params, NULL);
+  } else if (strcasecmp(cache_type, "lhd") == 0) {
+    return LHD_init(ccache_params, NULL);
+  } else {
+    ERROR("Sharded does not support shard cache %s\n", cache_type);
+    abort();
+  }
+}
+
+cache_t *Sharded_init(const common_cache_params_t ccache_params, const char *cache_specific_params) {
+  /* the objects are stored in the hash tables of the shards, the table of
+   * the wrapper is not used, the tables grow, so a clone, which uses the
+   * hashpower of this table, starts with small tables in the shards */
+  common_cache_params_t ccache_params_wrapper = ccache_params;
+  ccache_params_wrapper.hashpower = 4;
+  cache_t *cache = cache_struct_init("Sharded", ccache_params_wrapper, cache_specific_params);
+  cache->cache_init = Sharded_init;
+  cache->cache_free = Sharded_free;
+  cache->get = Sharded_get;
+  cache->find = Sharded_find;
+  cache->insert = Sharded_insert;
+  cache->evict = Sharded_evict;
+  cache->remove = Sharded_remove;
+  cache->to_evict = Sharded_to_evict;
+  cache->get_n_obj = Sharded_get_n_obj;
+  cache->get_occupied_byte = Sharded_get_occupied_byte;
+  cache->can_insert = Sharded_can_insert;
+  cache->prepare_fork = Sharded_prepare_fork;
+
+  cache->obj_md_size = 0;
+
+  cache->eviction_params = malloc(sizeof(Sharded_params_t));
+  memset(cache->eviction_params, 0, sizeof(Sharded_params_t));
+  Sharded_params_t *params = (Sharded_params_t *)cache->eviction_params;
+
+  Sharded_parse_params(cache, DEFAULT_CACHE_PARAMS);
+  if (cache_specific_params != NULL) {
+    Sharded_parse_params(cache, cache_specific_params);
+  }
+  if (params->n_shard <= 0 || params->n_shard > SHARDED_MAX_N_SHARD) {
+    ERROR("Sharded: n-shard should be in [1, %d]\n", SHARDED_MAX_N_SHARD);
+  }
+
+  /* each shard has 1/n_shard of the objects, so it needs a smaller hash
+   * table */
+  common_cache_params_t ccache_params_local = ccache_params;
+  int shard_bits = 0;
+  while ((1 << shard_bits) < params->n_shard) shard_bits++;
+  ccache_params_local.hashpower = MAX(ccache_params.hashpower - shard_bits, 12);
+
+  params->shards = malloc(sizeof(shard_t *) * params->n_shard);
+  for (int i = 0; i < params->n_shard; i++) {
+    shard_t *shard = aligned_alloc(64, sizeof(shard_t));
+    memset(shard, 0, sizeof(shard_t));
+    shard->idx = i;
+    spsc_ring_init(&shard->ring);
+    /* the first shards take the remainder of the cache size */
+    ccache_params_local.cache_size =
+        ccache_params.cache_size / params->n_shard + (i < (int)(ccache_params.cache_size % params->n_shard) ? 1 : 0);
+    shard->cache = create_shard_cache(params->shard_cache_type, ccache_params_local);
+    params->shards[i] = shard;
+  }
+
+  snprintf(cache->cache_name, CACHE_NAME_ARRAY_LEN, "Sharded-%d-%.40s", params->n_shard,
+           params->shards[0]->cache->cache_name);
+
+  return cache;
+}
+
+/**
+ * free resources used by this cache
+ *
+ * @param cache
+ */
+static void Sharded_free(cache_t *cache) {
+  Sharded_params_t *params = (Sharded_params_t *)cache->eviction_params;
+  Sharded_stop_workers(params);
+  for (int i = 0; i < params->n_shard; i++) {
+    params->shards[i]->cache->cache_free(params->shards[i]->cache);
+    spsc_ring_free(&params->shards[i]->ring);
+    free(params->shards[i]);
+  }
+  free(params->shards);
+  free(cache->eviction_params);
+  cache_struct_free(cache);
+}
+
+static inline shard_t *shard_of(const Sharded_params_t *params, const obj_id_t obj_id) {
+  /* use a hash different from the hash table in the shard, otherwise, the
+   * objects in a shard would only use part of the hash table */
+  uint64_t hv = mix64((uint64_t)obj_id);
+  return params->shards[((hv >> 32) * (uint64_t)params->n_shard) >> 32];
+}
+
+/**
+ * @brief this function is the user facing API
+ * the request is sent to the shard of the object
+ *
+ * @param cache
+ * @param req
+ * @return true if cache hit, false if cache miss
+ */
+static bool Sharded_get(cache_t *cache, const request_t *req) {
+  Sharded_params_t *params = (Sharded_params_t *)cache->eviction_params;
+  if (params->worker_started) {
+    /* the requests submitted before must finish first */
+    Sharded_drain(cache, NULL, NULL);
+  }
+
+  cache->n_req += 1;
+  cache_t *shard_cache = shard_of(params, req->obj_id)->cache;
+  int64_t n_evict = shard_cache->n_evict;
+  bool hit = shard_cache->get(shard_cache, req);
+  cache->n_evict += shard_cache->n_evict - n_evict;
+  return hit;
+}
+
+// ***********************************************************************
+// ****                                                               ****
+// ****                    parallel simulation                        ****
+// ****                                                               ****
+// ***********************************************************************
+
+static void *shard_worker(void *arg) {
+  shard_t *shard = (shard_t *)arg;
+  spsc_ring_t *ring = &shard->ring;
+  cache_t *cache = shard->cache;
+  request_t *req = new_request();
+  set_rand_seed(shard->idx + 1);
+
+  uint64_t head = atomic_load_explicit(&ring->head, memory_order_relaxed);
+  int n_spin = 0;
+  while (true) {
+    uint64_t tail = spsc_ring_published(ring);
+    if (head == tail) {
+      /* the producer publishes the last requests before setting stop */
+      if (atomic_load_explicit(&shard->stop, memory_order_acquire) && head == spsc_ring_published(ring)) {
+        break;
+      }
+      if (++n_spin > SPSC_RING_SPIN_BEFORE_YIELD + SHARD_YIELD_BEFORE_PARK) {
+        spsc_ring_wait(ring, head, &shard->stop);
+        n_spin = 0;
+      } else if (n_spin > SPSC_RING_SPIN_BEFORE_YIELD) {
+        sched_yield();
+      }
+      continue;
+    }
+    n_spin = 0;
+
+    for (; head != tail; head++) {
+      const spsc_req_t *r = &ring->reqs[head & (SPSC_RING_SIZE - 1)];
+      spsc_req_to_req(r, req);
+      bool hit = cache->get(cache, req);
+      if (!hit && r->record_stat) {
+        shard->n_miss += 1;
+        shard->n_miss_byte += r->obj_size;
+      }
+    }
+    spsc_ring_consume(ring, head);
+  }
+
+  free_request(req);
+  return NULL;
+}
+
+static void Sharded_start_workers(Sharded_params_t *params) {
+  for (int i = 0; i < params->n_shard; i++) {
+    shard_t *shard = params->shards[i];
+    atomic_store(&shard->stop, false);
+    if (pthread_create(&shard->thread, NULL, shard_worker, shard) != 0) {
+      ERROR("Sharded: cannot create worker thread\n");
+    }
+  }
+  params->worker_started = true;
+}
+
+static void Sharded_stop_workers(Sharded_params_t *params) {
+  if (!params->worker_started) return;
+
+  for (int i = 0; i < params->n_shard; i++) {
+    shard_t *shard = params->shards[i];
+    spsc_ring_stop(&shard->ring, &shard->stop);
+  }
+  for (int i = 0; i < params->n_shard; i++) {
+    pthread_join(params->shards[i]->thread, NULL);
+  }
+  params->worker_started = false;
+}
+
+/* the workers finish the submitted requests and exit, they are restarted by
+ * the next Sharded_submit */
+static bool Sharded_prepare_fork(cache_t *cache) {
+  Sharded_stop_workers((Sharded_params_t *)cache->eviction_params);
+  return true;
+}
+
+bool Sharded_is_parallel(const cache_t *cache) {
+  if (cache->cache_init != Sharded_init) return false;
+  return ((const Sharded_params_t *)cache->eviction_params)->parallel;
+}
+
+void Sharded_submit(cache_t *cache, const request_t *req, bool record_stat) {
+  Sharded_params_t *params = (Sharded_params_t *)cache->eviction_params;
+  if (unlikely(!params->worker_started)) {
+    Sharded_start_workers(params);
+  }
+
+  cache->n_req += 1;
+  spsc_ring_push(&shard_of(params, req->obj_id)->ring, req, record_stat);
+}
+
+void Sharded_drain(cache_t *cache, int64_t *n_miss, int64_t *n_miss_byte) {
+  Sharded_params_t *params = (Sharded_params_t *)cache->eviction_params;
+  int64_t total_miss = 0, total_miss_byte = 0, total_evict = 0;
+
+  for (int i = 0; i < params->n_shard; i++) {
+    shard_t *shard = params->shards[i];
+    if (params->worker_started) {
+      spsc_ring_flush(&shard->ring);
+    }
+    total_miss += shard->n_miss;
+    total_miss_byte += shard->n_miss_byte;
+    total_evict += shard->cache->n_evict;
+  }
+
+  cache->n_obj = Sharded_get_n_obj(cache);
+  cache->occupied_byte = Sharded_get_occupied_byte(cache);
+  cache->n_evict = total_evict;
+
+  if (n_miss != NULL) *n_miss = total_miss;
+  if (n_miss_byte != NULL) *n_miss_byte = total_miss_byte;
+}
+
+// ***********************************************************************
+// ****                                                               ****
+// ****       developer facing APIs (used by cache developer)         ****
+// ****                                                               ****
+// ***********************************************************************
+/* the operations below are forwarded to the shard of the object, they are
+ * only used when the cache runs serially */
+
+static cache_obj_t *Sharded_find(cache_t *cache, const request_t *req, const bool update_cache) {
+  cache_t *shard_cache = shard_of(cache->eviction_params, req->obj_id)->cache;
+  return shard_cache->find(shard_cache, req, update_cache);
+}
+
+static cache_obj_t *Sharded_insert(cache_t *cache, const request_t *req) {
+  cache_t *shard_cache = shard_of(cache->eviction_params, req->obj_id)->cache;
+  return shard_cache->insert(shard_cache, req);
+}
+
+static cache_obj_t *Sharded_to_evict(cache_t *cache, const request_t *req) {
+  cache_t *shard_cache = shard_of(cache->eviction_params, req->obj_id)->cache;
+  return shard_cache->to_evict(shard_cache, req);
+}
+
+/* evict from the shard that the request belongs to */
+static void Sharded_evict(cache_t *cache, const request_t *req) {
+  cache_t *shard_cache = shard_of(cache->eviction_params, req->obj_id)->cache;
+  shard_cache->evict(shard_cache, req);
+}
+
+static bool Sharded_remove(cache_t *cache, const obj_id_t obj_id) {
+  cache_t *shard_cache = shard_of(cache->eviction_params, obj_id)->cache;
+  return shard_cache->remove(shard_cache, obj_id);
+}
+
+static inline int64_t Sharded_get_occupied_byte(const cache_t *cache) {
+  Sharded_params_t *params = (Sharded_params_t *)cache->eviction_params;
+  int64_t occupied_byte = 0;
+  for (int i = 0; i < params->n_shard; i++) {
+    cache_t *shard_cache = params->shards[i]->cache;
+    occupied_byte += shard_cache->get_occupied_byte(shard_cache);
+  }
+  return occupied_byte;
+}
+
+static inline int64_t Sharded_get_n_obj(const cache_t *cache) {
+  Sharded_params_t *params = (Sharded_params_t *)cache->eviction_params;
+  int64_t n_obj = 0;
+  for (int i = 0; i < params->n_shard; i++) {
+    cache_t *shard_cache = params->shards[i]->cache;
+    n_obj += shard_cache->get_n_obj(shard_cache);
+  }
+  return n_obj;
+}
+
+static inline bool Sharded_can_insert(cache_t *cache, const request_t *req) {
+  cache_t *shard_cache = shard_of(cache->eviction_params, req->obj_id)->cache;
+  return shard_cache->can_insert(shard_cache, req);
+}
+
+// ***********************************************************************
+// ****                                                               ****
+// ****                parameter set up functions                     ****
+// ****                                                               ****
+// ***********************************************************************
+static const char *Sharded_current_params(Sharded_params_t *params) {
+  static __thread char params_str[128];
+  snprintf(params_str, 128, "n-shard=%d,shard-cache=%s,parallel=%d\n", params->n_shard, params->shard_cache_type,
+           params->parallel);
+  return params_str;
+}
+
+static void Sharded_parse_params(cache_t *cache, const char *cache_specific_params) {
+  Sharded_params_t *params = (Sharded_params_t *)(cache->eviction_params);
+
+  char *params_str = strdup(cache_specific_params);
+  char *old_params_str = params_str;
+
+  while (params_str != NULL && params_str[0] != '\0') {
+    /* different parameters are separated by comma,
+     * key and value are separated by = */
+    char *key = strsep((char **)&params_str, "=");
+    char *value = strsep((char **)&params_str, ",");
+
+    // skip the white space
+    while (params_str != NULL && *params_str == ' ') {
+      params_str++;
+    }
+
+    if (strcasecmp(key, "n-shard") == 0) {
+      params->n_shard = atoi(value);
+    } else if (strcasecmp(key, "shard-cache") == 0) {
+      strncpy(params->shard_cache_type, value, 30);
+    } else if (strcasecmp(key, "parallel") == 0) {
+      params->parallel = strcasecmp(value, "true") == 0 || strcmp(value, "1") == 0;
+    } else if (strcasecmp(key, "print") == 0) {
+      printf("parameters: %s\n", Sharded_current_params(params));
+      exit(0);
+    } else {
+      ERROR("%s does not have parameter %s\n", cache->cache_name, key);
+      exit(1);
+    }
+  }
+
+  free(old_params_str);
+}
+
+#ifdef __cplusplus
+}
+#endif
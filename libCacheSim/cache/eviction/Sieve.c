@@ -1,6 +1,7 @@
 
 
 #include "../../dataStructure/hashtable/hashtable.h"
+#include "../../dataStructure/ringQueue.h"
 #include "../../include/libCacheSim/cache.h"
 
 #ifdef __cplusplus
@@ -12,6 +13,8 @@ typedef struct {
   cache_obj_t *q_tail;
 
   cache_obj_t *pointer;
+  /* not NULL if the queue is a ring queue (queue=ring) */
+  ring_queue_t *ring;
 } Sieve_params_t;
 
 // ***********************************************************************
@@ -19,6 +22,8 @@ typedef struct {
 // ****                   function declarations                       ****
 // ****                                                               ****
 // ***********************************************************************
+static void Sieve_parse_params(cache_t *cache,
+                               const char *cache_specific_params);
 static void Sieve_free(cache_t *cache);
 static bool Sieve_get(cache_t *cache, const request_t *req);
 static cache_obj_t *Sieve_find(cache_t *cache, const request_t *req,
@@ -27,6 +32,8 @@ static cache_obj_t *Sieve_insert(cache_t *cache, const request_t *req);
 static cache_obj_t *Sieve_to_evict(cache_t *cache, const request_t *req);
 static void Sieve_evict(cache_t *cache, const request_t *req);
 static bool Sieve_remove(cache_t *cache, const obj_id_t obj_id);
+static bool Sieve_save_state(const cache_t *cache, FILE *f);
+static bool Sieve_load_state(cache_t *cache, FILE *f);
 
 // ***********************************************************************
 // ****                                                               ****
@@ -54,6 +61,9 @@ cache_t *Sieve_init(const common_cache_params_t ccache_params,
   cache->evict = Sieve_evict;
   cache->remove = Sieve_remove;
   cache->to_evict = Sieve_to_evict;
+  cache->save_state = Sieve_save_state;
+  cache->load_state = Sieve_load_state;
+  cache->checkpoint_algo = __func__;
 
   if (ccache_params.consider_obj_metadata) {
     cache->obj_md_size = 1;
@@ -67,6 +77,11 @@ cache_t *Sieve_init(const common_cache_params_t ccache_params,
   params->pointer = NULL;
   params->q_head = NULL;
   params->q_tail = NULL;
+  params->ring = NULL;
+
+  if (cache_specific_params != NULL) {
+    Sieve_parse_params(cache, cache_specific_params);
+  }
 
   return cache;
 }
@@ -77,6 +92,10 @@ cache_t *Sieve_init(const common_cache_params_t ccache_params,
  * @param cache
  */
 static void Sieve_free(cache_t *cache) {
+  Sieve_params_t *params = cache->eviction_params;
+  if (params->ring != NULL) {
+    free_ring_queue(params->ring);
+  }
   free(cache->eviction_params);
   cache_struct_free(cache);
 }
@@ -146,12 +165,35 @@ static cache_obj_t *Sieve_find(cache_t *cache, const request_t *req,
 static cache_obj_t *Sieve_insert(cache_t *cache, const request_t *req) {
   Sieve_params_t *params = cache->eviction_params;
   cache_obj_t *obj = cache_insert_base(cache, req);
-  prepend_obj_to_head(&params->q_head, &params->q_tail, obj);
+  if (params->ring != NULL) {
+    ring_queue_push(params->ring, obj);
+  } else {
+    prepend_obj_to_head(&params->q_head, &params->q_tail, obj);
+  }
   obj->sieve.freq = 0;
 
   return obj;
 }
 
+/* the hand moves from the oldest (tail) to the newest (head) object */
+static inline cache_obj_t *Sieve_oldest(const Sieve_params_t *params) {
+  return params->ring != NULL ? ring_queue_oldest(params->ring) : params->q_tail;
+}
+
+static inline cache_obj_t *Sieve_newer(const Sieve_params_t *params,
+                                       const cache_obj_t *obj) {
+  return params->ring != NULL ? ring_queue_newer(params->ring, obj)
+                              : obj->queue.prev;
+}
+
+static inline void Sieve_unlink(Sieve_params_t *params, cache_obj_t *obj) {
+  if (params->ring != NULL) {
+    ring_queue_remove(params->ring, obj);
+  } else {
+    remove_obj_from_list(&params->q_head, &params->q_tail, obj);
+  }
+}
+
 /**
  * @brief find the object to be evicted
  * this function does not actually evict the object or update metadata
@@ -169,18 +211,18 @@ static cache_obj_t *Sieve_to_evict_with_freq(cache_t *cache,
   cache_obj_t *pointer = params->pointer;
 
   /* if we have run one full around or first eviction */
-  if (pointer == NULL) pointer = params->q_tail;
+  if (pointer == NULL) pointer = Sieve_oldest(params);
 
   /* find the first untouched */
   while (pointer != NULL && pointer->sieve.freq > to_evict_freq) {
-    pointer = pointer->queue.prev;
+    pointer = Sieve_newer(params, pointer);
   }
 
   /* if we have finished one around, start from the tail */
   if (pointer == NULL) {
-    pointer = params->q_tail;
+    pointer = Sieve_oldest(params);
     while (pointer != NULL && pointer->sieve.freq > to_evict_freq) {
-      pointer = pointer->queue.prev;
+      pointer = Sieve_newer(params, pointer);
     }
   }
 
@@ -219,15 +261,17 @@ static void Sieve_evict(cache_t *cache, const request_t *req) {
   Sieve_params_t *params = cache->eviction_params;
 
   /* if we have run one full around or first eviction */
-  cache_obj_t *obj = params->pointer == NULL ? params->q_tail : params->pointer;
+  cache_obj_t *obj =
+      params->pointer == NULL ? Sieve_oldest(params) : params->pointer;
 
   while (obj->sieve.freq > 0) {
     obj->sieve.freq -= 1;
-    obj = obj->queue.prev == NULL ? params->q_tail : obj->queue.prev;
+    cache_obj_t *newer = Sieve_newer(params, obj);
+    obj = newer == NULL ? Sieve_oldest(params) : newer;
   }
 
-  params->pointer = obj->queue.prev;
-  remove_obj_from_list(&params->q_head, &params->q_tail, obj);
+  params->pointer = Sieve_newer(params, obj);
+  Sieve_unlink(params, obj);
   cache_evict_base(cache, obj, true);
 }
 
@@ -235,9 +279,9 @@ static void Sieve_remove_obj(cache_t *cache, cache_obj_t *obj_to_remove) {
   DEBUG_ASSERT(obj_to_remove != NULL);
   Sieve_params_t *params = cache->eviction_params;
   if (obj_to_remove == params->pointer) {
-    params->pointer = obj_to_remove->queue.prev;
+    params->pointer = Sieve_newer(params, obj_to_remove);
   }
-  remove_obj_from_list(&params->q_head, &params->q_tail, obj_to_remove);
+  Sieve_unlink(params, obj_to_remove);
   cache_remove_obj_base(cache, obj_to_remove, true);
 }
 
@@ -265,6 +309,121 @@ static bool Sieve_remove(cache_t *cache, const obj_id_t obj_id) {
   return true;
 }
 
+// ***********************************************************************
+// ****                                                               ****
+// ****                     checkpoint functions                      ****
+// ****                                                               ****
+// ***********************************************************************
+/**
+ * @brief save the queue and the position of the hand, the hand is stored as
+ * the index of the object from the head, -1 if the hand is not set
+ *
+ * @param cache
+ * @param f
+ * @return whether the state is written
+ */
+static bool Sieve_save_state(const cache_t *cache, FILE *f) {
+  Sieve_params_t *params = (Sieve_params_t *)cache->eviction_params;
+  int64_t pointer_pos = -1;
+  if (params->ring != NULL) {
+    if (params->pointer != NULL) {
+      pointer_pos = 0;
+      for (cache_obj_t *obj = ring_queue_newest(params->ring); obj != params->pointer;
+           obj = ring_queue_older(params->ring, obj)) {
+        pointer_pos += 1;
+      }
+    }
+    return fwrite(&pointer_pos, sizeof(pointer_pos), 1, f) == 1 && cache_save_ring_queue(params->ring, f);
+  }
+
+  if (params->pointer != NULL) {
+    pointer_pos = 0;
+    for (cache_obj_t *obj = params->q_head; obj != params->pointer; obj = obj->queue.next) {
+      pointer_pos += 1;
+    }
+  }
+
+  return fwrite(&pointer_pos, sizeof(pointer_pos), 1, f) == 1 && cache_save_obj_queue(params->q_head, f);
+}
+
+static bool Sieve_load_state(cache_t *cache, FILE *f) {
+  Sieve_params_t *params = (Sieve_params_t *)cache->eviction_params;
+  int64_t pointer_pos;
+  if (fread(&pointer_pos, sizeof(pointer_pos), 1, f) != 1) {
+    return false;
+  }
+
+  params->pointer = NULL;
+  if (params->ring != NULL) {
+    if (!cache_load_ring_queue(cache, f, params->ring)) {
+      return false;
+    }
+    if (pointer_pos >= 0) {
+      params->pointer = ring_queue_newest(params->ring);
+      for (int64_t i = 0; i < pointer_pos && params->pointer != NULL; i++) {
+        params->pointer = ring_queue_older(params->ring, params->pointer);
+      }
+    }
+    return true;
+  }
+
+  if (!cache_load_obj_queue(cache, f, &params->q_head, &params->q_tail)) {
+    return false;
+  }
+  if (pointer_pos >= 0) {
+    params->pointer = params->q_head;
+    for (int64_t i = 0; i < pointer_pos && params->pointer != NULL; i++) {
+      params->pointer = params->pointer->queue.next;
+    }
+  }
+  return true;
+}
+
+// ***********************************************************************
+// ****                                                               ****
+// ****                  parameter set up functions                   ****
+// ****                                                               ****
+// ***********************************************************************
+static void Sieve_parse_params(cache_t *cache,
+                               const char *cache_specific_params) {
+  Sieve_params_t *params = cache->eviction_params;
+  char *params_str = strdup(cache_specific_params);
+  char *old_params_str = params_str;
+
+  while (params_str != NULL && params_str[0] != '\0') {
+    /* different parameters are separated by comma,
+     * key and value are separated by = */
+    char *key = strsep((char **)&params_str, "=");
+    char *value = strsep((char **)&params_str, ",");
+
+    // skip the white space
+    while (params_str != NULL && *params_str == ' ') {
+      params_str++;
+    }
+
+    if (strcasecmp(key, "queue") == 0) {
+      if (strcasecmp(value, "ring") == 0) {
+        if (params->ring == NULL) params->ring = create_ring_queue();
+      } else if (strcasecmp(value, "list") == 0) {
+        if (params->ring != NULL) free_ring_queue(params->ring);
+        params->ring = NULL;
+      } else {
+        ERROR("Sieve queue can be list or ring, but got %s\n", value);
+        exit(1);
+      }
+    } else if (strcasecmp(key, "print") == 0) {
+      printf("current parameters: queue=%s\n",
+             params->ring != NULL ? "ring" : "list");
+      exit(0);
+    } else {
+      ERROR("%s does not have parameter %s, example parameters queue=ring\n",
+            cache->cache_name, key);
+      exit(1);
+    }
+  }
+  free(old_params_str);
+}
+
 static void Sieve_verify(cache_t *cache) {
   Sieve_params_t *params = cache->eviction_params;
   int64_t n_obj = 0, n_byte = 0;
@@ -109,6 +109,7 @@ static bool GDSF_get(cache_t *cache, const request_t *req) {
     cache->insert(cache, req);
     while (cache->get_occupied_byte(cache) > cache->cache_size) {
       cache->evict(cache, req);
+      cache->n_evict += 1;
     }
   }
 
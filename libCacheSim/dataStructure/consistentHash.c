@@ -0,0 +1,118 @@
+//
+// a ketama consistent hash ring, modified from the ring in example/cacheCluster
+//
+
+#include "consistentHash.h"
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "../utils/include/mymath.h"
+#include "ketama/md5.h"
+
+/* limit the points of a server with a very large weight */
+#define MAX_N_HASH_PER_SERVER (N_VNODE_PER_SERVER / 4 * 64)
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+static int ch_ring_compare(const void *a, const void *b) {
+  const vnode_t *node_a = (const vnode_t *)a;
+  const vnode_t *node_b = (const vnode_t *)b;
+  if (node_a->point != node_b->point) return node_a->point < node_b->point ? -1 : 1;
+  /* the order of the servers with the same point does not depend on qsort */
+  return node_a->server_id < node_b->server_id ? -1 : (node_a->server_id > node_b->server_id ? 1 : 0);
+}
+
+static void md5_digest(const char *const in_string, unsigned char md5pword[16]) {
+  md5_state_t md5state;
+
+  md5_init(&md5state);
+  md5_append(&md5state, (const unsigned char *)in_string, (int)strlen(in_string));
+  md5_finish(&md5state, md5pword);
+}
+
+/* the number of hashes of a server, each hash gives 4 points, the number
+ * only depends on the weight of the server, so that the points of the other
+ * servers do not change when a server is added or removed */
+static unsigned int ch_ring_n_hash(const double *weight, int i) {
+  double w = weight == NULL ? 1.0 : weight[i];
+  double ks = ceil(w * (N_VNODE_PER_SERVER / 4));
+  if (ks < 1) ks = 1;
+  if (ks > MAX_N_HASH_PER_SERVER) ks = MAX_N_HASH_PER_SERVER;
+  return (unsigned int)ks;
+}
+
+ring_t *ch_ring_create(int n_server, const unsigned int *server_ids, const double *weight) {
+  unsigned int max_n_point = 0;
+  for (int i = 0; i < n_server; i++) {
+    max_n_point += 4 * ch_ring_n_hash(weight, i);
+  }
+
+  ring_t *ring = (ring_t *)malloc(sizeof(ring_t));
+  ring->n_server = n_server;
+  ring->vnodes = (vnode_t *)malloc(sizeof(vnode_t) * (max_n_point > 0 ? max_n_point : 1));
+
+  unsigned int cnt = 0;
+  for (int i = 0; i < n_server; i++) {
+    unsigned int server_id = server_ids == NULL ? (unsigned int)i : server_ids[i];
+    unsigned int ks = ch_ring_n_hash(weight, i);
+
+    for (unsigned int k = 0; k < ks; k++) {
+      /* 40 hashes, 4 numbers per hash = 160 points per unit of weight */
+      char ss[32];
+      unsigned char digest[16];
+
+      snprintf(ss, sizeof(ss), "%u-%u", server_id, k);
+      md5_digest(ss, digest);
+
+      /* Use successive 4-bytes from hash as numbers for the points on the
+       * circle: */
+      for (int h = 0; h < 4; h++) {
+        ring->vnodes[cnt].point = ((unsigned int)digest[3 + h * 4] << 24) | ((unsigned int)digest[2 + h * 4] << 16) |
+                                  ((unsigned int)digest[1 + h * 4] << 8) | digest[h * 4];
+        ring->vnodes[cnt].server_id = server_id;
+        cnt++;
+      }
+    }
+  }
+  ring->n_point = cnt;
+
+  /* Sorts in ascending order of "point" */
+  qsort((void *)ring->vnodes, cnt, sizeof(vnode_t), ch_ring_compare);
+
+  return ring;
+}
+
+unsigned int ch_ring_get_server(uint64_t obj_id, const ring_t *const ring) {
+  /* md5 of every request is slow when the ring is used to route a trace,
+   * the object id is mixed into a 32-bit point instead */
+  unsigned int h = (unsigned int)(mix64(obj_id) >> 32);
+
+  /* the first point that is not smaller than h, wrap around to the first
+   * point if h is larger than all points */
+  unsigned int low = 0, high = ring->n_point;
+  while (low < high) {
+    unsigned int mid = low + (high - low) / 2;
+    if (ring->vnodes[mid].point < h) {
+      low = mid + 1;
+    } else {
+      high = mid;
+    }
+  }
+  if (low == ring->n_point) low = 0;
+
+  return ring->vnodes[low].server_id;
+}
+
+void ch_ring_destroy(ring_t *ring) {
+  free(ring->vnodes);
+  free(ring);
+}
+
+#ifdef __cplusplus
+}
+#endif
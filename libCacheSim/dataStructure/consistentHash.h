@@ -0,0 +1,61 @@
+//
+// a ketama consistent hash ring, modified from the ring in example/cacheCluster
+//
+// the points of a server only depend on the server id and its weight, so
+// adding or removing a server only moves the objects of that server
+//
+
+#ifndef CONSISTENT_HASH_H_
+#define CONSISTENT_HASH_H_
+
+#ifdef __cplusplus /* If this is a C++ compiler, use C linkage */
+extern "C" {
+#endif
+
+#include <inttypes.h>
+
+#define N_VNODE_PER_SERVER 160
+
+typedef struct {
+  unsigned int point;  // point on ring
+  unsigned int server_id;
+} vnode_t;
+
+typedef struct {
+  unsigned int n_point;
+  unsigned int n_server;
+  vnode_t *vnodes;
+} ring_t;
+
+/**
+ * @brief create a consistent hash ring with n servers
+ *
+ * @param n_server
+ * @param server_ids the ids of the servers, null if the ids are 0 to n_server - 1
+ * @param weight null if all servers have the same weight, a server has
+ *  N_VNODE_PER_SERVER points per unit of weight (up to 64 units)
+ * @return ring_t*
+ */
+ring_t *ch_ring_create(int n_server, const unsigned int *server_ids, const double *weight);
+
+/**
+ * @brief retrieve the server id from the consistent hash ring
+ *
+ * @param obj_id
+ * @param ring
+ * @return the server id
+ */
+unsigned int ch_ring_get_server(uint64_t obj_id, const ring_t *const ring);
+
+/**
+ * @brief destroy consistent hash ring
+ *
+ * @param ring
+ */
+void ch_ring_destroy(ring_t *ring);
+
+#ifdef __cplusplus /* If this is a C++ compiler, end C linkage */
+}
+#endif
+
+#endif  // CONSISTENT_HASH_H_
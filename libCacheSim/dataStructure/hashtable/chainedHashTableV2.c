@@ -17,6 +17,11 @@
 // |     void*      | ----> NULL
 // |----------------|
 //
+// the hash table is resized incrementally, when the load crosses a threshold,
+// a new table is allocated and the old table is kept, each insert and delete
+// moves CHAINED_HASHTABLE_REHASH_STEP buckets of the old table to the new
+// table, an object is in the old table if its bucket in the old table has not
+// been moved, otherwise it is in the new table, so a lookup checks one bucket
 //
 
 #ifdef __cplusplus
@@ -40,34 +45,58 @@ extern "C" {
 #define OBJ_EMPTY(cache_obj) ((cache_obj)->obj_size == 0)
 #define NEXT_OBJ(cur_obj) (((cache_obj_t *)(cur_obj))->hash_next)
 
-static void _copy_entries(hashtable_t *new_table, cache_obj_t **old_table, uint64_t old_size);
+static void _rehash_step(hashtable_t *hashtable, uint64_t n_bucket);
 static void _chained_hashtable_shrink_v2(hashtable_t *hashtable);
 static void _chained_hashtable_expand_v2(hashtable_t *hashtable);
 static void print_hashbucket_item_distribution(const hashtable_t *hashtable);
 
+#ifdef ENABLE_CACHE_OP_STAT
+/* the lookup functions take a const hashtable, the stat is not part of the
+ * table content */
+static inline void _record_lookup(const hashtable_t *hashtable, const int64_t chain_len) {
+  hashtable_t *ht = (hashtable_t *)hashtable;
+  ht->n_lookup += 1;
+  ht->n_lookup_step += chain_len;
+  if (chain_len > ht->max_chain_len) ht->max_chain_len = chain_len;
+}
+#define RECORD_LOOKUP(hashtable, chain_len) _record_lookup(hashtable, chain_len)
+#define RECORD_RESIZE(hashtable, field) (hashtable)->field += 1
+#else
+#define RECORD_LOOKUP(hashtable, chain_len)
+#define RECORD_RESIZE(hashtable, field)
+#endif
+
 /************************ helper func ************************/
 /**
- * get the last object in the hash bucket
+ * get the bucket of a hash value, the bucket is in the old table
+ * if the hash table is resizing and the bucket has not been moved
  */
-static inline cache_obj_t *_last_obj_in_bucket(const hashtable_t *hashtable, const uint64_t hv) {
-  cache_obj_t *cur_obj_in_bucket = hashtable->ptr_table[hv];
-  while (cur_obj_in_bucket->hash_next) {
-    cur_obj_in_bucket = cur_obj_in_bucket->hash_next;
+static inline cache_obj_t **_get_bucket(const hashtable_t *hashtable, const uint64_t hv) {
+  if (unlikely(hashtable->old_ptr_table != NULL)) {
+    uint64_t old_pos = hv & hashmask(hashtable->old_hashpower);
+    if (old_pos >= hashtable->rehash_pos) {
+      return &hashtable->old_ptr_table[old_pos];
+    }
   }
-  return cur_obj_in_bucket;
+  return &hashtable->ptr_table[hv & hashmask(hashtable->hashpower)];
 }
 
-/* add an object to the hashtable */
-static inline void add_to_table(hashtable_t *hashtable, cache_obj_t *cache_obj) {
-  uint64_t hv = get_hash_value_int_64(&cache_obj->obj_id) & hashmask(hashtable->hashpower);
-  if (hashtable->ptr_table[hv] == NULL) {
-    hashtable->ptr_table[hv] = cache_obj;
+/* add an object to the head of a bucket */
+static inline void add_to_bucket(cache_obj_t **bucket, cache_obj_t *cache_obj) {
+  if (*bucket == NULL) {
+    *bucket = cache_obj;
     return;
   }
-  cache_obj_t *head_ptr = hashtable->ptr_table[hv];
+  cache_obj_t *head_ptr = *bucket;
 
   cache_obj->hash_next = head_ptr;
-  hashtable->ptr_table[hv] = cache_obj;
+  *bucket = cache_obj;
+}
+
+/* add an object to the hashtable */
+static inline void add_to_table(hashtable_t *hashtable, cache_obj_t *cache_obj) {
+  uint64_t hv = get_hash_value_int_64(&cache_obj->obj_id);
+  add_to_bucket(_get_bucket(hashtable, hv), cache_obj);
 
 #ifdef HASHTABLE_DEBUG
   cache_obj_t *curr_obj = cache_obj->hash_next;
@@ -103,6 +132,7 @@ hashtable_t *create_chained_hashtable_v2(const uint16_t hashpower) {
 #endif
   hashtable->external_obj = false;
   hashtable->hashpower = hashpower;
+  hashtable->min_hashpower = hashpower;
   hashtable->n_obj = 0;
   return hashtable;
 }
@@ -110,15 +140,19 @@ hashtable_t *create_chained_hashtable_v2(const uint16_t hashpower) {
 cache_obj_t *chained_hashtable_find_obj_id_v2(const hashtable_t *hashtable, const obj_id_t obj_id) {
   cache_obj_t *cache_obj = NULL;
   uint64_t hv = get_hash_value_int_64(&obj_id);
-  hv = hv & hashmask(hashtable->hashpower);
-  cache_obj = hashtable->ptr_table[hv];
+  cache_obj = *_get_bucket(hashtable, hv);
 
+  /* optimized out if ENABLE_CACHE_OP_STAT is not defined */
+  int64_t chain_len = 0;
   while (cache_obj) {
+    chain_len += 1;
     if (cache_obj->obj_id == obj_id) {
+      RECORD_LOOKUP(hashtable, chain_len);
       return cache_obj;
     }
     cache_obj = cache_obj->hash_next;
   }
+  RECORD_LOOKUP(hashtable, chain_len);
   return cache_obj;
 }
 
@@ -130,11 +164,26 @@ cache_obj_t *chained_hashtable_find_obj_v2(const hashtable_t *hashtable, const c
   return chained_hashtable_find_obj_id_v2(hashtable, obj_to_find->obj_id);
 }
 
-/* the user needs to make sure the added object is not in the hash table */
-cache_obj_t *chained_hashtable_insert_v2(hashtable_t *hashtable, const request_t *req) {
+/* called after each insert and delete, it moves some buckets if the hash
+ * table is resizing, and starts a resize if the load crosses a threshold */
+static inline void _maybe_resize(hashtable_t *hashtable) {
+  if (unlikely(hashtable->old_ptr_table != NULL)) {
+    _rehash_step(hashtable, CHAINED_HASHTABLE_REHASH_STEP);
+  }
+
+  if (hashtable->in_foreach) return;
+
   if (hashtable->n_obj > (uint64_t)(hashsize(hashtable->hashpower) * CHAINED_HASHTABLE_EXPAND_THRESHOLD)) {
     _chained_hashtable_expand_v2(hashtable);
+  } else if (hashtable->hashpower > hashtable->min_hashpower && hashtable->old_ptr_table == NULL &&
+             hashtable->n_obj < (uint64_t)(hashsize(hashtable->hashpower) * CHAINED_HASHTABLE_SHRINK_THRESHOLD)) {
+    _chained_hashtable_shrink_v2(hashtable);
   }
+}
+
+/* the user needs to make sure the added object is not in the hash table */
+cache_obj_t *chained_hashtable_insert_v2(hashtable_t *hashtable, const request_t *req) {
+  _maybe_resize(hashtable);
 
   cache_obj_t *new_cache_obj = create_cache_obj_from_request(req);
   add_to_table(hashtable, new_cache_obj);
@@ -145,8 +194,7 @@ cache_obj_t *chained_hashtable_insert_v2(hashtable_t *hashtable, const request_t
 /* the user needs to make sure the added object is not in the hash table */
 cache_obj_t *chained_hashtable_insert_obj_v2(hashtable_t *hashtable, cache_obj_t *cache_obj) {
   DEBUG_ASSERT(hashtable->external_obj);
-  if (hashtable->n_obj > (uint64_t)(hashsize(hashtable->hashpower) * CHAINED_HASHTABLE_EXPAND_THRESHOLD))
-    _chained_hashtable_expand_v2(hashtable);
+  _maybe_resize(hashtable);
 
   add_to_table(hashtable, cache_obj);
   hashtable->n_obj += 1;
@@ -156,16 +204,17 @@ cache_obj_t *chained_hashtable_insert_obj_v2(hashtable_t *hashtable, cache_obj_t
 /* you need to free the extra_metadata before deleting from hash table */
 void chained_hashtable_delete_v2(hashtable_t *hashtable, cache_obj_t *cache_obj) {
   hashtable->n_obj -= 1;
-  uint64_t hv = get_hash_value_int_64(&cache_obj->obj_id) & hashmask(hashtable->hashpower);
-  if (hashtable->ptr_table[hv] == cache_obj) {
-    hashtable->ptr_table[hv] = cache_obj->hash_next;
+  cache_obj_t **bucket = _get_bucket(hashtable, get_hash_value_int_64(&cache_obj->obj_id));
+  if (*bucket == cache_obj) {
+    *bucket = cache_obj->hash_next;
     if (!hashtable->external_obj) free_cache_obj(cache_obj);
+    _maybe_resize(hashtable);
     return;
   }
 
   static int max_chain_len = 64;
   int chain_len = 1;
-  cache_obj_t *cur_obj = hashtable->ptr_table[hv];
+  cache_obj_t *cur_obj = *bucket;
   while (cur_obj != NULL && cur_obj->hash_next != cache_obj) {
     cur_obj = cur_obj->hash_next;
     chain_len += 1;
@@ -186,21 +235,23 @@ void chained_hashtable_delete_v2(hashtable_t *hashtable, cache_obj_t *cache_obj)
   if (!hashtable->external_obj) {
     free_cache_obj(cache_obj);
   }
+  _maybe_resize(hashtable);
 }
 
 bool chained_hashtable_try_delete_v2(hashtable_t *hashtable, cache_obj_t *cache_obj) {
   static int max_chain_len = 1;
 
-  uint64_t hv = get_hash_value_int_64(&cache_obj->obj_id) & hashmask(hashtable->hashpower);
-  if (hashtable->ptr_table[hv] == cache_obj) {
-    hashtable->ptr_table[hv] = cache_obj->hash_next;
+  cache_obj_t **bucket = _get_bucket(hashtable, get_hash_value_int_64(&cache_obj->obj_id));
+  if (*bucket == cache_obj) {
+    *bucket = cache_obj->hash_next;
     hashtable->n_obj -= 1;
     if (!hashtable->external_obj) free_cache_obj(cache_obj);
+    _maybe_resize(hashtable);
     return true;
   }
 
   int chain_len = 1;
-  cache_obj_t *cur_obj = hashtable->ptr_table[hv];
+  cache_obj_t *cur_obj = *bucket;
   while (cur_obj != NULL && cur_obj->hash_next != cache_obj) {
     cur_obj = cur_obj->hash_next;
     chain_len += 1;
@@ -229,6 +280,7 @@ bool chained_hashtable_try_delete_v2(hashtable_t *hashtable, cache_obj_t *cache_
     cur_obj->hash_next = cache_obj->hash_next;
     hashtable->n_obj -= 1;
     if (!hashtable->external_obj) free_cache_obj(cache_obj);
+    _maybe_resize(hashtable);
     return true;
   }
   return false;
@@ -249,16 +301,17 @@ bool chained_hashtable_try_delete_v2(hashtable_t *hashtable, cache_obj_t *cache_
  *  @return                                    [true or false]
  */
 bool chained_hashtable_delete_obj_id_v2(hashtable_t *hashtable, const obj_id_t obj_id) {
-  uint64_t hv = get_hash_value_int_64(&obj_id) & hashmask(hashtable->hashpower);
-  cache_obj_t *cur_obj = hashtable->ptr_table[hv];
+  cache_obj_t **bucket = _get_bucket(hashtable, get_hash_value_int_64(&obj_id));
+  cache_obj_t *cur_obj = *bucket;
   // the hash bucket is empty
   if (cur_obj == NULL) return false;
 
   // the object to remove is the first object in the hash bucket
   if (cur_obj->obj_id == obj_id) {
-    hashtable->ptr_table[hv] = cur_obj->hash_next;
+    *bucket = cur_obj->hash_next;
     if (!hashtable->external_obj) free_cache_obj(cur_obj);
     hashtable->n_obj -= 1;
+    _maybe_resize(hashtable);
     return true;
   }
 
@@ -274,39 +327,78 @@ bool chained_hashtable_delete_obj_id_v2(hashtable_t *hashtable, const obj_id_t o
     prev_obj->hash_next = cur_obj->hash_next;
     if (!hashtable->external_obj) free_cache_obj(cur_obj);
     hashtable->n_obj -= 1;
+    _maybe_resize(hashtable);
     return true;
   }
   // the object to remove is not in the hash table
   return false;
 }
 
+/**
+ * @brief get the idx-th object of bucket pos of the new table, when the hash
+ * table is resizing, the bucket also has the objects in the old table that
+ * will be moved to it
+ *
+ * @param idx the position in the bucket, decreased by the number of objects
+ *  in the bucket if the bucket has fewer objects
+ * @return the object or NULL if the bucket has fewer objects
+ */
+static cache_obj_t *_get_obj_in_bucket(const hashtable_t *hashtable, const uint64_t pos, int64_t *idx) {
+  for (cache_obj_t *cur_obj = hashtable->ptr_table[pos]; cur_obj != NULL; cur_obj = cur_obj->hash_next) {
+    if ((*idx)-- == 0) return cur_obj;
+  }
+  if (likely(hashtable->old_ptr_table == NULL)) return NULL;
+
+  bool expanding = hashtable->old_hashpower < hashtable->hashpower;
+  /* an old bucket is split into two buckets when expanding, and two old
+   * buckets are merged when shrinking */
+  uint64_t old_pos = pos & hashmask(hashtable->old_hashpower);
+  uint64_t old_step = expanding ? hashsize(hashtable->old_hashpower) : hashsize(hashtable->hashpower);
+  for (; old_pos < hashsize(hashtable->old_hashpower); old_pos += old_step) {
+    if (old_pos < hashtable->rehash_pos) continue;
+    cache_obj_t *cur_obj = hashtable->old_ptr_table[old_pos];
+    for (; cur_obj != NULL; cur_obj = cur_obj->hash_next) {
+      if (expanding && (get_hash_value_int_64(&cur_obj->obj_id) & hashmask(hashtable->hashpower)) != pos) continue;
+      if ((*idx)-- == 0) return cur_obj;
+    }
+  }
+  return NULL;
+}
+
 cache_obj_t *chained_hashtable_rand_obj_v2(hashtable_t *hashtable) {
+  int64_t n_obj_in_bucket;
   uint64_t pos = next_rand() & hashmask(hashtable->hashpower);
   int n_tries = 0;
-  while (hashtable->ptr_table[pos] == NULL) {
+  while (true) {
+    n_obj_in_bucket = INT64_MAX;
+    _get_obj_in_bucket(hashtable, pos, &n_obj_in_bucket);
+    n_obj_in_bucket = INT64_MAX - n_obj_in_bucket;
+    if (n_obj_in_bucket > 0) break;
+
     n_tries += 1;
     if (n_tries > 32) {
-      _chained_hashtable_shrink_v2(hashtable);
+      if (hashtable->old_ptr_table != NULL) {
+        _rehash_step(hashtable, CHAINED_HASHTABLE_REHASH_STEP);
+      } else {
+        _chained_hashtable_shrink_v2(hashtable);
+      }
     }
     pos = next_rand() & hashmask(hashtable->hashpower);
   }
 
-  int n_obj_in_bucket = 1;
-  cache_obj_t *cur_obj = hashtable->ptr_table[pos];
-  while (cur_obj->hash_next) {
-    cur_obj = cur_obj->hash_next;
-    n_obj_in_bucket += 1;
-  }
-  int rand_pos = next_rand() % n_obj_in_bucket;
-  cur_obj = hashtable->ptr_table[pos];
-  for (int i = 0; i < rand_pos; i++) {
-    cur_obj = cur_obj->hash_next;
-  }
-
-  return cur_obj;
+  int64_t rand_pos = next_rand() % n_obj_in_bucket;
+  return _get_obj_in_bucket(hashtable, pos, &rand_pos);
 }
 
 void chained_hashtable_foreach_v2(hashtable_t *hashtable, hashtable_iter iter_func, void *user_data) {
+  /* finish the resize so that each object is visited once */
+  if (hashtable->old_ptr_table != NULL) {
+    _rehash_step(hashtable, hashsize(hashtable->old_hashpower));
+  }
+
+  /* iter_func may delete the object, which must not move the objects */
+  bool in_foreach = hashtable->in_foreach;
+  hashtable->in_foreach = true;
   cache_obj_t *cur_obj, *next_obj;
   for (uint64_t i = 0; i < hashsize(hashtable->hashpower); i++) {
     cur_obj = hashtable->ptr_table[i];
@@ -316,68 +408,93 @@ void chained_hashtable_foreach_v2(hashtable_t *hashtable, hashtable_iter iter_fu
       cur_obj = next_obj;
     }
   }
+  hashtable->in_foreach = in_foreach;
 }
 
 void free_chained_hashtable_v2(hashtable_t *hashtable) {
   if (!hashtable->external_obj) chained_hashtable_foreach_v2(hashtable, foreach_free_obj, NULL);
+  if (hashtable->old_ptr_table != NULL) {
+    my_free(sizeof(cache_obj_t *) * hashsize(hashtable->old_hashpower), hashtable->old_ptr_table);
+  }
   my_free(sizeof(cache_obj_t *) * hashsize(hashtable->hashpower), hashtable->ptr_table);
   my_free(sizeof(hashtable_t), hashtable);
 }
 
 /**
- * @brief copy the entries from the old_table to the new_table
+ * @brief move n_bucket buckets of the old table to the new table,
+ * the old table is freed when all buckets are moved
  *
- * @param new_table
- * @param old_table
- * @param old_size
- * @return * void
+ * @param hashtable
+ * @param n_bucket
  */
-static void _copy_entries(hashtable_t *new_table, cache_obj_t **old_table, uint64_t old_size) {
+static void _rehash_step(hashtable_t *hashtable, uint64_t n_bucket) {
+  uint64_t old_size = hashsize(hashtable->old_hashpower);
+  uint64_t end = MIN(hashtable->rehash_pos + n_bucket, old_size);
   cache_obj_t *cur_obj, *next_obj;
-  for (uint64_t i = 0; i < old_size; i++) {
-    cur_obj = old_table[i];
+  for (uint64_t i = hashtable->rehash_pos; i < end; i++) {
+    cur_obj = hashtable->old_ptr_table[i];
     while (cur_obj != NULL) {
       next_obj = cur_obj->hash_next;
       cur_obj->hash_next = NULL;
-      add_to_table(new_table, cur_obj);
+      uint64_t hv = get_hash_value_int_64(&cur_obj->obj_id) & hashmask(hashtable->hashpower);
+      add_to_bucket(&hashtable->ptr_table[hv], cur_obj);
       cur_obj = next_obj;
     }
+    hashtable->old_ptr_table[i] = NULL;
+  }
+  hashtable->rehash_pos = end;
+
+  if (end == old_size) {
+    my_free(sizeof(cache_obj_t *) * old_size, hashtable->old_ptr_table);
+    hashtable->old_ptr_table = NULL;
+    hashtable->rehash_pos = 0;
   }
 }
 
-static void _chained_hashtable_shrink_v2(hashtable_t *hashtable) {
-  cache_obj_t **old_table = hashtable->ptr_table;
-  hashtable->ptr_table = my_malloc_n(cache_obj_t *, hashsize(--hashtable->hashpower));
+/**
+ * @brief allocate a table of the new size, the objects are moved to the new
+ * table by the following inserts and deletes
+ *
+ * @param hashtable
+ * @param new_hashpower
+ */
+static void _start_resize(hashtable_t *hashtable, const uint16_t new_hashpower) {
+  /* the previous resize has not finished */
+  if (hashtable->old_ptr_table != NULL) {
+    _rehash_step(hashtable, hashsize(hashtable->old_hashpower));
+  }
+
+  cache_obj_t **new_table = my_malloc_n(cache_obj_t *, hashsize(new_hashpower));
+  ASSERT_NOT_NULL(new_table, "unable to resize hashtable to size %llu\n", hashsizeULL(new_hashpower));
 #ifdef USE_HUGEPAGE
-  madvise(hashtable->table, sizeof(cache_obj_t *) * hashsize(hashtable->hashpower), MADV_HUGEPAGE);
+  madvise(new_table, sizeof(cache_obj_t *) * hashsize(new_hashpower), MADV_HUGEPAGE);
 #endif
-  memset(hashtable->ptr_table, 0, hashsize(hashtable->hashpower) * sizeof(cache_obj_t *));
-  ASSERT_NOT_NULL(hashtable->ptr_table, "unable to shrink hashtable to size %llu\n", hashsizeULL(hashtable->hashpower));
+  memset(new_table, 0, hashsize(new_hashpower) * sizeof(cache_obj_t *));
+
+  hashtable->old_ptr_table = hashtable->ptr_table;
+  hashtable->old_hashpower = hashtable->hashpower;
+  hashtable->rehash_pos = 0;
+  hashtable->ptr_table = new_table;
+  hashtable->hashpower = new_hashpower;
+}
+
+static void _chained_hashtable_shrink_v2(hashtable_t *hashtable) {
+  RECORD_RESIZE(hashtable, n_shrink);
+  _start_resize(hashtable, hashtable->hashpower - 1);
 
   DEBUG("shrink hash table size from %llu to %llu, new hashtable load %lu/%lu\n",
-        hashsizeULL((uint16_t)(hashtable->hashpower + 1)), hashsizeULL(hashtable->hashpower), hashtable->n_obj,
+        hashsizeULL(hashtable->old_hashpower), hashsizeULL(hashtable->hashpower), hashtable->n_obj,
         hashsize(hashtable->hashpower));
-
-  _copy_entries(hashtable, old_table, hashsize(hashtable->hashpower + 1));
-  my_free(sizeof(cache_obj_t) * hashsize(hashtable->hashpower + 1), old_table);
 }
 
 /* grows the hashtable to the next power of 2. */
 static void _chained_hashtable_expand_v2(hashtable_t *hashtable) {
-  cache_obj_t **old_table = hashtable->ptr_table;
-  hashtable->ptr_table = my_malloc_n(cache_obj_t *, hashsize(++hashtable->hashpower));
-#ifdef USE_HUGEPAGE
-  madvise(hashtable->table, sizeof(cache_obj_t *) * hashsize(hashtable->hashpower), MADV_HUGEPAGE);
-#endif
-  memset(hashtable->ptr_table, 0, hashsize(hashtable->hashpower) * sizeof(cache_obj_t *));
-  ASSERT_NOT_NULL(hashtable->ptr_table, "unable to grow hashtable to size %llu\n", hashsizeULL(hashtable->hashpower));
+  RECORD_RESIZE(hashtable, n_expand);
+  _start_resize(hashtable, hashtable->hashpower + 1);
 
   DEBUG("expand hashtable from %llu to %llu entries, new hashtable load %lu/%lu\n",
-        hashsizeULL((uint16_t)(hashtable->hashpower - 1)), hashsizeULL(hashtable->hashpower), hashtable->n_obj,
+        hashsizeULL(hashtable->old_hashpower), hashsizeULL(hashtable->hashpower), hashtable->n_obj,
         hashsize(hashtable->hashpower));
-
-  _copy_entries(hashtable, old_table, hashsize(hashtable->hashpower - 1));
-  my_free(sizeof(cache_obj_t) * hashsize(hashtable->hashpower), old_table);
 }
 
 void check_hashtable_integrity_v2(const hashtable_t *hashtable) {
@@ -387,6 +504,18 @@ void check_hashtable_integrity_v2(const hashtable_t *hashtable) {
     while (cur_obj != NULL) {
       next_obj = cur_obj->hash_next;
       assert(i == (get_hash_value_int_64(&cur_obj->obj_id) & hashmask(hashtable->hashpower)));
+      assert(_get_bucket(hashtable, get_hash_value_int_64(&cur_obj->obj_id)) == &hashtable->ptr_table[i]);
+      cur_obj = next_obj;
+    }
+  }
+
+  if (hashtable->old_ptr_table == NULL) return;
+  for (uint64_t i = 0; i < hashsize(hashtable->old_hashpower); i++) {
+    cur_obj = hashtable->old_ptr_table[i];
+    assert(i >= hashtable->rehash_pos || cur_obj == NULL);
+    while (cur_obj != NULL) {
+      next_obj = cur_obj->hash_next;
+      assert(i == (get_hash_value_int_64(&cur_obj->obj_id) & hashmask(hashtable->old_hashpower)));
       cur_obj = next_obj;
     }
   }
@@ -442,6 +571,20 @@ void print_chained_hashtable_v2(const hashtable_t *hashtable) {
     }
     printf("\n");
   }
+
+  if (hashtable->old_ptr_table == NULL) return;
+  for (uint64_t i = hashtable->rehash_pos; i < hashsize(hashtable->old_hashpower); i++) {
+    cache_obj_t *cur_obj = hashtable->old_ptr_table[i];
+    if (cur_obj == NULL) {
+      continue;
+    }
+    printf("old hash bucket %lu: ", (unsigned long)i);
+    while (cur_obj != NULL) {
+      printf("%lu, ", (unsigned long)cur_obj->obj_id);
+      cur_obj = cur_obj->hash_next;
+    }
+    printf("\n");
+  }
 }
 
 #ifdef __cplusplus
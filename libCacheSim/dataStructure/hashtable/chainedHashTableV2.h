@@ -37,6 +37,9 @@ cache_obj_t *chained_hashtable_insert_obj_v2(hashtable_t *hashtable,
 bool chained_hashtable_try_delete_v2(hashtable_t *hashtable,
                                      cache_obj_t *cache_obj);
 
+bool chained_hashtable_delete_obj_id_v2(hashtable_t *hashtable,
+                                        const obj_id_t obj_id);
+
 void chained_hashtable_delete_v2(hashtable_t *hashtable,
                                  cache_obj_t *cache_obj);
 
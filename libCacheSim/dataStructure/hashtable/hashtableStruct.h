@@ -29,6 +29,17 @@ typedef struct hashtable {
   uint16_t hashpower;
   bool external_obj; /* whether the object should be allocated by hash table,
                         this should be true most of the time */
+  /* used by hashtable V2 for incremental resizing, the objects are moved
+   * from old_ptr_table to ptr_table a few buckets at a time, the buckets of
+   * old_ptr_table before rehash_pos have been moved, old_ptr_table is NULL
+   * when the hash table is not resizing */
+  cache_obj_t **old_ptr_table;
+  uint64_t rehash_pos;
+  uint16_t old_hashpower;
+  /* the hash table does not shrink below the initial size */
+  uint16_t min_hashpower;
+  /* a resize does not start during foreach */
+  bool in_foreach;
   union {
     // used for hashtable V1, these cache_obj pointers are used by external
     // modules, so if hashtable needs to move the obj, their pointer need to be
@@ -40,6 +51,14 @@ typedef struct hashtable {
     };
     void *extra_data;
   };
+#ifdef ENABLE_CACHE_OP_STAT
+  /* lookup and resizing stat, see cacheOpStat.h */
+  int64_t n_lookup;
+  int64_t n_lookup_step;
+  int64_t max_chain_len;
+  int64_t n_expand;
+  int64_t n_shrink;
+#endif
 } hashtable_t;
 
 #ifdef __cplusplus
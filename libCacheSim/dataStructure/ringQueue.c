@@ -0,0 +1,110 @@
+//
+// a circular array queue of objects, see ringQueue.h
+//
+// ringQueue.c
+// libCacheSim
+//
+
+#include "ringQueue.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "../include/libCacheSim/logging.h"
+#include "../include/libCacheSim/macro.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define RING_QUEUE_INIT_CAPACITY 1024
+
+static cache_obj_t **alloc_slots(int64_t capacity) {
+  cache_obj_t **slots = calloc(capacity, sizeof(cache_obj_t *));
+  if (slots == NULL) {
+    ERROR("ring queue cannot allocate %ld slots\n", (long)capacity);
+  }
+  return slots;
+}
+
+ring_queue_t *create_ring_queue(void) {
+  ring_queue_t *rq = malloc(sizeof(ring_queue_t));
+  memset(rq, 0, sizeof(ring_queue_t));
+  rq->capacity = RING_QUEUE_INIT_CAPACITY;
+  rq->slots = alloc_slots(rq->capacity);
+  return rq;
+}
+
+void free_ring_queue(ring_queue_t *rq) {
+  free(rq->slots);
+  free(rq);
+}
+
+/* move the objects to consecutive positions starting from head, the array
+ * is doubled if more than half of the slots are live */
+static void compact(ring_queue_t *rq) {
+  const int64_t old_mask = rq->capacity - 1;
+  cache_obj_t **new_slots = rq->slots;
+  int64_t new_mask = old_mask;
+  if (rq->n_obj * 2 > rq->capacity) {
+    new_slots = alloc_slots(rq->capacity * 2);
+    new_mask = rq->capacity * 2 - 1;
+  }
+
+  /* in place, the write position never passes the read position */
+  int64_t pos = rq->head;
+  for (int64_t p = rq->head; p < rq->tail; p++) {
+    cache_obj_t *obj = rq->slots[p & old_mask];
+    if (obj == NULL) continue;
+    if (new_slots == rq->slots) rq->slots[p & old_mask] = NULL;
+    new_slots[pos & new_mask] = obj;
+    obj->ring_pos = pos;
+    pos++;
+  }
+  DEBUG_ASSERT(pos - rq->head == rq->n_obj);
+
+  if (new_slots != rq->slots) {
+    free(rq->slots);
+    rq->slots = new_slots;
+    rq->capacity = new_mask + 1;
+  }
+  rq->tail = pos;
+}
+
+void ring_queue_push(ring_queue_t *rq, cache_obj_t *obj) {
+  if (unlikely(rq->tail - rq->head == rq->capacity)) {
+    compact(rq);
+  }
+
+  rq->slots[rq->tail & (rq->capacity - 1)] = obj;
+  obj->ring_pos = rq->tail;
+  rq->tail += 1;
+  rq->n_obj += 1;
+}
+
+void ring_queue_remove(ring_queue_t *rq, cache_obj_t *obj) {
+  const int64_t mask = rq->capacity - 1;
+  DEBUG_ASSERT(obj->ring_pos >= rq->head && obj->ring_pos < rq->tail);
+  DEBUG_ASSERT(rq->slots[obj->ring_pos & mask] == obj);
+
+  rq->slots[obj->ring_pos & mask] = NULL;
+  rq->n_obj -= 1;
+
+  /* trim the tombstones at both ends */
+  while (rq->head < rq->tail && rq->slots[rq->head & mask] == NULL) {
+    rq->head += 1;
+  }
+  while (rq->tail > rq->head && rq->slots[(rq->tail - 1) & mask] == NULL) {
+    rq->tail -= 1;
+  }
+
+  /* the queue is compacted after at least n_obj / 2 removals, so the cost
+   * is amortized */
+  if (unlikely(rq->tail - rq->head > rq->n_obj * 2)) {
+    compact(rq);
+  }
+}
+
+#ifdef __cplusplus
+}
+#endif
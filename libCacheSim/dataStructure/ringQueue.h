@@ -0,0 +1,95 @@
+//
+// a FIFO-order queue of objects kept in a circular array, it is used by the
+// FIFO-family algorithms in place of the doubly linked list in
+// cache_obj_t.queue, so the queue can be scanned sequentially and an object
+// only stores its position (cache_obj_t.ring_pos) instead of two pointers
+//
+// the objects are pushed at the newest end, removing an object leaves a
+// tombstone (NULL) in its slot, the tombstones at both ends are trimmed
+// immediately, so the oldest and the newest slots are always live, and the
+// tombstones in the middle are compacted when the array is full or when they
+// are more than half of the slots between the oldest and the newest object,
+// so a scan with ring_queue_newer or ring_queue_older skips at most as many
+// tombstones as it visits objects
+//
+// ringQueue.h
+// libCacheSim
+//
+
+#ifndef RING_QUEUE_H
+#define RING_QUEUE_H
+
+#include <stdint.h>
+
+#include "../include/libCacheSim/cacheObj.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct ring_queue {
+  cache_obj_t **slots;
+  /* a power of 2 */
+  int64_t capacity;
+  /* positions increase monotonically and position p is stored at
+   * slots[p & (capacity - 1)], the objects are at [head, tail) */
+  int64_t head;
+  int64_t tail;
+  int64_t n_obj;
+} ring_queue_t;
+
+ring_queue_t *create_ring_queue(void);
+
+void free_ring_queue(ring_queue_t *rq);
+
+/**
+ * @brief add an object as the newest object, this may compact the queue or
+ * grow the array, which changes the ring_pos of the objects
+ */
+void ring_queue_push(ring_queue_t *rq, cache_obj_t *obj);
+
+/**
+ * @brief remove an object from the queue, the object must be in the queue,
+ * this may compact the queue, which changes the ring_pos of the objects
+ */
+void ring_queue_remove(ring_queue_t *rq, cache_obj_t *obj);
+
+static inline cache_obj_t *ring_queue_oldest(const ring_queue_t *rq) {
+  return rq->n_obj == 0 ? NULL : rq->slots[rq->head & (rq->capacity - 1)];
+}
+
+static inline cache_obj_t *ring_queue_newest(const ring_queue_t *rq) {
+  return rq->n_obj == 0 ? NULL : rq->slots[(rq->tail - 1) & (rq->capacity - 1)];
+}
+
+/**
+ * @brief the next newer object, which is obj->queue.prev in the list
+ *
+ * @return NULL if obj is the newest object
+ */
+static inline cache_obj_t *ring_queue_newer(const ring_queue_t *rq, const cache_obj_t *obj) {
+  const int64_t mask = rq->capacity - 1;
+  for (int64_t p = obj->ring_pos + 1; p < rq->tail; p++) {
+    if (rq->slots[p & mask] != NULL) return rq->slots[p & mask];
+  }
+  return NULL;
+}
+
+/**
+ * @brief the next older object, which is obj->queue.next in the list
+ *
+ * @return NULL if obj is the oldest object
+ */
+static inline cache_obj_t *ring_queue_older(const ring_queue_t *rq, const cache_obj_t *obj) {
+  const int64_t mask = rq->capacity - 1;
+  for (int64_t p = obj->ring_pos - 1; p >= rq->head; p--) {
+    if (rq->slots[p & mask] != NULL) return rq->slots[p & mask];
+  }
+  return NULL;
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* RING_QUEUE_H */
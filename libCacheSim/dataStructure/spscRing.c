@@ -0,0 +1,105 @@
+//
+// a single-producer single-consumer ring buffer of requests, see spscRing.h
+//
+// spscRing.c
+// libCacheSim
+//
+
+#include "spscRing.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "../include/libCacheSim/logging.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+void spsc_waiter_init(spsc_waiter_t *waiter) {
+  atomic_store_explicit(&waiter->sleeping, false, memory_order_relaxed);
+  pthread_mutex_init(&waiter->mutex, NULL);
+  pthread_cond_init(&waiter->cond, NULL);
+}
+
+void spsc_waiter_free(spsc_waiter_t *waiter) {
+  pthread_mutex_destroy(&waiter->mutex);
+  pthread_cond_destroy(&waiter->cond);
+}
+
+void spsc_waiter_wait(spsc_waiter_t *waiter, bool (*has_work)(void *), void *arg) {
+  pthread_mutex_lock(&waiter->mutex);
+  atomic_store_explicit(&waiter->sleeping, true, memory_order_relaxed);
+  atomic_thread_fence(memory_order_seq_cst);
+  while (!has_work(arg)) {
+    pthread_cond_wait(&waiter->cond, &waiter->mutex);
+  }
+  atomic_store_explicit(&waiter->sleeping, false, memory_order_relaxed);
+  pthread_mutex_unlock(&waiter->mutex);
+}
+
+void spsc_waiter_stop(spsc_waiter_t *waiter, _Atomic bool *stop) {
+  pthread_mutex_lock(&waiter->mutex);
+  atomic_store_explicit(stop, true, memory_order_release);
+  pthread_cond_signal(&waiter->cond);
+  pthread_mutex_unlock(&waiter->mutex);
+}
+
+void spsc_waiter_wake(spsc_waiter_t *waiter) {
+  pthread_mutex_lock(&waiter->mutex);
+  pthread_cond_signal(&waiter->cond);
+  pthread_mutex_unlock(&waiter->mutex);
+}
+
+void spsc_ring_init(spsc_ring_t *ring) {
+  memset(ring, 0, sizeof(spsc_ring_t));
+  ring->reqs = malloc(sizeof(spsc_req_t) * SPSC_RING_SIZE);
+  if (ring->reqs == NULL) {
+    ERROR("cannot allocate the ring of %d requests\n", SPSC_RING_SIZE);
+  }
+  spsc_waiter_init(&ring->own_waiter);
+  ring->waiter = &ring->own_waiter;
+}
+
+void spsc_ring_free(spsc_ring_t *ring) {
+  spsc_waiter_free(&ring->own_waiter);
+  free(ring->reqs);
+  ring->reqs = NULL;
+}
+
+void spsc_ring_reset(spsc_ring_t *ring) {
+  atomic_store_explicit(&ring->head, 0, memory_order_relaxed);
+  atomic_store_explicit(&ring->tail, 0, memory_order_relaxed);
+  ring->local_tail = 0;
+  ring->cached_head = 0;
+}
+
+void spsc_ring_set_waiter(spsc_ring_t *ring, spsc_waiter_t *waiter) {
+  ring->waiter = waiter == NULL ? &ring->own_waiter : waiter;
+}
+
+typedef struct {
+  spsc_ring_t *ring;
+  uint64_t head;
+  const _Atomic bool *stop;
+} spsc_ring_wait_arg_t;
+
+static bool spsc_ring_has_work(void *arg) {
+  spsc_ring_wait_arg_t *w = (spsc_ring_wait_arg_t *)arg;
+  return w->head != atomic_load_explicit(&w->ring->tail, memory_order_acquire) ||
+         atomic_load_explicit(w->stop, memory_order_acquire);
+}
+
+void spsc_ring_wait(spsc_ring_t *ring, uint64_t head, const _Atomic bool *stop) {
+  spsc_ring_wait_arg_t arg = {.ring = ring, .head = head, .stop = stop};
+  spsc_waiter_wait(ring->waiter, spsc_ring_has_work, &arg);
+}
+
+void spsc_ring_stop(spsc_ring_t *ring, _Atomic bool *stop) {
+  spsc_ring_publish(ring);
+  spsc_waiter_stop(ring->waiter, stop);
+}
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,214 @@
+//
+// a single-producer single-consumer ring buffer of requests, it is used to
+// send the requests of a trace to the worker threads of a parallel
+// simulation (the shards of the Sharded cache, the servers of a cluster),
+// each ring has one producer and is drained by one worker in order, so no
+// lock is needed
+//
+// the producer writes the requests at local_tail and publishes them in
+// batches to reduce the cache line transfers between the threads, and the
+// consumer advances head after processing the published requests, the
+// positions increase monotonically and position p is stored at
+// reqs[p & (SPSC_RING_SIZE - 1)]
+//
+// a consumer that has nothing to do can sleep with spsc_ring_wait, the
+// producer wakes it when it publishes, a consumer that drains several rings
+// makes them share one waiter (spsc_ring_set_waiter) and sleeps with
+// spsc_waiter_wait
+//
+// spscRing.h
+// libCacheSim
+//
+
+#ifndef SPSC_RING_H
+#define SPSC_RING_H
+
+#include <pthread.h>
+#include <sched.h>
+#include <stdatomic.h>
+#include <stdint.h>
+
+#include "../include/libCacheSim/macro.h"
+#include "../include/libCacheSim/request.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* the number of requests in a ring, must be power of 2 */
+#define SPSC_RING_SIZE 4096
+/* the producer publishes the requests in batches */
+#define SPSC_RING_PUBLISH_BATCH 32
+#define SPSC_RING_SPIN_BEFORE_YIELD 256
+
+/* the fields of a request used by the simulation */
+typedef struct {
+  int64_t clock_time;
+  obj_id_t obj_id;
+  int64_t obj_size;
+  int64_t next_access_vtime;
+  int32_t ttl;
+  int32_t tenant_id;
+  uint8_t op;
+  /* whether the result is counted, false for warmup requests */
+  bool record_stat;
+} spsc_req_t;
+
+/* the consumer waits on cond when it has no request, the producer signals
+ * it after publishing if sleeping is set */
+typedef struct {
+  _Atomic bool sleeping __attribute__((aligned(64)));
+  pthread_mutex_t mutex;
+  pthread_cond_t cond;
+} spsc_waiter_t;
+
+typedef struct {
+  /* written by the consumer */
+  _Atomic uint64_t head __attribute__((aligned(64)));
+
+  /* written by the producer */
+  _Atomic uint64_t tail __attribute__((aligned(64)));
+  /* the requests written but not published */
+  uint64_t local_tail;
+  /* the last head read by the producer */
+  uint64_t cached_head;
+
+  /* the waiter of the consumer, own_waiter unless it is shared */
+  spsc_waiter_t *waiter;
+  spsc_waiter_t own_waiter;
+
+  spsc_req_t *reqs;
+} spsc_ring_t;
+
+void spsc_waiter_init(spsc_waiter_t *waiter);
+
+void spsc_waiter_free(spsc_waiter_t *waiter);
+
+/**
+ * @brief the consumer sleeps until has_work returns true, has_work is
+ * checked under the mutex after sleeping is set, so it sees the requests
+ * published to the rings that use the waiter
+ */
+void spsc_waiter_wait(spsc_waiter_t *waiter, bool (*has_work)(void *), void *arg);
+
+/**
+ * @brief set stop under the mutex so that a sleeping consumer does not
+ * miss it
+ */
+void spsc_waiter_stop(spsc_waiter_t *waiter, _Atomic bool *stop);
+
+/* wake up the consumer, used by spsc_ring_publish */
+void spsc_waiter_wake(spsc_waiter_t *waiter);
+
+void spsc_ring_init(spsc_ring_t *ring);
+
+void spsc_ring_free(spsc_ring_t *ring);
+
+/**
+ * @brief empty the ring, no thread can use the ring at the same time
+ */
+void spsc_ring_reset(spsc_ring_t *ring);
+
+/**
+ * @brief wake waiter instead of the waiter of the ring when the producer
+ * publishes, NULL restores the waiter of the ring, it is set before the
+ * consumer starts to drain the ring
+ */
+void spsc_ring_set_waiter(spsc_ring_t *ring, spsc_waiter_t *waiter);
+
+/**
+ * @brief the consumer sleeps until the producer publishes requests after
+ * head or sets stop
+ */
+void spsc_ring_wait(spsc_ring_t *ring, uint64_t head, const _Atomic bool *stop);
+
+/**
+ * @brief publish the pending requests and set stop, stop is set under the
+ * mutex of the ring so that a sleeping consumer does not miss it
+ */
+void spsc_ring_stop(spsc_ring_t *ring, _Atomic bool *stop);
+
+/* the consumer sets sleeping before it checks the tail for the last time and
+ * the producer checks sleeping after it publishes the tail, with a full
+ * fence on both sides, at least one of them sees the store of the other,
+ * so the consumer either finds the requests or is woken up */
+static inline void spsc_ring_publish(spsc_ring_t *ring) {
+  atomic_store_explicit(&ring->tail, ring->local_tail, memory_order_release);
+  atomic_thread_fence(memory_order_seq_cst);
+  if (unlikely(atomic_load_explicit(&ring->waiter->sleeping, memory_order_relaxed))) {
+    spsc_waiter_wake(ring->waiter);
+  }
+}
+
+/**
+ * @brief append a request, wait for the consumer if the ring is full
+ */
+static inline void spsc_ring_push(spsc_ring_t *ring, const request_t *req, bool record_stat) {
+  uint64_t tail = ring->local_tail;
+  if (unlikely(tail - ring->cached_head >= SPSC_RING_SIZE)) {
+    /* publish the pending requests and wait for the consumer */
+    spsc_ring_publish(ring);
+    int n_spin = 0;
+    while (tail - (ring->cached_head = atomic_load_explicit(&ring->head, memory_order_acquire)) >=
+           SPSC_RING_SIZE) {
+      if (++n_spin > SPSC_RING_SPIN_BEFORE_YIELD) sched_yield();
+    }
+  }
+
+  spsc_req_t *r = &ring->reqs[tail & (SPSC_RING_SIZE - 1)];
+  r->clock_time = req->clock_time;
+  r->obj_id = req->obj_id;
+  r->obj_size = req->obj_size;
+  r->next_access_vtime = req->next_access_vtime;
+  r->ttl = req->ttl;
+  r->tenant_id = req->tenant_id;
+  r->op = (uint8_t)req->op;
+  r->record_stat = record_stat;
+
+  ring->local_tail = tail + 1;
+  if ((ring->local_tail & (SPSC_RING_PUBLISH_BATCH - 1)) == 0) {
+    spsc_ring_publish(ring);
+  }
+}
+
+/**
+ * @brief publish the pending requests and wait until the consumer processes
+ * all requests
+ */
+static inline void spsc_ring_flush(spsc_ring_t *ring) {
+  spsc_ring_publish(ring);
+  int n_spin = 0;
+  while (atomic_load_explicit(&ring->head, memory_order_acquire) != ring->local_tail) {
+    if (++n_spin > SPSC_RING_SPIN_BEFORE_YIELD) sched_yield();
+  }
+  ring->cached_head = ring->local_tail;
+}
+
+/* the position after the last published request */
+static inline uint64_t spsc_ring_published(spsc_ring_t *ring) {
+  return atomic_load_explicit(&ring->tail, memory_order_acquire);
+}
+
+/* the results of the requests before head are visible to the producer after
+ * it reads head */
+static inline void spsc_ring_consume(spsc_ring_t *ring, uint64_t head) {
+  atomic_store_explicit(&ring->head, head, memory_order_release);
+}
+
+static inline void spsc_req_to_req(const spsc_req_t *r, request_t *req) {
+  req->clock_time = r->clock_time;
+  req->obj_id = r->obj_id;
+  req->obj_size = r->obj_size;
+  req->next_access_vtime = r->next_access_vtime;
+  req->ttl = r->ttl;
+  req->tenant_id = r->tenant_id;
+  req->op = (req_op_e)r->op;
+  req->hv = 0;
+  req->valid = true;
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* SPSC_RING_H */
@@ -0,0 +1,131 @@
+//
+// a hierarchical timing wheel, see timerWheel.h
+//
+// timerWheel.c
+// libCacheSim
+//
+
+#include "timerWheel.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "../include/libCacheSim/logging.h"
+#include "../include/libCacheSim/macro.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define TIMER_WHEEL_SLOT_MASK (TIMER_WHEEL_N_SLOT - 1)
+
+timer_wheel_t *create_timer_wheel(int64_t start_time) {
+  timer_wheel_t *wheel = malloc(sizeof(timer_wheel_t));
+  memset(wheel, 0, sizeof(timer_wheel_t));
+  wheel->curr_time = start_time;
+  return wheel;
+}
+
+void free_timer_wheel(timer_wheel_t *wheel) {
+  for (int level = 0; level < TIMER_WHEEL_N_LEVEL; level++) {
+    for (int i = 0; i < TIMER_WHEEL_N_SLOT; i++) {
+      free(wheel->slots[level][i].entries);
+    }
+  }
+  free(wheel);
+}
+
+static void slot_push(timer_wheel_slot_t *slot, timer_wheel_entry_t entry) {
+  if (slot->n_entry == slot->capacity) {
+    slot->capacity = MAX(slot->capacity * 2, 8);
+    slot->entries = realloc(slot->entries, sizeof(timer_wheel_entry_t) * slot->capacity);
+    if (slot->entries == NULL) {
+      ERROR("timer wheel cannot allocate %u entries\n", slot->capacity);
+    }
+  }
+  slot->entries[slot->n_entry++] = entry;
+}
+
+/* an entry expires at deadline, it is placed at the lowest level whose slots
+ * cover the distance to curr_time, the distance is 0 only when an entry is
+ * moved down at its deadline */
+static void place_entry(timer_wheel_t *wheel, timer_wheel_entry_t entry, int64_t deadline) {
+  DEBUG_ASSERT(deadline >= wheel->curr_time);
+  uint64_t delta = (uint64_t)(deadline - wheel->curr_time);
+
+  int level = 0;
+  while (level < TIMER_WHEEL_N_LEVEL - 1 && delta >> (TIMER_WHEEL_LEVEL_BITS * (level + 1)) != 0) {
+    level++;
+  }
+  uint32_t idx = (uint32_t)(deadline >> (TIMER_WHEEL_LEVEL_BITS * level)) & TIMER_WHEEL_SLOT_MASK;
+  slot_push(&wheel->slots[level][idx], entry);
+  wheel->n_level_entry[level] += 1;
+}
+
+void timer_wheel_add(timer_wheel_t *wheel, obj_id_t obj_id, uint32_t exp_time) {
+  timer_wheel_entry_t entry = {.obj_id = obj_id, .exp_time = exp_time};
+  /* an object expires when the time is larger than exp_time, the current
+   * time has been processed, so an object that has expired is expired at the
+   * next time unit */
+  int64_t deadline = MAX((int64_t)exp_time + 1, wheel->curr_time + 1);
+  place_entry(wheel, entry, deadline);
+  wheel->n_entry += 1;
+}
+
+/* move the entries of a slot to the lower levels */
+static void cascade(timer_wheel_t *wheel, int level, uint32_t idx) {
+  timer_wheel_slot_t old = wheel->slots[level][idx];
+  memset(&wheel->slots[level][idx], 0, sizeof(timer_wheel_slot_t));
+  wheel->n_level_entry[level] -= old.n_entry;
+
+  for (uint32_t i = 0; i < old.n_entry; i++) {
+    int64_t deadline = MAX((int64_t)old.entries[i].exp_time + 1, wheel->curr_time);
+    place_entry(wheel, old.entries[i], deadline);
+  }
+
+  /* reuse the memory, an entry never moves back to the slot */
+  DEBUG_ASSERT(wheel->slots[level][idx].n_entry == 0);
+  old.n_entry = 0;
+  wheel->slots[level][idx] = old;
+}
+
+void timer_wheel_advance(timer_wheel_t *wheel, int64_t curr_time, timer_wheel_expire_func_ptr expire_func,
+                         void *user_data) {
+  while (wheel->curr_time < curr_time) {
+    if (wheel->n_entry == 0) {
+      wheel->curr_time = curr_time;
+      return;
+    }
+
+    /* nothing expires before the next wrap around of the lowest level */
+    if (wheel->n_level_entry[0] == 0) {
+      wheel->curr_time = MIN(curr_time, wheel->curr_time | TIMER_WHEEL_SLOT_MASK);
+      if (wheel->curr_time == curr_time) return;
+    }
+
+    int64_t t = ++wheel->curr_time;
+
+    /* the slots of the higher levels are moved down when all lower levels
+     * wrap around */
+    int level = 0;
+    while (level < TIMER_WHEEL_N_LEVEL - 1 && (t & ((1LL << (TIMER_WHEEL_LEVEL_BITS * (level + 1))) - 1)) == 0) {
+      level++;
+    }
+    for (; level > 0; level--) {
+      cascade(wheel, level, (uint32_t)(t >> (TIMER_WHEEL_LEVEL_BITS * level)) & TIMER_WHEEL_SLOT_MASK);
+    }
+
+    timer_wheel_slot_t *slot = &wheel->slots[0][t & TIMER_WHEEL_SLOT_MASK];
+    for (uint32_t i = 0; i < slot->n_entry; i++) {
+      DEBUG_ASSERT((int64_t)slot->entries[i].exp_time < t);
+      expire_func(slot->entries[i].obj_id, slot->entries[i].exp_time, user_data);
+    }
+    wheel->n_entry -= slot->n_entry;
+    wheel->n_level_entry[0] -= slot->n_entry;
+    slot->n_entry = 0;
+  }
+}
+
+#ifdef __cplusplus
+}
+#endif
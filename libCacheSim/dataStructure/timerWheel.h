@@ -0,0 +1,84 @@
+//
+// a hierarchical timing wheel that keeps the expiration time of objects,
+// the wheel has TIMER_WHEEL_N_LEVEL levels of TIMER_WHEEL_N_SLOT slots, a
+// slot of level i covers TIMER_WHEEL_N_SLOT^i time units, an entry is placed
+// at the lowest level that covers its expiration time, and it is moved to a
+// lower level when the wheel reaches its slot, so adding an entry is O(1) and
+// advancing the wheel touches only the entries that expire or move down
+//
+// the wheel does not support removing an entry, the caller checks whether an
+// expired entry is still valid, e.g., the object is still in the cache and
+// has the same expiration time
+//
+// timerWheel.h
+// libCacheSim
+//
+
+#ifndef TIMER_WHEEL_H
+#define TIMER_WHEEL_H
+
+#include <stdint.h>
+
+#include "../include/libCacheSim/request.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define TIMER_WHEEL_LEVEL_BITS 8
+#define TIMER_WHEEL_N_SLOT (1 << TIMER_WHEEL_LEVEL_BITS)
+/* 4 levels cover the uint32_t expiration time */
+#define TIMER_WHEEL_N_LEVEL 4
+
+typedef struct {
+  obj_id_t obj_id;
+  uint32_t exp_time;
+} timer_wheel_entry_t;
+
+typedef struct {
+  timer_wheel_entry_t *entries;
+  uint32_t n_entry;
+  uint32_t capacity;
+} timer_wheel_slot_t;
+
+typedef struct timer_wheel {
+  timer_wheel_slot_t slots[TIMER_WHEEL_N_LEVEL][TIMER_WHEEL_N_SLOT];
+  /* the entries that expire at or before curr_time have been expired */
+  int64_t curr_time;
+  int64_t n_entry;
+  int64_t n_level_entry[TIMER_WHEEL_N_LEVEL];
+} timer_wheel_t;
+
+/**
+ * @brief called for each expired entry
+ */
+typedef void (*timer_wheel_expire_func_ptr)(obj_id_t obj_id, uint32_t exp_time, void *user_data);
+
+/**
+ * @brief create a timing wheel
+ *
+ * @param start_time the current time, the entries that expire before
+ *  start_time are expired at the first advance
+ */
+timer_wheel_t *create_timer_wheel(int64_t start_time);
+
+void free_timer_wheel(timer_wheel_t *wheel);
+
+/**
+ * @brief add an object to the wheel, the object expires when the time
+ * is larger than exp_time, which is the same as cache_find_base
+ */
+void timer_wheel_add(timer_wheel_t *wheel, obj_id_t obj_id, uint32_t exp_time);
+
+/**
+ * @brief advance the wheel to curr_time and call expire_func for each entry
+ * with exp_time < curr_time, expire_func must not add to the wheel
+ */
+void timer_wheel_advance(timer_wheel_t *wheel, int64_t curr_time, timer_wheel_expire_func_ptr expire_func,
+                         void *user_data);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* TIMER_WHEEL_H */
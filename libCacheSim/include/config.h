@@ -43,6 +43,18 @@ extern "C" {
 #define CHAINED_HASHTABLE_EXPAND_THRESHOLD 2
 #endif
 
+/* the hash table shrinks when the load drops below this threshold, but not
+ * below the initial size */
+#ifndef CHAINED_HASHTABLE_SHRINK_THRESHOLD
+#define CHAINED_HASHTABLE_SHRINK_THRESHOLD 0.25
+#endif
+
+/* the number of buckets moved to the new table at each insert and delete
+ * when the hash table is resizing */
+#ifndef CHAINED_HASHTABLE_REHASH_STEP
+#define CHAINED_HASHTABLE_REHASH_STEP 4
+#endif
+
 #include <sys/mman.h>
 #ifndef MADV_HUGEPAGE
 #undef USE_HUGEPAGE
@@ -7,14 +7,19 @@
 
 #include "config.h"
 #include "libCacheSim/cache.h"
+#include "libCacheSim/cacheOpStat.h"
 #include "libCacheSim/cacheObj.h"
+#include "libCacheSim/clusterSimulator.h"
+#include "libCacheSim/concurrentCache.h"
 #include "libCacheSim/const.h"
 #include "libCacheSim/enum.h"
+#include "libCacheSim/hierarchySimulator.h"
 #include "libCacheSim/logging.h"
 #include "libCacheSim/macro.h"
 #include "libCacheSim/reader.h"
 #include "libCacheSim/request.h"
 #include "libCacheSim/sampling.h"
+#include "libCacheSim/traceMeta.h"
 
 /* admission */
 #include "libCacheSim/admissionAlgo.h"
@@ -29,5 +34,6 @@
 #include "libCacheSim/plugin.h"
 #include "libCacheSim/profilerLRU.h"
 #include "libCacheSim/simulator.h"
+#include "libCacheSim/metricsSink.h"
 
 #endif  // libCacheSim_H
@@ -65,6 +65,16 @@ typedef int64_t (*cache_get_n_obj_func_ptr)(const cache_t *);
 
 typedef void (*cache_print_cache_func_ptr)(const cache_t *);
 
+typedef bool (*cache_save_state_func_ptr)(const cache_t *, FILE *);
+
+typedef bool (*cache_load_state_func_ptr)(cache_t *, FILE *);
+
+typedef bool (*cache_prepare_fork_func_ptr)(cache_t *);
+
+typedef void (*cache_obj_iter_func_ptr)(cache_obj_t *, void *);
+
+typedef void (*cache_foreach_obj_func_ptr)(cache_t *, cache_obj_iter_func_ptr, void *);
+
 // #define EVICTION_AGE_ARRAY_SZE 40
 #define EVICTION_AGE_ARRAY_SZE 320
 #define EVICTION_AGE_LOG_BASE 1.08
@@ -90,6 +100,10 @@ typedef struct {
 } cache_stat_t;
 
 struct hashtable;
+struct timer_wheel;
+struct ring_queue;
+struct metrics_recorder;
+struct cache_op_stat;
 struct cache {
   struct hashtable *hashtable;
 
@@ -107,6 +121,21 @@ struct cache {
   cache_get_occupied_byte_func_ptr get_occupied_byte;
   cache_get_n_obj_func_ptr get_n_obj;
   cache_print_cache_func_ptr print_cache;
+  /* serialize the eviction algorithm state (queues, per-object metadata and
+   * eviction_params), NULL if the algorithm does not support checkpoint */
+  cache_save_state_func_ptr save_state;
+  cache_load_state_func_ptr load_state;
+  /* the identity of the algorithm in checkpoints (the name of its init
+   * function), a checkpoint is only loaded into the same algorithm */
+  const char *checkpoint_algo;
+  /* stop the threads run by the cache before the process forks (e.g.,
+   * simulate_with_branches), because the child only has the forking thread,
+   * returns false if the cache cannot be forked, NULL if the cache does not
+   * run threads */
+  cache_prepare_fork_func_ptr prepare_fork;
+  /* iterate over the cached objects, for the caches that keep the objects
+   * in the hash tables of sub-caches, NULL if the objects are in hashtable */
+  cache_foreach_obj_func_ptr foreach_obj;
 
   admissioner_t *admissioner;
 
@@ -116,6 +145,13 @@ struct cache {
 
   // other name: logical_time, virtual_time, reference_count
   int64_t n_req; /* number of requests (used by some eviction algo) */
+  /* number of evictions triggered by get (cache_get_base or the get of the
+   * algorithm), a Sharded cache sums the evictions of its shards */
+  int64_t n_evict;
+  /* number of objects and bytes removed because they expired, only updated
+   * when SUPPORT_TTL is on */
+  int64_t n_expired_obj;
+  int64_t n_expired_byte;
 
   /**************** private fields *****************/
   // use cache->get_n_obj to obtain the number of objects in the cache
@@ -158,6 +194,26 @@ struct cache {
   int32_t *future_stack_dist;
   int64_t future_stack_dist_array_size;
 
+  /* used by the simulator, if not NULL, the cache state is saved to this
+   * path after warmup */
+  char *warmup_checkpoint_path;
+  /* the cache state is restored from a checkpoint, so the simulator skips
+   * the warmup requests instead of replaying them */
+  bool restored_from_checkpoint;
+  /* used by the simulator, if not NULL, the per-interval metrics are
+   * recorded, see metricsSink.h */
+  struct metrics_recorder *metrics_recorder;
+  /* used by the simulator, if true and static_sim_support(cache), the
+   * simulator runs a copy of the algorithm compiled without function
+   * pointers instead of this cache, see simulator.h */
+  bool use_static_sim;
+  /* if not NULL, the operations are counted and timed, see cacheOpStat.h */
+  struct cache_op_stat *op_stat;
+  /* the expiration time of the objects inserted by cache_get_base, used to
+   * remove the expired objects as the trace time advances, created at the
+   * first request when SUPPORT_TTL is on */
+  struct timer_wheel *ttl_wheel;
+
   int64_t log_eviction_age_cnt[EVICTION_AGE_ARRAY_SZE];
 };
 
@@ -202,6 +258,71 @@ cache_t *clone_cache(const cache_t *old_cache);
 cache_t *create_cache_with_new_size(const cache_t *old_cache,
                                     const uint64_t new_size);
 
+/**
+ * @brief save the state of a warmed cache to a checkpoint file, including the
+ * cached objects, the queue order, the per-object metadata and the eviction
+ * parameters, the state of the admission and prefetching algorithm is not saved
+ *
+ * @param cache
+ * @param path
+ * @return false if the eviction algorithm does not support checkpoint or the
+ * file cannot be written
+ */
+bool cache_save_checkpoint(const cache_t *cache, const char *path);
+
+/**
+ * @brief restore the cache state from a checkpoint file,
+ * the cache must be empty and use the same eviction algorithm and cache size
+ * as the cache that creates the checkpoint
+ *
+ * @param cache
+ * @param path
+ * @return whether the cache is restored
+ */
+bool cache_load_checkpoint(cache_t *cache, const char *path);
+
+/**
+ * @brief save/load the common cache state followed by the eviction algorithm
+ * state, this is used by checkpoint and algorithms that are composed of
+ * other caches, e.g., S3FIFO
+ */
+bool cache_save_state(const cache_t *cache, FILE *f);
+
+bool cache_load_state(cache_t *cache, FILE *f);
+
+/**
+ * @brief write the objects in a queue (from head to tail) to the checkpoint
+ *
+ * @param head
+ * @param f
+ * @return
+ */
+bool cache_save_obj_queue(const cache_obj_t *head, FILE *f);
+
+/**
+ * @brief read a queue written by cache_save_obj_queue, the objects are
+ * inserted into the hash table and appended to the queue, note that
+ * the cache n_obj and occupied_byte are not updated because they are
+ * restored from the common state
+ *
+ * @param cache
+ * @param f
+ * @param head
+ * @param tail
+ * @return
+ */
+bool cache_load_obj_queue(cache_t *cache, FILE *f, cache_obj_t **head,
+                          cache_obj_t **tail);
+
+/**
+ * @brief the same as cache_save_obj_queue and cache_load_obj_queue for a
+ * ring queue, the objects are written from the newest to the oldest, so a
+ * checkpoint can be loaded into a cache that uses either kind of queue
+ */
+bool cache_save_ring_queue(const struct ring_queue *rq, FILE *f);
+
+bool cache_load_ring_queue(cache_t *cache, FILE *f, struct ring_queue *rq);
+
 /**
  * a function that finds object from the cache, it is used by
  * all eviction algorithms that directly use the hashtable
@@ -214,6 +335,16 @@ cache_t *create_cache_with_new_size(const cache_t *old_cache,
 cache_obj_t *cache_find_base(cache_t *cache, const request_t *req,
                              const bool update_cache);
 
+/**
+ * @brief call iter_func on each object in the cache, using
+ * cache->foreach_obj if the cache keeps the objects in sub-caches
+ *
+ * @param cache
+ * @param iter_func
+ * @param user_data
+ */
+void cache_foreach_obj(cache_t *cache, cache_obj_iter_func_ptr iter_func, void *user_data);
+
 /**
  * a common cache get function
  * @param cache
@@ -145,6 +145,14 @@ typedef struct {
   int32_t freq;
 } EvolveCache_obj_metadata_t;
 
+typedef struct {
+  int32_t md_idx;  // the slot of the object in the metadata pool
+} EvolveComplete_obj_params_t;
+
+typedef struct {
+  uint32_t tag_idx;  // the index of the object in the LHD tag arrays
+} LHD_obj_metadata_t;
+
 typedef struct {
   int32_t freq;
 } __attribute__((packed)) Sieve_obj_params_t;
@@ -160,10 +168,15 @@ typedef struct cache_obj {
   struct cache_obj *hash_next;
   obj_id_t obj_id;
   int64_t obj_size;
-  struct {
-    struct cache_obj *prev;
-    struct cache_obj *next;
-  } queue;  // for LRU, FIFO, etc.
+  union {
+    struct {
+      struct cache_obj *prev;
+      struct cache_obj *next;
+    } queue;  // for LRU, FIFO, etc.
+    /* the position in a ring queue, which is used instead of the list by
+     * some FIFO-family algorithms, see dataStructure/ringQueue.h */
+    int64_t ring_pos;
+  };
 #ifdef SUPPORT_TTL
   uint32_t exp_time;
 #endif
@@ -198,6 +211,8 @@ typedef struct cache_obj {
     Sieve_obj_params_t sieve;
     CAR_obj_metadata_t CAR;
     EvolveCache_obj_metadata_t evolve; // for EvolveCache
+    EvolveComplete_obj_params_t evolve_complete; // for EvolveComplete
+    LHD_obj_metadata_t lhd;          // for LHD
 
 #if defined(ENABLE_GLCACHE) && ENABLE_GLCACHE == 1
     GLCache_obj_metadata_t GLCache;
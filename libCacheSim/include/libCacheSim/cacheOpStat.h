@@ -0,0 +1,140 @@
+//
+//  cacheOpStat.h
+//  libCacheSim
+//
+//  low-overhead instrumentation of the cache operations, which is used to
+//  compare the CPU cost of eviction algorithms
+//
+//  when enabled, the function pointers (get, find, insert, evict, to_evict,
+//  remove) of the cache are replaced with wrappers that count the calls and
+//  measure the cycles (rdtsc) of one in 2^sample_shift calls, the hashtable
+//  records the chain length of lookups and the number of expansions (chained
+//  hashtable v2 only).
+//  optionally, the cache misses and branch misses of the sampled calls are
+//  measured with perf_event (Linux only)
+//
+//  the time of an operation includes the operations it calls, e.g., the get
+//  time includes find, insert and evict, and the evict time includes the
+//  remove called by the eviction algorithm.
+//  algorithms composed of other caches (e.g., S3FIFO) only record the
+//  operations of the outer cache
+//
+//  this is only compiled with -DENABLE_CACHE_OP_STAT=ON, otherwise
+//  cache_enable_op_stat returns false and the hot path is not changed
+//
+
+#ifndef CACHE_OP_STAT_H
+#define CACHE_OP_STAT_H
+
+#include "cache.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define CACHE_OP_STAT_DEFAULT_SAMPLE_SHIFT 6
+
+typedef enum {
+  CACHE_OP_GET = 0,
+  CACHE_OP_FIND,
+  CACHE_OP_INSERT,
+  CACHE_OP_EVICT,
+  CACHE_OP_TO_EVICT,
+  CACHE_OP_REMOVE,
+  N_CACHE_OP,
+} cache_op_e;
+
+extern const char *g_cache_op_names[N_CACHE_OP];
+
+typedef enum {
+  CACHE_OP_PERF_CACHE_MISS = 0,
+  CACHE_OP_PERF_BRANCH_MISS,
+  N_CACHE_OP_PERF_EVENT,
+} cache_op_perf_event_e;
+
+typedef struct {
+  int64_t n_call;
+  /* the calls that are timed */
+  int64_t n_sampled;
+  uint64_t sampled_cycles;
+  uint64_t max_cycles;
+  /* the hardware events of the sampled calls */
+  uint64_t perf_cnt[N_CACHE_OP_PERF_EVENT];
+} cache_op_counter_t;
+
+typedef struct {
+  int64_t n_lookup;
+  /* the number of objects compared in lookups */
+  int64_t n_lookup_step;
+  int64_t max_chain_len;
+  int64_t n_expand;
+  int64_t n_shrink;
+} hashtable_op_stat_t;
+
+typedef struct cache_op_stat {
+  cache_op_counter_t ops[N_CACHE_OP];
+  /* a copy of the hashtable stat when the stat is read */
+  hashtable_op_stat_t hashtable;
+
+  /* whether perf_event counters are read for the sampled calls */
+  bool perf_event_enabled;
+
+  /**************** private fields *****************/
+  uint64_t sample_mask;
+  /* the group of perf_event counters opened by the thread running the cache,
+   * -1 if not opened */
+  int perf_fds[N_CACHE_OP_PERF_EVENT];
+  bool perf_event_failed;
+
+  /* the original functions of the cache */
+  cache_get_func_ptr get;
+  cache_find_func_ptr find;
+  cache_insert_func_ptr insert;
+  cache_evict_func_ptr evict;
+  cache_to_evict_func_ptr to_evict;
+  cache_remove_func_ptr remove;
+} cache_op_stat_t;
+
+/**
+ * @brief start recording the operations of the cache,
+ * it must be called before the cache is used and after all function
+ * pointers of the cache are set
+ *
+ * @param cache
+ * @param sample_shift time one in 2^sample_shift calls of each operation
+ * @param use_perf_event read the cache miss and branch miss counters of the
+ * sampled calls, this is much more expensive because it reads the counters
+ * with system calls
+ * @return false if the library is compiled without ENABLE_CACHE_OP_STAT
+ */
+bool cache_enable_op_stat(cache_t *cache, int sample_shift,
+                          bool use_perf_event);
+
+/**
+ * @brief get the recorded operation stat of the cache
+ *
+ * @param cache
+ * @return NULL if the stat is not enabled
+ */
+const cache_op_stat_t *cache_get_op_stat(const cache_t *cache);
+
+/**
+ * @brief print the operation stat, including the calls per request and the
+ * estimated cycles of each operation
+ *
+ * @param cache
+ */
+void cache_print_op_stat(const cache_t *cache);
+
+/**
+ * @brief free the stat, called by cache_struct_free
+ *
+ * @param cache
+ */
+void cache_free_op_stat(cache_t *cache);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* CACHE_OP_STAT_H */
@@ -0,0 +1,134 @@
+//
+//  simulate a CDN cluster, the requests are routed to the cache servers by a
+//  consistent hash ring, and each server has one or more caches (e.g., DRAM
+//  and disk) that are checked in order
+//
+//  clusterSimulator.h
+//  libCacheSim
+//
+
+#ifndef CLUSTER_SIMULATOR_H
+#define CLUSTER_SIMULATOR_H
+
+#include "cache.h"
+#include "reader.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define CLUSTER_MAX_N_SERVER 4096
+#define CLUSTER_MAX_N_CACHE_PER_SERVER 8
+
+struct cluster;
+typedef struct cluster cluster_t;
+
+typedef enum {
+  CLUSTER_ADD_SERVER,
+  /* the server does not receive requests after it is removed, but its
+   * caches are kept, so it has the old content if it is added back */
+  CLUSTER_REMOVE_SERVER,
+} cluster_event_type_e;
+
+typedef struct {
+  /* the event happens before the first request whose clock time is not
+   * smaller than time */
+  int64_t time;
+  cluster_event_type_e type;
+  /* the server to remove or to add back, -1 to add a new server */
+  int server_id;
+  /* the caches and the weight of a new server, the cluster owns the caches */
+  cache_t **caches;
+  int n_cache;
+  double weight;
+} cluster_event_t;
+
+typedef struct {
+  int server_id;
+  bool active;
+  int64_t n_req;
+  int64_t n_miss;
+  int64_t n_req_byte;
+  int64_t n_miss_byte;
+} cluster_server_stat_t;
+
+typedef struct {
+  int64_t n_req;
+  int64_t n_miss;
+  int64_t n_req_byte;
+  int64_t n_miss_byte;
+  /* the requests that arrive when there is no active server */
+  int64_t n_req_no_server;
+  int n_server;
+  /* one entry for each server ever added, indexed by server id */
+  cluster_server_stat_t *server_stats;
+} cluster_stat_t;
+
+cluster_t *create_cluster(void);
+
+/**
+ * @brief add a server to the cluster, the cluster owns the caches
+ *
+ * @param cluster
+ * @param caches the caches of the server, checked in order, a request that
+ *  misses in a cache is sent to the next cache
+ * @param n_cache
+ * @param weight a server with a larger weight receives more requests, the
+ *  server has 160 points on the ring per unit of weight (up to 64 units)
+ * @return the server id
+ */
+int cluster_add_server(cluster_t *cluster, cache_t **caches, int n_cache, double weight);
+
+/**
+ * @brief remove a server from the consistent hash ring, or add a removed
+ * server back, only the objects of the server move to or from other servers
+ */
+void cluster_remove_server(cluster_t *cluster, int server_id);
+
+void cluster_restore_server(cluster_t *cluster, int server_id);
+
+/**
+ * @brief the server that the object is routed to, -1 if there is no active server
+ */
+int cluster_get_server(const cluster_t *cluster, obj_id_t obj_id);
+
+/**
+ * @brief send a request to the cluster, return true on hit
+ */
+bool cluster_get(cluster_t *cluster, const request_t *req);
+
+/**
+ * @brief the cache of a server, NULL if the server or the cache does not exist
+ */
+cache_t *cluster_get_cache(const cluster_t *cluster, int server_id, int cache_idx);
+
+void free_cluster(cluster_t *cluster);
+
+/**
+ * @brief replay the trace on the cluster
+ *
+ * a router (the calling thread) reads the trace and sends each request to the
+ * queue of its server, and the servers are simulated by n_thread worker
+ * threads, each server is always simulated by the same worker, because each
+ * server sees the same sequence of requests as in a serial run, the result is
+ * the same as the serial run (as long as the caches do not use random numbers)
+ *
+ * @param reader
+ * @param cluster
+ * @param events the server add and remove events sorted by time, can be NULL
+ * @param n_event
+ * @param n_thread the number of worker threads, 1 runs serially
+ *  in the calling thread, 0 uses one thread per server, but no more than
+ *  the number of online cores
+ * @return the stat, free with free_cluster_stat
+ */
+cluster_stat_t *simulate_cluster(reader_t *reader, cluster_t *cluster, const cluster_event_t *events, int n_event,
+                                 int n_thread);
+
+void free_cluster_stat(cluster_stat_t *stat);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* CLUSTER_SIMULATOR_H */
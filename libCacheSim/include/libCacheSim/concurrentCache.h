@@ -0,0 +1,75 @@
+//
+//  thread-safe caches that can be shared by multiple threads
+//
+//  the eviction algorithms in cache/eviction assume a single thread, the
+//  caches here are the concurrent variants of FIFO, Clock, Sieve and S3FIFO,
+//  which use a hash table with striped locks, set the visited bits on hit
+//  without taking the eviction lock, and serialize the insertion and eviction
+//  on one lock, so that the throughput of the algorithms can be compared when
+//  they are shared by many threads
+//
+//  a miss does not block on the eviction lock, the thread holding the lock
+//  inserts the objects of the concurrent misses in batches, but the queues
+//  are still updated by one thread at a time, so the throughput of a
+//  miss-heavy workload does not scale with the number of threads
+//
+//  the hash table does not grow, set ccache_params.hashpower close to log2
+//  of the number of objects the cache holds, the chains get longer and the
+//  lookups slower when the cache holds more objects than buckets
+//
+//  concurrentCache.h
+//  libCacheSim
+//
+
+#pragma once
+
+#include "cache.h"
+#include "request.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+struct concurrent_cache;
+typedef struct concurrent_cache concurrent_cache_t;
+
+typedef bool (*concurrent_cache_get_func_ptr)(concurrent_cache_t *, const request_t *);
+typedef int64_t (*concurrent_cache_get_int_func_ptr)(const concurrent_cache_t *);
+typedef void (*concurrent_cache_free_func_ptr)(concurrent_cache_t *);
+
+struct concurrent_cache {
+  /* can be called by multiple threads, return true on hit */
+  concurrent_cache_get_func_ptr get;
+  concurrent_cache_get_int_func_ptr get_occupied_byte;
+  concurrent_cache_get_int_func_ptr get_n_obj;
+  concurrent_cache_free_func_ptr cache_free;
+
+  int64_t cache_size;
+  char cache_name[CACHE_NAME_ARRAY_LEN];
+  /* the state of the cache, see cache/concurrent/concurrentCacheInternal.h */
+  void *cc_params;
+};
+
+concurrent_cache_t *ConcurrentFIFO_init(const common_cache_params_t ccache_params,
+                                        const char *cache_specific_params);
+
+concurrent_cache_t *ConcurrentClock_init(const common_cache_params_t ccache_params,
+                                         const char *cache_specific_params);
+
+concurrent_cache_t *ConcurrentSieve_init(const common_cache_params_t ccache_params,
+                                         const char *cache_specific_params);
+
+concurrent_cache_t *ConcurrentS3FIFO_init(const common_cache_params_t ccache_params,
+                                          const char *cache_specific_params);
+
+/**
+ * @brief create a concurrent cache by name, fifo, clock, sieve or s3fifo
+ *
+ * @return the cache or NULL if the algorithm has no concurrent variant
+ */
+concurrent_cache_t *create_concurrent_cache(const char *algo, const common_cache_params_t ccache_params,
+                                            const char *cache_specific_params);
+
+#ifdef __cplusplus
+}
+#endif
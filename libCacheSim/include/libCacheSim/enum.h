@@ -42,6 +42,9 @@ typedef enum {
 
   VALPIN_TRACE,
 
+  /* generated in process from a workload spec */
+  SYNTHETIC_TRACE,
+
   UNKNOWN_TRACE,
 } __attribute__((__packed__)) trace_type_e;
 
@@ -62,6 +65,7 @@ static const char* const g_trace_type_name[UNKNOWN_TRACE + 2] = {
     "ORACLE_SYS_TWRNS_TRACE",
 
     "VALPIN_TRACE",
+    "SYNTHETIC_TRACE",
     "UNKNOWN_TRACE",
 };
 
@@ -6,9 +6,14 @@
 extern "C" {
 #endif
 
+struct ring_queue;
+
 typedef struct {
   cache_obj_t *q_head;
   cache_obj_t *q_tail;
+  /* not NULL if the queue is a ring queue (queue=ring), then q_head and
+   * q_tail are not used */
+  struct ring_queue *ring;
 } FIFO_params_t;
 
 /* used by LFU related */
@@ -28,6 +33,8 @@ typedef struct freq_node {
 typedef struct {
   cache_obj_t *q_head;
   cache_obj_t *q_tail;
+  /* not NULL if the queue is a ring queue (queue=ring) */
+  struct ring_queue *ring;
   // clock uses one-bit counter
   int32_t n_bit_counter;
   // max_freq = 1 << (n_bit_counter - 1)
@@ -38,6 +45,35 @@ typedef struct {
   int64_t n_byte_rewritten;
 } Clock_params_t;
 
+/* the small, ghost and main queues are FIFO caches, the ghost queue is NULL
+ * if ghost-size-ratio is 0 */
+typedef struct {
+  cache_t *small_fifo;
+  cache_t *ghost_fifo;
+  cache_t *main_fifo;
+  bool hit_on_ghost;
+
+  int move_to_main_threshold;
+  double small_size_ratio;
+  double ghost_size_ratio;
+
+  bool has_evicted;
+  /* the small, ghost and main FIFOs use ring queues (queue=ring) */
+  bool use_ring_queue;
+  request_t *req_local;
+} S3FIFO_params_t;
+
+/* segment n_seg - 1 is the most recent, a hit promotes the object to the
+ * next segment and the tail of a full segment is moved to the previous one */
+typedef struct SLRU_params {
+  cache_obj_t **lru_heads;
+  cache_obj_t **lru_tails;
+  int64_t *lru_n_bytes;
+  int64_t *lru_n_objs;
+  int64_t *lru_max_n_bytes;
+  int n_seg;
+} SLRU_params_t;
+
 cache_t *ARC_init(const common_cache_params_t ccache_params, const char *cache_specific_params);
 
 cache_t *ARCv0_init(const common_cache_params_t ccache_params, const char *cache_specific_params);
@@ -138,6 +174,19 @@ cache_t *EvolveCache_init(const common_cache_params_t ccache_params, const char
 
 cache_t *EvolveComplete_init(const common_cache_params_t ccache_params, const char *cache_specific_params);
 
+cache_t *Sharded_init(const common_cache_params_t ccache_params, const char *cache_specific_params);
+
+/* whether the cache is a sharded cache simulated with one thread per shard */
+bool Sharded_is_parallel(const cache_t *cache);
+
+/* send the request to the worker of its shard, the miss is counted if
+ * record_stat is true */
+void Sharded_submit(cache_t *cache, const request_t *req, bool record_stat);
+
+/* wait until the workers finish all submitted requests, and return the
+ * misses counted, n_miss and n_miss_byte can be NULL */
+void Sharded_drain(cache_t *cache, int64_t *n_miss, int64_t *n_miss_byte);
+
 #ifdef ENABLE_LRB
 cache_t *LRB_init(const common_cache_params_t ccache_params, const char *cache_specific_params);
 #endif
@@ -0,0 +1,86 @@
+//
+//  simulate a cache hierarchy in memory, e.g., CDN edge, mid-tier and shield
+//
+//  a hierarchy is a graph of traces and caches, a cache receives the requests
+//  of its upstream traces and the misses of its upstream caches, so several
+//  L1 caches can share one L2 cache, and several configurations of a level
+//  can be evaluated in one run by giving them the same upstream, the misses
+//  are passed in memory without writing a miss trace
+//
+//  hierarchySimulator.h
+//  libCacheSim
+//
+
+#ifndef HIERARCHY_SIMULATOR_H
+#define HIERARCHY_SIMULATOR_H
+
+#include "cache.h"
+#include "reader.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+struct cache_hierarchy;
+typedef struct cache_hierarchy cache_hierarchy_t;
+
+cache_hierarchy_t *create_cache_hierarchy(void);
+
+/**
+ * @brief add a trace to the hierarchy, the requests of multiple traces are
+ * merged by clock time, the caller owns the reader
+ *
+ * @return the node id of the trace
+ */
+int hierarchy_add_trace(cache_hierarchy_t *hierarchy, reader_t *reader);
+
+/**
+ * @brief add a cache to the hierarchy, the hierarchy owns the cache
+ *
+ * @param hierarchy
+ * @param cache
+ * @param upstream the node ids of the traces and caches that send requests
+ *  to the cache, the cache receives the requests of a trace and the misses of
+ *  a cache, the requests of several upstream nodes are merged in trace order
+ * @param n_upstream
+ * @return the node id of the cache
+ */
+int hierarchy_add_cache(cache_hierarchy_t *hierarchy, cache_t *cache, const int *upstream, int n_upstream);
+
+/**
+ * @brief the cache of the node, NULL if the node is a trace
+ */
+cache_t *hierarchy_get_cache(const cache_hierarchy_t *hierarchy, int node_id);
+
+/**
+ * @brief the level of the node, the traces are level 0, and a cache is one
+ * level below its lowest upstream node
+ */
+int hierarchy_get_level(const cache_hierarchy_t *hierarchy, int node_id);
+
+/**
+ * @brief replay the traces on the hierarchy
+ *
+ * the traces are read in batches, the caches of one level process a batch in
+ * parallel and pass their misses to the next level, each cache sees its
+ * requests in trace order, so the result does not depend on n_thread,
+ * a cache below the first level sees the next access time of the original
+ * trace, so the algorithms that use the future are only exact at level 1
+ *
+ * @param hierarchy
+ * @param n_thread the number of threads, 1 runs in the calling thread
+ * @return one stat for each node indexed by node id, the stat of a trace has
+ *  its requests as misses, free with free
+ */
+cache_stat_t *simulate_cache_hierarchy(cache_hierarchy_t *hierarchy, int n_thread);
+
+/**
+ * @brief free the hierarchy and its caches, the readers are not closed
+ */
+void free_cache_hierarchy(cache_hierarchy_t *hierarchy);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* HIERARCHY_SIMULATOR_H */
@@ -0,0 +1,180 @@
+//
+//  metricsSink.h
+//  libCacheSim
+//
+//  record the per-interval metrics of simulations into a binary columnar file
+//
+//  each cache attached to the sink has a recorder, which is only updated by
+//  the thread simulating the cache, so there is no locking on the hot path,
+//  the recorder buffers the metrics of METRICS_BLOCK_N_ROW intervals in
+//  columns and appends the block to the file (with a lock) when it is full
+//
+//  file format (little endian)
+//  header:
+//    char magic[8] = "LCSMTRC1"
+//    int32_t version, int32_t n_column, int32_t n_cache, int32_t interval_type
+//    int64_t interval
+//    char column_names[n_column][METRICS_COLUMN_NAME_LEN]
+//    for each cache: char cache_name[CACHE_NAME_ARRAY_LEN], int64_t cache_size
+//  followed by blocks:
+//    int32_t cache_idx, int32_t n_row
+//    int64_t column[n_row] for each of the n_column columns
+//
+//  see scripts/metrics_reader.py for reading the file
+//
+
+#ifndef METRICS_SINK_H
+#define METRICS_SINK_H
+
+#include <pthread.h>
+#include <stdio.h>
+
+#include "cache.h"
+#include "request.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define METRICS_SINK_VERSION 1
+#define METRICS_COLUMN_NAME_LEN 16
+#define METRICS_BLOCK_N_ROW 1024
+
+typedef enum {
+  /* an interval is interval seconds of trace time */
+  METRICS_INTERVAL_SEC = 0,
+  /* an interval is interval requests */
+  METRICS_INTERVAL_REQ = 1,
+} metrics_interval_type_e;
+
+typedef enum {
+  /* the last request of the interval, counted from the start of the
+   * measurement (i.e., after warmup) */
+  METRICS_COL_VTIME = 0,
+  /* the trace time at the end of the interval */
+  METRICS_COL_RTIME,
+  /* the counters in the interval */
+  METRICS_COL_N_REQ,
+  METRICS_COL_N_REQ_BYTE,
+  METRICS_COL_N_MISS,
+  METRICS_COL_N_MISS_BYTE,
+  METRICS_COL_N_EVICT,
+  /* the cache state at the end of the interval */
+  METRICS_COL_OCCUPIED_BYTE,
+  METRICS_COL_N_OBJ,
+  METRICS_N_COLUMN,
+} metrics_column_e;
+
+extern const char *g_metrics_column_names[METRICS_N_COLUMN];
+
+struct metrics_sink;
+
+typedef struct metrics_recorder {
+  struct metrics_sink *sink;
+  const cache_t *cache;
+  int32_t cache_idx;
+  char cache_name[CACHE_NAME_ARRAY_LEN];
+  int64_t cache_size;
+
+  /* the end of the current interval in trace time or requests */
+  int64_t next_boundary;
+  bool started;
+
+  /* counters of the current interval */
+  int64_t vtime;
+  int64_t last_rtime;
+  int64_t n_req;
+  int64_t n_req_byte;
+  int64_t n_miss;
+  int64_t n_miss_byte;
+  int64_t last_n_evict;
+
+  /* buffered rows in columnar layout */
+  int32_t n_row;
+  int64_t columns[METRICS_N_COLUMN][METRICS_BLOCK_N_ROW];
+} metrics_recorder_t;
+
+typedef struct metrics_sink {
+  FILE *file;
+  char *path;
+  metrics_interval_type_e interval_type;
+  int64_t interval;
+
+  int32_t n_cache;
+  int32_t max_n_cache;
+  metrics_recorder_t **recorders;
+  /* protects the file and the recorders array, not used on the hot path */
+  pthread_mutex_t mtx;
+  bool header_written;
+} metrics_sink_t;
+
+/**
+ * @brief create a metrics sink that writes to path
+ *
+ * @param path
+ * @param interval_type the interval is in trace time or number of requests
+ * @param interval
+ * @return the sink, NULL if the file cannot be created
+ */
+metrics_sink_t *create_metrics_sink(const char *path, metrics_interval_type_e interval_type, int64_t interval);
+
+/**
+ * @brief create a recorder for the cache and attach it to
+ * cache->metrics_recorder,
+ * all caches must be attached before the simulation starts because the
+ * caches are listed in the file header
+ *
+ * @param sink
+ * @param cache
+ * @return the recorder
+ */
+metrics_recorder_t *metrics_sink_attach(metrics_sink_t *sink, cache_t *cache);
+
+/**
+ * @brief flush all recorders, close the file and free the sink, the caches
+ * attached should not be used to record after this
+ *
+ * @param sink
+ */
+void close_metrics_sink(metrics_sink_t *sink);
+
+/* end the current interval and start a new one, called by
+ * metrics_recorder_record when the request is in a new interval */
+void metrics_recorder_end_interval(metrics_recorder_t *recorder, int64_t curr);
+
+/* end the last (partial) interval and flush the buffered rows, called when
+ * the simulation of the cache finishes */
+void metrics_recorder_finish(metrics_recorder_t *recorder);
+
+/**
+ * @brief record the result of one request, this is on the hot path
+ *
+ * @param recorder
+ * @param req the clock_time should be relative to the start of the trace
+ * @param hit
+ */
+static inline void metrics_recorder_record(metrics_recorder_t *recorder, const request_t *req, bool hit) {
+  int64_t curr = recorder->sink->interval_type == METRICS_INTERVAL_SEC ? (int64_t)req->clock_time
+                                                                         : recorder->vtime;
+  if (unlikely(!recorder->started)) {
+    recorder->started = true;
+    recorder->next_boundary = curr + recorder->sink->interval;
+  } else if (curr >= recorder->next_boundary) {
+    metrics_recorder_end_interval(recorder, curr);
+  }
+
+  recorder->vtime += 1;
+  recorder->last_rtime = (int64_t)req->clock_time;
+  recorder->n_req += 1;
+  recorder->n_req_byte += req->obj_size;
+  if (!hit) {
+    recorder->n_miss += 1;
+    recorder->n_miss_byte += req->obj_size;
+  }
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* METRICS_SINK_H */
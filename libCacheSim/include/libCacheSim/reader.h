@@ -74,6 +74,10 @@ typedef struct {
 
   // sample some requests in the trace
   sampler_t *sampler;
+
+  // save the trace metadata to a sidecar file next to the trace
+  // (trace_path.meta) so that later runs do not scan the trace again
+  bool save_trace_meta;
 } reader_init_param_t;
 
 enum read_direction {
@@ -82,6 +86,7 @@ enum read_direction {
 };
 
 struct zstd_reader;
+struct trace_meta;
 typedef struct reader {
   /************* common fields *************/
   int64_t n_read_req;
@@ -145,6 +150,10 @@ typedef struct reader {
   /* used for trace sampling */
   sampler_t *sampler;
   enum read_direction read_direction;
+
+  /* the metadata of the trace, loaded or computed on demand,
+   * see get_trace_meta in traceMeta.h */
+  struct trace_meta *trace_meta;
 } reader_t;
 
 static inline void set_default_reader_init_params(reader_init_param_t *params) {
@@ -166,6 +175,7 @@ static inline void set_default_reader_init_params(reader_init_param_t *params) {
   params->binary_fmt_str = NULL;
 
   params->sampler = NULL;
+  params->save_trace_meta = false;
 }
 
 static inline reader_init_param_t default_reader_init_params(void) {
@@ -60,6 +60,7 @@ typedef struct request {
   bool compulsory_miss;      /* use this field only when it is set */
   bool overwrite;            // this request overwrites a previous object
   bool first_seen_in_window; /* the first time see in the time window */
+  bool obj_sampled_out;      /* the object is not tracked (object sampling) */
   /* used in trace analysis */
 
   bool valid; /* indicate whether request is valid request
@@ -99,6 +99,67 @@ cache_stat_t *simulate_with_multi_caches(reader_t *reader,
                                          bool free_cache_when_finish, 
                                          bool use_random_seed);
 
+/**
+ * whether simulate_with_multi_caches and simulate_at_multi_sizes can run the
+ * cache with the static-dispatch engine, which runs LRU, FIFO, Clock, Sieve
+ * and S3FIFO as template instantiations and reads the trace in the same loop,
+ * the engine is used when cache->use_static_sim is set, the misses are the
+ * same as cache->get, and the cache is not updated
+ *
+ * the cache must be empty and not use admission, prefetching, metrics
+ * recording, operation stat, checkpoint or TTL
+ */
+bool static_sim_support(const cache_t *cache);
+
+/**
+ * set up the cache of a branch before it continues the simulation, e.g.,
+ * change the admission or prefetching algorithm, this runs in the child
+ * process so the change is not visible to the other branches
+ */
+typedef void (*sim_branch_setup_func_ptr)(cache_t *cache, int branch_idx, void *user_data);
+
+/**
+ * this function runs the first n_prefix_req requests (the shared prefix) from
+ * the reader through the cache once, then forks n_branch child processes at
+ * the branch point, each child starts from the warmed cache, which is shared
+ * with the parent copy-on-write, so the what-if variations do not need to
+ * repeat the warmup or copy the cache
+ *
+ * a child calls branch_setup (if not NULL) on the cache, then continues the
+ * simulation with branch_readers[i] if branch_readers and branch_readers[i]
+ * are not NULL, otherwise, with the requests following the prefix, the
+ * timestamps of all branches are shifted by the start time of the prefix
+ *
+ * the results (excluding the prefix) are sent back to the parent through
+ * pipes, at most num_of_processes children run at the same time, if a child
+ * fails, the request count of its result is 0
+ *
+ * the cache is left in the state at the branch point, and the returned
+ * cache_stat_t array should be freed by the user
+ *
+ * the threads run by the cache are stopped or finished at the branch point
+ * using cache->prepare_fork (e.g., GLCache waits for the model trained in the
+ * background), if the cache cannot stop them, no branch is simulated
+ *
+ * @param reader
+ * @param cache
+ * @param n_prefix_req
+ * @param n_branch
+ * @param branch_readers can be NULL
+ * @param branch_setup can be NULL
+ * @param user_data passed to branch_setup
+ * @param num_of_processes <= 0 means all branches run at the same time
+ * @return an array of n_branch cache_stat_t, NULL if the cache cannot be forked
+ */
+cache_stat_t *simulate_with_branches(reader_t *reader,
+                                     cache_t *cache,
+                                     int64_t n_prefix_req,
+                                     int n_branch,
+                                     reader_t *branch_readers[],
+                                     sim_branch_setup_func_ptr branch_setup,
+                                     void *user_data,
+                                     int num_of_processes);
+
 #ifdef __cplusplus
 }
 #endif
@@ -0,0 +1,125 @@
+//
+//  traceMeta.h
+//  libCacheSim
+//
+//  the metadata (summary statistics) of a trace, e.g., the number of
+//  requests, the working set size, the time range and the object size
+//  distribution, which are needed by many tools before simulation starts
+//
+//  the metadata is computed once in a single pass over the trace and kept in
+//  memory for the other readers of the same trace in the process, with the
+//  save_trace_meta reader parameter, it is also stored in a sidecar file next
+//  to the trace (trace_path.meta), so later runs load the sidecar instead of
+//  scanning the trace again, lcs traces carry the statistics in the trace
+//  header, which is used when available
+//
+
+#ifndef TRACE_META_H
+#define TRACE_META_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "reader.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define TRACE_META_VERSION 1
+/* object size buckets are powers of two, up to 2^48 bytes */
+#define TRACE_META_N_SIZE_BUCKET 48
+
+typedef struct trace_meta {
+  int64_t n_req;
+  int64_t n_obj;
+  int64_t n_req_byte;
+  /* the working set size in bytes, each object is counted once using the
+   * size at its first request */
+  int64_t n_obj_byte;
+
+  int64_t start_time;
+  int64_t end_time;
+
+  int64_t smallest_obj_size;
+  int64_t largest_obj_size;
+  /* obj_size_hist[i] is the number of objects whose size is in
+   * [2^i, 2^(i+1)), objects of size zero are in bucket 0 */
+  int64_t obj_size_hist[TRACE_META_N_SIZE_BUCKET];
+  /* the lcs trace header does not have the size histogram */
+  bool has_obj_size_hist;
+
+  /* large traces sample 1 / obj_sample_scale of the objects when computing
+   * the object statistics, which are scaled back */
+  int32_t obj_sample_scale;
+} trace_meta_t;
+
+/* the index of the obj_size_hist bucket of the object size */
+static inline int trace_meta_size_bucket(int64_t obj_size) {
+  if (obj_size <= 1) return 0;
+  int bucket = 63 - __builtin_clzll((unsigned long long)obj_size);
+  return bucket < TRACE_META_N_SIZE_BUCKET ? bucket : TRACE_META_N_SIZE_BUCKET - 1;
+}
+
+/**
+ * get the metadata of the trace, the metadata is taken from (in order)
+ * 1. the metadata cached in the reader
+ * 2. the lcs trace header
+ * 3. the metadata computed earlier by another reader of the trace in this
+ *    process
+ * 4. the sidecar file trace_path.meta
+ * 5. a pass over the trace (using a cloned reader), the result is saved to
+ *    the sidecar file if the reader has the save_trace_meta parameter
+ *
+ * 3 and 4 are only used if the reader reads the full trace, i.e., it has
+ * no sampler and no cap on the number of requests
+ *
+ * @param reader
+ * @return the metadata owned by the reader, it is freed when the reader is
+ * closed
+ */
+const trace_meta_t *get_trace_meta(reader_t *reader);
+
+/**
+ * get the metadata of the trace if it is available without a pass over the
+ * trace, i.e., step 1 - 4 of get_trace_meta
+ *
+ * @param reader
+ * @return the metadata owned by the reader, or NULL
+ */
+const trace_meta_t *find_trace_meta(reader_t *reader);
+
+/**
+ * compute the metadata with one pass over the trace,
+ * the position of the reader is not changed
+ * @param reader
+ * @param meta
+ */
+void compute_trace_meta(reader_t *reader, trace_meta_t *meta);
+
+/**
+ * load the metadata from the sidecar file, the sidecar is rejected if the
+ * trace has been modified or the reader uses different parameters
+ * (e.g., different csv fields or ignore_obj_size) from the one that created it
+ * @param reader
+ * @param meta
+ * @return true if the sidecar is found and valid
+ */
+bool load_trace_meta(const reader_t *reader, trace_meta_t *meta);
+
+/**
+ * save the metadata to the sidecar file trace_path.meta
+ * @param reader
+ * @param meta
+ * @return true on success, false if the reader does not read the full trace
+ * or the file cannot be written
+ */
+bool save_trace_meta(const reader_t *reader, const trace_meta_t *meta);
+
+void print_trace_meta(const trace_meta_t *meta);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* TRACE_META_H */
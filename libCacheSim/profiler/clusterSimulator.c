@@ -0,0 +1,412 @@
+//
+//  simulate a CDN cluster of cache servers, the requests are routed by a
+//  consistent hash ring, and the servers can be simulated in parallel
+//
+//  the router reads the trace and appends each request to the queue of its
+//  server, which is a single-producer single-consumer ring (spscRing.h) as
+//  in the Sharded cache, each worker thread owns a fixed set of servers and drains
+//  their queues, so the requests of a server are processed in trace order by
+//  one thread and no lock is needed
+//
+//  clusterSimulator.c
+//  libCacheSim
+//
+
+#include "../include/libCacheSim/clusterSimulator.h"
+
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#include "../dataStructure/consistentHash.h"
+#include "../dataStructure/spscRing.h"
+#include "../include/libCacheSim/logging.h"
+#include "../include/libCacheSim/macro.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* a worker with empty queues sleeps after yielding this many times, so that
+ * the idle workers do not use the CPU while the router is the bottleneck */
+#define CLUSTER_YIELD_BEFORE_PARK 64
+
+typedef struct {
+  int server_id;
+  cache_t *caches[CLUSTER_MAX_N_CACHE_PER_SERVER];
+  int n_cache;
+  double weight;
+  bool active;
+
+  /* written by the thread that simulates the server */
+  int64_t n_req;
+  int64_t n_miss;
+  int64_t n_req_byte;
+  int64_t n_miss_byte;
+
+  /* only used by the parallel simulation, reqs is NULL before */
+  spsc_ring_t ring;
+} cluster_server_t;
+
+struct cluster {
+  cluster_server_t *servers[CLUSTER_MAX_N_SERVER];
+  int n_server;
+  int n_active_server;
+  /* the ring of the active servers, NULL if there is no active server */
+  ring_t *ring;
+};
+
+typedef struct {
+  int idx;
+  /* the router appends the servers added during the simulation */
+  cluster_server_t *servers[CLUSTER_MAX_N_SERVER];
+  _Atomic int n_server;
+  _Atomic bool stop;
+  /* shared by the rings of the servers, the worker sleeps on it when all
+   * the rings are empty */
+  spsc_waiter_t waiter;
+  pthread_t thread;
+} cluster_worker_t;
+
+// ***********************************************************************
+// ****                                                               ****
+// ****                          cluster                              ****
+// ****                                                               ****
+// ***********************************************************************
+
+static void cluster_rebuild_ring(cluster_t *cluster) {
+  if (cluster->ring != NULL) {
+    ch_ring_destroy(cluster->ring);
+    cluster->ring = NULL;
+  }
+
+  unsigned int server_ids[CLUSTER_MAX_N_SERVER];
+  double weights[CLUSTER_MAX_N_SERVER];
+  int n_active = 0;
+  for (int i = 0; i < cluster->n_server; i++) {
+    if (cluster->servers[i]->active) {
+      server_ids[n_active] = (unsigned int)i;
+      weights[n_active] = cluster->servers[i]->weight;
+      n_active += 1;
+    }
+  }
+
+  cluster->n_active_server = n_active;
+  if (n_active > 0) {
+    cluster->ring = ch_ring_create(n_active, server_ids, weights);
+  }
+}
+
+cluster_t *create_cluster(void) {
+  cluster_t *cluster = malloc(sizeof(cluster_t));
+  memset(cluster, 0, sizeof(cluster_t));
+  return cluster;
+}
+
+int cluster_add_server(cluster_t *cluster, cache_t **caches, int n_cache, double weight) {
+  if (cluster->n_server == CLUSTER_MAX_N_SERVER) {
+    ERROR("a cluster has at most %d servers\n", CLUSTER_MAX_N_SERVER);
+  }
+  if (n_cache <= 0 || n_cache > CLUSTER_MAX_N_CACHE_PER_SERVER) {
+    ERROR("a server has 1 to %d caches, got %d\n", CLUSTER_MAX_N_CACHE_PER_SERVER, n_cache);
+  }
+  if (weight <= 0) {
+    ERROR("the weight of a server should be positive, got %lf\n", weight);
+  }
+
+  cluster_server_t *server = aligned_alloc(64, sizeof(cluster_server_t));
+  memset(server, 0, sizeof(cluster_server_t));
+  server->server_id = cluster->n_server;
+  memcpy(server->caches, caches, sizeof(cache_t *) * n_cache);
+  server->n_cache = n_cache;
+  server->weight = weight;
+  server->active = true;
+
+  cluster->servers[cluster->n_server++] = server;
+  cluster_rebuild_ring(cluster);
+
+  return server->server_id;
+}
+
+static cluster_server_t *cluster_server(const cluster_t *cluster, int server_id) {
+  if (server_id < 0 || server_id >= cluster->n_server) {
+    ERROR("server %d does not exist, the cluster has %d servers\n", server_id, cluster->n_server);
+  }
+  return cluster->servers[server_id];
+}
+
+void cluster_remove_server(cluster_t *cluster, int server_id) {
+  cluster_server(cluster, server_id)->active = false;
+  cluster_rebuild_ring(cluster);
+}
+
+void cluster_restore_server(cluster_t *cluster, int server_id) {
+  cluster_server(cluster, server_id)->active = true;
+  cluster_rebuild_ring(cluster);
+}
+
+int cluster_get_server(const cluster_t *cluster, obj_id_t obj_id) {
+  if (cluster->ring == NULL) return -1;
+  return (int)ch_ring_get_server(obj_id, cluster->ring);
+}
+
+cache_t *cluster_get_cache(const cluster_t *cluster, int server_id, int cache_idx) {
+  if (server_id < 0 || server_id >= cluster->n_server) return NULL;
+  cluster_server_t *server = cluster->servers[server_id];
+  if (cache_idx < 0 || cache_idx >= server->n_cache) return NULL;
+  return server->caches[cache_idx];
+}
+
+/* check the caches of the server in order */
+static inline bool server_get(cluster_server_t *server, const request_t *req) {
+  server->n_req += 1;
+  server->n_req_byte += req->obj_size;
+  for (int i = 0; i < server->n_cache; i++) {
+    cache_t *cache = server->caches[i];
+    if (cache->get(cache, req)) {
+      return true;
+    }
+  }
+  server->n_miss += 1;
+  server->n_miss_byte += req->obj_size;
+  return false;
+}
+
+bool cluster_get(cluster_t *cluster, const request_t *req) {
+  int server_id = cluster_get_server(cluster, req->obj_id);
+  if (server_id < 0) return false;
+  return server_get(cluster->servers[server_id], req);
+}
+
+void free_cluster(cluster_t *cluster) {
+  for (int i = 0; i < cluster->n_server; i++) {
+    cluster_server_t *server = cluster->servers[i];
+    for (int j = 0; j < server->n_cache; j++) {
+      server->caches[j]->cache_free(server->caches[j]);
+    }
+    if (server->ring.reqs != NULL) {
+      spsc_ring_free(&server->ring);
+    }
+    free(server);
+  }
+  if (cluster->ring != NULL) {
+    ch_ring_destroy(cluster->ring);
+  }
+  free(cluster);
+}
+
+// ***********************************************************************
+// ****                                                               ****
+// ****                    parallel simulation                        ****
+// ****                                                               ****
+// ***********************************************************************
+
+/* process the published requests of the server, return false if none */
+static bool server_drain(cluster_server_t *server, request_t *req) {
+  spsc_ring_t *ring = &server->ring;
+  uint64_t head = atomic_load_explicit(&ring->head, memory_order_relaxed);
+  uint64_t tail = spsc_ring_published(ring);
+  if (head == tail) return false;
+
+  for (; head != tail; head++) {
+    spsc_req_to_req(&ring->reqs[head & (SPSC_RING_SIZE - 1)], req);
+    server_get(server, req);
+  }
+  spsc_ring_consume(ring, head);
+  return true;
+}
+
+/* whether the worker has requests to process or should stop */
+static bool cluster_worker_has_work(void *arg) {
+  cluster_worker_t *worker = (cluster_worker_t *)arg;
+  if (atomic_load_explicit(&worker->stop, memory_order_acquire)) return true;
+
+  int n_server = atomic_load_explicit(&worker->n_server, memory_order_acquire);
+  for (int i = 0; i < n_server; i++) {
+    spsc_ring_t *ring = &worker->servers[i]->ring;
+    if (atomic_load_explicit(&ring->head, memory_order_relaxed) != spsc_ring_published(ring)) return true;
+  }
+  return false;
+}
+
+static void *cluster_worker(void *arg) {
+  cluster_worker_t *worker = (cluster_worker_t *)arg;
+  request_t *req = new_request();
+
+  int n_spin = 0;
+  while (true) {
+    /* the router publishes the last requests before setting stop, so if
+     * stop is set before the scan and nothing is found, all are processed */
+    bool stop = atomic_load_explicit(&worker->stop, memory_order_acquire);
+    int n_server = atomic_load_explicit(&worker->n_server, memory_order_acquire);
+    bool found = false;
+    for (int i = 0; i < n_server; i++) {
+      found |= server_drain(worker->servers[i], req);
+    }
+
+    if (found) {
+      n_spin = 0;
+    } else if (stop) {
+      break;
+    } else if (++n_spin > SPSC_RING_SPIN_BEFORE_YIELD + CLUSTER_YIELD_BEFORE_PARK) {
+      spsc_waiter_wait(&worker->waiter, cluster_worker_has_work, worker);
+      n_spin = 0;
+    } else if (n_spin > SPSC_RING_SPIN_BEFORE_YIELD) {
+      sched_yield();
+    }
+  }
+
+  free_request(req);
+  return NULL;
+}
+
+/* give the server to a worker, the worker sees the server after the release,
+ * the router wakes the worker when it publishes to the ring of the server */
+static void assign_server(cluster_worker_t *workers, int n_worker, cluster_server_t *server) {
+  if (server->ring.reqs == NULL) {
+    spsc_ring_init(&server->ring);
+  }
+  spsc_ring_reset(&server->ring);
+
+  cluster_worker_t *worker = &workers[server->server_id % n_worker];
+  spsc_ring_set_waiter(&server->ring, &worker->waiter);
+  int n = atomic_load_explicit(&worker->n_server, memory_order_relaxed);
+  worker->servers[n] = server;
+  atomic_store_explicit(&worker->n_server, n + 1, memory_order_release);
+}
+
+static void apply_event(cluster_t *cluster, const cluster_event_t *event, cluster_worker_t *workers, int n_worker) {
+  if (event->type == CLUSTER_REMOVE_SERVER) {
+    cluster_remove_server(cluster, event->server_id);
+  } else if (event->server_id >= 0) {
+    cluster_restore_server(cluster, event->server_id);
+  } else {
+    int server_id = cluster_add_server(cluster, event->caches, event->n_cache, event->weight);
+    if (workers != NULL) {
+      assign_server(workers, n_worker, cluster->servers[server_id]);
+    }
+  }
+}
+
+cluster_stat_t *simulate_cluster(reader_t *reader, cluster_t *cluster, const cluster_event_t *events, int n_event,
+                                 int n_thread) {
+  for (int i = 0; i < cluster->n_server; i++) {
+    cluster_server_t *server = cluster->servers[i];
+    server->n_req = server->n_miss = server->n_req_byte = server->n_miss_byte = 0;
+  }
+  for (int i = 1; i < n_event; i++) {
+    if (events[i].time < events[i - 1].time) {
+      ERROR("cluster events should be sorted by time\n");
+    }
+  }
+
+  int n_worker = n_thread;
+  if (n_thread <= 0) {
+    n_worker = cluster->n_server;
+    for (int i = 0; i < n_event; i++) {
+      n_worker += events[i].type == CLUSTER_ADD_SERVER && events[i].server_id < 0;
+    }
+    /* the router is the bottleneck, more workers than cores only spin */
+    n_worker = MIN(n_worker, (int)sysconf(_SC_NPROCESSORS_ONLN));
+    n_worker = MIN(MAX(n_worker, 1), CLUSTER_MAX_N_SERVER);
+  }
+
+  /* a single worker runs in the router thread */
+  cluster_worker_t *workers = NULL;
+  if (n_worker > 1) {
+    workers = calloc(n_worker, sizeof(cluster_worker_t));
+    for (int i = 0; i < n_worker; i++) {
+      spsc_waiter_init(&workers[i].waiter);
+    }
+    for (int i = 0; i < cluster->n_server; i++) {
+      assign_server(workers, n_worker, cluster->servers[i]);
+    }
+    for (int i = 0; i < n_worker; i++) {
+      workers[i].idx = i;
+      atomic_store(&workers[i].stop, false);
+      if (pthread_create(&workers[i].thread, NULL, cluster_worker, &workers[i]) != 0) {
+        ERROR("cannot create cluster worker thread\n");
+      }
+    }
+  }
+
+  cluster_stat_t *stat = malloc(sizeof(cluster_stat_t));
+  memset(stat, 0, sizeof(cluster_stat_t));
+
+  request_t *req = new_request();
+  int next_event = 0;
+  read_one_req(reader, req);
+  while (req->valid) {
+    while (next_event < n_event && events[next_event].time <= req->clock_time) {
+      apply_event(cluster, &events[next_event++], workers, n_worker);
+    }
+
+    int server_id = cluster_get_server(cluster, req->obj_id);
+    if (server_id < 0) {
+      stat->n_req_no_server += 1;
+      stat->n_req += 1;
+      stat->n_miss += 1;
+      stat->n_req_byte += req->obj_size;
+      stat->n_miss_byte += req->obj_size;
+    } else if (workers == NULL) {
+      server_get(cluster->servers[server_id], req);
+    } else {
+      spsc_ring_push(&cluster->servers[server_id]->ring, req, true);
+    }
+
+    read_one_req(reader, req);
+  }
+  free_request(req);
+
+  if (workers != NULL) {
+    for (int i = 0; i < cluster->n_server; i++) {
+      spsc_ring_publish(&cluster->servers[i]->ring);
+    }
+    for (int i = 0; i < n_worker; i++) {
+      spsc_waiter_stop(&workers[i].waiter, &workers[i].stop);
+    }
+    for (int i = 0; i < n_worker; i++) {
+      pthread_join(workers[i].thread, NULL);
+    }
+    for (int i = 0; i < cluster->n_server; i++) {
+      if (cluster->servers[i]->ring.reqs != NULL) {
+        spsc_ring_set_waiter(&cluster->servers[i]->ring, NULL);
+      }
+    }
+    for (int i = 0; i < n_worker; i++) {
+      spsc_waiter_free(&workers[i].waiter);
+    }
+    free(workers);
+  }
+
+  stat->n_server = cluster->n_server;
+  stat->server_stats = malloc(sizeof(cluster_server_stat_t) * MAX(cluster->n_server, 1));
+  for (int i = 0; i < cluster->n_server; i++) {
+    cluster_server_t *server = cluster->servers[i];
+    cluster_server_stat_t *s = &stat->server_stats[i];
+    s->server_id = server->server_id;
+    s->active = server->active;
+    s->n_req = server->n_req;
+    s->n_miss = server->n_miss;
+    s->n_req_byte = server->n_req_byte;
+    s->n_miss_byte = server->n_miss_byte;
+
+    stat->n_req += server->n_req;
+    stat->n_miss += server->n_miss;
+    stat->n_req_byte += server->n_req_byte;
+    stat->n_miss_byte += server->n_miss_byte;
+  }
+
+  return stat;
+}
+
+void free_cluster_stat(cluster_stat_t *stat) {
+  free(stat->server_stats);
+  free(stat);
+}
+
+#ifdef __cplusplus
+}
+#endif
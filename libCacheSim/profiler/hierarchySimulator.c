@@ -0,0 +1,380 @@
+//
+//  simulate a cache hierarchy in memory
+//
+//  the traces are read into a batch of requests, the output of a node is the
+//  positions of its requests (trace) or misses (cache) in the batch, a cache
+//  merges the outputs of its upstream nodes by position, which is the order
+//  of the merged trace, so each cache sees its requests in the same order as
+//  replaying the miss traces, the caches of one level are simulated in
+//  parallel, and the levels are simulated one after another
+//
+//  hierarchySimulator.c
+//  libCacheSim
+//
+
+#include "../include/libCacheSim/hierarchySimulator.h"
+
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "../include/libCacheSim/logging.h"
+#include "../include/libCacheSim/macro.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* the number of requests read from the traces before they are simulated */
+#define HIERARCHY_BATCH_SIZE 16384
+
+/* the fields of a request passed between the levels */
+typedef struct {
+  int64_t clock_time;
+  obj_id_t obj_id;
+  int64_t obj_size;
+  int64_t next_access_vtime;
+  int32_t ttl;
+  int32_t tenant_id;
+  uint8_t op;
+} hierarchy_req_t;
+
+typedef struct {
+  /* a node is either a trace or a cache */
+  reader_t *reader;
+  cache_t *cache;
+  int level;
+  int *upstream;
+  int n_upstream;
+
+  /* the positions of the requests sent to the next level in the batch */
+  uint32_t *out;
+  uint32_t n_out;
+  /* the merged requests of the upstream nodes */
+  uint32_t *in;
+  /* the max number of requests the node receives in a batch, a request can
+   * come from several upstream nodes if they all miss */
+  uint64_t max_n_in;
+
+  cache_stat_t stat;
+} hierarchy_node_t;
+
+struct cache_hierarchy {
+  hierarchy_node_t *nodes;
+  int n_node;
+  int node_array_size;
+  int n_level;
+
+  /* the state of the simulation */
+  hierarchy_req_t *batch;
+  int **level_nodes;
+  int *level_n_node;
+  int curr_level;
+  _Atomic int next_node;
+  _Atomic bool stop;
+  pthread_barrier_t barrier;
+};
+
+cache_hierarchy_t *create_cache_hierarchy(void) {
+  cache_hierarchy_t *hierarchy = malloc(sizeof(cache_hierarchy_t));
+  memset(hierarchy, 0, sizeof(cache_hierarchy_t));
+  return hierarchy;
+}
+
+static int hierarchy_add_node(cache_hierarchy_t *hierarchy) {
+  if (hierarchy->n_node == hierarchy->node_array_size) {
+    hierarchy->node_array_size = MAX(hierarchy->node_array_size * 2, 8);
+    hierarchy->nodes = realloc(hierarchy->nodes, sizeof(hierarchy_node_t) * hierarchy->node_array_size);
+  }
+  hierarchy_node_t *node = &hierarchy->nodes[hierarchy->n_node];
+  memset(node, 0, sizeof(hierarchy_node_t));
+  return hierarchy->n_node++;
+}
+
+int hierarchy_add_trace(cache_hierarchy_t *hierarchy, reader_t *reader) {
+  int node_id = hierarchy_add_node(hierarchy);
+  hierarchy->nodes[node_id].reader = reader;
+  return node_id;
+}
+
+int hierarchy_add_cache(cache_hierarchy_t *hierarchy, cache_t *cache, const int *upstream, int n_upstream) {
+  if (n_upstream <= 0) {
+    ERROR("a cache in the hierarchy needs at least one upstream node\n");
+  }
+
+  int level = 0;
+  for (int i = 0; i < n_upstream; i++) {
+    if (upstream[i] < 0 || upstream[i] >= hierarchy->n_node) {
+      ERROR("upstream node %d does not exist, the hierarchy has %d nodes\n", upstream[i], hierarchy->n_node);
+    }
+    level = MAX(level, hierarchy->nodes[upstream[i]].level + 1);
+  }
+
+  int node_id = hierarchy_add_node(hierarchy);
+  hierarchy_node_t *node = &hierarchy->nodes[node_id];
+  node->cache = cache;
+  node->level = level;
+  node->upstream = malloc(sizeof(int) * n_upstream);
+  memcpy(node->upstream, upstream, sizeof(int) * n_upstream);
+  node->n_upstream = n_upstream;
+  hierarchy->n_level = MAX(hierarchy->n_level, level + 1);
+
+  return node_id;
+}
+
+cache_t *hierarchy_get_cache(const cache_hierarchy_t *hierarchy, int node_id) {
+  if (node_id < 0 || node_id >= hierarchy->n_node) return NULL;
+  return hierarchy->nodes[node_id].cache;
+}
+
+int hierarchy_get_level(const cache_hierarchy_t *hierarchy, int node_id) {
+  if (node_id < 0 || node_id >= hierarchy->n_node) return -1;
+  return hierarchy->nodes[node_id].level;
+}
+
+void free_cache_hierarchy(cache_hierarchy_t *hierarchy) {
+  for (int i = 0; i < hierarchy->n_node; i++) {
+    hierarchy_node_t *node = &hierarchy->nodes[i];
+    if (node->cache != NULL) {
+      node->cache->cache_free(node->cache);
+    }
+    free(node->upstream);
+  }
+  free(hierarchy->nodes);
+  free(hierarchy);
+}
+
+// ***********************************************************************
+// ****                                                               ****
+// ****                          simulation                           ****
+// ****                                                               ****
+// ***********************************************************************
+
+/* merge the sorted outputs of the upstream nodes */
+static uint32_t merge_upstream(const cache_hierarchy_t *hierarchy, const hierarchy_node_t *node, uint32_t *in) {
+  uint32_t pos[node->n_upstream];
+  memset(pos, 0, sizeof(pos));
+  uint32_t n_in = 0;
+  while (true) {
+    int min_upstream = -1;
+    uint32_t min_idx = UINT32_MAX;
+    for (int i = 0; i < node->n_upstream; i++) {
+      const hierarchy_node_t *up = &hierarchy->nodes[node->upstream[i]];
+      if (pos[i] < up->n_out && up->out[pos[i]] < min_idx) {
+        min_idx = up->out[pos[i]];
+        min_upstream = i;
+      }
+    }
+    if (min_upstream == -1) break;
+    in[n_in++] = min_idx;
+    pos[min_upstream] += 1;
+  }
+  return n_in;
+}
+
+static void simulate_node(cache_hierarchy_t *hierarchy, hierarchy_node_t *node, request_t *req) {
+  const uint32_t *in;
+  uint32_t n_in;
+  if (node->n_upstream == 1) {
+    const hierarchy_node_t *up = &hierarchy->nodes[node->upstream[0]];
+    in = up->out;
+    n_in = up->n_out;
+  } else {
+    n_in = merge_upstream(hierarchy, node, node->in);
+    in = node->in;
+  }
+
+  cache_t *cache = node->cache;
+  node->n_out = 0;
+  for (uint32_t i = 0; i < n_in; i++) {
+    const hierarchy_req_t *r = &hierarchy->batch[in[i]];
+    req->clock_time = r->clock_time;
+    req->obj_id = r->obj_id;
+    req->obj_size = r->obj_size;
+    req->next_access_vtime = r->next_access_vtime;
+    req->ttl = r->ttl;
+    req->tenant_id = r->tenant_id;
+    req->op = (req_op_e)r->op;
+    req->hv = 0;
+    req->valid = true;
+
+    node->stat.n_req += 1;
+    node->stat.n_req_byte += req->obj_size;
+    if (!cache->get(cache, req)) {
+      node->stat.n_miss += 1;
+      node->stat.n_miss_byte += req->obj_size;
+      node->out[node->n_out++] = in[i];
+    }
+  }
+}
+
+/* the caches of the current level are taken by the threads one by one */
+static void simulate_level(cache_hierarchy_t *hierarchy, request_t *req) {
+  int level = hierarchy->curr_level;
+  int n = hierarchy->level_n_node[level];
+  int i;
+  while ((i = atomic_fetch_add_explicit(&hierarchy->next_node, 1, memory_order_relaxed)) < n) {
+    simulate_node(hierarchy, &hierarchy->nodes[hierarchy->level_nodes[level][i]], req);
+  }
+}
+
+static void *hierarchy_worker(void *arg) {
+  cache_hierarchy_t *hierarchy = (cache_hierarchy_t *)arg;
+  request_t *req = new_request();
+  while (true) {
+    /* the barriers order the accesses to the batch and the outputs */
+    pthread_barrier_wait(&hierarchy->barrier);
+    if (atomic_load_explicit(&hierarchy->stop, memory_order_relaxed)) break;
+    simulate_level(hierarchy, req);
+    pthread_barrier_wait(&hierarchy->barrier);
+  }
+  free_request(req);
+  return NULL;
+}
+
+static void copy_req(hierarchy_req_t *r, const request_t *req) {
+  r->clock_time = req->clock_time;
+  r->obj_id = req->obj_id;
+  r->obj_size = req->obj_size;
+  r->next_access_vtime = req->next_access_vtime;
+  r->ttl = req->ttl;
+  r->tenant_id = req->tenant_id;
+  r->op = (uint8_t)req->op;
+}
+
+/* read the next batch from the traces, the trace with the smallest clock
+ * time goes first, return the number of requests */
+static uint32_t read_batch(cache_hierarchy_t *hierarchy, request_t **next_reqs) {
+  for (int i = 0; i < hierarchy->n_node; i++) {
+    hierarchy->nodes[i].n_out = 0;
+  }
+
+  uint32_t n_req = 0;
+  while (n_req < HIERARCHY_BATCH_SIZE) {
+    int trace = -1;
+    for (int i = 0; i < hierarchy->n_node; i++) {
+      if (next_reqs[i] == NULL || !next_reqs[i]->valid) continue;
+      if (trace == -1 || next_reqs[i]->clock_time < next_reqs[trace]->clock_time) {
+        trace = i;
+      }
+    }
+    if (trace == -1) break;
+
+    hierarchy_node_t *node = &hierarchy->nodes[trace];
+    copy_req(&hierarchy->batch[n_req], next_reqs[trace]);
+    node->out[node->n_out++] = n_req;
+    node->stat.n_req += 1;
+    node->stat.n_req_byte += next_reqs[trace]->obj_size;
+    n_req += 1;
+    read_one_req(node->reader, next_reqs[trace]);
+  }
+  return n_req;
+}
+
+cache_stat_t *simulate_cache_hierarchy(cache_hierarchy_t *hierarchy, int n_thread) {
+  int n_node = hierarchy->n_node;
+  if (n_thread < 1) n_thread = 1;
+
+  /* group the caches by level */
+  hierarchy->level_nodes = malloc(sizeof(int *) * MAX(hierarchy->n_level, 1));
+  hierarchy->level_n_node = calloc(MAX(hierarchy->n_level, 1), sizeof(int));
+  for (int l = 0; l < hierarchy->n_level; l++) {
+    hierarchy->level_nodes[l] = malloc(sizeof(int) * MAX(n_node, 1));
+  }
+
+  request_t **next_reqs = calloc(MAX(n_node, 1), sizeof(request_t *));
+  for (int i = 0; i < n_node; i++) {
+    hierarchy_node_t *node = &hierarchy->nodes[i];
+    memset(&node->stat, 0, sizeof(cache_stat_t));
+    node->max_n_in = node->reader != NULL ? HIERARCHY_BATCH_SIZE : 0;
+    for (int j = 0; j < node->n_upstream; j++) {
+      /* the upstream nodes have smaller ids */
+      node->max_n_in += hierarchy->nodes[node->upstream[j]].max_n_in;
+    }
+    node->out = malloc(sizeof(uint32_t) * node->max_n_in);
+    node->in = node->n_upstream > 1 ? malloc(sizeof(uint32_t) * node->max_n_in) : NULL;
+    if (node->reader != NULL) {
+      next_reqs[i] = new_request();
+      read_one_req(node->reader, next_reqs[i]);
+    } else {
+      hierarchy->level_nodes[node->level][hierarchy->level_n_node[node->level]++] = i;
+    }
+  }
+  hierarchy->batch = malloc(sizeof(hierarchy_req_t) * HIERARCHY_BATCH_SIZE);
+
+  /* the calling thread is one of the threads */
+  pthread_t *workers = NULL;
+  atomic_store(&hierarchy->stop, false);
+  if (n_thread > 1) {
+    pthread_barrier_init(&hierarchy->barrier, NULL, n_thread);
+    workers = malloc(sizeof(pthread_t) * (n_thread - 1));
+    for (int i = 0; i < n_thread - 1; i++) {
+      if (pthread_create(&workers[i], NULL, hierarchy_worker, hierarchy) != 0) {
+        ERROR("cannot create hierarchy worker thread\n");
+      }
+    }
+  }
+
+  request_t *req = new_request();
+  while (read_batch(hierarchy, next_reqs) > 0) {
+    /* level 0 is the traces */
+    for (int l = 1; l < hierarchy->n_level; l++) {
+      hierarchy->curr_level = l;
+      atomic_store_explicit(&hierarchy->next_node, 0, memory_order_relaxed);
+      if (workers != NULL) pthread_barrier_wait(&hierarchy->barrier);
+      simulate_level(hierarchy, req);
+      if (workers != NULL) pthread_barrier_wait(&hierarchy->barrier);
+    }
+  }
+  free_request(req);
+
+  if (workers != NULL) {
+    atomic_store(&hierarchy->stop, true);
+    pthread_barrier_wait(&hierarchy->barrier);
+    for (int i = 0; i < n_thread - 1; i++) {
+      pthread_join(workers[i], NULL);
+    }
+    free(workers);
+    pthread_barrier_destroy(&hierarchy->barrier);
+  }
+
+  cache_stat_t *stat = malloc(sizeof(cache_stat_t) * MAX(n_node, 1));
+  for (int i = 0; i < n_node; i++) {
+    hierarchy_node_t *node = &hierarchy->nodes[i];
+    stat[i] = node->stat;
+    if (node->cache != NULL) {
+      cache_t *cache = node->cache;
+      stat[i].cache_size = cache->cache_size;
+      stat[i].n_obj = cache->get_n_obj(cache);
+      stat[i].occupied_byte = cache->get_occupied_byte(cache);
+      snprintf(stat[i].cache_name, CACHE_NAME_ARRAY_LEN, "%s", cache->cache_name);
+    } else {
+      stat[i].n_miss = stat[i].n_req;
+      stat[i].n_miss_byte = stat[i].n_req_byte;
+      snprintf(stat[i].cache_name, CACHE_NAME_ARRAY_LEN, "trace");
+    }
+
+    free(node->out);
+    free(node->in);
+    node->out = node->in = NULL;
+    if (next_reqs[i] != NULL) free_request(next_reqs[i]);
+  }
+
+  for (int l = 0; l < hierarchy->n_level; l++) {
+    free(hierarchy->level_nodes[l]);
+  }
+  free(hierarchy->level_nodes);
+  free(hierarchy->level_n_node);
+  free(hierarchy->batch);
+  free(next_reqs);
+  hierarchy->level_nodes = NULL;
+  hierarchy->level_n_node = NULL;
+  hierarchy->batch = NULL;
+
+  return stat;
+}
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,188 @@
+//
+//  metricsSink.c
+//  libCacheSim
+//
+//  record the per-interval metrics of simulations into a binary columnar file
+//
+
+#include "../include/libCacheSim/metricsSink.h"
+
+#include <errno.h>
+
+#include "../include/libCacheSim/logging.h"
+#include "../include/libCacheSim/macro.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+static const char METRICS_SINK_MAGIC[8] = {'L', 'C', 'S', 'M', 'T', 'R', 'C', '1'};
+
+const char *g_metrics_column_names[METRICS_N_COLUMN] = {
+    "vtime", "rtime", "n_req", "n_req_byte", "n_miss", "n_miss_byte", "n_evict", "occupied_byte", "n_obj"};
+
+metrics_sink_t *create_metrics_sink(const char *path, metrics_interval_type_e interval_type, int64_t interval) {
+  if (interval <= 0) {
+    ERROR("metrics interval must be positive, %ld\n", (long)interval);
+  }
+
+  FILE *f = fopen(path, "wb");
+  if (f == NULL) {
+    WARN("cannot open metrics file %s: %s\n", path, strerror(errno));
+    return NULL;
+  }
+
+  metrics_sink_t *sink = my_malloc(metrics_sink_t);
+  memset(sink, 0, sizeof(metrics_sink_t));
+  sink->file = f;
+  sink->path = strdup(path);
+  sink->interval_type = interval_type;
+  sink->interval = interval;
+  sink->max_n_cache = 8;
+  sink->recorders = malloc(sizeof(metrics_recorder_t *) * sink->max_n_cache);
+  pthread_mutex_init(&sink->mtx, NULL);
+
+  return sink;
+}
+
+metrics_recorder_t *metrics_sink_attach(metrics_sink_t *sink, cache_t *cache) {
+  pthread_mutex_lock(&sink->mtx);
+  if (sink->header_written) {
+    ERROR("cannot attach %s to metrics sink %s after the simulation starts\n", cache->cache_name, sink->path);
+  }
+
+  if (sink->n_cache == sink->max_n_cache) {
+    sink->max_n_cache *= 2;
+    sink->recorders = realloc(sink->recorders, sizeof(metrics_recorder_t *) * sink->max_n_cache);
+  }
+
+  metrics_recorder_t *recorder = my_malloc(metrics_recorder_t);
+  memset(recorder, 0, sizeof(metrics_recorder_t));
+  recorder->sink = sink;
+  recorder->cache = cache;
+  recorder->cache_idx = sink->n_cache;
+  memcpy(recorder->cache_name, cache->cache_name, CACHE_NAME_ARRAY_LEN);
+  recorder->cache_size = cache->cache_size;
+  recorder->last_n_evict = cache->n_evict;
+  sink->recorders[sink->n_cache++] = recorder;
+  pthread_mutex_unlock(&sink->mtx);
+
+  cache->metrics_recorder = recorder;
+  return recorder;
+}
+
+/* the caller holds the lock */
+static void _write_header(metrics_sink_t *sink) {
+  int32_t header_i32[4] = {METRICS_SINK_VERSION, METRICS_N_COLUMN, sink->n_cache, (int32_t)sink->interval_type};
+  fwrite(METRICS_SINK_MAGIC, sizeof(METRICS_SINK_MAGIC), 1, sink->file);
+  fwrite(header_i32, sizeof(header_i32), 1, sink->file);
+  fwrite(&sink->interval, sizeof(sink->interval), 1, sink->file);
+
+  char column_name[METRICS_COLUMN_NAME_LEN];
+  for (int i = 0; i < METRICS_N_COLUMN; i++) {
+    memset(column_name, 0, sizeof(column_name));
+    snprintf(column_name, sizeof(column_name), "%s", g_metrics_column_names[i]);
+    fwrite(column_name, sizeof(column_name), 1, sink->file);
+  }
+
+  /* the caches may have been freed, use the copy in the recorder */
+  for (int i = 0; i < sink->n_cache; i++) {
+    const metrics_recorder_t *recorder = sink->recorders[i];
+    fwrite(recorder->cache_name, sizeof(recorder->cache_name), 1, sink->file);
+    fwrite(&recorder->cache_size, sizeof(recorder->cache_size), 1, sink->file);
+  }
+
+  sink->header_written = true;
+}
+
+static void _flush_recorder(metrics_recorder_t *recorder) {
+  if (recorder->n_row == 0) {
+    return;
+  }
+
+  metrics_sink_t *sink = recorder->sink;
+  int32_t block_header[2] = {recorder->cache_idx, recorder->n_row};
+
+  pthread_mutex_lock(&sink->mtx);
+  if (!sink->header_written) {
+    _write_header(sink);
+  }
+  bool success = fwrite(block_header, sizeof(block_header), 1, sink->file) == 1;
+  for (int i = 0; i < METRICS_N_COLUMN; i++) {
+    success = success && fwrite(recorder->columns[i], sizeof(int64_t), recorder->n_row, sink->file) ==
+                             (size_t)recorder->n_row;
+  }
+  pthread_mutex_unlock(&sink->mtx);
+
+  if (!success) {
+    WARN_ONCE("fail to write metrics to %s\n", sink->path);
+  }
+  recorder->n_row = 0;
+}
+
+void metrics_recorder_end_interval(metrics_recorder_t *recorder, int64_t curr) {
+  const cache_t *cache = recorder->cache;
+  int32_t row = recorder->n_row;
+
+  recorder->columns[METRICS_COL_VTIME][row] = recorder->vtime;
+  recorder->columns[METRICS_COL_RTIME][row] = recorder->last_rtime;
+  recorder->columns[METRICS_COL_N_REQ][row] = recorder->n_req;
+  recorder->columns[METRICS_COL_N_REQ_BYTE][row] = recorder->n_req_byte;
+  recorder->columns[METRICS_COL_N_MISS][row] = recorder->n_miss;
+  recorder->columns[METRICS_COL_N_MISS_BYTE][row] = recorder->n_miss_byte;
+  recorder->columns[METRICS_COL_N_EVICT][row] = cache->n_evict - recorder->last_n_evict;
+  recorder->columns[METRICS_COL_OCCUPIED_BYTE][row] = cache->get_occupied_byte(cache);
+  recorder->columns[METRICS_COL_N_OBJ][row] = cache->get_n_obj(cache);
+
+  recorder->last_n_evict = cache->n_evict;
+  recorder->n_req = 0;
+  recorder->n_req_byte = 0;
+  recorder->n_miss = 0;
+  recorder->n_miss_byte = 0;
+
+  /* skip the intervals without requests, e.g., a gap in the trace */
+  int64_t interval = recorder->sink->interval;
+  if (curr >= recorder->next_boundary) {
+    recorder->next_boundary += ((curr - recorder->next_boundary) / interval + 1) * interval;
+  }
+
+  if (++recorder->n_row == METRICS_BLOCK_N_ROW) {
+    _flush_recorder(recorder);
+  }
+}
+
+void metrics_recorder_finish(metrics_recorder_t *recorder) {
+  if (recorder->n_req > 0) {
+    metrics_recorder_end_interval(recorder, recorder->next_boundary);
+  }
+  _flush_recorder(recorder);
+}
+
+void close_metrics_sink(metrics_sink_t *sink) {
+  for (int i = 0; i < sink->n_cache; i++) {
+    /* the recorders of the caches that finish have been flushed */
+    _flush_recorder(sink->recorders[i]);
+  }
+
+  pthread_mutex_lock(&sink->mtx);
+  if (!sink->header_written) {
+    _write_header(sink);
+  }
+  pthread_mutex_unlock(&sink->mtx);
+
+  if (fclose(sink->file) != 0) {
+    WARN("fail to close metrics file %s: %s\n", sink->path, strerror(errno));
+  }
+
+  for (int i = 0; i < sink->n_cache; i++) {
+    my_free(sizeof(metrics_recorder_t), sink->recorders[i]);
+  }
+  free(sink->recorders);
+  free(sink->path);
+  pthread_mutex_destroy(&sink->mtx);
+  my_free(sizeof(metrics_sink_t), sink);
+}
+
+#ifdef __cplusplus
+}
+#endif
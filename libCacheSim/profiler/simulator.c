@@ -12,13 +12,19 @@ extern "C" {
 
 #include "../include/libCacheSim/simulator.h"
 
+#include <errno.h>
 #include <math.h>
+#include <poll.h>
+#include <sys/wait.h>
+#include <unistd.h>
 
 #include "../cache/cacheUtils.h"
 #include "../include/libCacheSim/evictionAlgo.h"
+#include "../include/libCacheSim/metricsSink.h"
 #include "../include/libCacheSim/plugin.h"
 #include "../utils/include/myprint.h"
 #include "../utils/include/mystr.h"
+#include "staticSimulator.h"
 
 typedef struct simulator_multithreading_params {
   reader_t *reader;
@@ -53,12 +59,35 @@ static void _simulate(gpointer data, gpointer user_data) {
   cache_t *local_cache = params->caches[idx];
   strncpy(result[idx].cache_name, local_cache->cache_name, CACHE_NAME_ARRAY_LEN);
 
+  /* a cache restored from a checkpoint has been warmed up, the warmup
+   * requests are skipped without sending to the cache */
+  bool need_warmup = !local_cache->restored_from_checkpoint;
+
+  /* a sharded cache simulated in parallel does not return the result of each
+   * request, the misses are collected after all requests are submitted */
+  bool parallel = Sharded_is_parallel(local_cache);
+
+  /* the static-dispatch engine replaces the cache, so the cache stays empty */
+  static_sim_t *sim = NULL;
+  if (local_cache->use_static_sim) {
+    sim = create_static_sim(local_cache);
+    if (sim == NULL) {
+      WARN("%s: the static simulation engine does not support the cache, use cache->get\n", local_cache->cache_name);
+    }
+  }
+
   /* warm up using warmup_reader */
-  if (params->warmup_reader) {
+  if (params->warmup_reader && need_warmup) {
     reader_t *warmup_cloned_reader = clone_reader(params->warmup_reader);
     read_one_req(warmup_cloned_reader, req);
     while (req->valid) {
-      local_cache->get(local_cache, req);
+      if (parallel) {
+        Sharded_submit(local_cache, req, false);
+      } else if (sim != NULL) {
+        static_sim_get(sim, req);
+      } else {
+        local_cache->get(local_cache, req);
+      }
       result[idx].n_warmup_req += 1;
       read_one_req(warmup_cloned_reader, req);
     }
@@ -77,7 +106,13 @@ static void _simulate(gpointer data, gpointer user_data) {
     uint64_t n_warmup = 0;
     while (req->valid && (n_warmup < params->n_warmup_req || req->clock_time - start_ts < params->warmup_sec)) {
       req->clock_time -= start_ts;
-      local_cache->get(local_cache, req);
+      if (need_warmup && parallel) {
+        Sharded_submit(local_cache, req, false);
+      } else if (need_warmup && sim != NULL) {
+        static_sim_get(sim, req);
+      } else if (need_warmup) {
+        local_cache->get(local_cache, req);
+      }
       n_warmup += 1;
       read_one_req(cloned_reader, req);
     }
@@ -88,42 +123,68 @@ static void _simulate(gpointer data, gpointer user_data) {
          local_cache->cache_name, local_cache->cache_size, n_warmup, (double)(req->clock_time - start_ts) / 3600.0);
   }
 
+  if (need_warmup && result[idx].n_warmup_req > 0 && local_cache->warmup_checkpoint_path != NULL) {
+    if (parallel) {
+      Sharded_drain(local_cache, NULL, NULL);
+    }
+    cache_save_checkpoint(local_cache, local_cache->warmup_checkpoint_path);
+  }
+
+  metrics_recorder_t *recorder = local_cache->metrics_recorder;
+  if (parallel && recorder != NULL) {
+    WARN("%s: per-interval metrics are not recorded when the shards run in parallel\n", local_cache->cache_name);
+    recorder = NULL;
+  }
+  while (parallel && req->valid) {
+    result[idx].n_req++;
+    result[idx].n_req_byte += req->obj_size;
+    req->clock_time -= start_ts;
+    Sharded_submit(local_cache, req, true);
+    read_one_req(cloned_reader, req);
+  }
+  if (parallel) {
+    int64_t n_miss, n_miss_byte;
+    Sharded_drain(local_cache, &n_miss, &n_miss_byte);
+    result[idx].n_miss += n_miss;
+    result[idx].n_miss_byte += n_miss_byte;
+  }
+
+  if (sim != NULL) {
+    static_sim_run(sim, cloned_reader, req, start_ts, &result[idx]);
+  }
+
   while (req->valid) {
     result[idx].n_req++;
     result[idx].n_req_byte += req->obj_size;
 
     req->clock_time -= start_ts;
-    if (local_cache->get(local_cache, req) == false) {
+    bool hit = local_cache->get(local_cache, req);
+    if (hit == false) {
       result[idx].n_miss++;
       result[idx].n_miss_byte += req->obj_size;
     }
+    if (recorder != NULL) {
+      metrics_recorder_record(recorder, req, hit);
+    }
     read_one_req(cloned_reader, req);
   }
-
-/* disabled due to ARC and LeCaR use ghost entries in the hash table */
-#if defined(SUPPORT_TTL) && defined(ENABLE_SCAN)
-  /* get expiration information */
-  if (local_cache->hashtable->n_obj != 0) {
-    cache_stat_t temp_stat;
-    memset(&temp_stat, 0, sizeof(cache_stat_t));
-    temp_stat.curr_rtime = req->clock_time;
-    get_cache_state(local_cache, &temp_stat);
-
-    if (local_cache->occupied_size != temp_stat.occupied_size) {
-      WARN(
-          "occupied_size not match, %ld vs %ld, maybe the "
-          "cache uses a ghost list, in which case, the expired "
-          "object count may not be accurate",
-          local_cache->occupied_size, temp_stat.occupied_size);
-    }
-    result[idx].expired_obj_cnt = temp_stat.expired_obj_cnt;
-    result[idx].expired_bytes = temp_stat.expired_bytes;
+  if (recorder != NULL) {
+    metrics_recorder_finish(recorder);
   }
+
+#ifdef SUPPORT_TTL
+  /* the expired objects are removed as the trace time advances */
+  result[idx].expired_obj_cnt = local_cache->n_expired_obj;
+  result[idx].expired_bytes = local_cache->n_expired_byte;
 #endif
 
   result[idx].curr_rtime = req->clock_time;
-  result[idx].n_obj = local_cache->n_obj;
-  result[idx].occupied_byte = local_cache->occupied_byte;
+  if (sim != NULL) {
+    free_static_sim(sim);
+  } else {
+    result[idx].n_obj = local_cache->n_obj;
+    result[idx].occupied_byte = local_cache->occupied_byte;
+  }
 
   // report progress
   g_mutex_lock(&(params->mtx));
@@ -304,6 +365,210 @@ cache_stat_t *simulate_with_multi_caches(reader_t *reader, cache_t *caches[], in
   return result;
 }
 
+/**
+ * @brief whether a forked child can continue reading from the reader of the
+ * parent, an uncompressed binary trace is read through mmap so the read
+ * position is private to each process, other readers share the file offset
+ * with the parent and the other children
+ */
+static bool _reader_is_fork_safe(const reader_t *reader) {
+  return reader->trace_format == BINARY_TRACE_FORMAT && !reader->is_zstd_file && reader->mapped_file != NULL;
+}
+
+/**
+ * @brief run one branch in the forked child, the result is written to fd
+ * and the child exits without returning
+ */
+static void _simulate_branch(reader_t *reader, reader_t *prefix_reader, int64_t n_prefix_req, int64_t start_ts,
+                             reader_t *branch_reader, cache_t *cache, int branch_idx,
+                             sim_branch_setup_func_ptr branch_setup, void *user_data, int fd) {
+  /* the metrics sink is owned by the parent */
+  cache->metrics_recorder = NULL;
+  if (branch_setup != NULL) {
+    branch_setup(cache, branch_idx, user_data);
+  }
+
+  reader_t *local_reader = NULL;
+  if (branch_reader != NULL) {
+    local_reader = clone_reader(branch_reader);
+  } else if (_reader_is_fork_safe(prefix_reader)) {
+    local_reader = prefix_reader;
+  } else {
+    /* skip the prefix using a private copy of the reader */
+    local_reader = clone_reader(reader);
+    request_t *req = new_request();
+    for (int64_t i = 0; i < n_prefix_req; i++) {
+      read_one_req(local_reader, req);
+    }
+    free_request(req);
+  }
+
+  cache_stat_t result;
+  memset(&result, 0, sizeof(result));
+  strncpy(result.cache_name, cache->cache_name, CACHE_NAME_ARRAY_LEN);
+  result.cache_size = cache->cache_size;
+  result.n_warmup_req = n_prefix_req;
+
+  request_t *req = new_request();
+  read_one_req(local_reader, req);
+  while (req->valid) {
+    result.n_req++;
+    result.n_req_byte += req->obj_size;
+
+    req->clock_time -= start_ts;
+    if (cache->get(cache, req) == false) {
+      result.n_miss++;
+      result.n_miss_byte += req->obj_size;
+    }
+    read_one_req(local_reader, req);
+  }
+  result.curr_rtime = req->clock_time;
+  result.n_obj = cache->get_n_obj(cache);
+  result.occupied_byte = cache->get_occupied_byte(cache);
+
+  /* the result is smaller than PIPE_BUF, so the write is atomic */
+  bool success = write(fd, &result, sizeof(result)) == (ssize_t)sizeof(result);
+  close(fd);
+  /* the memory is released when the child exits, skip the clean up */
+  _exit(success ? 0 : 1);
+}
+
+/**
+ * @brief run the shared prefix of the trace once, then fork n_branch children
+ * that continue from the warmed cache, see simulator.h
+ */
+cache_stat_t *simulate_with_branches(reader_t *reader, cache_t *cache, int64_t n_prefix_req, int n_branch,
+                                     reader_t *branch_readers[], sim_branch_setup_func_ptr branch_setup,
+                                     void *user_data, int num_of_processes) {
+  assert(n_branch > 0);
+  if (num_of_processes <= 0 || num_of_processes > n_branch) {
+    num_of_processes = n_branch;
+  }
+
+  cache_stat_t *result = my_malloc_n(cache_stat_t, n_branch);
+  memset(result, 0, sizeof(cache_stat_t) * n_branch);
+
+  /* run the prefix in the parent */
+  reader_t *prefix_reader = clone_reader(reader);
+  request_t *req = new_request();
+  int64_t n_prefix = 0, start_ts = 0;
+  while (n_prefix < n_prefix_req && read_one_req(prefix_reader, req) == 0) {
+    if (n_prefix == 0) {
+      start_ts = (int64_t)req->clock_time;
+    }
+    req->clock_time -= start_ts;
+    cache->get(cache, req);
+    n_prefix += 1;
+  }
+  free_request(req);
+
+  /* the child only has the forking thread */
+  if (cache->prepare_fork != NULL && !cache->prepare_fork(cache)) {
+    WARN("%s cannot be forked, no branch is simulated\n", cache->cache_name);
+    close_reader(prefix_reader);
+    my_free(sizeof(cache_stat_t) * n_branch, result);
+    return NULL;
+  }
+
+  INFO("%s finishes the prefix of %lld requests using %s, start %d branches, %d processes\n", __func__,
+       (long long)n_prefix, cache->cache_name, n_branch, num_of_processes);
+
+  /* avoid the buffered output being written by every child */
+  fflush(stdout);
+  fflush(stderr);
+
+  pid_t *pids = my_malloc_n(pid_t, n_branch);
+  struct pollfd *pfds = my_malloc_n(struct pollfd, num_of_processes);
+  int *pfd_branch = my_malloc_n(int, num_of_processes);
+  int n_running = 0, n_started = 0, n_finished = 0;
+
+  while (n_finished < n_branch) {
+    /* start new branches until num_of_processes are running */
+    while (n_started < n_branch && n_running < num_of_processes) {
+      int idx = n_started;
+      strncpy(result[idx].cache_name, cache->cache_name, CACHE_NAME_ARRAY_LEN);
+      result[idx].cache_size = cache->cache_size;
+      result[idx].n_warmup_req = n_prefix;
+
+      int pipe_fd[2];
+      if (pipe(pipe_fd) != 0) {
+        ERROR("cannot create pipe for branch %d: %s\n", idx, strerror(errno));
+      }
+
+      pid_t pid = fork();
+      if (pid < 0) {
+        ERROR("cannot fork branch %d: %s\n", idx, strerror(errno));
+      } else if (pid == 0) {
+        close(pipe_fd[0]);
+        for (int i = 0; i < n_running; i++) {
+          close(pfds[i].fd);
+        }
+        _simulate_branch(reader, prefix_reader, n_prefix, start_ts, branch_readers ? branch_readers[idx] : NULL,
+                         cache, idx, branch_setup, user_data, pipe_fd[1]);
+      }
+
+      close(pipe_fd[1]);
+      pids[idx] = pid;
+      pfds[n_running].fd = pipe_fd[0];
+      pfds[n_running].events = POLLIN;
+      pfd_branch[n_running] = idx;
+      n_running += 1;
+      n_started += 1;
+    }
+
+    if (poll(pfds, n_running, -1) < 0) {
+      if (errno == EINTR) continue;
+      ERROR("poll error %s\n", strerror(errno));
+    }
+
+    for (int i = n_running - 1; i >= 0; i--) {
+      if (pfds[i].revents == 0) continue;
+
+      int idx = pfd_branch[i];
+      cache_stat_t branch_result;
+      ssize_t n_read = 0, ret;
+      while (n_read < (ssize_t)sizeof(branch_result) &&
+             (ret = read(pfds[i].fd, (char *)&branch_result + n_read, sizeof(branch_result) - n_read)) != 0) {
+        if (ret < 0) {
+          if (errno == EINTR) continue;
+          break;
+        }
+        n_read += ret;
+      }
+      close(pfds[i].fd);
+
+      int status = 0;
+      pid_t waited;
+      while ((waited = waitpid(pids[idx], &status, 0)) < 0 && errno == EINTR) {
+      }
+      if (waited < 0) {
+        WARN("cannot wait for branch %d (pid %d): %s\n", idx, (int)pids[idx], strerror(errno));
+      }
+      if (waited == pids[idx] && n_read == (ssize_t)sizeof(branch_result) && WIFEXITED(status) &&
+          WEXITSTATUS(status) == 0) {
+        result[idx] = branch_result;
+      } else {
+        WARN("branch %d (pid %d) of %s does not finish successfully, status %d\n", idx, (int)pids[idx],
+             cache->cache_name, status);
+      }
+
+      /* move the last running branch to this slot */
+      n_running -= 1;
+      pfds[i] = pfds[n_running];
+      pfd_branch[i] = pfd_branch[n_running];
+      n_finished += 1;
+    }
+  }
+
+  my_free(sizeof(int) * num_of_processes, pfd_branch);
+  my_free(sizeof(struct pollfd) * num_of_processes, pfds);
+  my_free(sizeof(pid_t) * n_branch, pids);
+  close_reader(prefix_reader);
+
+  // user is responsible for free-ing the result
+  return result;
+}
+
 cache_stat_t *simulate_with_multi_caches_scaling(reader_t **readers, cache_t *caches[], int num_of_caches,
                                                  reader_t *warmup_reader, double warmup_frac, int warmup_sec,
                                                  int num_of_threads, bool free_cache_when_finish) {
@@ -0,0 +1,849 @@
+//
+// a simulation engine that runs the common eviction algorithms without
+// function pointers, an algorithm is a template instantiation over the index
+// (object id -> slot), the allocator (the slots of the objects) and the
+// per-object metadata, so the lookup, the promotion and the eviction loop
+// are inlined into the loop that reads the trace
+//
+// the engine replays cache_get_base step by step, so the misses are the same
+// as running the cache it is created from, it supports LRU, FIFO, Clock,
+// Sieve, S3FIFO, SLRU and ARC without admission, prefetching, metrics
+// recording, operation stat, checkpoint and TTL, the simulator falls back to
+// cache->get for the other caches, see static_sim_support
+//
+// staticSimulator.cpp
+// libCacheSim
+//
+
+#include "staticSimulator.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+
+#include "../include/libCacheSim/evictionAlgo.h"
+#include "../include/libCacheSim/simulator.h"
+#include "../utils/include/mymath.h"
+
+namespace staticsim {
+
+static constexpr uint32_t NIL = UINT32_MAX;
+
+/* open addressing with linear probing, a deletion moves the following
+ * entries back, so the table has no tombstone */
+class FlatIndex {
+ public:
+  FlatIndex() : table_(1u << 16), mask_((1u << 16) - 1), n_entry_(0) {}
+
+  uint32_t find(obj_id_t obj_id) const {
+    for (uint64_t pos = home(obj_id);; pos = (pos + 1) & mask_) {
+      const entry_t &e = table_[pos];
+      if (e.slot == NIL || e.obj_id == obj_id) return e.slot;
+    }
+  }
+
+  /* the object must not be in the index */
+  void insert(obj_id_t obj_id, uint32_t slot) {
+    if ((n_entry_ + 1) * 4 > table_.size() * 3) {
+      expand();
+    }
+    uint64_t pos = home(obj_id);
+    while (table_[pos].slot != NIL) pos = (pos + 1) & mask_;
+    table_[pos] = {obj_id, slot};
+    n_entry_ += 1;
+  }
+
+  /* the object must be in the index */
+  void erase(obj_id_t obj_id) {
+    uint64_t pos = home(obj_id);
+    while (table_[pos].obj_id != obj_id || table_[pos].slot == NIL) pos = (pos + 1) & mask_;
+
+    /* an entry after pos moves to pos if pos is between its home and itself */
+    uint64_t next = pos;
+    while (true) {
+      next = (next + 1) & mask_;
+      if (table_[next].slot == NIL) break;
+      uint64_t next_home = home(table_[next].obj_id);
+      if (((next - next_home) & mask_) >= ((next - pos) & mask_)) {
+        table_[pos] = table_[next];
+        pos = next;
+      }
+    }
+    table_[pos].slot = NIL;
+    n_entry_ -= 1;
+  }
+
+ private:
+  struct entry_t {
+    obj_id_t obj_id = 0;
+    uint32_t slot = NIL;
+  };
+
+  uint64_t home(obj_id_t obj_id) const { return mix64((uint64_t)obj_id) & mask_; }
+
+  void expand() {
+    std::vector<entry_t> old_table(table_.size() * 2);
+    old_table.swap(table_);
+    mask_ = table_.size() - 1;
+    for (const entry_t &e : old_table) {
+      if (e.slot == NIL) continue;
+      uint64_t pos = home(e.obj_id);
+      while (table_[pos].slot != NIL) pos = (pos + 1) & mask_;
+      table_[pos] = e;
+    }
+  }
+
+  std::vector<entry_t> table_;
+  uint64_t mask_;
+  uint64_t n_entry_;
+};
+
+/* the objects are kept in a vector of nodes, the queues link the nodes by
+ * index, and the slot of a removed object is reused by the next insert */
+template <typename Meta>
+class NodePool {
+ public:
+  struct node_t {
+    obj_id_t obj_id;
+    int64_t obj_size;
+    /* prev is closer to the head, the same as cache_obj_t */
+    uint32_t prev;
+    uint32_t next;
+    Meta meta;
+  };
+
+  node_t &operator[](uint32_t slot) { return nodes_[slot]; }
+
+  uint32_t alloc() {
+    if (free_head_ != NIL) {
+      uint32_t slot = free_head_;
+      free_head_ = nodes_[slot].next;
+      return slot;
+    }
+    nodes_.emplace_back();
+    return (uint32_t)(nodes_.size() - 1);
+  }
+
+  void free(uint32_t slot) {
+    nodes_[slot].next = free_head_;
+    free_head_ = slot;
+  }
+
+ private:
+  std::vector<node_t> nodes_;
+  uint32_t free_head_ = NIL;
+};
+
+/* a doubly linked list of nodes, the same as q_head and q_tail of the
+ * algorithms, the bytes include obj_md_size of each object */
+struct queue_t {
+  uint32_t head = NIL;
+  uint32_t tail = NIL;
+  int64_t n_obj = 0;
+  int64_t n_byte = 0;
+  int64_t obj_md_size = 0;
+};
+
+/* the objects of all queues of an algorithm */
+template <typename Meta, typename Index, template <typename> class Alloc>
+class ObjStore {
+ public:
+  using node_t = typename Alloc<Meta>::node_t;
+
+  node_t &node(uint32_t slot) { return pool_[slot]; }
+
+  uint32_t find(obj_id_t obj_id) const { return index_.find(obj_id); }
+
+  /* add a new object to the head of the queue, the metadata is zeroed as
+   * cache_obj_t */
+  uint32_t add(queue_t &q, obj_id_t obj_id, int64_t obj_size) {
+    uint32_t slot = pool_.alloc();
+    node_t &n = pool_[slot];
+    n.obj_id = obj_id;
+    n.obj_size = obj_size;
+    n.meta = Meta();
+    index_.insert(obj_id, slot);
+    link_head(q, slot);
+    return slot;
+  }
+
+  void remove(queue_t &q, uint32_t slot) {
+    unlink(q, slot);
+    index_.erase(pool_[slot].obj_id);
+    pool_.free(slot);
+  }
+
+  void link_head(queue_t &q, uint32_t slot) {
+    node_t &n = pool_[slot];
+    n.prev = NIL;
+    n.next = q.head;
+    if (q.head != NIL) {
+      pool_[q.head].prev = slot;
+    } else {
+      q.tail = slot;
+    }
+    q.head = slot;
+    q.n_obj += 1;
+    q.n_byte += n.obj_size + q.obj_md_size;
+  }
+
+  void unlink(queue_t &q, uint32_t slot) {
+    node_t &n = pool_[slot];
+    if (n.prev != NIL) {
+      pool_[n.prev].next = n.next;
+    } else {
+      q.head = n.next;
+    }
+    if (n.next != NIL) {
+      pool_[n.next].prev = n.prev;
+    } else {
+      q.tail = n.prev;
+    }
+    q.n_obj -= 1;
+    q.n_byte -= n.obj_size + q.obj_md_size;
+  }
+
+  void move_to_head(queue_t &q, uint32_t slot) {
+    if (q.head == slot) return;
+    unlink(q, slot);
+    link_head(q, slot);
+  }
+
+ private:
+  Index index_;
+  Alloc<Meta> pool_;
+};
+
+struct no_meta_t {};
+
+struct freq_meta_t {
+  int32_t freq = 0;
+};
+
+/* an algorithm provides find (with the side effects of cache->find), insert,
+ * evict, can_insert and the bytes and objects in the cache, the engine calls
+ * them in the order of cache_get_base */
+template <typename Index, template <typename> class Alloc>
+class LRU {
+ public:
+  explicit LRU(const cache_t *cache) { q_.obj_md_size = cache->obj_md_size; }
+
+  bool find(const request_t *req) {
+    uint32_t slot = objs_.find(req->obj_id);
+    if (slot == NIL) return false;
+    objs_.move_to_head(q_, slot);
+    return true;
+  }
+  bool can_insert(const request_t *req) const { return true; }
+  void insert(const request_t *req) { objs_.add(q_, req->obj_id, req->obj_size); }
+  void evict(const request_t *req) { objs_.remove(q_, q_.tail); }
+  int64_t occupied_byte() const { return q_.n_byte; }
+  int64_t n_obj() const { return q_.n_obj; }
+
+ private:
+  ObjStore<no_meta_t, Index, Alloc> objs_;
+  queue_t q_;
+};
+
+template <typename Index, template <typename> class Alloc>
+class FIFO {
+ public:
+  explicit FIFO(const cache_t *cache) { q_.obj_md_size = cache->obj_md_size; }
+
+  bool find(const request_t *req) { return objs_.find(req->obj_id) != NIL; }
+  bool can_insert(const request_t *req) const { return true; }
+  void insert(const request_t *req) { objs_.add(q_, req->obj_id, req->obj_size); }
+  void evict(const request_t *req) { objs_.remove(q_, q_.tail); }
+  int64_t occupied_byte() const { return q_.n_byte; }
+  int64_t n_obj() const { return q_.n_obj; }
+
+ private:
+  ObjStore<no_meta_t, Index, Alloc> objs_;
+  queue_t q_;
+};
+
+template <typename Index, template <typename> class Alloc>
+class Clock {
+ public:
+  explicit Clock(const cache_t *cache) {
+    const Clock_params_t *params = (const Clock_params_t *)cache->eviction_params;
+    max_freq_ = params->max_freq;
+    init_freq_ = params->init_freq;
+    q_.obj_md_size = cache->obj_md_size;
+  }
+
+  bool find(const request_t *req) {
+    uint32_t slot = objs_.find(req->obj_id);
+    if (slot == NIL) return false;
+    freq_meta_t &meta = objs_.node(slot).meta;
+    if (meta.freq < max_freq_) meta.freq += 1;
+    return true;
+  }
+  bool can_insert(const request_t *req) const { return true; }
+  void insert(const request_t *req) {
+    uint32_t slot = objs_.add(q_, req->obj_id, req->obj_size);
+    objs_.node(slot).meta.freq = init_freq_;
+  }
+  void evict(const request_t *req) {
+    uint32_t slot = q_.tail;
+    while (objs_.node(slot).meta.freq >= 1) {
+      objs_.node(slot).meta.freq -= 1;
+      objs_.move_to_head(q_, slot);
+      slot = q_.tail;
+    }
+    objs_.remove(q_, slot);
+  }
+  int64_t occupied_byte() const { return q_.n_byte; }
+  int64_t n_obj() const { return q_.n_obj; }
+
+ private:
+  ObjStore<freq_meta_t, Index, Alloc> objs_;
+  queue_t q_;
+  int32_t max_freq_;
+  int32_t init_freq_;
+};
+
+template <typename Index, template <typename> class Alloc>
+class Sieve {
+ public:
+  explicit Sieve(const cache_t *cache) { q_.obj_md_size = cache->obj_md_size; }
+
+  bool find(const request_t *req) {
+    uint32_t slot = objs_.find(req->obj_id);
+    if (slot == NIL) return false;
+    objs_.node(slot).meta.freq = 1;
+    return true;
+  }
+  bool can_insert(const request_t *req) const { return true; }
+  void insert(const request_t *req) { objs_.add(q_, req->obj_id, req->obj_size); }
+  void evict(const request_t *req) {
+    uint32_t slot = pointer_ == NIL ? q_.tail : pointer_;
+    while (objs_.node(slot).meta.freq > 0) {
+      objs_.node(slot).meta.freq -= 1;
+      slot = objs_.node(slot).prev == NIL ? q_.tail : objs_.node(slot).prev;
+    }
+    pointer_ = objs_.node(slot).prev;
+    objs_.remove(q_, slot);
+  }
+  int64_t occupied_byte() const { return q_.n_byte; }
+  int64_t n_obj() const { return q_.n_obj; }
+
+ private:
+  ObjStore<freq_meta_t, Index, Alloc> objs_;
+  queue_t q_;
+  uint32_t pointer_ = NIL;
+};
+
+struct s3fifo_meta_t {
+  int64_t freq = 0;
+  /* SMALL, MAIN or GHOST */
+  int8_t queue = 0;
+};
+
+/* the small, main and ghost FIFO share one index, an object is in at most
+ * one of them, which is also the case for the three sub-caches */
+template <typename Index, template <typename> class Alloc>
+class S3FIFO {
+ public:
+  explicit S3FIFO(const cache_t *cache) {
+    const S3FIFO_params_t *params = (const S3FIFO_params_t *)cache->eviction_params;
+    small_size_ = params->small_fifo->cache_size;
+    main_size_ = params->main_fifo->cache_size;
+    small_.obj_md_size = params->small_fifo->obj_md_size;
+    main_.obj_md_size = params->main_fifo->obj_md_size;
+    has_ghost_ = params->ghost_fifo != NULL;
+    if (has_ghost_) {
+      ghost_size_ = params->ghost_fifo->cache_size;
+      ghost_.obj_md_size = params->ghost_fifo->obj_md_size;
+    }
+    move_to_main_threshold_ = params->move_to_main_threshold;
+  }
+
+  bool find(const request_t *req) {
+    hit_on_ghost_ = false;
+    uint32_t slot = objs_.find(req->obj_id);
+    if (slot == NIL) return false;
+    s3fifo_meta_t &meta = objs_.node(slot).meta;
+    if (meta.queue == GHOST) {
+      objs_.remove(ghost_, slot);
+      hit_on_ghost_ = true;
+      return false;
+    }
+    meta.freq += 1;
+    return true;
+  }
+
+  bool can_insert(const request_t *req) const { return req->obj_size <= small_size_; }
+
+  void insert(const request_t *req) {
+    queue_t *q = &small_;
+    if (hit_on_ghost_) {
+      hit_on_ghost_ = false;
+      q = &main_;
+    } else {
+      if (req->obj_size >= small_size_) return;
+      if (!has_evicted_ && small_.n_byte >= small_size_) q = &main_;
+    }
+    uint32_t slot = objs_.add(*q, req->obj_id, req->obj_size);
+    objs_.node(slot).meta.queue = q == &small_ ? SMALL : MAIN;
+  }
+
+  void evict(const request_t *req) {
+    has_evicted_ = true;
+    if (main_.n_byte > main_size_ || small_.n_byte == 0) {
+      evict_main();
+    } else {
+      evict_small();
+    }
+  }
+
+  int64_t occupied_byte() const { return small_.n_byte + main_.n_byte; }
+  int64_t n_obj() const { return small_.n_obj + main_.n_obj; }
+
+ private:
+  enum : int8_t { SMALL = 1, MAIN = 2, GHOST = 3 };
+
+  void evict_small() {
+    bool has_evicted = false;
+    while (!has_evicted && small_.n_byte > 0) {
+      uint32_t slot = small_.tail;
+      auto &n = objs_.node(slot);
+      if (n.meta.freq >= move_to_main_threshold_) {
+        /* the object inserted to the main FIFO has a zero frequency */
+        objs_.unlink(small_, slot);
+        objs_.link_head(main_, slot);
+        n.meta.freq = 0;
+        n.meta.queue = MAIN;
+      } else {
+        obj_id_t obj_id = n.obj_id;
+        int64_t obj_size = n.obj_size;
+        objs_.remove(small_, slot);
+        if (has_ghost_) insert_ghost(obj_id, obj_size);
+        has_evicted = true;
+      }
+    }
+  }
+
+  void evict_main() {
+    bool has_evicted = false;
+    while (!has_evicted && main_.n_byte > 0) {
+      uint32_t slot = main_.tail;
+      auto &n = objs_.node(slot);
+      if (n.meta.freq >= 1) {
+        objs_.move_to_head(main_, slot);
+        n.meta.freq = (n.meta.freq < 3 ? n.meta.freq : 3) - 1;
+      } else {
+        objs_.remove(main_, slot);
+        has_evicted = true;
+      }
+    }
+  }
+
+  /* the same as ghost_fifo->get of a missed object */
+  void insert_ghost(obj_id_t obj_id, int64_t obj_size) {
+    if (obj_size + ghost_.obj_md_size > ghost_size_) return;
+    while (ghost_.n_byte + obj_size + ghost_.obj_md_size > ghost_size_) {
+      objs_.remove(ghost_, ghost_.tail);
+    }
+    uint32_t slot = objs_.add(ghost_, obj_id, obj_size);
+    objs_.node(slot).meta.queue = GHOST;
+  }
+
+  ObjStore<s3fifo_meta_t, Index, Alloc> objs_;
+  queue_t small_, main_, ghost_;
+  int64_t small_size_, main_size_, ghost_size_ = 0;
+  int move_to_main_threshold_;
+  bool has_ghost_;
+  bool hit_on_ghost_ = false;
+  bool has_evicted_ = false;
+};
+
+struct slru_meta_t {
+  int32_t seg = 0;
+};
+
+/* the segments are LRU queues, segment n_seg - 1 is the most recent, the
+ * bytes of the segments are counted the same way as SLRU.c, where an object
+ * moved to the previous segment by cool carries its size but not
+ * obj_md_size */
+template <typename Index, template <typename> class Alloc>
+class SLRU {
+ public:
+  explicit SLRU(const cache_t *cache) {
+    const SLRU_params_t *params = (const SLRU_params_t *)cache->eviction_params;
+    n_seg_ = params->n_seg;
+    segs_.resize(n_seg_);
+    seg_bytes_.assign(n_seg_, 0);
+    seg_max_bytes_.assign(params->lru_max_n_bytes, params->lru_max_n_bytes + n_seg_);
+    obj_md_size_ = cache->obj_md_size;
+  }
+
+  bool find(const request_t *req) {
+    uint32_t slot = objs_.find(req->obj_id);
+    if (slot == NIL) return false;
+    auto &n = objs_.node(slot);
+    int32_t seg = n.meta.seg;
+    if (seg == n_seg_ - 1) {
+      objs_.move_to_head(segs_[seg], slot);
+      return true;
+    }
+
+    /* promote to the next segment and cool it if it is full */
+    objs_.unlink(segs_[seg], slot);
+    seg_bytes_[seg] -= n.obj_size + obj_md_size_;
+    objs_.link_head(segs_[seg + 1], slot);
+    seg_bytes_[seg + 1] += n.obj_size + obj_md_size_;
+    n.meta.seg = seg + 1;
+    while (seg_bytes_[n.meta.seg] > seg_max_bytes_[n.meta.seg]) {
+      cool(n.meta.seg);
+    }
+    return true;
+  }
+
+  bool can_insert(const request_t *req) const { return req->obj_size + obj_md_size_ <= seg_max_bytes_[0]; }
+
+  /* the lowest segment with space, the cache has space after the evictions
+   * of cache_get_base, so SLRU_insert does not evict */
+  void insert(const request_t *req) {
+    int32_t seg = 0;
+    for (int32_t i = 0; i < n_seg_; i++) {
+      if (seg_bytes_[i] + req->obj_size + obj_md_size_ <= seg_max_bytes_[i]) {
+        seg = i;
+        break;
+      }
+    }
+    uint32_t slot = objs_.add(segs_[seg], req->obj_id, req->obj_size);
+    objs_.node(slot).meta.seg = seg;
+    seg_bytes_[seg] += req->obj_size + obj_md_size_;
+    occupied_byte_ += req->obj_size + obj_md_size_;
+  }
+
+  /* the tail of the lowest segment that has bytes */
+  void evict(const request_t *req) {
+    int32_t seg = 0;
+    while (seg_bytes_[seg] <= 0) seg++;
+    uint32_t slot = segs_[seg].tail;
+    int64_t obj_size = objs_.node(slot).obj_size;
+    seg_bytes_[seg] -= obj_size + obj_md_size_;
+    occupied_byte_ -= obj_size + obj_md_size_;
+    objs_.remove(segs_[seg], slot);
+  }
+
+  int64_t occupied_byte() const { return occupied_byte_; }
+  int64_t n_obj() const {
+    int64_t n = 0;
+    for (const queue_t &q : segs_) n += q.n_obj;
+    return n;
+  }
+
+ private:
+  /* move the tail of the segment to the previous segment, the first
+   * segment evicts */
+  void cool(int32_t seg) {
+    if (seg == 0) {
+      evict(nullptr);
+      return;
+    }
+    uint32_t slot = segs_[seg].tail;
+    auto &n = objs_.node(slot);
+    objs_.unlink(segs_[seg], slot);
+    objs_.link_head(segs_[seg - 1], slot);
+    n.meta.seg = seg - 1;
+    seg_bytes_[seg] -= n.obj_size;
+    seg_bytes_[seg - 1] += n.obj_size;
+    while (seg_bytes_[seg - 1] > seg_max_bytes_[seg - 1]) {
+      cool(seg - 1);
+    }
+  }
+
+  ObjStore<slru_meta_t, Index, Alloc> objs_;
+  /* the queues are only used for the links and the number of objects */
+  std::vector<queue_t> segs_;
+  std::vector<int64_t> seg_bytes_;
+  std::vector<int64_t> seg_max_bytes_;
+  int32_t n_seg_;
+  int64_t obj_md_size_;
+  int64_t occupied_byte_ = 0;
+};
+
+struct arc_meta_t {
+  /* L1_DATA, L2_DATA, L1_GHOST or L2_GHOST */
+  int8_t queue = 0;
+};
+
+/* the data and ghost queues share one index, the same as the hash table of
+ * ARC.c, p and the flags of the last ghost hit are kept across requests in
+ * the same way, including the flags of a ghost hit that is not inserted */
+template <typename Index, template <typename> class Alloc>
+class ARC {
+ public:
+  explicit ARC(const cache_t *cache) : cache_size_(cache->cache_size), obj_md_size_(cache->obj_md_size) {
+    l1_data_.obj_md_size = l2_data_.obj_md_size = obj_md_size_;
+    l1_ghost_.obj_md_size = l2_ghost_.obj_md_size = obj_md_size_;
+  }
+
+  bool find(const request_t *req) {
+    /* cache->n_req of cache_get_base */
+    n_req_ += 1;
+    uint32_t slot = objs_.find(req->obj_id);
+    if (slot == NIL) return false;
+
+    in_l1_ghost_ = false;
+    in_l2_ghost_ = false;
+    auto &n = objs_.node(slot);
+    switch (n.meta.queue) {
+      case L1_GHOST: {
+        vtime_last_req_in_ghost_ = n_req_;
+        in_l1_ghost_ = true;
+        double delta = std::max((double)l2_ghost_.n_byte / l1_ghost_.n_byte, 1.0);
+        p_ = std::min(p_ + delta, (double)cache_size_);
+        objs_.remove(l1_ghost_, slot);
+        return false;
+      }
+      case L2_GHOST: {
+        vtime_last_req_in_ghost_ = n_req_;
+        in_l2_ghost_ = true;
+        double delta = std::max((double)l1_ghost_.n_byte / l2_ghost_.n_byte, 1.0);
+        p_ = std::max(p_ - delta, 0.0);
+        objs_.remove(l2_ghost_, slot);
+        return false;
+      }
+      case L1_DATA:
+        objs_.unlink(l1_data_, slot);
+        objs_.link_head(l2_data_, slot);
+        n.meta.queue = L2_DATA;
+        return true;
+      default:
+        objs_.move_to_head(l2_data_, slot);
+        return true;
+    }
+  }
+
+  bool can_insert(const request_t *req) const { return true; }
+
+  void insert(const request_t *req) {
+    if (ghost_hit()) {
+      uint32_t slot = objs_.add(l2_data_, req->obj_id, req->obj_size);
+      objs_.node(slot).meta.queue = L2_DATA;
+      in_l1_ghost_ = false;
+      in_l2_ghost_ = false;
+      vtime_last_req_in_ghost_ = -1;
+    } else {
+      uint32_t slot = objs_.add(l1_data_, req->obj_id, req->obj_size);
+      objs_.node(slot).meta.queue = L1_DATA;
+    }
+  }
+
+  void evict(const request_t *req) {
+    if (ghost_hit()) {
+      replace();
+    } else {
+      evict_miss_on_all_queues(req);
+    }
+  }
+
+  int64_t occupied_byte() const { return l1_data_.n_byte + l2_data_.n_byte; }
+  int64_t n_obj() const { return l1_data_.n_obj + l2_data_.n_obj; }
+
+ private:
+  enum : int8_t { L1_DATA = 1, L2_DATA = 2, L1_GHOST = 3, L2_GHOST = 4 };
+
+  bool ghost_hit() const { return vtime_last_req_in_ghost_ == n_req_ && (in_l1_ghost_ || in_l2_ghost_); }
+
+  /* move the tail of a data queue to its ghost queue */
+  void demote(queue_t &data, queue_t &ghost, int8_t ghost_id) {
+    uint32_t slot = data.tail;
+    objs_.unlink(data, slot);
+    objs_.link_head(ghost, slot);
+    objs_.node(slot).meta.queue = ghost_id;
+  }
+
+  /* the REPLACE function in the paper */
+  void replace() {
+    bool cond1 = l1_data_.n_byte > 0;
+    bool cond2 = l1_data_.n_byte > p_;
+    bool cond3 = l1_data_.n_byte == p_ && in_l2_ghost_;
+    bool cond4 = l2_data_.n_byte == 0;
+    if ((cond1 && (cond2 || cond3)) || cond4) {
+      demote(l1_data_, l1_ghost_, L1_GHOST);
+    } else {
+      demote(l2_data_, l2_ghost_, L2_GHOST);
+    }
+  }
+
+  /* the case IV in the paper */
+  void evict_miss_on_all_queues(const request_t *req) {
+    int64_t incoming_size = req->obj_size + obj_md_size_;
+    if (l1_data_.n_byte + l1_ghost_.n_byte + incoming_size > cache_size_) {
+      if (l1_ghost_.n_byte > 0) {
+        objs_.remove(l1_ghost_, l1_ghost_.tail);
+        replace();
+      } else {
+        objs_.remove(l1_data_, l1_data_.tail);
+      }
+    } else {
+      if (l1_data_.n_byte + l1_ghost_.n_byte + l2_data_.n_byte + l2_ghost_.n_byte >= cache_size_ * 2 &&
+          l2_ghost_.n_byte > 0) {
+        objs_.remove(l2_ghost_, l2_ghost_.tail);
+      }
+      replace();
+    }
+  }
+
+  ObjStore<arc_meta_t, Index, Alloc> objs_;
+  queue_t l1_data_, l2_data_, l1_ghost_, l2_ghost_;
+  const int64_t cache_size_;
+  const int64_t obj_md_size_;
+  double p_ = 0;
+  bool in_l1_ghost_ = false;
+  bool in_l2_ghost_ = false;
+  int64_t vtime_last_req_in_ghost_ = -1;
+  int64_t n_req_ = 0;
+};
+
+}  // namespace staticsim
+
+/* the type-erased engine, the virtual calls are per warmup request and per
+ * simulation, not per request of the simulation */
+struct static_sim {
+  virtual ~static_sim() = default;
+  virtual bool get(const request_t *req) = 0;
+  virtual void run(reader_t *reader, request_t *req, int64_t start_ts, cache_stat_t *result) = 0;
+};
+
+namespace staticsim {
+
+template <typename Algo>
+class Engine final : public static_sim {
+ public:
+  explicit Engine(const cache_t *cache)
+      : algo_(cache), cache_size_(cache->cache_size), obj_md_size_(cache->obj_md_size) {}
+
+  bool get(const request_t *req) override { return get_inline(req); }
+
+  void run(reader_t *reader, request_t *req, int64_t start_ts, cache_stat_t *result) override {
+    int64_t n_req = 0, n_req_byte = 0, n_miss = 0, n_miss_byte = 0;
+    while (req->valid) {
+      n_req += 1;
+      n_req_byte += req->obj_size;
+      req->clock_time -= start_ts;
+      if (!get_inline(req)) {
+        n_miss += 1;
+        n_miss_byte += req->obj_size;
+      }
+      read_one_req(reader, req);
+    }
+    result->n_req += n_req;
+    result->n_req_byte += n_req_byte;
+    result->n_miss += n_miss;
+    result->n_miss_byte += n_miss_byte;
+    result->n_obj = algo_.n_obj();
+    result->occupied_byte = algo_.occupied_byte();
+  }
+
+ private:
+  /* cache_get_base without the hooks that static_sim_support excludes */
+  inline bool get_inline(const request_t *req) {
+    if (algo_.find(req)) return true;
+    if (!algo_.can_insert(req) || req->obj_size + obj_md_size_ > cache_size_) {
+      return false;
+    }
+    while (algo_.occupied_byte() + req->obj_size + obj_md_size_ > cache_size_) {
+      algo_.evict(req);
+    }
+    algo_.insert(req);
+    return false;
+  }
+
+  Algo algo_;
+  const int64_t cache_size_;
+  const int64_t obj_md_size_;
+};
+
+template <template <typename, template <typename> class> class Algo>
+static static_sim *create_engine(const cache_t *cache) {
+  return new Engine<Algo<FlatIndex, NodePool>>(cache);
+}
+
+}  // namespace staticsim
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* the algorithm of the engine that runs the cache, NONE if the algorithm
+ * has no engine */
+enum static_sim_algo_e { STATIC_SIM_NONE, STATIC_SIM_LRU, STATIC_SIM_FIFO, STATIC_SIM_CLOCK,
+                         STATIC_SIM_SIEVE, STATIC_SIM_S3FIFO, STATIC_SIM_SLRU, STATIC_SIM_ARC };
+
+static static_sim_algo_e static_sim_algo(const cache_t *cache) {
+  if (cache->cache_init == LRU_init) return STATIC_SIM_LRU;
+  if (cache->cache_init == FIFO_init) return STATIC_SIM_FIFO;
+  if (cache->cache_init == Clock_init) return STATIC_SIM_CLOCK;
+  if (cache->cache_init == Sieve_init) return STATIC_SIM_SIEVE;
+  if (cache->cache_init == S3FIFO_init) return STATIC_SIM_S3FIFO;
+  if (cache->cache_init == SLRU_init) return STATIC_SIM_SLRU;
+  if (cache->cache_init == ARC_init) return STATIC_SIM_ARC;
+  return STATIC_SIM_NONE;
+}
+
+/**
+ * @brief whether the simulator can run the cache with the static-dispatch
+ * engine, the cache must be empty and use one of the supported algorithms
+ * without the features that hook into cache_get_base
+ */
+bool static_sim_support(const cache_t *cache) {
+#ifdef SUPPORT_TTL
+  return false;
+#else
+  static_sim_algo_e algo = static_sim_algo(cache);
+  if (algo == STATIC_SIM_NONE) {
+    return false;
+  }
+  /* S3FIFO and SLRU check the size of the small FIFO and the first segment
+   * in their own can_insert */
+  if (algo != STATIC_SIM_S3FIFO && algo != STATIC_SIM_SLRU && cache->can_insert != cache_can_insert_default) {
+    return false;
+  }
+
+  return cache->admissioner == NULL && cache->prefetcher == NULL && cache->metrics_recorder == NULL &&
+         cache->op_stat == NULL && cache->warmup_checkpoint_path == NULL && !cache->restored_from_checkpoint &&
+         cache->get_n_obj(cache) == 0;
+#endif
+}
+
+static_sim_t *create_static_sim(const cache_t *cache) {
+  if (!static_sim_support(cache)) return NULL;
+
+  switch (static_sim_algo(cache)) {
+    case STATIC_SIM_LRU:
+      return staticsim::create_engine<staticsim::LRU>(cache);
+    case STATIC_SIM_FIFO:
+      return staticsim::create_engine<staticsim::FIFO>(cache);
+    case STATIC_SIM_CLOCK:
+      return staticsim::create_engine<staticsim::Clock>(cache);
+    case STATIC_SIM_SIEVE:
+      return staticsim::create_engine<staticsim::Sieve>(cache);
+    case STATIC_SIM_S3FIFO:
+      return staticsim::create_engine<staticsim::S3FIFO>(cache);
+    case STATIC_SIM_SLRU:
+      return staticsim::create_engine<staticsim::SLRU>(cache);
+    case STATIC_SIM_ARC:
+      return staticsim::create_engine<staticsim::ARC>(cache);
+    case STATIC_SIM_NONE:
+      break;
+  }
+  return NULL;
+}
+
+void free_static_sim(static_sim_t *sim) { delete sim; }
+
+bool static_sim_get(static_sim_t *sim, const request_t *req) { return sim->get(req); }
+
+void static_sim_run(static_sim_t *sim, reader_t *reader, request_t *req, int64_t start_ts, cache_stat_t *result) {
+  sim->run(reader, req, start_ts, result);
+}
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,47 @@
+//
+// the static-dispatch simulation engine used by the simulator, see
+// staticSimulator.cpp
+//
+// staticSimulator.h
+// libCacheSim
+//
+
+#ifndef STATIC_SIMULATOR_H
+#define STATIC_SIMULATOR_H
+
+#include "../include/libCacheSim/cache.h"
+#include "../include/libCacheSim/reader.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct static_sim static_sim_t;
+
+/**
+ * @brief create an engine that runs the algorithm of the cache with the same
+ * size and parameters, the cache itself is not used or modified
+ *
+ * @return NULL if static_sim_support(cache) is false
+ */
+static_sim_t *create_static_sim(const cache_t *cache);
+
+void free_static_sim(static_sim_t *sim);
+
+/**
+ * @brief the same as cache->get, used for warmup
+ */
+bool static_sim_get(static_sim_t *sim, const request_t *req);
+
+/**
+ * @brief run req and the following requests of the reader, the clock time of
+ * each request is shifted by start_ts, the requests and misses are added to
+ * result, and the number of objects and bytes in the cache are set
+ */
+void static_sim_run(static_sim_t *sim, reader_t *reader, request_t *req, int64_t start_ts, cache_stat_t *result);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* STATIC_SIMULATOR_H */
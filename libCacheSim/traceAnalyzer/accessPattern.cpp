@@ -43,62 +43,68 @@ void AccessPattern::add_req(const request_t *req) {
     return;
   }
 
-  if (access_rtime_map_.find(req->obj_id) == access_rtime_map_.end()) {
-    access_rtime_map_[req->obj_id] = vector<uint32_t>();
-    access_vtime_map_[req->obj_id] = vector<uint32_t>();
+  auto it = obj_idx_map_.find(req->obj_id);
+  uint32_t obj_idx;
+  if (it == obj_idx_map_.end()) {
+    obj_idx = (uint32_t)obj_idx_map_.size();
+    obj_idx_map_[req->obj_id] = obj_idx;
+  } else {
+    obj_idx = it->second;
+  }
+
+  access_obj_idx_.push_back(obj_idx);
+  access_rtime_.push_back(req->clock_time - start_rtime_);
+  access_vtime_.push_back(n_seen_req_);
+}
+
+void AccessPattern::dump_access_log(ofstream &ofs,
+                                    const vector<uint32_t> &time_col,
+                                    const vector<uint32_t> &offsets,
+                                    const vector<uint32_t> &order) {
+  /* objects are indexed in the order of the first access, so the sequences
+   * are sorted by the first timestamp */
+  for (size_t obj_idx = 0; obj_idx + 1 < offsets.size(); obj_idx++) {
+    for (uint32_t i = offsets[obj_idx]; i < offsets[obj_idx + 1]; i++) {
+      ofs << time_col[order[i]] << ",";
+    }
+    ofs << "\n";
   }
-  access_rtime_map_[req->obj_id].push_back(req->clock_time - start_rtime_);
-  access_vtime_map_[req->obj_id].push_back(n_seen_req_);
 }
 
 void AccessPattern::dump(string &path_base) {
+  /* group the access log by object using a counting sort, which keeps the
+   * accesses of each object in time order */
+  size_t n_obj = obj_idx_map_.size();
+  vector<uint32_t> offsets(n_obj + 1, 0);
+  for (const uint32_t obj_idx : access_obj_idx_) {
+    offsets[obj_idx + 1] += 1;
+  }
+  for (size_t i = 1; i <= n_obj; i++) {
+    offsets[i] += offsets[i - 1];
+  }
+
+  vector<uint32_t> order(access_obj_idx_.size());
+  {
+    vector<uint32_t> next_pos(offsets.begin(), offsets.end() - 1);
+    for (size_t i = 0; i < access_obj_idx_.size(); i++) {
+      order[next_pos[access_obj_idx_[i]]++] = (uint32_t)i;
+    }
+  }
+
   string ofile_path = path_base + ".accessRtime";
   ofstream ofs(ofile_path, ios::out | ios::trunc);
   ofs << "# " << path_base << "\n";
   ofs << "# access pattern real time, each line stores all the real time of "
          "requests to an object\n";
-
-  // sort the timestamp list by the first timestamp
-  vector<vector<uint32_t> *> sorted_rtime_vec;
-  for (auto &p : access_rtime_map_) {
-    sorted_rtime_vec.push_back(&p.second);
-  }
-  sort(sorted_rtime_vec.begin(), sorted_rtime_vec.end(),
-       [](vector<uint32_t> *p1, vector<uint32_t> *p2) {
-         return (*p1).at(0) < (*p2).at(0);
-       });
-
-  for (const auto *p : sorted_rtime_vec) {
-    for (const uint32_t rtime : *p) {
-      ofs << rtime << ",";
-    }
-    ofs << "\n";
-  }
+  dump_access_log(ofs, access_rtime_, offsets, order);
   ofs << "\n" << endl;
   ofs.close();
 
-  ofs << "# " << path_base << "\n";
   string ofile_path2 = path_base + ".accessVtime";
   ofstream ofs2(ofile_path2, ios::out | ios::trunc);
   ofs2 << "# access pattern virtual time, each line stores all the virtual "
           "time of requests to an object\n";
-  vector<vector<uint32_t> *> sorted_vtime_vec;
-  for (auto &p : access_vtime_map_) {
-    sorted_vtime_vec.push_back(&(p.second));
-  }
-
-  sort(sorted_vtime_vec.begin(), sorted_vtime_vec.end(),
-       [](vector<uint32_t> *p1, vector<uint32_t> *p2) -> bool {
-         return (*p1).at(0) < (*p2).at(0);
-       });
-
-  for (const vector<uint32_t> *p : sorted_vtime_vec) {
-    for (const uint32_t vtime : *p) {
-      ofs2 << vtime << ",";
-    }
-    ofs2 << "\n";
-  }
-
+  dump_access_log(ofs2, access_vtime_, offsets, order);
   ofs2.close();
 }
 
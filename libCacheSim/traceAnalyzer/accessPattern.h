@@ -10,9 +10,17 @@
  * a bias when we plot the access pattern
  * so we use a static sample ratio
  *
+ * the accesses are stored in an append-only columnar log of
+ * (object index, rtime, vtime), where the object index is assigned in the
+ * order of first access, the per-object access sequences are built with a
+ * counting sort over the object index when dumping
+ *
  */
 
 
+#include <fstream>
+#include <vector>
+
 #include "../include/libCacheSim/logging.h"
 #include "../include/libCacheSim/request.h"
 #include "struct.h"
@@ -55,7 +63,15 @@ class AccessPattern {
   int sample_ratio_ = 1001;
 
   int64_t start_rtime_ = -1;
-  unordered_map<obj_id_t, vector<uint32_t>> access_rtime_map_;
-  unordered_map<obj_id_t, vector<uint32_t>> access_vtime_map_;
+  /* the index of each sampled object, assigned at its first access */
+  robin_hood::unordered_flat_map<obj_id_t, uint32_t> obj_idx_map_;
+  /* the access log, one entry per access to a sampled object */
+  vector<uint32_t> access_obj_idx_;
+  vector<uint32_t> access_rtime_;
+  vector<uint32_t> access_vtime_;
+
+  void dump_access_log(ofstream &ofs, const vector<uint32_t> &time_col,
+                       const vector<uint32_t> &offsets,
+                       const vector<uint32_t> &order);
 };
 }  // namespace traceAnalyzer
@@ -3,14 +3,13 @@
 //
 
 #include <algorithm>  // std::make_heap, std::pop_heap, std::push_heap, std::sort_heap
+#include <mutex>
 #include <vector>  // std::vector
 
 #include "analyzer.h"
 #include "utils/include/utils.h"
 
 void traceAnalyzer::TraceAnalyzer::initialize() {
-  obj_map_.reserve(DEFAULT_PREALLOC_N_OBJ);
-
   op_stat_ = new OpStat();
 
   if (option_.ttl) {
@@ -33,6 +32,10 @@ void traceAnalyzer::TraceAnalyzer::initialize() {
     reuse_stat_ = new ReuseDistribution(output_path_, time_window_);
   }
 
+  if (option_.popularity && popularity_top_k_ > 0) {
+    popularity_sketch_ = new PopularitySketch(popularity_top_k_);
+  }
+
   if (option_.popularity_decay) {
     popularity_decay_stat_ =
         new PopularityDecay(output_path_, time_window_, warmup_time_);
@@ -65,6 +68,7 @@ void traceAnalyzer::TraceAnalyzer::cleanup() {
   delete size_stat_;
   delete access_stat_;
   delete popularity_stat_;
+  delete popularity_sketch_;
   delete popularity_decay_stat_;
 
   delete prob_at_age_;
@@ -85,6 +89,19 @@ void traceAnalyzer::TraceAnalyzer::cleanup() {
   }
 }
 
+/* the object is not tracked because of object sampling, so the fields that
+ * depend on the previous requests to the object are unknown */
+static inline void set_req_obj_unknown(request_t *req) {
+  req->obj_sampled_out = true;
+  req->compulsory_miss = false;
+  req->overwrite = false;
+  req->first_seen_in_window = false;
+  req->create_rtime = (int32_t)req->clock_time;
+  req->prev_size = -1;
+  req->vtime_since_last_access = -1;
+  req->rtime_since_last_access = -1;
+}
+
 void traceAnalyzer::TraceAnalyzer::run() {
   if (has_run_) return;
 
@@ -94,6 +111,17 @@ void traceAnalyzer::TraceAnalyzer::run() {
   int32_t curr_time_window_idx = 0;
   int next_time_window_ts = time_window_;
 
+  /* the reader and the obj_map_ enrichment run on this thread, the modules
+   * consume the enriched requests on this thread, or in batches on their own
+   * threads if the pipeline is used */
+  std::vector<std::function<void(request_t *)>> consumers =
+      get_module_consumers();
+  ReqPipeline *pipeline = nullptr;
+  if (pipeline_) {
+    pipeline = new ReqPipeline(pipeline_batch_size_);
+    pipeline->start(consumers);
+  }
+
   int64_t n = 0;
   /* going through the trace */
   do {
@@ -120,9 +148,19 @@ void traceAnalyzer::TraceAnalyzer::run() {
     n_req_ += 1;
     sum_obj_size_req += req->obj_size;
 
-    auto it = obj_map_.find(req->obj_id);
-    if (it == obj_map_.end()) {
+    /* the object table is over the memory budget and does not track this
+     * object, the request is only used by the request-level modules */
+    struct obj_info *info = nullptr;
+    bool sampled = obj_map_.is_sampled(req->obj_id);
+    if (sampled) {
+      info = obj_map_.find(req->obj_id);
+    }
+
+    if (!sampled) {
+      set_req_obj_unknown(req);
+    } else if (info == nullptr) {
       /* the first request to the object */
+      req->obj_sampled_out = false;
       req->compulsory_miss =
           true; /* whether the object is seen for the first time */
       req->overwrite = false;
@@ -137,90 +175,73 @@ void traceAnalyzer::TraceAnalyzer::run() {
       struct obj_info obj_info;
       obj_info.create_rtime = (int32_t)req->clock_time;
       obj_info.freq = 1;
-      obj_info.obj_size = (obj_size_t)req->obj_size;
+      obj_info.set_obj_size((obj_size_t)req->obj_size);
       obj_info.last_access_rtime = (int32_t)req->clock_time;
-      obj_info.last_access_vtime = n_req_;
-
-      obj_map_[req->obj_id] = obj_info;
-      sum_obj_size_obj += req->obj_size;
+      obj_info.set_last_access_vtime(n_req_);
+
+      obj_size_hist_[trace_meta_size_bucket(req->obj_size)] += 1;
+      smallest_obj_size_ = std::min(smallest_obj_size_, (int64_t)req->obj_size);
+      largest_obj_size_ = std::max(largest_obj_size_, (int64_t)req->obj_size);
+
+      bool was_sampling = obj_map_.is_sampling();
+      obj_map_.insert(req->obj_id, obj_info);
+      if (!was_sampling && obj_map_.is_sampling()) {
+        WARN(
+            "start sampling objects at request %ld, the per-object analysis "
+            "after this point only includes sampled objects\n",
+            (long)n_req_);
+      }
+      if (!obj_map_.is_sampled(req->obj_id)) {
+        set_req_obj_unknown(req);
+      }
 
     } else {
+      req->obj_sampled_out = false;
       req->compulsory_miss = false;
       req->first_seen_in_window =
-          (time_to_window_idx(it->second.last_access_rtime) !=
+          (time_to_window_idx(info->last_access_rtime) !=
            curr_time_window_idx);
-      req->create_rtime = it->second.create_rtime;
+      req->create_rtime = info->create_rtime;
       if (req->op == OP_SET || req->op == OP_REPLACE || req->op == OP_CAS) {
         req->overwrite = true;
       } else {
         req->overwrite = false;
       }
       req->vtime_since_last_access =
-          (int64_t)n_req_ - it->second.last_access_vtime;
+          (int64_t)n_req_ - info->last_access_vtime();
       req->rtime_since_last_access =
-          (int64_t)(req->clock_time) - it->second.last_access_rtime;
+          (int64_t)(req->clock_time) - info->last_access_rtime;
 
       assert(req->vtime_since_last_access > 0);
       assert(req->rtime_since_last_access >= 0);
 
-      req->prev_size = it->second.obj_size;
-      it->second.obj_size = req->obj_size;
-      it->second.freq += 1;
-      it->second.last_access_vtime = n_req_;
-      it->second.last_access_rtime = (int32_t)(req->clock_time);
-    }
-
-    op_stat_->add_req(req);
-
-    if (ttl_stat_ != nullptr) {
-      ttl_stat_->add_req(req);
-    }
-
-    if (req_rate_stat_ != nullptr) {
-      req_rate_stat_->add_req(req);
-    }
-
-    if (size_stat_ != nullptr) {
-      size_stat_->add_req(req);
-    }
-
-    if (reuse_stat_ != nullptr) {
-      reuse_stat_->add_req(req);
-    }
-
-    if (access_stat_ != nullptr) {
-      access_stat_->add_req(req);
+      req->prev_size = (int64_t)info->obj_size();
+      info->set_obj_size(req->obj_size);
+      info->freq += 1;
+      info->set_last_access_vtime(n_req_);
+      info->last_access_rtime = (int32_t)(req->clock_time);
     }
 
-    if (popularity_decay_stat_ != nullptr) {
-      popularity_decay_stat_->add_req(req);
-    }
-
-    if (prob_at_age_ != nullptr) {
-      prob_at_age_->add_req(req);
-    }
-
-    if (lifetime_stat_ != nullptr) {
-      lifetime_stat_->add_req(req);
-    }
-
-    if (create_future_reuse_ != nullptr) {
-      create_future_reuse_->add_req(req);
-    }
-
-    if (size_change_distribution_ != nullptr) {
-      size_change_distribution_->add_req(req);
-    }
-    if (scan_detector_ != nullptr) {
-      scan_detector_->add_req(req);
+    if (pipeline != nullptr) {
+      pipeline->add_req(req);
+    } else {
+      for (auto &consumer : consumers) {
+        consumer(req);
+      }
     }
 
     read_one_req(reader_, req);
   } while (req->valid);
   end_ts_ = req->clock_time + start_ts_;
 
+  if (pipeline != nullptr) {
+    pipeline->finish();
+    delete pipeline;
+  }
+
   /* processing */
   post_processing();
+  save_trace_meta_sidecar();
 
   free_request(req);
 
@@ -252,6 +273,10 @@ void traceAnalyzer::TraceAnalyzer::run() {
     popularity_stat_->dump(output_path_);
   }
 
+  if (popularity_sketch_ != nullptr) {
+    popularity_sketch_->dump(output_path_);
+  }
+
   if (popularity_decay_stat_ != nullptr) {
     popularity_decay_stat_->dump(output_path_);
   }
@@ -283,20 +308,94 @@ void traceAnalyzer::TraceAnalyzer::run() {
   has_run_ = true;
 }
 
+std::vector<std::function<void(request_t *)>>
+traceAnalyzer::TraceAnalyzer::get_module_consumers() {
+  std::vector<std::function<void(request_t *)>> consumers;
+  /* the per-object modules use the object state of the request, e.g., reuse
+   * time and object age, which is unknown when the object is sampled out */
+  auto add_per_obj_consumer = [&consumers](std::function<void(request_t *)> fn) {
+    consumers.emplace_back([fn](request_t *req) {
+      if (!req->obj_sampled_out) fn(req);
+    });
+  };
+
+  consumers.emplace_back([this](request_t *req) { op_stat_->add_req(req); });
+
+  if (ttl_stat_ != nullptr) {
+    consumers.emplace_back([this](request_t *req) { ttl_stat_->add_req(req); });
+  }
+
+  if (req_rate_stat_ != nullptr) {
+    consumers.emplace_back(
+        [this](request_t *req) { req_rate_stat_->add_req(req); });
+  }
+
+  if (size_stat_ != nullptr) {
+    consumers.emplace_back([this](request_t *req) { size_stat_->add_req(req); });
+  }
+
+  if (reuse_stat_ != nullptr) {
+    add_per_obj_consumer(
+        [this](request_t *req) { reuse_stat_->add_req(req); });
+  }
+
+  if (access_stat_ != nullptr) {
+    add_per_obj_consumer(
+        [this](request_t *req) { access_stat_->add_req(req); });
+  }
+
+  if (popularity_sketch_ != nullptr) {
+    consumers.emplace_back(
+        [this](request_t *req) { popularity_sketch_->add_req(req); });
+  }
+
+  if (popularity_decay_stat_ != nullptr) {
+    add_per_obj_consumer(
+        [this](request_t *req) { popularity_decay_stat_->add_req(req); });
+  }
+
+  if (prob_at_age_ != nullptr) {
+    add_per_obj_consumer(
+        [this](request_t *req) { prob_at_age_->add_req(req); });
+  }
+
+  if (lifetime_stat_ != nullptr) {
+    add_per_obj_consumer(
+        [this](request_t *req) { lifetime_stat_->add_req(req); });
+  }
+
+  if (create_future_reuse_ != nullptr) {
+    add_per_obj_consumer(
+        [this](request_t *req) { create_future_reuse_->add_req(req); });
+  }
+
+  if (size_change_distribution_ != nullptr) {
+    add_per_obj_consumer(
+        [this](request_t *req) { size_change_distribution_->add_req(req); });
+  }
+
+  if (scan_detector_ != nullptr) {
+    add_per_obj_consumer(
+        [this](request_t *req) { scan_detector_->add_req(req); });
+  }
+
+  return consumers;
+}
+
 string traceAnalyzer::TraceAnalyzer::gen_stat_str() {
   stat_ss_.clear();
-  double cold_miss_ratio = (double)obj_map_.size() / (double)n_req_;
+  double cold_miss_ratio = (double)obj_map_.n_obj() / (double)n_req_;
   double byte_cold_miss_ratio =
       (double)sum_obj_size_obj / (double)sum_obj_size_req;
   int mean_obj_size_req = (int)((double)sum_obj_size_req / (double)n_req_);
   int mean_obj_size_obj =
-      (int)((double)sum_obj_size_obj / (double)obj_map_.size());
-  double freq_mean = (double)n_req_ / (double)obj_map_.size();
+      (int)((double)sum_obj_size_obj / (double)obj_map_.n_obj());
+  double freq_mean = (double)n_req_ / (double)obj_map_.n_obj();
   int64_t time_span = end_ts_ - start_ts_;
 
   stat_ss_ << setprecision(4) << fixed << "dat: " << reader_->trace_path << "\n"
            << "number of requests: " << n_req_
-           << ", number of objects: " << obj_map_.size() << "\n"
+           << ", number of objects: " << obj_map_.n_obj() << "\n"
            << "number of req GiB: " << (double)sum_obj_size_req / (double)GiB
            << ", number of obj GiB: " << (double)sum_obj_size_obj / (double)GiB
            << "\n"
@@ -307,6 +406,11 @@ string traceAnalyzer::TraceAnalyzer::gen_stat_str() {
            << "frequency mean: " << freq_mean << "\n";
   stat_ss_ << "time span: " << time_span << "("
            << (double)(end_ts_ - start_ts_) / 3600 / 24 << " day)\n";
+  if (obj_map_.is_sampling()) {
+    stat_ss_ << "object table is over the memory budget, object statistics "
+                "are scaled from a sample ratio of "
+             << obj_map_.sample_ratio() << "\n";
+  }
 
   stat_ss_ << *op_stat_;
   if (ttl_stat_ != nullptr) {
@@ -314,11 +418,12 @@ string traceAnalyzer::TraceAnalyzer::gen_stat_str() {
   }
   if (req_rate_stat_ != nullptr) stat_ss_ << *req_rate_stat_;
   if (popularity_stat_ != nullptr) stat_ss_ << *popularity_stat_;
+  if (popularity_sketch_ != nullptr) stat_ss_ << *popularity_sketch_;
 
   stat_ss_ << "X-hit (number of obj accessed X times): ";
   for (int i = 0; i < track_n_hit_; i++) {
     stat_ss_ << n_hit_cnt_[i] << "("
-             << (double)n_hit_cnt_[i] / (double)obj_map_.size() << "), ";
+             << (double)n_hit_cnt_[i] / (double)obj_map_.n_obj() << "), ";
   }
   stat_ss_ << "\n";
 
@@ -337,6 +442,30 @@ string traceAnalyzer::TraceAnalyzer::gen_stat_str() {
   return stat_ss_.str();
 }
 
+void traceAnalyzer::TraceAnalyzer::save_trace_meta_sidecar() {
+  /* the sidecar is not requested, the metadata is already available, or the
+   * object statistics are estimated from a sample */
+  if (!reader_->init_params.save_trace_meta || reader_->trace_meta != nullptr ||
+      obj_map_.is_sampling())
+    return;
+
+  trace_meta_t meta;
+  memset(&meta, 0, sizeof(meta));
+  meta.n_req = n_req_;
+  meta.n_obj = obj_map_.n_obj();
+  meta.n_req_byte = (int64_t)sum_obj_size_req;
+  meta.n_obj_byte = (int64_t)sum_obj_size_obj;
+  meta.start_time = start_ts_;
+  meta.end_time = end_ts_;
+  meta.smallest_obj_size = meta.n_obj > 0 ? smallest_obj_size_ : 0;
+  meta.largest_obj_size = largest_obj_size_;
+  memcpy(meta.obj_size_hist, obj_size_hist_, sizeof(obj_size_hist_));
+  meta.has_obj_size_hist = true;
+  meta.obj_sample_scale = 1;
+
+  save_trace_meta(reader_, &meta);
+}
+
 void traceAnalyzer::TraceAnalyzer::post_processing() {
   assert(n_hit_cnt_ == nullptr);
   assert(popular_cnt_ == nullptr);
@@ -346,13 +475,48 @@ void traceAnalyzer::TraceAnalyzer::post_processing() {
   memset(n_hit_cnt_, 0, sizeof(uint64_t) * track_n_hit_);
   memset(popular_cnt_, 0, sizeof(uint64_t) * track_n_popular_);
 
-  for (auto it : obj_map_) {
-    if ((int) it.second.freq <= track_n_hit_) {
-      n_hit_cnt_[it.second.freq - 1] += 1;
+  sum_obj_size_obj = obj_map_.sum_obj_size();
+
+  /* count the X-hit wonders of each shard in parallel */
+  std::mutex mtx;
+  obj_map_.for_each_shard([this, &mtx](const obj_info_map_type &shard) {
+    std::vector<uint64_t> shard_n_hit_cnt(track_n_hit_, 0);
+    for (const auto &p : shard) {
+      if ((int)p.second.freq <= track_n_hit_) {
+        shard_n_hit_cnt[p.second.freq - 1] += 1;
+      }
+    }
+
+    std::lock_guard<std::mutex> lock(mtx);
+    for (int i = 0; i < track_n_hit_; i++) {
+      n_hit_cnt_[i] += shard_n_hit_cnt[i];
+    }
+  });
+
+  if (obj_map_.is_sampling()) {
+    for (int i = 0; i < track_n_hit_; i++) {
+      n_hit_cnt_[i] =
+          (uint64_t)((double)n_hit_cnt_[i] / obj_map_.sample_ratio());
     }
   }
 
-  if (option_.popularity) {
+  if (popularity_sketch_ != nullptr) {
+    std::stringstream merge_list(popularity_sketch_merge_);
+    std::string sketch_path;
+    while (std::getline(merge_list, sketch_path, ',')) {
+      if (sketch_path.empty()) continue;
+      PopularitySketch saved_sketch;
+      if (saved_sketch.load(sketch_path)) {
+        INFO("merge popularity sketch %s\n", sketch_path.c_str());
+        popularity_sketch_->merge(saved_sketch);
+      }
+    }
+    popularity_sketch_->compute();
+    auto &sorted_freq = popularity_sketch_->get_sorted_freq();
+    for (int i = 0; i < track_n_popular_ && i < (int)sorted_freq.size(); i++) {
+      popular_cnt_[i] = sorted_freq[i];
+    }
+  } else if (option_.popularity) {
     popularity_stat_ = new Popularity(obj_map_);
     auto sorted_freq = popularity_stat_->get_sorted_freq();
     for (int i = 0; i < track_n_popular_; i++) {
@@ -11,6 +11,7 @@
 #include <stdlib.h>
 #include <unistd.h>
 
+#include <functional>
 #include <iostream>
 #include <sstream>
 #include <string>
@@ -19,10 +20,14 @@
 #include <vector>
 
 #include "../include/libCacheSim/reader.h"
+#include "../include/libCacheSim/traceMeta.h"
 #include "accessPattern.h"
+#include "objTable.h"
 #include "op.h"
 #include "popularity.h"
 #include "popularityDecay.h"
+#include "popularitySketch.h"
+#include "reqPipeline.h"
 #include "reqRate.h"
 #include "reuse.h"
 #include "size.h"
@@ -66,6 +71,18 @@ typedef struct analysis_param {
   int warmup_time;
   double access_pattern_sample_ratio;
   int access_pattern_sample_ratio_inv;
+  /* run each analysis module on its own thread */
+  bool pipeline;
+  /* the number of requests passed to the module threads at a time */
+  int pipeline_batch_size;
+  /* memory budget (in bytes) of the object table, 0 means unbounded,
+   * objects are sampled when the table grows beyond the budget */
+  int64_t obj_table_mem_budget;
+  /* use a top-K sketch for popularity analysis, 0 means exact popularity */
+  int popularity_top_k;
+  /* comma-separated paths of saved popularity sketches, which are merged
+   * into the sketch of this trace, NULL means no merge */
+  const char *popularity_sketch_merge;
 } analysis_param_t;
 
 static analysis_param_t default_param() {
@@ -76,6 +93,11 @@ static analysis_param_t default_param() {
   param.warmup_time = 86400;
   param.access_pattern_sample_ratio = 0.01;
   param.access_pattern_sample_ratio_inv = 101;
+  param.pipeline = false;
+  param.pipeline_batch_size = DEFAULT_PIPELINE_BATCH_SIZE;
+  param.obj_table_mem_budget = 0;
+  param.popularity_top_k = 0;
+  param.popularity_sketch_merge = nullptr;
 
   return param;
 };
@@ -111,7 +133,15 @@ class TraceAnalyzer {
         track_n_hit_(params.track_n_hit),
         time_window_(params.time_window),
         warmup_time_(params.warmup_time),
+        pipeline_(params.pipeline),
+        pipeline_batch_size_(params.pipeline_batch_size),
+        popularity_top_k_(params.popularity_top_k),
+        popularity_sketch_merge_(params.popularity_sketch_merge == nullptr
+                                     ? ""
+                                     : params.popularity_sketch_merge),
         n_req_(0),
+        obj_map_(DEFAULT_OBJ_TABLE_N_SHARD_POW, params.obj_table_mem_budget,
+                 params.obj_table_mem_budget > 0 ? 0 : DEFAULT_PREALLOC_N_OBJ),
         reader_(reader),
         option_(option),
         output_path_(std::move(output_path)) {
@@ -152,6 +182,13 @@ class TraceAnalyzer {
   int time_window_;
   // warmup time in seconds
   int warmup_time_;
+  // whether each module runs on its own thread
+  bool pipeline_;
+  int pipeline_batch_size_;
+  // the number of objects tracked in streaming popularity analysis
+  int popularity_top_k_;
+  // the saved popularity sketches merged into the sketch of this trace
+  string popularity_sketch_merge_;
 
   /* stat */
   int64_t n_req_ = 0;
@@ -168,7 +205,12 @@ class TraceAnalyzer {
    * an object is requested, we ignore for now */
   //  uint64_t sum_req_size_req = 0, sum_req_size_obj = 0;
 
-  obj_info_map_type obj_map_;
+  ObjTable obj_map_;
+
+  /* the object size distribution collected when objects are first seen,
+   * used to create the trace metadata sidecar */
+  int64_t obj_size_hist_[TRACE_META_N_SIZE_BUCKET] = {0};
+  int64_t smallest_obj_size_ = INT64_MAX, largest_obj_size_ = 0;
 
  private:
   reader_t *reader_ = nullptr;
@@ -183,6 +225,7 @@ class TraceAnalyzer {
   ReuseDistribution *reuse_stat_ = nullptr;
   AccessPattern *access_stat_ = nullptr;
   Popularity *popularity_stat_ = nullptr;
+  PopularitySketch *popularity_sketch_ = nullptr;
   PopularityDecay *popularity_decay_stat_ = nullptr;
 
   ProbAtAge *prob_at_age_ = nullptr;
@@ -198,6 +241,15 @@ class TraceAnalyzer {
 
   void post_processing();
 
+  /* the analysis has scanned the full trace, save the trace metadata if the
+   * reader has save_trace_meta, so that later runs (e.g., cachesim) do not
+   * need to scan the trace again */
+  void save_trace_meta_sidecar();
+
+  /* one add_req callback per enabled module, used by both the serial path
+   * and the pipeline */
+  std::vector<std::function<void(request_t *)>> get_module_consumers();
+
   string gen_stat_str();
 
   inline int time_to_window_idx(uint32_t rtime) { return rtime / time_window_; }
@@ -0,0 +1,115 @@
+/**
+ * @file objTable.cpp
+ * @brief the sharded object table of TraceAnalyzer
+ *
+ */
+
+#include "objTable.h"
+
+#include <algorithm>
+#include <atomic>
+#include <thread>
+
+namespace traceAnalyzer {
+
+ObjTable::ObjTable(int n_shard_pow, int64_t mem_budget, int64_t prealloc_n_obj)
+    : n_shard_pow_(n_shard_pow),
+      n_shard_(1 << n_shard_pow),
+      mem_budget_(mem_budget),
+      n_active_shard_(1 << n_shard_pow),
+      shards_(1 << n_shard_pow),
+      shard_obj_bytes_(1 << n_shard_pow, 0) {
+  if (n_shard_pow_ < 0 || n_shard_pow_ > 16) {
+    ERROR("the number of object table shards 2^%d is out of range\n",
+          n_shard_pow_);
+    abort();
+  }
+
+  if (prealloc_n_obj > 0) {
+    for (auto &shard : shards_) {
+      shard.reserve(prealloc_n_obj / n_shard_);
+    }
+  }
+}
+
+int64_t ObjTable::n_stored_obj() const {
+  int64_t n = 0;
+  for (int i = 0; i < n_active_shard_; i++) {
+    n += (int64_t)shards_[i].size();
+  }
+  return n;
+}
+
+int64_t ObjTable::sum_obj_size() const {
+  int64_t sum = 0;
+  for (int i = 0; i < n_active_shard_; i++) {
+    sum += shard_obj_bytes_[i];
+  }
+  return (int64_t)((double)sum / sample_ratio());
+}
+
+int64_t ObjTable::mem_usage() const {
+  /* a flat map stores the nodes inline and one info byte per slot */
+  int64_t n_byte = 0;
+  for (int i = 0; i < n_active_shard_; i++) {
+    if (shards_[i].empty()) continue;
+    n_byte += (int64_t)(shards_[i].mask() + 1) *
+              (int64_t)(sizeof(obj_id_t) + sizeof(struct obj_info) + 1);
+  }
+  return n_byte;
+}
+
+void ObjTable::enforce_mem_budget() {
+  int64_t n_byte = mem_usage();
+  if (n_byte <= mem_budget_) return;
+
+  int n_active_shard_old = n_active_shard_;
+  while (n_byte > mem_budget_ && n_active_shard_ > 1) {
+    n_active_shard_ -= 1;
+    obj_info_map_type &shard = shards_[n_active_shard_];
+    n_byte -= (int64_t)(shard.mask() + 1) *
+              (int64_t)(sizeof(obj_id_t) + sizeof(struct obj_info) + 1);
+    /* swap with an empty map to release the memory */
+    obj_info_map_type().swap(shard);
+    shard_obj_bytes_[n_active_shard_] = 0;
+  }
+
+  WARN(
+      "object table uses more than the memory budget %.2lf GiB, drop %d "
+      "shards and sample %.4lf of the objects\n",
+      (double)mem_budget_ / GiB, n_active_shard_old - n_active_shard_,
+      sample_ratio());
+}
+
+void ObjTable::for_each_shard(
+    const std::function<void(const obj_info_map_type &)> &fn,
+    int n_thread) const {
+  if (n_thread <= 0) {
+    n_thread = (int)std::thread::hardware_concurrency();
+  }
+  n_thread = std::max(1, std::min(n_thread, n_active_shard_));
+
+  if (n_thread == 1) {
+    for (int i = 0; i < n_active_shard_; i++) {
+      fn(shards_[i]);
+    }
+    return;
+  }
+
+  std::atomic<int> next_shard(0);
+  std::vector<std::thread> threads;
+  for (int t = 0; t < n_thread; t++) {
+    threads.emplace_back([this, &fn, &next_shard]() {
+      int i;
+      while ((i = next_shard.fetch_add(1)) < n_active_shard_) {
+        fn(shards_[i]);
+      }
+    });
+  }
+
+  for (std::thread &th : threads) {
+    th.join();
+  }
+}
+
+}  // namespace traceAnalyzer
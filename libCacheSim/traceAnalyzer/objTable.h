@@ -0,0 +1,128 @@
+#pragma once
+
+/**
+ * the object table used by TraceAnalyzer
+ *
+ * objects are hash-partitioned into shards, each shard is a flat hash map
+ * of compact obj_info records, so the shards can be scanned in parallel
+ *
+ * an optional memory budget bounds the size of the table, when the table
+ * grows beyond the budget, it drops shards (starting from the last one) and
+ * only tracks the objects in the remaining shards, which is a spatial
+ * sampling of the objects, the object-level statistics (number of objects,
+ * bytes, X-hit wonders) are scaled by the sampling ratio
+ *
+ */
+
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+#include "../include/libCacheSim/logging.h"
+#include "struct.h"
+
+namespace traceAnalyzer {
+
+#define DEFAULT_OBJ_TABLE_N_SHARD_POW 6
+/* check the memory usage every 16K new objects */
+#define OBJ_TABLE_MEM_CHECK_INTVL (1 << 14)
+
+class ObjTable {
+ public:
+  /**
+   * @param n_shard_pow the table has 2^n_shard_pow shards
+   * @param mem_budget the memory budget of the table in bytes,
+   *        0 means unbounded
+   * @param prealloc_n_obj the number of objects to reserve space for
+   */
+  explicit ObjTable(int n_shard_pow = DEFAULT_OBJ_TABLE_N_SHARD_POW,
+                    int64_t mem_budget = 0, int64_t prealloc_n_obj = 0);
+
+  ~ObjTable() = default;
+
+  /* whether the object is tracked, objects in dropped shards are not */
+  inline bool is_sampled(obj_id_t obj_id) const {
+    return shard_idx(obj_id) < n_active_shard_;
+  }
+
+  inline struct obj_info *find(obj_id_t obj_id) {
+    obj_info_map_type &shard = shards_[shard_idx(obj_id)];
+    auto it = shard.find(obj_id);
+    return it == shard.end() ? nullptr : &it->second;
+  }
+
+  /* insert an object that is not in the table, the object must be sampled */
+  inline void insert(obj_id_t obj_id, const struct obj_info &info) {
+    int idx = shard_idx(obj_id);
+    shards_[idx][obj_id] = info;
+    shard_obj_bytes_[idx] += info.obj_size();
+
+    if (mem_budget_ > 0 && ++n_insert_since_check_ >= OBJ_TABLE_MEM_CHECK_INTVL) {
+      n_insert_since_check_ = 0;
+      enforce_mem_budget();
+    }
+  }
+
+  /* the fraction of objects that are tracked */
+  inline double sample_ratio() const {
+    return (double)n_active_shard_ / (double)n_shard_;
+  }
+
+  inline bool is_sampling() const { return n_active_shard_ < n_shard_; }
+
+  /* the number of objects stored in the table */
+  int64_t n_stored_obj() const;
+
+  /* the estimated number of objects in the trace, scaled by sample ratio */
+  int64_t n_obj() const {
+    return (int64_t)((double)n_stored_obj() / sample_ratio());
+  }
+
+  /* the estimated number of object bytes in the trace (each object counted
+   * once using the size at the first request), scaled by sample ratio */
+  int64_t sum_obj_size() const;
+
+  /* the estimated memory usage of the table in bytes */
+  int64_t mem_usage() const;
+
+  /**
+   * call fn on each active shard, the shards are processed in parallel
+   * using up to n_thread threads, fn must be safe to call concurrently on
+   * different shards
+   */
+  void for_each_shard(const std::function<void(const obj_info_map_type &)> &fn,
+                      int n_thread = -1) const;
+
+  /* call fn on each stored object, sequentially */
+  template <typename F>
+  void for_each(F &&fn) const {
+    for (int i = 0; i < n_active_shard_; i++) {
+      for (const auto &p : shards_[i]) {
+        fn(p.first, p.second);
+      }
+    }
+  }
+
+ private:
+  inline int shard_idx(obj_id_t obj_id) const {
+    if (n_shard_pow_ == 0) return 0;
+    /* use the high bits of a multiplicative hash, the low bits are used by
+     * the hash map inside the shard */
+    return (int)(((uint64_t)obj_id * 0x9E3779B97F4A7C15ULL) >>
+                 (64 - n_shard_pow_));
+  }
+
+  void enforce_mem_budget();
+
+  const int n_shard_pow_;
+  const int n_shard_;
+  const int64_t mem_budget_;
+  /* shards with index smaller than n_active_shard_ are tracked */
+  int n_active_shard_;
+  int64_t n_insert_since_check_ = 0;
+
+  std::vector<obj_info_map_type> shards_;
+  std::vector<int64_t> shard_obj_bytes_;
+};
+
+}  // namespace traceAnalyzer
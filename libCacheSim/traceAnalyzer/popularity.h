@@ -9,6 +9,7 @@
 #include <vector>
 
 #include "../include/libCacheSim/logging.h"
+#include "objTable.h"
 #include "struct.h"
 #include "utils/include/linReg.h"
 
@@ -34,7 +35,7 @@ class Popularity {
   Popularity() { has_run = false; };
   ~Popularity() = default;
 
-  explicit Popularity(obj_info_map_type &obj_map) { run(obj_map); };
+  explicit Popularity(const ObjTable &obj_map) { run(obj_map); };
 
   friend std::ostream &operator<<(std::ostream &os,
                                   const Popularity &popularity) {
@@ -61,7 +62,7 @@ class Popularity {
   std::string fit_fail_reason_ = "";
 
  private:
-  void run(obj_info_map_type &obj_map);
+  void run(const ObjTable &obj_map);
 
   std::vector<uint32_t> freq_vec_{};
   double slope_ = -1, intercept_ = -1, r2_ = -1;
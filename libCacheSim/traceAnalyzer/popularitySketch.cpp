@@ -0,0 +1,290 @@
+/**
+ * @file popularitySketch.cpp
+ * @brief streaming popularity analysis using SpaceSaving and HyperLogLog
+ *
+ */
+
+#include "popularitySketch.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <fstream>
+
+#include "../include/libCacheSim/logging.h"
+#include "popularity.h"
+
+namespace traceAnalyzer {
+using namespace std;
+
+static const char POPULARITY_SKETCH_MAGIC[8] = {'L', 'C', 'S', 'P',
+                                                'O', 'P', 'S', '1'};
+
+/******************************** HyperLogLog ********************************/
+int64_t HyperLogLog::estimate() const {
+  const double m = (double)registers_.size();
+  const double alpha = 0.7213 / (1.0 + 1.079 / m);
+
+  double sum = 0;
+  int n_zero = 0;
+  for (const uint8_t r : registers_) {
+    sum += ldexp(1.0, -r);
+    if (r == 0) n_zero += 1;
+  }
+
+  double est = alpha * m * m / sum;
+  if (est <= 2.5 * m && n_zero > 0) {
+    /* linear counting for small cardinality */
+    est = m * log(m / n_zero);
+  }
+
+  return (int64_t)est;
+}
+
+void HyperLogLog::merge(const HyperLogLog &other) {
+  for (size_t i = 0; i < registers_.size(); i++) {
+    registers_[i] = max(registers_[i], other.registers_[i]);
+  }
+}
+
+/******************************** SpaceSaving ********************************/
+void SpaceSaving::heap_swap(uint32_t pos1, uint32_t pos2) {
+  swap(heap_[pos1], heap_[pos2]);
+  heap_pos_[heap_[pos1]] = pos1;
+  heap_pos_[heap_[pos2]] = pos2;
+}
+
+void SpaceSaving::sift_down(uint32_t pos) {
+  uint32_t n = (uint32_t)heap_.size();
+  while (true) {
+    uint32_t smallest = pos;
+    uint32_t l = 2 * pos + 1, r = 2 * pos + 2;
+    if (l < n && entries_[heap_[l]].count < entries_[heap_[smallest]].count)
+      smallest = l;
+    if (r < n && entries_[heap_[r]].count < entries_[heap_[smallest]].count)
+      smallest = r;
+    if (smallest == pos) return;
+    heap_swap(pos, smallest);
+    pos = smallest;
+  }
+}
+
+void SpaceSaving::add(obj_id_t obj_id, uint64_t count, uint64_t error) {
+  auto it = obj_idx_.find(obj_id);
+  if (it != obj_idx_.end()) {
+    entries_[it->second].count += count;
+    entries_[it->second].error += error;
+    sift_down(heap_pos_[it->second]);
+    return;
+  }
+
+  if ((int)entries_.size() < k_) {
+    uint32_t idx = (uint32_t)entries_.size();
+    entries_.push_back({obj_id, count, error});
+    heap_.push_back(idx);
+    heap_pos_.push_back(idx);
+    obj_idx_[obj_id] = idx;
+
+    /* sift up */
+    uint32_t pos = idx;
+    while (pos > 0) {
+      uint32_t parent = (pos - 1) / 2;
+      if (entries_[heap_[parent]].count <= entries_[heap_[pos]].count) break;
+      heap_swap(pos, parent);
+      pos = parent;
+    }
+    return;
+  }
+
+  /* replace the object with the smallest count */
+  uint32_t idx = heap_[0];
+  entry &e = entries_[idx];
+  obj_idx_.erase(e.obj_id);
+  e.error = e.count + error;
+  e.count = e.count + count;
+  e.obj_id = obj_id;
+  obj_idx_[obj_id] = idx;
+  sift_down(0);
+}
+
+vector<SpaceSaving::entry> SpaceSaving::sorted_entries() const {
+  vector<entry> sorted(entries_);
+  sort(sorted.begin(), sorted.end(),
+       [](const entry &e1, const entry &e2) { return e1.count > e2.count; });
+  return sorted;
+}
+
+void SpaceSaving::merge(const SpaceSaving &other) {
+  /* an object missing from one summary has at most the min count of that
+   * summary, which is added to both its count and error */
+  const uint64_t min1 = min_count(), min2 = other.min_count();
+
+  vector<entry> merged;
+  merged.reserve(entries_.size() + other.entries_.size());
+  for (const entry &e : entries_) {
+    auto it = other.obj_idx_.find(e.obj_id);
+    if (it == other.obj_idx_.end()) {
+      merged.push_back({e.obj_id, e.count + min2, e.error + min2});
+    } else {
+      const entry &e2 = other.entries_[it->second];
+      merged.push_back({e.obj_id, e.count + e2.count, e.error + e2.error});
+    }
+  }
+  for (const entry &e : other.entries_) {
+    if (obj_idx_.find(e.obj_id) == obj_idx_.end()) {
+      merged.push_back({e.obj_id, e.count + min1, e.error + min1});
+    }
+  }
+
+  sort(merged.begin(), merged.end(),
+       [](const entry &e1, const entry &e2) { return e1.count > e2.count; });
+  if ((int)merged.size() > k_) merged.resize(k_);
+
+  entries_.clear();
+  heap_.clear();
+  heap_pos_.clear();
+  obj_idx_.clear();
+  /* a list sorted in descending order is rebuilt into a min-heap by adding
+   * from the smallest */
+  for (auto it = merged.rbegin(); it != merged.rend(); ++it) {
+    add(it->obj_id, it->count, it->error);
+  }
+}
+
+/***************************** PopularitySketch ******************************/
+void PopularitySketch::merge(const PopularitySketch &other) {
+  n_req_ += other.n_req_;
+  top_k_.merge(other.top_k_);
+  n_obj_.merge(other.n_obj_);
+}
+
+void PopularitySketch::save(const string &path_base) const {
+  string ofile_path = path_base + ".popularitySketch";
+  ofstream ofs(ofile_path, ios::out | ios::trunc | ios::binary);
+
+  vector<SpaceSaving::entry> entries = top_k_.sorted_entries();
+  int32_t k = top_k_.k();
+  int64_t n_entry = (int64_t)entries.size();
+  int32_t hll_precision = HLL_PRECISION;
+
+  ofs.write(POPULARITY_SKETCH_MAGIC, sizeof(POPULARITY_SKETCH_MAGIC));
+  ofs.write(reinterpret_cast<const char *>(&n_req_), sizeof(n_req_));
+  ofs.write(reinterpret_cast<const char *>(&k), sizeof(k));
+  ofs.write(reinterpret_cast<const char *>(&n_entry), sizeof(n_entry));
+  ofs.write(reinterpret_cast<const char *>(entries.data()),
+            (streamsize)(sizeof(SpaceSaving::entry) * entries.size()));
+  ofs.write(reinterpret_cast<const char *>(&hll_precision),
+            sizeof(hll_precision));
+  ofs.write(reinterpret_cast<const char *>(n_obj_.registers_.data()),
+            (streamsize)n_obj_.registers_.size());
+  ofs.close();
+}
+
+bool PopularitySketch::load(const string &sketch_path) {
+  ifstream ifs(sketch_path, ios::in | ios::binary);
+  char magic[sizeof(POPULARITY_SKETCH_MAGIC)];
+  int32_t k, hll_precision;
+  int64_t n_req, n_entry;
+
+  ifs.read(magic, sizeof(magic));
+  if (!ifs || memcmp(magic, POPULARITY_SKETCH_MAGIC, sizeof(magic)) != 0) {
+    ERROR("%s is not a popularity sketch\n", sketch_path.c_str());
+    return false;
+  }
+
+  ifs.read(reinterpret_cast<char *>(&n_req), sizeof(n_req));
+  ifs.read(reinterpret_cast<char *>(&k), sizeof(k));
+  ifs.read(reinterpret_cast<char *>(&n_entry), sizeof(n_entry));
+  vector<SpaceSaving::entry> entries(n_entry);
+  ifs.read(reinterpret_cast<char *>(entries.data()),
+           (streamsize)(sizeof(SpaceSaving::entry) * entries.size()));
+  ifs.read(reinterpret_cast<char *>(&hll_precision), sizeof(hll_precision));
+  if (!ifs || hll_precision != HLL_PRECISION) {
+    ERROR("popularity sketch %s is truncated or uses a different precision\n",
+          sketch_path.c_str());
+    return false;
+  }
+
+  SpaceSaving top_k(k);
+  for (auto it = entries.rbegin(); it != entries.rend(); ++it) {
+    top_k.add(it->obj_id, it->count, it->error);
+  }
+  HyperLogLog n_obj;
+  ifs.read(reinterpret_cast<char *>(n_obj.registers_.data()),
+           (streamsize)n_obj.registers_.size());
+  if (!ifs) {
+    ERROR("popularity sketch %s is truncated\n", sketch_path.c_str());
+    return false;
+  }
+
+  n_req_ = n_req;
+  top_k_ = std::move(top_k);
+  n_obj_ = std::move(n_obj);
+  return true;
+}
+
+void PopularitySketch::compute() {
+  vector<SpaceSaving::entry> entries = top_k_.sorted_entries();
+  freq_vec_.clear();
+  freq_vec_.reserve(entries.size());
+  for (const auto &e : entries) {
+    freq_vec_.push_back(e.count);
+  }
+
+  if (freq_vec_.size() < 200) {
+    fit_fail_reason_ = "popularity: too few objects (" +
+                       to_string(freq_vec_.size()) +
+                       "), skip the popularity computation";
+    WARN("%s\n", fit_fail_reason_.c_str());
+    return;
+  }
+
+  /* the counters of the least popular objects in the summary are dominated
+   * by the error, only fit on the objects whose count is accurate */
+  size_t n_fit = 0;
+  for (const auto &e : entries) {
+    if (e.error * 2 > e.count) break;
+    n_fit += 1;
+  }
+  if (n_fit < 200) n_fit = min(freq_vec_.size(), (size_t)200);
+
+  vector<double> log_freq(n_fit);
+  vector<double> log_rank(n_fit);
+  for (size_t i = 0; i < n_fit; i++) {
+    log_freq[i] = log((double)freq_vec_[i]);
+    log_rank[i] = log((double)(i + 1));
+  }
+
+  slope_ = -PopularityUtils::slope(log_rank, log_freq);
+}
+
+void PopularitySketch::dump(string &path_base) {
+  if (freq_vec_.empty()) {
+    ERROR("popularity has not been computed\n");
+    return;
+  }
+
+  string ofile_path = path_base + ".popularity";
+  ofstream ofs(ofile_path, ios::out | ios::trunc);
+  ofs << "# " << path_base << "\n";
+  ofs << "# freq (sorted):cnt - for Zipf plot, top " << top_k_.k()
+      << " objects only\n";
+
+  uint64_t last_freq = freq_vec_[0];
+  uint64_t freq_cnt = 0;
+  for (auto &cnt : freq_vec_) {
+    if (cnt == last_freq) {
+      freq_cnt += 1;
+    } else {
+      ofs << last_freq << ":" << freq_cnt << "\n";
+      freq_cnt = 1;
+      last_freq = cnt;
+    }
+  }
+  ofs << last_freq << ":" << freq_cnt << "\n";
+  ofs.close();
+
+  save(path_base);
+}
+
+}  // namespace traceAnalyzer
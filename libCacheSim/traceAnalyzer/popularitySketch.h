@@ -0,0 +1,150 @@
+#pragma once
+
+/**
+ * streaming popularity analysis in bounded memory
+ *
+ * the exact popularity module needs the frequency of every object, this
+ * module instead keeps
+ * 1. a SpaceSaving summary of the top-K most popular objects,
+ * 2. a HyperLogLog sketch to estimate the number of objects,
+ * the Zipf skewness is fitted on the rank-frequency curve of the top-K
+ * objects, and the freq:cnt histogram is built from the top-K counters
+ *
+ * both sketches are mergeable, so the popularity of traces analyzed
+ * separately (e.g., different shards or days) can be combined by saving the
+ * sketch of each trace and merging them
+ *
+ */
+
+#include <cstdint>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "../dataStructure/robin_hood.h"
+#include "../include/libCacheSim/request.h"
+#include "../utils/include/mymath.h"
+
+namespace traceAnalyzer {
+
+#define DEFAULT_POPULARITY_TOP_K 4096
+/* 2^14 registers, the standard error is 1.04 / sqrt(2^14) = 0.8% */
+#define HLL_PRECISION 14
+
+class HyperLogLog {
+ public:
+  HyperLogLog() : registers_(1 << HLL_PRECISION, 0){};
+
+  inline void add(uint64_t hv) {
+    uint32_t idx = (uint32_t)(hv >> (64 - HLL_PRECISION));
+    /* the position of the first 1 bit in the remaining bits */
+    uint64_t w = (hv << HLL_PRECISION) | (1ULL << (HLL_PRECISION - 1));
+    uint8_t rank = (uint8_t)(__builtin_clzll(w) + 1);
+    if (rank > registers_[idx]) registers_[idx] = rank;
+  }
+
+  int64_t estimate() const;
+
+  void merge(const HyperLogLog &other);
+
+  std::vector<uint8_t> registers_;
+};
+
+class SpaceSaving {
+ public:
+  explicit SpaceSaving(int k = DEFAULT_POPULARITY_TOP_K) : k_(k) {
+    entries_.reserve(k);
+    obj_idx_.reserve(k);
+  };
+
+  struct entry {
+    obj_id_t obj_id;
+    /* an upper bound of the frequency */
+    uint64_t count;
+    /* count - error is a lower bound of the frequency */
+    uint64_t error;
+  };
+
+  void add(obj_id_t obj_id, uint64_t count = 1, uint64_t error = 0);
+
+  /* the smallest count in the summary, objects not in the summary have at
+   * most this frequency */
+  inline uint64_t min_count() const {
+    return (int)entries_.size() < k_ ? 0 : entries_[heap_[0]].count;
+  }
+
+  /* the entries sorted by count in descending order */
+  std::vector<entry> sorted_entries() const;
+
+  void merge(const SpaceSaving &other);
+
+  int k() const { return k_; }
+
+ private:
+  int k_;
+  /* entries_ are organized as a min-heap on count through heap_,
+   * heap_pos_ maps an entry to its position in heap_ */
+  std::vector<entry> entries_;
+  std::vector<uint32_t> heap_;
+  std::vector<uint32_t> heap_pos_;
+  robin_hood::unordered_flat_map<obj_id_t, uint32_t> obj_idx_;
+
+  void sift_down(uint32_t pos);
+  void heap_swap(uint32_t pos1, uint32_t pos2);
+};
+
+class PopularitySketch {
+ public:
+  explicit PopularitySketch(int top_k = DEFAULT_POPULARITY_TOP_K)
+      : top_k_(top_k){};
+  ~PopularitySketch() = default;
+
+  inline void add_req(const request_t *req) {
+    n_req_ += 1;
+    top_k_.add(req->obj_id);
+    /* mix the object id, so that sequential ids spread over registers */
+    n_obj_.add(mix64((uint64_t)req->obj_id));
+  }
+
+  void merge(const PopularitySketch &other);
+
+  /* save the sketch to path_base.popularitySketch, which can be loaded and
+   * merged with the sketches of other traces */
+  void save(const std::string &path_base) const;
+
+  bool load(const std::string &sketch_path);
+
+  /* fit the Zipf skewness using the top-K objects */
+  void compute();
+
+  int64_t n_obj() const { return n_obj_.estimate(); }
+
+  /* the frequency of the most popular objects in descending order */
+  std::vector<uint64_t> &get_sorted_freq() { return freq_vec_; }
+
+  void dump(std::string &path_base);
+
+  friend std::ostream &operator<<(std::ostream &os,
+                                  const PopularitySketch &sketch) {
+    if (sketch.fit_fail_reason_.size() > 0) {
+      os << sketch.fit_fail_reason_ << "\n";
+    } else {
+      os << "popularity (top " << sketch.top_k_.k()
+         << " objects): Zipf linear fitting slope=" << sketch.slope_
+         << ", estimated number of objects " << sketch.n_obj() << "\n";
+    }
+    return os;
+  }
+
+  std::string fit_fail_reason_ = "";
+
+ private:
+  int64_t n_req_ = 0;
+  SpaceSaving top_k_;
+  HyperLogLog n_obj_;
+
+  std::vector<uint64_t> freq_vec_{};
+  double slope_ = -1;
+};
+
+}  // namespace traceAnalyzer
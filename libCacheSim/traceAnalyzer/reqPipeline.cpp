@@ -0,0 +1,104 @@
+/**
+ * @file reqPipeline.cpp
+ * @brief broadcast request batches from the analyzer to per-module threads
+ *
+ */
+
+#include "reqPipeline.h"
+
+#include <cassert>
+
+#include "../include/libCacheSim/logging.h"
+
+namespace traceAnalyzer {
+
+ReqPipeline::ReqPipeline(int batch_size, int n_slot)
+    : batch_size_(batch_size), n_slot_(n_slot), slots_(n_slot) {
+  if (batch_size_ <= 0 || n_slot_ <= 1) {
+    ERROR(
+        "pipeline batch size (%d) must be positive and the number of slots "
+        "(%d) must be at least 2\n",
+        batch_size_, n_slot_);
+    abort();
+  }
+
+  for (auto &slot : slots_) {
+    slot.reqs.reserve(batch_size_);
+  }
+}
+
+void ReqPipeline::start(
+    const std::vector<std::function<void(request_t *)>> &consumers) {
+  assert(threads_.empty());
+  n_consumer_ = (int)consumers.size();
+  for (const auto &fn : consumers) {
+    threads_.emplace_back(&ReqPipeline::consume, this, fn);
+  }
+}
+
+std::vector<request_t> *ReqPipeline::acquire_batch() {
+  std::unique_lock<std::mutex> lock(mtx_);
+  batch_slot &slot = slots_[n_published_ % n_slot_];
+  released_cond_.wait(lock, [&slot]() { return slot.n_pending == 0; });
+  lock.unlock();
+
+  slot.reqs.clear();
+  return &slot.reqs;
+}
+
+void ReqPipeline::publish_batch() {
+  if (curr_batch_ == nullptr) return;
+
+  std::unique_lock<std::mutex> lock(mtx_);
+  slots_[n_published_ % n_slot_].n_pending = n_consumer_;
+  n_published_ += 1;
+  lock.unlock();
+
+  curr_batch_ = nullptr;
+  published_cond_.notify_all();
+}
+
+void ReqPipeline::finish() {
+  publish_batch();
+
+  std::unique_lock<std::mutex> lock(mtx_);
+  finished_ = true;
+  lock.unlock();
+  published_cond_.notify_all();
+
+  join();
+}
+
+void ReqPipeline::join() {
+  for (std::thread &th : threads_) {
+    th.join();
+  }
+  threads_.clear();
+}
+
+void ReqPipeline::consume(const std::function<void(request_t *)> &fn) {
+  for (int64_t seq = 0;; seq++) {
+    std::unique_lock<std::mutex> lock(mtx_);
+    published_cond_.wait(lock,
+                         [this, seq]() { return n_published_ > seq || finished_; });
+    if (n_published_ <= seq) {
+      /* all batches have been consumed */
+      return;
+    }
+    batch_slot &slot = slots_[seq % n_slot_];
+    lock.unlock();
+
+    /* the producer does not touch a slot before all consumers release it */
+    for (request_t &req : slot.reqs) {
+      fn(&req);
+    }
+
+    lock.lock();
+    slot.n_pending -= 1;
+    bool released = slot.n_pending == 0;
+    lock.unlock();
+    if (released) released_cond_.notify_one();
+  }
+}
+
+}  // namespace traceAnalyzer
@@ -0,0 +1,82 @@
+#pragma once
+
+/**
+ * a single-producer, multi-consumer broadcast pipeline of request batches
+ *
+ * the producer (the reader and obj_map enrichment stage of TraceAnalyzer)
+ * fills a batch of annotated requests and publishes it, every consumer
+ * (one thread per analysis module) sees every batch in order,
+ * a batch slot is recycled only after all consumers have released it
+ *
+ * synchronization happens once per batch, so the per-request cost is a copy
+ * of the request into the batch
+ *
+ */
+
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "../include/libCacheSim/request.h"
+
+namespace traceAnalyzer {
+
+#define DEFAULT_PIPELINE_BATCH_SIZE 4096
+#define DEFAULT_PIPELINE_N_SLOT 8
+
+class ReqPipeline {
+ public:
+  explicit ReqPipeline(int batch_size = DEFAULT_PIPELINE_BATCH_SIZE,
+                       int n_slot = DEFAULT_PIPELINE_N_SLOT);
+
+  ~ReqPipeline() { join(); };
+
+  /* start one consumer thread per function, must be called before
+   * publishing the first batch */
+  void start(const std::vector<std::function<void(request_t *)>> &consumers);
+
+  /* copy one request into the current batch, publish the batch when full */
+  inline void add_req(const request_t *req) {
+    if (curr_batch_ == nullptr) curr_batch_ = acquire_batch();
+    curr_batch_->push_back(*req);
+    if ((int)curr_batch_->size() >= batch_size_) publish_batch();
+  }
+
+  /* publish the partial batch, signal the end of the stream and wait for
+   * all consumers to finish */
+  void finish();
+
+ private:
+  struct batch_slot {
+    std::vector<request_t> reqs;
+    /* the number of consumers that have not released this batch */
+    int n_pending = 0;
+  };
+
+  std::vector<request_t> *acquire_batch();
+  void publish_batch();
+  void consume(const std::function<void(request_t *)> &fn);
+  void join();
+
+  const int batch_size_;
+  const int n_slot_;
+  int n_consumer_ = 0;
+
+  std::vector<batch_slot> slots_;
+  std::vector<std::thread> threads_;
+  std::vector<request_t> *curr_batch_ = nullptr;
+
+  std::mutex mtx_;
+  /* wakes up consumers when a batch is published or the stream ends */
+  std::condition_variable published_cond_;
+  /* wakes up the producer when a slot is released by all consumers */
+  std::condition_variable released_cond_;
+  /* the number of batches published, guarded by mtx_ */
+  int64_t n_published_ = 0;
+  bool finished_ = false;
+};
+
+}  // namespace traceAnalyzer
@@ -10,12 +10,39 @@ typedef uint64_t obj_size_t;
 // typedef int32_t time_t;
 
 namespace traceAnalyzer {
+/**
+ * compact per-object record (22 bytes), the real times are relative to the
+ * start of the trace, the virtual time and object size are stored in 40 bits,
+ * which supports up to 2^40 requests and 1 TiB objects
+ */
 struct obj_info {
-  int64_t last_access_vtime;
-  obj_size_t obj_size;
   int32_t last_access_rtime;
-  int32_t freq;
   int32_t create_rtime;
+  uint32_t freq;
+
+  inline int64_t last_access_vtime() const { return get_u40(last_access_vtime_); }
+  inline void set_last_access_vtime(int64_t vtime) {
+    set_u40(last_access_vtime_, (uint64_t)vtime);
+  }
+
+  inline obj_size_t obj_size() const { return get_u40(obj_size_); }
+  inline void set_obj_size(obj_size_t obj_size) { set_u40(obj_size_, obj_size); }
+
+ private:
+  uint8_t last_access_vtime_[5];
+  uint8_t obj_size_[5];
+
+  static inline uint64_t get_u40(const uint8_t *b) {
+    return (uint64_t)b[0] | (uint64_t)b[1] << 8 | (uint64_t)b[2] << 16 |
+           (uint64_t)b[3] << 24 | (uint64_t)b[4] << 32;
+  }
+
+  static inline void set_u40(uint8_t *b, uint64_t v) {
+    if (v > 0xffffffffffULL) v = 0xffffffffffULL;
+    for (int i = 0; i < 5; i++) {
+      b[i] = (uint8_t)(v >> (8 * i));
+    }
+  }
 } __attribute__((packed));
 
 using obj_info_map_type =
@@ -91,6 +91,7 @@ int lcsReader_setup(reader_t *reader) {
   reader->trace_start_offset = sizeof(lcs_trace_header_t);
   reader->obj_id_is_num = true;
   reader->n_total_req = header->stat.n_req;
+  trace_meta_from_lcs_stat(reader, &header->stat);
 
   if (reader->lcs_ver == 1) {
     reader->item_size = sizeof(lcs_req_v1_t);
@@ -0,0 +1,438 @@
+//
+//  synthetic.c
+//  libCacheSim
+//
+//  generate requests on the fly from a workload spec instead of reading a
+//  trace file, the trace_path of the reader is the spec
+//
+//  the spec consists of sections separated by ';', a section is either the
+//  global parameters or a workload component
+//    global parameters:   n_req=<int>,seed=<int>,req_rate=<int>
+//    workload component:  <type>:<key>=<value>,<key>=<value>... or <type>
+//  component types
+//    zipf      requests follow Zipf(alpha) over n_obj objects
+//    uniform   requests are uniformly distributed over n_obj objects
+//    loop      requests loop over n_obj objects sequentially
+//    scan      each request accesses a new object
+//  component parameters
+//    alpha     the Zipf skewness (zipf only)
+//    n_obj     the number of objects (zipf, uniform and loop)
+//    weight    the share of requests of the component, default 1
+//    size      the object size, default 4096
+//    size_min, size_max, size_dist=uniform|loguniform
+//              draw the size of each object from a distribution
+//  for example,
+//    zipf:alpha=1.0,n_obj=1000000,weight=0.9;scan:weight=0.1;n_req=1e8
+//
+//  each component is a tenant with its own object id space, the components
+//  are interleaved with a shuffled weighted round-robin, so the k-th request
+//  of a component is known for each request and scan and loop are sequential
+//  per component.
+//  a request is a function of (seed, position), so the reader can be reset,
+//  cloned, skipped and read backward like a binary trace, where each request
+//  takes one byte of a virtual file of n_req bytes
+//
+
+#include <math.h>
+
+#include "../../include/libCacheSim/macro.h"
+#include "../../utils/include/mymath.h"
+#include "../readerInternal.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define SYNTHETIC_MAX_N_COMPONENT 16
+/* the number of slots in one round of the weighted round-robin */
+#define SYNTHETIC_N_SLOT 1024
+#define SYNTHETIC_DEFAULT_N_REQ 10000000
+#define SYNTHETIC_DEFAULT_REQ_RATE 1000
+#define SYNTHETIC_DEFAULT_OBJ_SIZE 4096
+/* the object id of a component starts at (component_idx + 1) << 40 */
+#define SYNTHETIC_OBJ_ID_SHIFT 40
+
+typedef enum {
+  SYNTHETIC_ZIPF,
+  SYNTHETIC_UNIFORM,
+  SYNTHETIC_LOOP,
+  SYNTHETIC_SCAN,
+} synthetic_component_type_e;
+
+typedef struct {
+  synthetic_component_type_e type;
+  double weight;
+  int64_t n_obj;
+  double alpha;
+
+  int64_t size;
+  int64_t size_min;
+  int64_t size_max;
+  bool size_log_uniform;
+
+  /* the rejection-inversion Zipf sampler, see _zipf_sample */
+  double h_integral_x1;
+  double h_integral_n;
+  double s;
+
+  /* the number of slots in one round */
+  int32_t n_slot;
+} synthetic_component_t;
+
+typedef struct {
+  uint8_t component_idx;
+  /* the rank of the slot among the slots of the component in one round */
+  uint16_t rank;
+} synthetic_slot_t;
+
+typedef struct {
+  uint64_t seed;
+  int64_t req_rate;
+
+  int32_t n_component;
+  synthetic_component_t components[SYNTHETIC_MAX_N_COMPONENT];
+
+  int32_t n_slot;
+  synthetic_slot_t slots[SYNTHETIC_N_SLOT + SYNTHETIC_MAX_N_COMPONENT];
+} synthetic_params_t;
+
+// ***********************************************************************
+// ****                                                               ****
+// ****                       random number helpers                   ****
+// ****                                                               ****
+// ***********************************************************************
+
+/* the j-th random number of the k-th request of component c, this is a
+ * counter-based generator so that any request can be generated directly */
+static inline uint64_t _rand_u64(uint64_t seed, int c, uint64_t k, uint64_t j) {
+  return mix64(mix64(seed + 0x9e3779b97f4a7c15ULL * (uint64_t)(c + 1)) ^ (k * 0x9e3779b97f4a7c15ULL + j));
+}
+
+/* a double in [0, 1) */
+static inline double _rand_double(uint64_t seed, int c, uint64_t k, uint64_t j) {
+  return (double)(_rand_u64(seed, c, k, j) >> 11) * 0x1.0p-53;
+}
+
+// ***********************************************************************
+// ****                                                               ****
+// ****                   rejection-inversion Zipf sampler            ****
+// ****                                                               ****
+// ***********************************************************************
+/* W. Hormann and G. Derflinger, "Rejection-inversion to generate variates
+ * from monotone discrete distributions", it uses O(1) memory and accepts
+ * a sample in about one iteration for all alpha > 0 */
+
+static inline double _zipf_helper1(double x) {
+  return fabs(x) > 1e-8 ? log1p(x) / x : 1 - x * (0.5 - x * (1.0 / 3.0 - 0.25 * x));
+}
+
+static inline double _zipf_helper2(double x) {
+  return fabs(x) > 1e-8 ? expm1(x) / x : 1 + x * 0.5 * (1 + x * 1.0 / 3.0 * (1 + 0.25 * x));
+}
+
+static inline double _zipf_h(double alpha, double x) { return exp(-alpha * log(x)); }
+
+static inline double _zipf_h_integral(double alpha, double x) {
+  double log_x = log(x);
+  return _zipf_helper2((1 - alpha) * log_x) * log_x;
+}
+
+static inline double _zipf_h_integral_inverse(double alpha, double x) {
+  double t = x * (1 - alpha);
+  if (t < -1) t = -1;
+  return exp(_zipf_helper1(t) * x);
+}
+
+static void _zipf_init(synthetic_component_t *comp) {
+  double alpha = comp->alpha;
+  comp->h_integral_x1 = _zipf_h_integral(alpha, 1.5) - 1;
+  comp->h_integral_n = _zipf_h_integral(alpha, (double)comp->n_obj + 0.5);
+  comp->s = 2 - _zipf_h_integral_inverse(alpha, _zipf_h_integral(alpha, 2.5) - _zipf_h(alpha, 2));
+}
+
+/* return the rank in [1, n_obj] */
+static inline int64_t _zipf_sample(const synthetic_component_t *comp, uint64_t seed, int c, uint64_t k) {
+  double alpha = comp->alpha;
+  for (uint64_t j = 0;; j++) {
+    double u = comp->h_integral_n + _rand_double(seed, c, k, j) * (comp->h_integral_x1 - comp->h_integral_n);
+    double x = _zipf_h_integral_inverse(alpha, u);
+    int64_t rank = (int64_t)(x + 0.5);
+    if (rank < 1) {
+      rank = 1;
+    } else if (rank > comp->n_obj) {
+      rank = comp->n_obj;
+    }
+
+    if ((double)rank - x <= comp->s || u >= _zipf_h_integral(alpha, (double)rank + 0.5) - _zipf_h(alpha, (double)rank)) {
+      return rank;
+    }
+  }
+}
+
+// ***********************************************************************
+// ****                                                               ****
+// ****                           spec parsing                        ****
+// ****                                                               ****
+// ***********************************************************************
+
+static int64_t _parse_int(const char *key, const char *value) {
+  char *end;
+  /* allow 1e9 */
+  double v = strtod(value, &end);
+  if (end == value || *end != '\0' || v < 0 || v != floor(v)) {
+    ERROR("synthetic trace: invalid value %s for %s\n", value, key);
+  }
+  return (int64_t)v;
+}
+
+static double _parse_double(const char *key, const char *value) {
+  char *end;
+  double v = strtod(value, &end);
+  if (end == value || *end != '\0' || v < 0) {
+    ERROR("synthetic trace: invalid value %s for %s\n", value, key);
+  }
+  return v;
+}
+
+static void _parse_global_params(synthetic_params_t *params, int64_t *n_req, char *section) {
+  char *kv;
+  while ((kv = strsep(&section, ",")) != NULL) {
+    if (kv[0] == '\0') continue;
+    char *key = strsep(&kv, "=");
+    if (kv == NULL) {
+      ERROR("synthetic trace: missing value for %s\n", key);
+    }
+
+    if (strcasecmp(key, "n_req") == 0) {
+      *n_req = _parse_int(key, kv);
+    } else if (strcasecmp(key, "seed") == 0) {
+      params->seed = (uint64_t)_parse_int(key, kv);
+    } else if (strcasecmp(key, "req_rate") == 0) {
+      params->req_rate = _parse_int(key, kv);
+    } else {
+      ERROR("synthetic trace: unknown parameter %s, supported: n_req, seed, req_rate\n", key);
+    }
+  }
+}
+
+static void _parse_component(synthetic_params_t *params, char *type, char *section) {
+  if (params->n_component == SYNTHETIC_MAX_N_COMPONENT) {
+    ERROR("synthetic trace: at most %d components are supported\n", SYNTHETIC_MAX_N_COMPONENT);
+  }
+
+  synthetic_component_t *comp = &params->components[params->n_component++];
+  memset(comp, 0, sizeof(synthetic_component_t));
+  comp->weight = 1;
+  comp->size = SYNTHETIC_DEFAULT_OBJ_SIZE;
+
+  if (strcasecmp(type, "zipf") == 0) {
+    comp->type = SYNTHETIC_ZIPF;
+    comp->alpha = 1.0;
+  } else if (strcasecmp(type, "uniform") == 0) {
+    comp->type = SYNTHETIC_UNIFORM;
+  } else if (strcasecmp(type, "loop") == 0) {
+    comp->type = SYNTHETIC_LOOP;
+  } else if (strcasecmp(type, "scan") == 0) {
+    comp->type = SYNTHETIC_SCAN;
+  } else {
+    ERROR("synthetic trace: unknown component %s, supported: zipf, uniform, loop, scan\n", type);
+  }
+
+  char *kv;
+  while ((kv = strsep(&section, ",")) != NULL) {
+    if (kv[0] == '\0') continue;
+    char *key = strsep(&kv, "=");
+    if (kv == NULL) {
+      ERROR("synthetic trace: missing value for %s\n", key);
+    }
+
+    if (strcasecmp(key, "alpha") == 0 && comp->type == SYNTHETIC_ZIPF) {
+      comp->alpha = _parse_double(key, kv);
+    } else if (strcasecmp(key, "n_obj") == 0 && comp->type != SYNTHETIC_SCAN) {
+      comp->n_obj = _parse_int(key, kv);
+    } else if (strcasecmp(key, "weight") == 0) {
+      comp->weight = _parse_double(key, kv);
+    } else if (strcasecmp(key, "size") == 0) {
+      comp->size = _parse_int(key, kv);
+    } else if (strcasecmp(key, "size_min") == 0) {
+      comp->size_min = _parse_int(key, kv);
+    } else if (strcasecmp(key, "size_max") == 0) {
+      comp->size_max = _parse_int(key, kv);
+    } else if (strcasecmp(key, "size_dist") == 0) {
+      if (strcasecmp(kv, "loguniform") == 0) {
+        comp->size_log_uniform = true;
+      } else if (strcasecmp(kv, "uniform") != 0) {
+        ERROR("synthetic trace: unknown size_dist %s, supported: uniform, loguniform\n", kv);
+      }
+    } else {
+      ERROR("synthetic trace: unknown parameter %s for component %s\n", key, type);
+    }
+  }
+
+  if (comp->type != SYNTHETIC_SCAN && comp->n_obj <= 0) {
+    ERROR("synthetic trace: component %s requires n_obj\n", type);
+  }
+  if (comp->n_obj >= (1LL << SYNTHETIC_OBJ_ID_SHIFT)) {
+    ERROR("synthetic trace: n_obj %ld is too large\n", (long)comp->n_obj);
+  }
+  if (comp->size_max > 0 && (comp->size_min <= 0 || comp->size_min > comp->size_max)) {
+    ERROR("synthetic trace: size_min and size_max should satisfy 0 < size_min <= size_max\n");
+  }
+  if (comp->size <= 0) {
+    ERROR("synthetic trace: object size should be positive\n");
+  }
+  if (comp->weight <= 0) {
+    ERROR("synthetic trace: component weight should be positive\n");
+  }
+
+  /* Zipf with alpha 0 is uniform */
+  if (comp->type == SYNTHETIC_ZIPF && comp->alpha == 0) {
+    comp->type = SYNTHETIC_UNIFORM;
+  }
+  if (comp->type == SYNTHETIC_ZIPF) {
+    _zipf_init(comp);
+  }
+}
+
+/* assign the slots of one round to the components by weight, and shuffle
+ * the slots so that the components are interleaved */
+static void _setup_slots(synthetic_params_t *params) {
+  double sum_weight = 0;
+  for (int i = 0; i < params->n_component; i++) {
+    sum_weight += params->components[i].weight;
+  }
+
+  params->n_slot = 0;
+  for (int i = 0; i < params->n_component; i++) {
+    synthetic_component_t *comp = &params->components[i];
+    comp->n_slot = MAX((int32_t)llround(comp->weight / sum_weight * SYNTHETIC_N_SLOT), 1);
+    for (int j = 0; j < comp->n_slot; j++) {
+      params->slots[params->n_slot++].component_idx = (uint8_t)i;
+    }
+  }
+
+  for (int i = params->n_slot - 1; i > 0; i--) {
+    int j = (int)(_rand_u64(params->seed, -1, (uint64_t)i, 0) % (uint64_t)(i + 1));
+    uint8_t tmp = params->slots[i].component_idx;
+    params->slots[i].component_idx = params->slots[j].component_idx;
+    params->slots[j].component_idx = tmp;
+  }
+
+  int32_t rank[SYNTHETIC_MAX_N_COMPONENT] = {0};
+  for (int i = 0; i < params->n_slot; i++) {
+    params->slots[i].rank = (uint16_t)rank[params->slots[i].component_idx]++;
+  }
+}
+
+// ***********************************************************************
+// ****                                                               ****
+// ****                        reader functions                       ****
+// ****                                                               ****
+// ***********************************************************************
+
+int syntheticReader_setup(reader_t *const reader) {
+  synthetic_params_t *params = (synthetic_params_t *)malloc(sizeof(synthetic_params_t));
+  memset(params, 0, sizeof(synthetic_params_t));
+  params->req_rate = SYNTHETIC_DEFAULT_REQ_RATE;
+  int64_t n_req = SYNTHETIC_DEFAULT_N_REQ;
+
+  char *spec = strdup(reader->trace_path);
+  char *spec_to_free = spec;
+  char *section;
+  while ((section = strsep(&spec, ";")) != NULL) {
+    while (*section == ' ') section++;
+    if (section[0] == '\0') continue;
+
+    char *colon = strchr(section, ':');
+    if (colon == NULL && strchr(section, '=') == NULL) {
+      /* a component without parameters, e.g., scan */
+      _parse_component(params, section, NULL);
+    } else if (colon == NULL) {
+      _parse_global_params(params, &n_req, section);
+    } else {
+      *colon = '\0';
+      _parse_component(params, section, colon + 1);
+    }
+  }
+  free(spec_to_free);
+
+  if (params->n_component == 0) {
+    ERROR("synthetic trace %s does not have any workload component, e.g., zipf:alpha=1.0,n_obj=1000000\n",
+          reader->trace_path);
+  }
+  if (n_req <= 0 || params->req_rate <= 0) {
+    ERROR("synthetic trace: n_req and req_rate should be positive\n");
+  }
+  _setup_slots(params);
+
+  reader->reader_params = params;
+  reader->trace_format = BINARY_TRACE_FORMAT;
+  reader->obj_id_is_num = true;
+  /* each request takes one byte of a virtual file, so that the position of
+   * the reader works the same as a binary trace */
+  reader->item_size = 1;
+  reader->file_size = (size_t)n_req;
+  reader->trace_start_offset = 0;
+  reader->mmap_offset = 0;
+
+  return 0;
+}
+
+static inline int64_t _obj_size(const synthetic_component_t *comp, uint64_t seed, int c, obj_id_t obj_id) {
+  if (comp->size_max <= 0) {
+    return comp->size;
+  }
+
+  /* the size is a function of the object */
+  double u = _rand_double(seed, c, obj_id, UINT64_MAX);
+  if (comp->size_log_uniform) {
+    double log_min = log((double)comp->size_min), log_max = log((double)comp->size_max + 1);
+    return MIN((int64_t)exp(log_min + u * (log_max - log_min)), comp->size_max);
+  }
+  return comp->size_min + (int64_t)(u * (double)(comp->size_max - comp->size_min + 1));
+}
+
+int synthetic_read_one_req(reader_t *const reader, request_t *const req) {
+  const synthetic_params_t *params = (const synthetic_params_t *)reader->reader_params;
+  uint64_t pos = (uint64_t)reader->mmap_offset;
+  reader->mmap_offset += 1;
+
+  const synthetic_slot_t *slot = &params->slots[pos % (uint64_t)params->n_slot];
+  int c = slot->component_idx;
+  const synthetic_component_t *comp = &params->components[c];
+  /* the request is the k-th request of the component */
+  uint64_t k = pos / (uint64_t)params->n_slot * (uint64_t)comp->n_slot + slot->rank;
+
+  uint64_t id_in_component;
+  switch (comp->type) {
+    case SYNTHETIC_ZIPF:
+      id_in_component = (uint64_t)_zipf_sample(comp, params->seed, c, k) - 1;
+      break;
+    case SYNTHETIC_UNIFORM:
+      id_in_component = _rand_u64(params->seed, c, k, 0) % (uint64_t)comp->n_obj;
+      break;
+    case SYNTHETIC_LOOP:
+      id_in_component = k % (uint64_t)comp->n_obj;
+      break;
+    case SYNTHETIC_SCAN:
+      id_in_component = k & ((1ULL << SYNTHETIC_OBJ_ID_SHIFT) - 1);
+      break;
+    default:
+      ERROR("synthetic trace: unknown component type %d\n", comp->type);
+      abort();
+  }
+
+  req->obj_id = ((uint64_t)(c + 1) << SYNTHETIC_OBJ_ID_SHIFT) | id_in_component;
+  req->obj_size = _obj_size(comp, params->seed, c, req->obj_id);
+  req->clock_time = (int64_t)(pos / (uint64_t)params->req_rate);
+  req->op = OP_GET;
+  req->tenant_id = c;
+  req->next_access_vtime = -2;
+  req->valid = true;
+
+  return 0;
+}
+
+#ifdef __cplusplus
+}
+#endif
@@ -9,6 +9,7 @@
 #include <ctype.h>
 
 #include "../include/libCacheSim/macro.h"
+#include "../include/libCacheSim/traceMeta.h"
 #include "customizedReader/lcs.h"
 #include "customizedReader/oracle/oracleGeneralBin.h"
 #include "customizedReader/oracle/oracleTwrBin.h"
@@ -55,7 +56,7 @@ reader_t *setup_reader(const char *const trace_path, const trace_type_e trace_ty
   reader->zstd_reader_p = NULL;
 #ifdef SUPPORT_ZSTD_TRACE
   size_t slen = strlen(trace_path);
-  if (strncmp(trace_path + (slen - 4), ".zst", 4) == 0) {
+  if (trace_type != SYNTHETIC_TRACE && slen > 4 && strncmp(trace_path + (slen - 4), ".zst", 4) == 0) {
     reader->is_zstd_file = true;
     reader->zstd_reader_p = create_zstd_reader(trace_path);
     if (!_info_printed) {
@@ -102,6 +103,13 @@ reader_t *setup_reader(const char *const trace_path, const trace_type_e trace_ty
   assert(trace_path != NULL);
   reader->trace_path = strdup(trace_path);
 
+  if (trace_type == SYNTHETIC_TRACE) {
+    /* the trace_path is the workload spec, there is no file to open */
+    syntheticReader_setup(reader);
+    reader->n_total_req = (reader->file_size - reader->trace_start_offset) / reader->item_size;
+    return reader;
+  }
+
   if ((fd = open(trace_path, O_RDONLY)) < 0) {
     ERROR("Unable to open '%s', %s\n", trace_path, strerror(errno));
     exit(1);
@@ -290,6 +298,9 @@ int read_one_req(reader_t *const reader, request_t *const req) {
       case VALPIN_TRACE:
         status = valpin_read_one_req(reader, req);
         break;
+      case SYNTHETIC_TRACE:
+        status = synthetic_read_one_req(reader, req);
+        break;
       default:
         ERROR(
             "cannot recognize reader obj_id_type, given reader obj_id_type: "
@@ -503,19 +514,24 @@ void reset_reader(reader_t *const reader) {
 int64_t get_num_of_req(reader_t *const reader) {
   if (reader->n_total_req > 0) return reader->n_total_req;
 
-  int64_t n_req = 0;
+  /* use the trace metadata if it is already available */
+  const trace_meta_t *meta = find_trace_meta(reader);
+  if (meta != NULL) {
+    reader->n_total_req = meta->n_req;
+    return reader->n_total_req;
+  }
 
-  if (reader->trace_format == TXT_TRACE_FORMAT || reader->is_zstd_file) {
-    reader_t *reader_copy = clone_reader(reader);
-    reader_copy->mmap_offset = 0;
-    request_t *req = new_request();
-    while (read_one_req(reader_copy, req) == 0) {
-      n_req++;
-    }
-  } else {
-    ERROR("should not reach here\n");
-    abort();
+  /* only count the requests, the object statistics in the trace metadata
+   * need a table of all objects */
+  int64_t n_req = 0;
+  reader_t *reader_copy = clone_reader(reader);
+  request_t *req = new_request();
+  while (read_one_req(reader_copy, req) == 0) {
+    n_req++;
   }
+  free_request(req);
+  close_reader(reader_copy);
+
   reader->n_total_req = n_req;
   return n_req;
 }
@@ -523,8 +539,12 @@ int64_t get_num_of_req(reader_t *const reader) {
 reader_t *clone_reader(const reader_t *const reader_in) {
   reader_t *reader = setup_reader(reader_in->trace_path, reader_in->trace_type, &reader_in->init_params);
   reader->n_total_req = reader_in->n_total_req;
+  if (reader->trace_meta == NULL && reader_in->trace_meta != NULL) {
+    reader->trace_meta = malloc(sizeof(trace_meta_t));
+    memcpy(reader->trace_meta, reader_in->trace_meta, sizeof(trace_meta_t));
+  }
 
-  if (reader->trace_format != TXT_TRACE_FORMAT) {
+  if (reader->trace_format != TXT_TRACE_FORMAT && reader->mapped_file != NULL) {
     munmap(reader->mapped_file, reader->file_size);
     reader->mapped_file = reader_in->mapped_file;
   }
@@ -579,6 +599,10 @@ int close_reader(reader_t *const reader) {
     free(reader->sampler);
   }
 
+  if (reader->trace_meta != NULL) {
+    free(reader->trace_meta);
+  }
+
   free(reader->trace_path);
   free(reader);
 
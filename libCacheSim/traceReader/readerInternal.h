@@ -15,6 +15,11 @@ extern "C" {
 /**************** common ****************/
 bool is_str_num(const char *str, size_t len);
 
+/**************** trace metadata ****************/
+struct lcs_trace_stat;
+/* set the metadata of the reader using the stat in the lcs trace header */
+void trace_meta_from_lcs_stat(reader_t *reader, const struct lcs_trace_stat *stat);
+
 /**************** csv ****************/
 typedef struct {
   struct csv_parser *csv_parser;
@@ -59,6 +64,11 @@ bool check_delimiter(const reader_t *reader, char delimiter);
 /**************** txt ****************/
 int txt_read_one_req(reader_t *const reader, request_t *const req);
 
+/**************** synthetic ****************/
+int syntheticReader_setup(reader_t *const reader);
+
+int synthetic_read_one_req(reader_t *const reader, request_t *const req);
+
 /**************** binary ****************/
 static inline int format_to_size(char format) {
   switch (format) {
@@ -0,0 +1,372 @@
+//
+//  traceMeta.c
+//  libCacheSim
+//
+//  compute, load and save the metadata of a trace
+//
+
+#include "../include/libCacheSim/traceMeta.h"
+
+#include <pthread.h>
+
+#include "customizedReader/lcs.h"
+#include "readerInternal.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+static const char TRACE_META_MAGIC[8] = {'L', 'C', 'S', 'M', 'E', 'T', 'A', '1'};
+
+/* the header of the sidecar file, it records the trace file and the reader
+ * parameters that the metadata is computed with */
+typedef struct {
+  char magic[8];
+  int64_t version;
+  int64_t trace_file_size;
+  int64_t trace_mtime;
+  uint64_t param_fingerprint;
+} trace_meta_file_header_t;
+
+/* whether the reader reads the full trace, the metadata of a sampled or
+ * capped trace is not persisted */
+static bool _reader_reads_full_trace(const reader_t *reader) {
+  return reader->sampler == NULL && reader->init_params.sampler == NULL && reader->cap_at_n_req <= 0;
+}
+
+static inline uint64_t _fnv1a(uint64_t hv, const void *data, size_t len) {
+  const unsigned char *p = (const unsigned char *)data;
+  for (size_t i = 0; i < len; i++) {
+    hv ^= p[i];
+    hv *= 0x100000001b3ULL;
+  }
+  return hv;
+}
+
+#define FINGERPRINT_FIELD(hv, field) hv = _fnv1a(hv, &(field), sizeof(field))
+
+/* the reader parameters that change the requests read from the trace */
+static uint64_t _reader_param_fingerprint(const reader_t *reader) {
+  const reader_init_param_t *p = &reader->init_params;
+  uint64_t hv = 0xcbf29ce484222325ULL;
+
+  FINGERPRINT_FIELD(hv, reader->trace_type);
+  FINGERPRINT_FIELD(hv, p->ignore_obj_size);
+  FINGERPRINT_FIELD(hv, p->ignore_size_zero_req);
+  FINGERPRINT_FIELD(hv, p->obj_id_is_num);
+  FINGERPRINT_FIELD(hv, p->obj_id_is_num_set);
+  FINGERPRINT_FIELD(hv, p->time_field);
+  FINGERPRINT_FIELD(hv, p->obj_id_field);
+  FINGERPRINT_FIELD(hv, p->obj_size_field);
+  FINGERPRINT_FIELD(hv, p->op_field);
+  FINGERPRINT_FIELD(hv, p->cnt_field);
+  FINGERPRINT_FIELD(hv, p->block_size);
+  FINGERPRINT_FIELD(hv, p->has_header);
+  FINGERPRINT_FIELD(hv, p->has_header_set);
+  FINGERPRINT_FIELD(hv, p->delimiter);
+  FINGERPRINT_FIELD(hv, p->trace_start_offset);
+  if (p->binary_fmt_str != NULL) {
+    hv = _fnv1a(hv, p->binary_fmt_str, strlen(p->binary_fmt_str));
+  }
+
+  return hv;
+}
+
+#undef FINGERPRINT_FIELD
+
+static char *_sidecar_path(const reader_t *reader) {
+  size_t len = strlen(reader->trace_path) + 6;
+  char *path = malloc(len);
+  snprintf(path, len, "%s.meta", reader->trace_path);
+  return path;
+}
+
+static bool _fill_file_header(const reader_t *reader, trace_meta_file_header_t *header) {
+  struct stat st;
+  if (stat(reader->trace_path, &st) != 0) {
+    return false;
+  }
+
+  memset(header, 0, sizeof(trace_meta_file_header_t));
+  memcpy(header->magic, TRACE_META_MAGIC, sizeof(TRACE_META_MAGIC));
+  header->version = TRACE_META_VERSION;
+  header->trace_file_size = (int64_t)st.st_size;
+  header->trace_mtime = (int64_t)st.st_mtime;
+  header->param_fingerprint = _reader_param_fingerprint(reader);
+
+  return true;
+}
+
+void compute_trace_meta(reader_t *const reader, trace_meta_t *const meta) {
+  memset(meta, 0, sizeof(trace_meta_t));
+  meta->smallest_obj_size = INT64_MAX;
+  meta->has_obj_size_hist = true;
+
+  // sample the object space in case there are too many objects
+  // which can cause a crash
+  meta->obj_sample_scale = 1;
+  if (reader->file_size > 5 * GiB) {
+    meta->obj_sample_scale = 101;
+  } else if (reader->file_size > 1 * GiB) {
+    meta->obj_sample_scale = 11;
+  }
+
+  reader_t *reader_copy = clone_reader(reader);
+  request_t *req = new_request();
+  GHashTable *obj_table = g_hash_table_new(g_direct_hash, g_direct_equal);
+
+  INFO("calculating trace metadata of %s...\n", reader->trace_path);
+  while (read_one_req(reader_copy, req) == 0) {
+    if (meta->n_req == 0) {
+      meta->start_time = req->clock_time;
+    }
+    meta->end_time = req->clock_time;
+    meta->n_req += 1;
+    meta->n_req_byte += req->obj_size;
+    if (meta->n_req % 2000000 == 0) {
+      DEBUG("processed %ld requests, %lld objects, %lld bytes\n", (long)meta->n_req, (long long)meta->n_obj,
+            (long long)meta->n_obj_byte);
+    }
+
+    if (meta->obj_sample_scale > 1 && req->obj_id % meta->obj_sample_scale != 0) {
+      continue;
+    }
+
+    if (g_hash_table_contains(obj_table, (gconstpointer)req->obj_id)) {
+      continue;
+    }
+    g_hash_table_add(obj_table, (gpointer)req->obj_id);
+
+    meta->n_obj += 1;
+    meta->n_obj_byte += req->obj_size;
+    meta->obj_size_hist[trace_meta_size_bucket(req->obj_size)] += 1;
+    if ((int64_t)req->obj_size < meta->smallest_obj_size) meta->smallest_obj_size = req->obj_size;
+    if ((int64_t)req->obj_size > meta->largest_obj_size) meta->largest_obj_size = req->obj_size;
+  }
+
+  if (meta->n_obj == 0) {
+    meta->smallest_obj_size = 0;
+  }
+
+  meta->n_obj *= meta->obj_sample_scale;
+  meta->n_obj_byte *= meta->obj_sample_scale;
+  for (int i = 0; i < TRACE_META_N_SIZE_BUCKET; i++) {
+    meta->obj_size_hist[i] *= meta->obj_sample_scale;
+  }
+
+  g_hash_table_destroy(obj_table);
+  free_request(req);
+  close_reader(reader_copy);
+}
+
+/* the metadata computed in this process, so that the readers that do not
+ * save the sidecar (or cannot write it) scan the trace at most once */
+typedef struct trace_meta_mem_entry {
+  char *trace_path;
+  trace_meta_file_header_t header;
+  trace_meta_t meta;
+  struct trace_meta_mem_entry *next;
+} trace_meta_mem_entry_t;
+
+static trace_meta_mem_entry_t *trace_meta_mem_cache = NULL;
+static pthread_mutex_t trace_meta_mem_cache_lock = PTHREAD_MUTEX_INITIALIZER;
+
+static bool _load_trace_meta_from_mem(const reader_t *reader, trace_meta_t *meta) {
+  trace_meta_file_header_t expected;
+  if (!_reader_reads_full_trace(reader) || !_fill_file_header(reader, &expected)) {
+    return false;
+  }
+
+  bool found = false;
+  pthread_mutex_lock(&trace_meta_mem_cache_lock);
+  for (trace_meta_mem_entry_t *e = trace_meta_mem_cache; e != NULL; e = e->next) {
+    if (strcmp(e->trace_path, reader->trace_path) == 0 && memcmp(&e->header, &expected, sizeof(expected)) == 0) {
+      memcpy(meta, &e->meta, sizeof(trace_meta_t));
+      found = true;
+      break;
+    }
+  }
+  pthread_mutex_unlock(&trace_meta_mem_cache_lock);
+
+  return found;
+}
+
+static void _save_trace_meta_to_mem(const reader_t *reader, const trace_meta_t *meta) {
+  trace_meta_file_header_t header;
+  if (!_reader_reads_full_trace(reader) || !_fill_file_header(reader, &header)) {
+    return;
+  }
+
+  trace_meta_mem_entry_t *entry = malloc(sizeof(trace_meta_mem_entry_t));
+  entry->trace_path = strdup(reader->trace_path);
+  entry->header = header;
+  memcpy(&entry->meta, meta, sizeof(trace_meta_t));
+
+  pthread_mutex_lock(&trace_meta_mem_cache_lock);
+  entry->next = trace_meta_mem_cache;
+  trace_meta_mem_cache = entry;
+  pthread_mutex_unlock(&trace_meta_mem_cache_lock);
+}
+
+bool load_trace_meta(const reader_t *const reader, trace_meta_t *const meta) {
+  if (!_reader_reads_full_trace(reader)) {
+    return false;
+  }
+
+  trace_meta_file_header_t expected, header;
+  if (!_fill_file_header(reader, &expected)) {
+    return false;
+  }
+
+  char *path = _sidecar_path(reader);
+  FILE *f = fopen(path, "rb");
+  if (f == NULL) {
+    free(path);
+    return false;
+  }
+
+  bool valid = fread(&header, sizeof(header), 1, f) == 1 && memcmp(&header, &expected, sizeof(header)) == 0 &&
+               fread(meta, sizeof(trace_meta_t), 1, f) == 1;
+  fclose(f);
+
+  if (!valid) {
+    INFO("ignore outdated trace metadata %s\n", path);
+  } else {
+    DEBUG("load trace metadata from %s\n", path);
+  }
+  free(path);
+
+  return valid;
+}
+
+bool save_trace_meta(const reader_t *const reader, const trace_meta_t *const meta) {
+  if (!_reader_reads_full_trace(reader)) {
+    return false;
+  }
+
+  trace_meta_file_header_t header;
+  if (!_fill_file_header(reader, &header)) {
+    return false;
+  }
+
+  char *path = _sidecar_path(reader);
+  FILE *f = fopen(path, "wb");
+  if (f == NULL) {
+    /* the trace may be in a read-only directory, which is not an error */
+    DEBUG("cannot write trace metadata %s: %s\n", path, strerror(errno));
+    free(path);
+    return false;
+  }
+
+  bool success = fwrite(&header, sizeof(header), 1, f) == 1 && fwrite(meta, sizeof(trace_meta_t), 1, f) == 1;
+  success = (fclose(f) == 0) && success;
+  if (!success) {
+    WARN("fail to write trace metadata %s\n", path);
+    remove(path);
+  }
+  free(path);
+
+  return success;
+}
+
+void trace_meta_from_lcs_stat(reader_t *const reader, const lcs_trace_stat_t *const stat) {
+  /* the trace was generated before the stat is added to the header */
+  if (stat->n_req <= 0 || stat->n_obj <= 0) {
+    return;
+  }
+
+  /* the stat does not apply if the reader does not read the full trace or
+   * changes the object sizes */
+  if (!_reader_reads_full_trace(reader) || reader->ignore_obj_size || reader->block_size > 1) {
+    return;
+  }
+
+  trace_meta_t *meta = malloc(sizeof(trace_meta_t));
+  memset(meta, 0, sizeof(trace_meta_t));
+  meta->n_req = stat->n_req;
+  meta->n_obj = stat->n_obj;
+  meta->n_req_byte = stat->n_req_byte;
+  meta->n_obj_byte = stat->n_obj_byte;
+  meta->start_time = stat->start_timestamp;
+  meta->end_time = stat->end_timestamp;
+  meta->smallest_obj_size = stat->smallest_obj_size;
+  meta->largest_obj_size = stat->largest_obj_size;
+  meta->has_obj_size_hist = false;
+  meta->obj_sample_scale = 1;
+
+  free(reader->trace_meta);
+  reader->trace_meta = meta;
+}
+
+const trace_meta_t *find_trace_meta(reader_t *const reader) {
+  /* the metadata of lcs traces is set from the trace header during setup */
+  if (reader->trace_meta != NULL) {
+    return reader->trace_meta;
+  }
+
+  trace_meta_t *meta = malloc(sizeof(trace_meta_t));
+  if (_load_trace_meta_from_mem(reader, meta)) {
+    /* found */
+  } else if (load_trace_meta(reader, meta)) {
+    _save_trace_meta_to_mem(reader, meta);
+  } else {
+    free(meta);
+    return NULL;
+  }
+
+  reader->trace_meta = meta;
+  if (reader->n_total_req <= 0) {
+    reader->n_total_req = meta->n_req;
+  }
+
+  return meta;
+}
+
+const trace_meta_t *get_trace_meta(reader_t *const reader) {
+  const trace_meta_t *found = find_trace_meta(reader);
+  if (found != NULL) {
+    return found;
+  }
+
+  trace_meta_t *meta = malloc(sizeof(trace_meta_t));
+  compute_trace_meta(reader, meta);
+  _save_trace_meta_to_mem(reader, meta);
+  if (reader->init_params.save_trace_meta) {
+    save_trace_meta(reader, meta);
+  }
+
+  reader->trace_meta = meta;
+  if (reader->n_total_req <= 0) {
+    reader->n_total_req = meta->n_req;
+  }
+
+  return meta;
+}
+
+void print_trace_meta(const trace_meta_t *const meta) {
+  printf("trace meta: n_req %lld, n_obj %lld, n_byte %lld (%.2lf GiB), n_uniq_byte %lld (%.2lf GiB)\n",
+         (long long)meta->n_req, (long long)meta->n_obj, (long long)meta->n_req_byte,
+         (double)meta->n_req_byte / GiB, (long long)meta->n_obj_byte, (double)meta->n_obj_byte / GiB);
+  printf("start time %lld, end time %lld, duration %lld seconds\n", (long long)meta->start_time,
+         (long long)meta->end_time, (long long)(meta->end_time - meta->start_time));
+  printf("object size: smallest %lld, largest %lld\n", (long long)meta->smallest_obj_size,
+         (long long)meta->largest_obj_size);
+
+  if (meta->has_obj_size_hist) {
+    printf("object size histogram (log2 bucket:n_obj):");
+    for (int i = 0; i < TRACE_META_N_SIZE_BUCKET; i++) {
+      if (meta->obj_size_hist[i] > 0) {
+        printf(" %d:%lld", i, (long long)meta->obj_size_hist[i]);
+      }
+    }
+    printf("\n");
+  }
+
+  if (meta->obj_sample_scale > 1) {
+    printf("object statistics are estimated with a sample ratio of %.4lf\n", 1.0 / meta->obj_sample_scale);
+  }
+}
+
+#ifdef __cplusplus
+}
+#endif
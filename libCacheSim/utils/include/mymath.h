@@ -33,6 +33,16 @@ static inline uint64_t next_rand(void) {
   return g_lehmer64_state >> 64;
 }
 
+/**
+ * the finalizer of splitmix64, a fast and well-mixed 64-bit hash of an
+ * integer, e.g., the object id
+ */
+static inline uint64_t mix64(uint64_t x) {
+  x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ULL;
+  x = (x ^ (x >> 27)) * 0x94d049bb133111ebULL;
+  return x ^ (x >> 31);
+}
+
 static inline long long next_power_of_2(long long N) {
   // if N is a power of two simply return it
   if (!(N & (N - 1))) return N;
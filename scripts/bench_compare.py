@@ -0,0 +1,91 @@
+# compare the results of two cacheBench runs, e.g., before and after a change
+#
+# usage:
+#   ./bin/cacheBench -o base.json --label $(git rev-parse --short HEAD~1)
+#   ./bin/cacheBench -o new.json --label $(git rev-parse --short HEAD)
+#   python3 bench_compare.py base.json new.json --threshold 0.1
+#
+# a case regresses if ns_per_get or md_byte_per_obj increases by more than
+# threshold, or if the miss ratio changes (the workloads are deterministic),
+# the script exits with 1 if any case regresses
+
+import json
+import sys
+from argparse import ArgumentParser
+
+
+def load_results(path):
+    with open(path) as f:
+        bench = json.load(f)
+    results = {}
+    for r in bench["results"]:
+        results[(r["workload"], r["algo"], r["cache_size_ratio"])] = r
+    return bench, results
+
+
+def compare(base_path, new_path, threshold, miss_ratio_tolerance=1e-4):
+    base_bench, base = load_results(base_path)
+    new_bench, new = load_results(new_path)
+    print(
+        f"base {base_bench.get('label', '')} ({base_path}), new {new_bench.get('label', '')} ({new_path})"
+    )
+    print(
+        "{:<32} {:<12} {:>6} {:>10} {:>10} {:>8} {:>10} {:>10} {:>8}  {}".format(
+            "workload", "algo", "size", "base ns", "new ns", "change",
+            "base md", "new md", "change", "",
+        )
+    )
+
+    n_regression = 0
+    for key in sorted(new.keys()):
+        if key not in base:
+            continue
+        b, n = base[key], new[key]
+        notes = []
+        if not n["success"]:
+            notes.append("FAILED" if b["success"] else "failed in both")
+            if b["success"]:
+                n_regression += 1
+        if not (b["success"] and n["success"]):
+            print(f"{key[0][:32]:<32} {key[1]:<12} {key[2]:>6} {'':>10} {'':>10} {'':>8} {'':>10} {'':>10} {'':>8}  {' '.join(notes)}")
+            continue
+
+        ns_change = n["ns_per_get"] / b["ns_per_get"] - 1
+        md_change = (
+            n["md_byte_per_obj"] / b["md_byte_per_obj"] - 1
+            if b["md_byte_per_obj"] > 0
+            else 0
+        )
+        if ns_change > threshold:
+            notes.append("SLOWER")
+        if md_change > threshold:
+            notes.append("MORE MEMORY")
+        if abs(n["miss_ratio"] - b["miss_ratio"]) > miss_ratio_tolerance:
+            notes.append(f"MISS RATIO {b['miss_ratio']:.4f} -> {n['miss_ratio']:.4f}")
+        if notes:
+            n_regression += 1
+
+        print(
+            "{:<32} {:<12} {:>6} {:>10.1f} {:>10.1f} {:>+7.1%} {:>10.1f} {:>10.1f} {:>+7.1%}  {}".format(
+                key[0][:32], key[1], key[2], b["ns_per_get"], n["ns_per_get"], ns_change,
+                b["md_byte_per_obj"], n["md_byte_per_obj"], md_change, " ".join(notes),
+            )
+        )
+
+    print(f"{n_regression} cases regressed")
+    return n_regression
+
+
+if __name__ == "__main__":
+    p = ArgumentParser()
+    p.add_argument("base", help="the results of the baseline")
+    p.add_argument("new", help="the results to compare")
+    p.add_argument(
+        "--threshold",
+        type=float,
+        default=0.1,
+        help="the relative increase of ns_per_get or md_byte_per_obj considered a regression",
+    )
+    args = p.parse_args()
+
+    sys.exit(1 if compare(args.base, args.new, args.threshold) > 0 else 0)
@@ -0,0 +1,128 @@
+# see [metricsSink.h](../libCacheSim/include/libCacheSim/metricsSink.h) for the definition of the file format
+# header:
+#   char magic[8] = "LCSMTRC1"
+#   int32_t version, int32_t n_column, int32_t n_cache, int32_t interval_type
+#   int64_t interval
+#   char column_names[n_column][16]
+#   for each cache: char cache_name[64], int64_t cache_size
+# followed by blocks:
+#   int32_t cache_idx, int32_t n_row
+#   int64_t column[n_row] for each of the n_column columns
+#
+# usage:
+#   python3 metrics_reader.py result/trace.metrics
+#
+# or in python:
+#   from metrics_reader import read_metrics
+#   caches = read_metrics("result/trace.metrics")
+#   for cache in caches:
+#       miss_ratio = [m / r for m, r in zip(cache["n_miss"], cache["n_req"])]
+
+
+import struct
+
+METRICS_MAGIC = b"LCSMTRC1"
+METRICS_VERSION = 1
+METRICS_COLUMN_NAME_LEN = 16
+CACHE_NAME_ARRAY_LEN = 64
+INTERVAL_TYPE_NAMES = ["sec", "req"]
+
+
+def _read_exact(f, n):
+    b = f.read(n)
+    if len(b) != n:
+        raise EOFError("the metrics file is truncated")
+    return b
+
+
+def read_metrics(path):
+    """read the metrics file,
+    return a list of caches, each cache is a dict with cache_name, cache_size,
+    interval_type, interval and a list for each column"""
+
+    with open(path, "rb") as f:
+        magic = _read_exact(f, 8)
+        if magic != METRICS_MAGIC:
+            raise ValueError(f"{path} is not a metrics file")
+        version, n_column, n_cache, interval_type = struct.unpack(
+            "<iiii", _read_exact(f, 16)
+        )
+        if version != METRICS_VERSION:
+            raise ValueError(f"unsupported metrics file version {version}")
+        (interval,) = struct.unpack("<q", _read_exact(f, 8))
+
+        columns = []
+        for _ in range(n_column):
+            name = _read_exact(f, METRICS_COLUMN_NAME_LEN)
+            columns.append(name.split(b"\0", 1)[0].decode())
+
+        caches = []
+        for _ in range(n_cache):
+            name = _read_exact(f, CACHE_NAME_ARRAY_LEN)
+            (cache_size,) = struct.unpack("<q", _read_exact(f, 8))
+            cache = {
+                "cache_name": name.split(b"\0", 1)[0].decode(),
+                "cache_size": cache_size,
+                "interval_type": INTERVAL_TYPE_NAMES[interval_type],
+                "interval": interval,
+            }
+            cache.update({col: [] for col in columns})
+            caches.append(cache)
+
+        while True:
+            b = f.read(8)
+            if len(b) == 0:
+                break
+            if len(b) != 8:
+                raise EOFError("the metrics file is truncated")
+            cache_idx, n_row = struct.unpack("<ii", b)
+            for col in columns:
+                caches[cache_idx][col].extend(
+                    struct.unpack(f"<{n_row}q", _read_exact(f, 8 * n_row))
+                )
+
+    return caches
+
+
+def print_metrics(path, n=-1):
+    for cache in read_metrics(path):
+        print(
+            f"{cache['cache_name']} cache size {cache['cache_size']}, "
+            f"interval {cache['interval']} {cache['interval_type']}"
+        )
+        n_row = len(cache["vtime"])
+        if n > 0:
+            n_row = min(n, n_row)
+        print(
+            "{:>12} {:>12} {:>10} {:>12} {:>10}".format(
+                "vtime", "rtime", "n_req", "miss_ratio", "n_evict"
+            )
+        )
+        for i in range(n_row):
+            n_req = cache["n_req"][i]
+            print(
+                "{:>12} {:>12} {:>10} {:>12.4f} {:>10}".format(
+                    cache["vtime"][i],
+                    cache["rtime"][i],
+                    n_req,
+                    cache["n_miss"][i] / n_req if n_req > 0 else 0,
+                    cache["n_evict"][i],
+                )
+            )
+
+
+if __name__ == "__main__":
+    from argparse import ArgumentParser
+
+    p = ArgumentParser()
+    p.add_argument("metrics", help="metrics file path")
+    p.add_argument(
+        "-n",
+        type=int,
+        help="number of intervals to print per cache",
+        required=False,
+        default=-1,
+    )
+    args = p.parse_args()
+
+    print_metrics(args.metrics, args.n)
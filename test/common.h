@@ -252,7 +252,7 @@ static cache_t *create_test_cache(const char *alg_name,
     } else if (strcasecmp(alg_name, "GLCache-LearnedTrueY") == 0) {
       init_params =
           "type=learned, "
-          "train-source-y=oracle, rank-intvl=0.05, retrain-intvl=172800";
+          "train-source-y=oracle, rank-intvl=0.05, retrain-intvl=172800, async-train=false";
     } else if (strcasecmp(alg_name, "GLCache-LearnedOnline") == 0) {
       init_params =
           "type=learned, "
@@ -269,6 +269,16 @@ static cache_t *create_test_cache(const char *alg_name,
       init_params = "objective=byte-miss-ratio";
     }
     cache = ThreeLCache_init(cc_params, init_params);
+#endif
+#if defined(ENABLE_LRB) && ENABLE_LRB == 1
+  } else if (strncasecmp(alg_name, "LRB", 3) == 0) {
+    const char *init_params = NULL;
+    if (strcasecmp(alg_name, "LRB-batch1") == 0) {
+      init_params = "objective=object-miss-ratio, eviction-batch=1";
+    } else if (strcasecmp(alg_name, "LRB-batch8") == 0) {
+      init_params = "objective=object-miss-ratio, eviction-batch=8";
+    }
+    cache = LRB_init(cc_params, init_params);
 #endif
   } else if (strcasecmp(alg_name, "LHD") == 0) {
     cache = LHD_init(cc_params, NULL);
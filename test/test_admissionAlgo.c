@@ -38,8 +38,8 @@ static void print_results(const cache_t *cache, const cache_stat_t *res) {
 }
 
 static void test_AdaptSize(gconstpointer user_data) {
-  uint64_t miss_cnt_true[] = {83204, 80907, 77835, 77086, 76173, 76158, 76158, 76158};
-  uint64_t miss_byte_true[] = {3996894720, 3916923392, 3790021120, 3751927808, 3695680512, 3695609344, 3695609344, 3695609344};
+  uint64_t miss_cnt_true[] = {83228, 80998, 77876, 77087, 76173, 76158, 76158, 76158};
+  uint64_t miss_byte_true[] = {3997681664, 3919162368, 3792145920, 3751940608, 3695680512, 3695609344, 3695609344, 3695609344};
 
   reader_t *reader = (reader_t *)user_data;
   common_cache_params_t cc_params = {.cache_size = CACHE_SIZE, .hashpower = 20, .default_ttl = DEFAULT_TTL};
@@ -101,6 +101,37 @@ static void test_BloomFilter(gconstpointer user_data) {
   my_free(sizeof(cache_stat_t), res);
 }
 
+static void test_BloomFilter_rotation(gconstpointer user_data) {
+  // the cache holds about 2000 objects, so each generation records 2000 objects
+  admissioner_t *admissioner = create_admissioner("bloomfilter", "fpr=0.001,n-gen=2");
+  request_t *req = new_request();
+  req->obj_size = 100;
+  for (obj_id_t id = 0; id < 1000; id++) {
+    req->obj_id = id;
+    admissioner->update(admissioner, req, 200000);
+    g_assert_false(admissioner->admit(admissioner, req));
+  }
+  for (obj_id_t id = 0; id < 1000; id++) {
+    req->obj_id = id;
+    g_assert_true(admissioner->admit(admissioner, req));
+  }
+
+  // the objects are forgotten after all generations are rotated
+  for (obj_id_t id = 1000; id < 10000; id++) {
+    req->obj_id = id;
+    admissioner->admit(admissioner, req);
+  }
+  int n_admit = 0;
+  for (obj_id_t id = 0; id < 1000; id++) {
+    req->obj_id = id;
+    n_admit += admissioner->admit(admissioner, req);
+  }
+  g_assert_cmpint(n_admit, <, 20);
+
+  free_request(req);
+  admissioner->free(admissioner);
+}
+
 static void empty_test(gconstpointer user_data) { ; }
 
 int main(int argc, char *argv[]) {
@@ -121,6 +152,7 @@ int main(int argc, char *argv[]) {
   g_test_add_data_func("/libCacheSim/admissionAlgo_Size", reader, test_Size);
   g_test_add_data_func("/libCacheSim/admissionAlgo_SizeProb", reader, test_SizeProb);
   g_test_add_data_func("/libCacheSim/admissionAlgo_BloomFilter", reader, test_BloomFilter);
+  g_test_add_data_func("/libCacheSim/admissionAlgo_BloomFilter_rotation", reader, test_BloomFilter_rotation);
 
   return g_test_run();
 }
@@ -4,6 +4,8 @@
 
 #include "../libCacheSim/dataStructure/hashtable/chainedHashTableV2.h"
 #include "../libCacheSim/dataStructure/hashtable/hashtable.h"
+#include "../libCacheSim/dataStructure/ringQueue.h"
+#include "../libCacheSim/dataStructure/timerWheel.h"
 #include "common.h"
 
 void test_chained_hashtable_v2(gconstpointer user_data) {
@@ -29,12 +31,187 @@ void test_chained_hashtable_v2(gconstpointer user_data) {
   // printf("random object %lu\n", obj->obj_id);
 }
 
+void test_chained_hashtable_v2_resize(gconstpointer user_data) {
+  const int n_obj = 100000;
+  hashtable_t *hashtable = create_chained_hashtable_v2(4);
+  request_t *req = new_request();
+
+  /* the hash table expands several times, and the objects are found while
+   * they are moved to the new table */
+  for (int i = 0; i < n_obj; i++) {
+    req->obj_id = i;
+    chained_hashtable_insert_v2(hashtable, req);
+    if (i % 997 == 0) {
+      check_hashtable_integrity_v2(hashtable);
+      for (int j = 0; j <= i; j += 13) {
+        g_assert_nonnull(chained_hashtable_find_obj_id_v2(hashtable, j));
+      }
+    }
+  }
+  g_assert_cmpuint(hashtable->n_obj, ==, n_obj);
+  uint16_t max_hashpower = hashtable->hashpower;
+  g_assert_cmpuint(max_hashpower, >, 4);
+
+  /* the hash table shrinks when most objects are removed */
+  for (int i = 0; i < n_obj - 100; i++) {
+    g_assert_true(chained_hashtable_delete_obj_id_v2(hashtable, i));
+    if (i % 997 == 0) {
+      check_hashtable_integrity_v2(hashtable);
+      g_assert_null(chained_hashtable_find_obj_id_v2(hashtable, i));
+      g_assert_nonnull(chained_hashtable_find_obj_id_v2(hashtable, n_obj - 1));
+    }
+  }
+  g_assert_cmpuint(hashtable->hashpower, <, max_hashpower);
+  g_assert_cmpuint(hashtable->n_obj, ==, 100);
+
+  for (int i = 0; i < 1000; i++) {
+    cache_obj_t *obj = chained_hashtable_rand_obj_v2(hashtable);
+    g_assert_cmpint(obj->obj_id, >=, n_obj - 100);
+  }
+
+  free_request(req);
+  free_chained_hashtable_v2(hashtable);
+}
+
+typedef struct {
+  int64_t curr_time;
+  int64_t *expired_at;
+} timer_wheel_test_state_t;
+
+static void timer_wheel_test_expire(obj_id_t obj_id, uint32_t exp_time, void *user_data) {
+  timer_wheel_test_state_t *state = user_data;
+  g_assert_cmpint(state->expired_at[obj_id], ==, -1);
+  state->expired_at[obj_id] = state->curr_time;
+}
+
+void test_timer_wheel(gconstpointer user_data) {
+  const int n_obj = 20000;
+  int64_t start_time = 1000;
+  uint32_t *exp_time = malloc(sizeof(uint32_t) * n_obj);
+  int64_t *expired_at = malloc(sizeof(int64_t) * n_obj);
+  timer_wheel_t *wheel = create_timer_wheel(start_time);
+
+  /* the expiration times span all levels of the wheel */
+  for (int i = 0; i < n_obj; i++) {
+    uint32_t ttl = (uint32_t)(rand() % 4 == 0 ? rand() % 200 : rand() % 20000000);
+    exp_time[i] = (uint32_t)start_time + ttl;
+    expired_at[i] = -1;
+    timer_wheel_add(wheel, i, exp_time[i]);
+  }
+
+  /* advance with irregular steps, an object expires at the first advance
+   * to a time larger than its expiration time */
+  timer_wheel_test_state_t state = {.curr_time = start_time, .expired_at = expired_at};
+  GArray *times = g_array_new(FALSE, FALSE, sizeof(int64_t));
+  while (state.curr_time <= start_time + 20000000) {
+    state.curr_time += rand() % 3 == 0 ? rand() % 100000 : rand() % 16;
+    g_array_append_val(times, state.curr_time);
+    timer_wheel_advance(wheel, state.curr_time, timer_wheel_test_expire, &state);
+  }
+
+  for (int i = 0; i < n_obj; i++) {
+    int64_t first_time = -1;
+    for (guint j = 0; j < times->len; j++) {
+      if (g_array_index(times, int64_t, j) > exp_time[i]) {
+        first_time = g_array_index(times, int64_t, j);
+        break;
+      }
+    }
+    g_assert_cmpint(expired_at[i], ==, first_time);
+  }
+  g_assert_cmpint(wheel->n_entry, ==, 0);
+
+  free_timer_wheel(wheel);
+  g_array_free(times, TRUE);
+  free(exp_time);
+  free(expired_at);
+}
+
+/* push and remove objects in random order and compare the queue with the
+ * objects in the pushed order, the queue is compacted and grown, and the
+ * removals keep the tombstones no more than the objects */
+void test_ring_queue(gconstpointer user_data) {
+  const int n_obj = 20000;
+  cache_obj_t *objs = calloc(n_obj, sizeof(cache_obj_t));
+  bool *in_queue = calloc(n_obj, sizeof(bool));
+  /* the object ids in the pushed order, the same object can be pushed again */
+  GArray *order = g_array_new(FALSE, FALSE, sizeof(int));
+  ring_queue_t *rq = create_ring_queue();
+
+  for (int round = 0; round < 200000; round++) {
+    int i = rand() % n_obj;
+    if (in_queue[i]) {
+      ring_queue_remove(rq, &objs[i]);
+      in_queue[i] = false;
+    } else {
+      objs[i].obj_id = i;
+      ring_queue_push(rq, &objs[i]);
+      in_queue[i] = true;
+      g_array_append_val(order, i);
+    }
+    /* the tombstones are no more than the objects */
+    g_assert_cmpint(rq->tail - rq->head, <=, rq->n_obj * 2);
+  }
+
+  /* the live objects from the newest to the oldest, an object that is pushed
+   * again is at its last position */
+  GArray *live = g_array_new(FALSE, FALSE, sizeof(int));
+  bool *seen = calloc(n_obj, sizeof(bool));
+  for (int j = (int)order->len - 1; j >= 0; j--) {
+    int i = g_array_index(order, int, j);
+    if (in_queue[i] && !seen[i]) {
+      g_array_append_val(live, i);
+      seen[i] = true;
+    }
+  }
+  free(seen);
+
+  g_assert_cmpint(rq->n_obj, ==, live->len);
+  g_assert_cmpint(rq->capacity, >, 1024);
+  cache_obj_t *obj = ring_queue_newest(rq);
+  for (guint j = 0; j < live->len; j++) {
+    g_assert_true(obj != NULL);
+    g_assert_cmpint(obj->obj_id, ==, g_array_index(live, int, j));
+    obj = ring_queue_older(rq, obj);
+  }
+  g_assert_true(obj == NULL);
+
+  obj = ring_queue_oldest(rq);
+  for (int j = (int)live->len - 1; j >= 0; j--) {
+    g_assert_cmpint(obj->obj_id, ==, g_array_index(live, int, j));
+    obj = ring_queue_newer(rq, obj);
+  }
+  g_assert_true(obj == NULL);
+
+  /* remove every other object, starting from the second newest, so that the
+   * oldest and the newest stay live and the tombstones are in the middle */
+  for (guint j = 1; j < live->len; j += 2) {
+    ring_queue_remove(rq, &objs[g_array_index(live, int, j)]);
+    g_assert_cmpint(rq->tail - rq->head, <=, rq->n_obj * 2);
+  }
+  for (guint j = 0; j < live->len; j += 2) {
+    ring_queue_remove(rq, &objs[g_array_index(live, int, j)]);
+  }
+  g_assert_cmpint(rq->n_obj, ==, 0);
+  g_assert_true(ring_queue_oldest(rq) == NULL);
+  g_assert_cmpint(rq->head, ==, rq->tail);
+
+  free_ring_queue(rq);
+  g_array_free(order, TRUE);
+  g_array_free(live, TRUE);
+  free(in_queue);
+  free(objs);
+}
+
 int main(int argc, char *argv[]) {
   g_test_init(&argc, &argv, NULL);
   reader_t *reader;
 
   reader = setup_plaintxt_reader_num();
   g_test_add_data_func("/libCacheSim/test_chained_hashtable_v2", NULL, test_chained_hashtable_v2);
+  g_test_add_data_func("/libCacheSim/test_chained_hashtable_v2_resize", NULL, test_chained_hashtable_v2_resize);
+  g_test_add_data_func("/libCacheSim/test_timer_wheel", NULL, test_timer_wheel);
+  g_test_add_data_func("/libCacheSim/test_ring_queue", NULL, test_ring_queue);
 
   return g_test_run();
 }
@@ -2,6 +2,8 @@
 // Created by Juncheng Yang on 11/21/19.
 //
 
+#include <pthread.h>
+
 #include "../libCacheSim/utils/include/mymath.h"
 #include "common.h"
 
@@ -153,9 +155,9 @@ static void test_BeladySize(gconstpointer user_data) {
 }
 
 static void test_Random(gconstpointer user_data) {
-  uint64_t miss_cnt_true[] = {92457, 88582, 84459, 80277, 76132, 72134, 68230, 64225};
-  uint64_t miss_byte_true[] = {4170166272, 3975292416, 3757524992, 3539850752,
-                               3321110016, 3113551360, 2917275648, 2725705216};
+  uint64_t miss_cnt_true[] = {92457, 88579, 84449, 80255, 76110, 72145, 68199, 64226};
+  uint64_t miss_byte_true[] = {4170166272, 3975338496, 3756662272, 3539553280,
+                               3319941632, 3115123712, 2916532224, 2725969408};
 
   reader_t *reader = (reader_t *)user_data;
   common_cache_params_t cc_params = {.cache_size = CACHE_SIZE, .hashpower = 12, .default_ttl = DEFAULT_TTL};
@@ -238,9 +240,9 @@ static void test_LHD(gconstpointer user_data) {
 }
 
 static void test_Hyperbolic(gconstpointer user_data) {
-  uint64_t miss_cnt_true[] = {92924, 89470, 83452, 81234, 74544, 71234, 69356, 65338};
-  uint64_t miss_byte_true[] = {4213586432, 4064826368, 3766646272, 3644941824,
-                               3245021184, 3035783168, 2939981312, 2754100224};
+  uint64_t miss_cnt_true[] = {92920, 89463, 83449, 81217, 74548, 71228, 69392, 65311};
+  uint64_t miss_byte_true[] = {4213437952, 4065067008, 3766368768, 3643624960,
+                               3245030400, 3035704320, 2941154816, 2752437760};
 
   reader_t *reader = (reader_t *)user_data;
   common_cache_params_t cc_params = {.cache_size = CACHE_SIZE, .hashpower = 18, .default_ttl = DEFAULT_TTL};
@@ -495,6 +497,273 @@ static void test_LIRS(gconstpointer user_data) {
   my_free(sizeof(cache_stat_t), res);
 }
 
+/* warm up a cache with the first half of the trace, save it to a checkpoint
+ * and load into a new cache, the two caches should have the same hits on the
+ * second half of the trace */
+static void test_checkpoint(gconstpointer user_data) {
+  const char *algos[] = {"FIFO", "LRU", "Clock", "Sieve", "S3-FIFO", "SLRU", "ARC"};
+  char ckpt_path[128];
+  snprintf(ckpt_path, sizeof(ckpt_path), "/tmp/libCacheSim_test_%d.ckpt", (int)getpid());
+
+  reader_t *reader = (reader_t *)user_data;
+  common_cache_params_t cc_params = {.cache_size = CACHE_SIZE / 4, .hashpower = 20, .default_ttl = DEFAULT_TTL};
+  request_t *req = new_request();
+
+  for (size_t i = 0; i < sizeof(algos) / sizeof(algos[0]); i++) {
+    cache_t *cache = create_test_cache(algos[i], cc_params, reader, NULL);
+    cache_t *restored_cache = create_test_cache(algos[i], cc_params, reader, NULL);
+
+    reset_reader(reader);
+    for (uint64_t n = 0; n < g_req_cnt_true / 2; n++) {
+      read_one_req(reader, req);
+      cache->get(cache, req);
+    }
+
+    g_assert_true(cache_save_checkpoint(cache, ckpt_path));
+    g_assert_true(cache_load_checkpoint(restored_cache, ckpt_path));
+    g_assert_true(restored_cache->restored_from_checkpoint);
+    g_assert_cmpint(cache->get_n_obj(cache), ==, restored_cache->get_n_obj(restored_cache));
+    g_assert_cmpint(cache->get_occupied_byte(cache), ==, restored_cache->get_occupied_byte(restored_cache));
+
+    uint64_t n_hit = 0, n_hit_restored = 0;
+    while (read_one_req(reader, req) == 0) {
+      n_hit += cache->get(cache, req);
+      n_hit_restored += restored_cache->get(restored_cache, req);
+    }
+    g_assert_cmpuint(n_hit, >, 0);
+    g_assert_cmpuint(n_hit, ==, n_hit_restored);
+
+    cache->cache_free(cache);
+    restored_cache->cache_free(restored_cache);
+  }
+
+  /* a checkpoint cannot be loaded into a cache of a different size */
+  cache_t *cache = create_test_cache("LRU", cc_params, reader, NULL);
+  cc_params.cache_size *= 2;
+  cache_t *larger_cache = create_test_cache("LRU", cc_params, reader, NULL);
+  g_assert_true(cache_save_checkpoint(cache, ckpt_path));
+  g_assert_false(cache_load_checkpoint(larger_cache, ckpt_path));
+  cache->cache_free(cache);
+  larger_cache->cache_free(larger_cache);
+
+  /* or into a different algorithm */
+  cc_params.cache_size /= 2;
+  cache = create_test_cache("FIFO", cc_params, reader, NULL);
+  cache_t *clock_cache = create_test_cache("Clock", cc_params, reader, NULL);
+  g_assert_true(cache_save_checkpoint(cache, ckpt_path));
+  g_assert_false(cache_load_checkpoint(clock_cache, ckpt_path));
+  cache->cache_free(cache);
+  clock_cache->cache_free(clock_cache);
+
+  remove(ckpt_path);
+  free_request(req);
+  reset_reader(reader);
+}
+
+/* a ring queue keeps the objects in the same order as the linked list, so
+ * queue=ring has the same hits and eviction candidates, and a checkpoint of
+ * a ring queue can be loaded into a cache that uses the linked list */
+static void test_ring_queue(gconstpointer user_data) {
+  cache_init_func_ptr inits[] = {FIFO_init, Clock_init, Clock_init, Sieve_init, S3FIFO_init, QDLP_init, QDLP_init};
+  const char *list_params[] = {NULL, NULL, "n-bit-counter=2", NULL, "move-to-main-threshold=2",
+                               "main-cache=Clock2", "main-cache=Sieve"};
+  const char *ring_params[] = {"queue=ring",
+                               "queue=ring",
+                               "n-bit-counter=2,queue=ring",
+                               "queue=ring",
+                               "move-to-main-threshold=2,queue=ring",
+                               "main-cache=Clock2,queue=ring",
+                               "main-cache=Sieve,queue=ring"};
+  char ckpt_path[128];
+  snprintf(ckpt_path, sizeof(ckpt_path), "/tmp/libCacheSim_test_ring_%d.ckpt", (int)getpid());
+
+  reader_t *reader = (reader_t *)user_data;
+  common_cache_params_t cc_params = {.cache_size = CACHE_SIZE / 4, .hashpower = 20, .default_ttl = DEFAULT_TTL};
+  request_t *req = new_request();
+
+  for (size_t i = 0; i < sizeof(inits) / sizeof(inits[0]); i++) {
+    cache_t *list_cache = inits[i](cc_params, list_params[i]);
+    cache_t *ring_cache = inits[i](cc_params, ring_params[i]);
+    cache_t *restored_cache = inits[i](cc_params, list_params[i]);
+    /* FIFO, Clock and Sieve support to_evict */
+    bool has_to_evict = inits[i] != S3FIFO_init && inits[i] != QDLP_init;
+
+    reset_reader(reader);
+    for (uint64_t n = 0; n < g_req_cnt_true / 2; n++) {
+      read_one_req(reader, req);
+      if (has_to_evict && n % 1000 == 999) {
+        g_assert_cmpint(list_cache->to_evict(list_cache, req)->obj_id, ==,
+                        ring_cache->to_evict(ring_cache, req)->obj_id);
+      }
+      g_assert_cmpint(list_cache->get(list_cache, req), ==, ring_cache->get(ring_cache, req));
+    }
+
+    /* QDLP does not support checkpoint */
+    bool restored = ring_cache->save_state != NULL;
+    if (restored) {
+      g_assert_true(cache_save_checkpoint(ring_cache, ckpt_path));
+      g_assert_true(cache_load_checkpoint(restored_cache, ckpt_path));
+    }
+
+    while (read_one_req(reader, req) == 0) {
+      bool hit = list_cache->get(list_cache, req);
+      g_assert_cmpint(hit, ==, ring_cache->get(ring_cache, req));
+      if (restored) {
+        g_assert_cmpint(hit, ==, restored_cache->get(restored_cache, req));
+      }
+    }
+    g_assert_cmpint(list_cache->get_n_obj(list_cache), ==, ring_cache->get_n_obj(ring_cache));
+
+    list_cache->cache_free(list_cache);
+    ring_cache->cache_free(ring_cache);
+    restored_cache->cache_free(restored_cache);
+  }
+
+  remove(ckpt_path);
+  free_request(req);
+  reset_reader(reader);
+}
+
+static void test_op_stat(gconstpointer user_data) {
+  const char *algos[] = {"LRU", "Clock", "Sieve", "S3-FIFO"};
+  reader_t *reader = (reader_t *)user_data;
+  common_cache_params_t cc_params = {.cache_size = CACHE_SIZE / 4, .hashpower = 20, .default_ttl = DEFAULT_TTL};
+  request_t *req = new_request();
+
+  for (size_t i = 0; i < sizeof(algos) / sizeof(algos[0]); i++) {
+    cache_t *cache = create_test_cache(algos[i], cc_params, reader, NULL);
+    cache_t *profiled_cache = create_test_cache(algos[i], cc_params, reader, NULL);
+#ifdef ENABLE_CACHE_OP_STAT
+    g_assert_true(cache_enable_op_stat(profiled_cache, 2, false));
+#else
+    g_assert_false(cache_enable_op_stat(profiled_cache, 2, false));
+#endif
+
+    /* the instrumentation does not change the result */
+    uint64_t n_req = 0, n_hit = 0, n_hit_profiled = 0;
+    reset_reader(reader);
+    while (read_one_req(reader, req) == 0) {
+      n_req += 1;
+      n_hit += cache->get(cache, req);
+      n_hit_profiled += profiled_cache->get(profiled_cache, req);
+    }
+    g_assert_cmpuint(n_hit, ==, n_hit_profiled);
+
+    const cache_op_stat_t *stat = cache_get_op_stat(profiled_cache);
+#ifdef ENABLE_CACHE_OP_STAT
+    g_assert_nonnull(stat);
+    g_assert_cmpint(stat->ops[CACHE_OP_GET].n_call, ==, n_req);
+    g_assert_cmpint(stat->ops[CACHE_OP_GET].n_sampled, ==, (n_req + 3) / 4);
+    g_assert_cmpint(stat->ops[CACHE_OP_FIND].n_call, >=, n_req);
+    g_assert_cmpint(stat->ops[CACHE_OP_INSERT].n_call, >=, n_req - n_hit);
+    g_assert_cmpint(stat->ops[CACHE_OP_EVICT].n_call, >=, profiled_cache->n_evict);
+    g_assert_cmpuint(stat->ops[CACHE_OP_GET].sampled_cycles, >, 0);
+    if (strcmp(algos[i], "LRU") == 0) {
+      g_assert_cmpint(stat->hashtable.n_lookup, ==, n_req);
+    }
+#else
+    g_assert_null(stat);
+#endif
+
+    cache->cache_free(cache);
+    profiled_cache->cache_free(profiled_cache);
+  }
+
+  free_request(req);
+  reset_reader(reader);
+}
+
+typedef struct {
+  concurrent_cache_t *cache;
+  request_t *reqs;
+  int64_t n_req;
+  int64_t n_hit;
+} concurrent_worker_t;
+
+static void *concurrent_worker(void *arg) {
+  concurrent_worker_t *worker = (concurrent_worker_t *)arg;
+  for (int64_t i = 0; i < worker->n_req; i++) {
+    worker->n_hit += worker->cache->get(worker->cache, &worker->reqs[i]);
+  }
+  return NULL;
+}
+
+static void test_concurrent(gconstpointer user_data) {
+  const char *algos[] = {"FIFO", "Clock", "Sieve", "S3-FIFO"};
+  const int n_thread = 4;
+  reader_t *reader = (reader_t *)user_data;
+  common_cache_params_t cc_params = {.cache_size = CACHE_SIZE / 4, .hashpower = 16, .default_ttl = DEFAULT_TTL};
+
+  int64_t n_req = 0;
+  request_t *reqs = malloc(sizeof(request_t) * g_req_cnt_true);
+  reset_reader(reader);
+  while (n_req < (int64_t)g_req_cnt_true && read_one_req(reader, &reqs[n_req]) == 0) {
+    n_req += 1;
+  }
+
+  /* the requests of an object are sent to the same thread */
+  request_t *parts[4];
+  concurrent_worker_t workers[4];
+  for (int t = 0; t < n_thread; t++) {
+    parts[t] = malloc(sizeof(request_t) * n_req);
+    workers[t] = (concurrent_worker_t){.reqs = parts[t], .n_req = 0, .n_hit = 0};
+  }
+  for (int64_t i = 0; i < n_req; i++) {
+    int t = (int)(reqs[i].obj_id % n_thread);
+    parts[t][workers[t].n_req++] = reqs[i];
+  }
+
+  for (size_t i = 0; i < sizeof(algos) / sizeof(algos[0]); i++) {
+    cache_t *cache = create_test_cache(algos[i], cc_params, reader, NULL);
+    concurrent_cache_t *ccache = create_concurrent_cache(algos[i], cc_params, NULL);
+    g_assert_nonnull(ccache);
+
+    /* a single thread gives the same result as the serial cache */
+    int64_t n_hit = 0, n_hit_concurrent = 0;
+    for (int64_t j = 0; j < n_req; j++) {
+      n_hit += cache->get(cache, &reqs[j]);
+      n_hit_concurrent += ccache->get(ccache, &reqs[j]);
+    }
+    if (strcasecmp(algos[i], "S3-FIFO") == 0) {
+      /* the ghost of the concurrent S3FIFO is approximate */
+      g_assert_cmpfloat(fabs((double)(n_hit - n_hit_concurrent) / n_req), <, 0.005);
+    } else {
+      g_assert_cmpint(n_hit, ==, n_hit_concurrent);
+      g_assert_cmpint(cache->get_n_obj(cache), ==, ccache->get_n_obj(ccache));
+      g_assert_cmpint(cache->get_occupied_byte(cache), ==, ccache->get_occupied_byte(ccache));
+    }
+    ccache->cache_free(ccache);
+
+    /* multiple threads share the cache */
+    ccache = create_concurrent_cache(algos[i], cc_params, NULL);
+    pthread_t threads[4];
+    for (int t = 0; t < n_thread; t++) {
+      workers[t].cache = ccache;
+      workers[t].n_hit = 0;
+      pthread_create(&threads[t], NULL, concurrent_worker, &workers[t]);
+    }
+    n_hit_concurrent = 0;
+    for (int t = 0; t < n_thread; t++) {
+      pthread_join(threads[t], NULL);
+      n_hit_concurrent += workers[t].n_hit;
+    }
+    g_assert_cmpint(ccache->get_occupied_byte(ccache), <=, cc_params.cache_size);
+    g_assert_cmpint(ccache->get_n_obj(ccache), >, 0);
+    /* the interleaving changes the result, and the threads may run one after
+     * another on a machine with few cores */
+    g_assert_cmpfloat(fabs((double)(n_hit - n_hit_concurrent) / n_req), <, 0.2);
+
+    ccache->cache_free(ccache);
+    cache->cache_free(cache);
+  }
+
+  for (int t = 0; t < n_thread; t++) {
+    free(parts[t]);
+  }
+  free(reqs);
+  reset_reader(reader);
+}
+
 static void empty_test(gconstpointer user_data) { ; }
 
 int main(int argc, char *argv[]) {
@@ -539,6 +808,11 @@ int main(int argc, char *argv[]) {
   g_test_add_data_func("/libCacheSim/cacheAlgo_GDSF", reader, test_GDSF);
   g_test_add_data_func("/libCacheSim/cacheAlgo_LHD", reader, test_LHD);
 
+  g_test_add_data_func("/libCacheSim/cacheAlgo_checkpoint", reader, test_checkpoint);
+  g_test_add_data_func("/libCacheSim/cacheAlgo_ring_queue", reader, test_ring_queue);
+  g_test_add_data_func("/libCacheSim/cacheAlgo_op_stat", reader, test_op_stat);
+  g_test_add_data_func("/libCacheSim/cacheAlgo_concurrent", reader, test_concurrent);
+
   // /* Belady requires reader that has next access information and can only use
   //  * oracleGeneral trace */
   // g_test_add_data_func("/libCacheSim/cacheAlgo_Belady", reader, test_Belady);
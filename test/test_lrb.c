@@ -0,0 +1,73 @@
+//
+// test LRB with LightGBM
+//
+
+#include "common.h"
+
+/* the model is trained after LRB collects 131072 training samples, so the
+ * trace is much longer than the test traces of the other algorithms */
+#define LRB_TRACE_SPEC                                                                              \
+  "zipf:alpha=0.9,n_obj=50000,size_min=1024,size_max=65536,size_dist=loguniform;scan:weight=0.1;" \
+  "n_req=500000,seed=42"
+#define LRB_CACHE_SIZE (128 * MiB)
+#define LRB_STEP_SIZE (64 * MiB)
+
+static void print_results(const cache_t *cache, const cache_stat_t *res, uint64_t num_of_sizes) {
+  for (uint64_t i = 0; i < num_of_sizes; i++) {
+    printf("%s cache size %8.4lf MB, req %" PRIu64 " miss %8" PRIu64 " req_bytes %" PRIu64 " miss_bytes %" PRIu64 "\n",
+           cache->cache_name, (double)res[i].cache_size / (double)MiB, res[i].n_req, res[i].n_miss, res[i].n_req_byte,
+           res[i].n_miss_byte);
+  }
+}
+
+static cache_stat_t *run_LRB(reader_t *reader, const char *alg_name) {
+  common_cache_params_t cc_params = {.cache_size = LRB_CACHE_SIZE, .hashpower = 20, .default_ttl = DEFAULT_TTL};
+  cache_t *cache = create_test_cache(alg_name, cc_params, reader, NULL);
+  g_assert_true(cache != NULL);
+  cache_stat_t *res = simulate_at_multi_sizes_with_step_size(reader, cache, LRB_STEP_SIZE, NULL, 0, 0, _n_cores(), false);
+  print_results(cache, res, LRB_CACHE_SIZE / LRB_STEP_SIZE);
+  cache->cache_free(cache);
+  return res;
+}
+
+/* the misses of the original LRB, which evicts one object per prediction */
+static const uint64_t miss_cnt_true[] = {242511, 194753};
+
+/* with one candidate per prediction, the same objects are evicted as the
+ * original LRB */
+static void test_LRB_BATCH1(gconstpointer user_data) {
+  cache_stat_t *res = run_LRB((reader_t *)user_data, "LRB-batch1");
+  for (uint64_t i = 0; i < LRB_CACHE_SIZE / LRB_STEP_SIZE; i++) {
+    g_assert_cmpuint(res[i].n_miss, ==, miss_cnt_true[i]);
+  }
+  my_free(sizeof(cache_stat_t), res);
+}
+
+/* evicting the best 8 candidates of one prediction is close to evicting
+ * the best candidate of each prediction */
+static void test_LRB_BATCH8(gconstpointer user_data) {
+  cache_stat_t *res = run_LRB((reader_t *)user_data, "LRB-batch8");
+  for (uint64_t i = 0; i < LRB_CACHE_SIZE / LRB_STEP_SIZE; i++) {
+    double diff = fabs((double)res[i].n_miss - (double)miss_cnt_true[i]) / (double)miss_cnt_true[i];
+    g_assert_cmpfloat(diff, <, 0.02);
+  }
+  my_free(sizeof(cache_stat_t), res);
+}
+
+static void empty_test(gconstpointer user_data) { ; }
+
+int main(int argc, char *argv[]) {
+  g_test_init(&argc, &argv, NULL);
+  srand(0);  // for reproducibility
+  reader_t *reader;
+
+#if defined(ENABLE_LRB) && ENABLE_LRB == 1
+  reader = setup_reader(LRB_TRACE_SPEC, SYNTHETIC_TRACE, NULL);
+  g_test_add_data_func("/libCacheSim/cacheAlgo_LRB_BATCH1", reader, test_LRB_BATCH1);
+  g_test_add_data_func("/libCacheSim/cacheAlgo_LRB_BATCH8", reader, test_LRB_BATCH8);
+
+  g_test_add_data_func_full("/libCacheSim/empty", reader, empty_test, test_teardown);
+#endif /* ENABLE_LRB */
+
+  return g_test_run();
+}
@@ -173,11 +173,365 @@ static void test_simulator_with_warmup2(gconstpointer user_data) {
   cache->cache_free(cache);
 }
 
+static void _branch_setup(cache_t *cache, int branch_idx, void *user_data) {
+  if (branch_idx == 2) {
+    cache->admissioner = create_admissioner("prob", "prob=0.5");
+  }
+}
+
+/**
+ * this one for testing forking branches from a warmed cache, the branches
+ * that continue the trace should have the same result as warmup2
+ * @param user_data
+ */
+static void test_simulator_with_branches(gconstpointer user_data) {
+  reader_t *reader = (reader_t *)user_data;
+  common_cache_params_t cc_params = {.cache_size = STEP_SIZE, .default_ttl = 0};
+  cache_t *caches[1];
+  caches[0] = LRU_init(cc_params, NULL);
+  cache_stat_t *res_true = simulate_with_multi_caches(reader, caches, 1, NULL, 0.2, 0, 1, false, false);
+
+  cache_t *cache = LRU_init(cc_params, NULL);
+  int64_t n_prefix_req = (int64_t)((double)get_num_of_req(reader) * 0.2);
+  cache_stat_t *res = simulate_with_branches(reader, cache, n_prefix_req, 3, NULL, _branch_setup, NULL, 2);
+
+  for (int i = 0; i < 3; i++) {
+    g_assert_cmpint(res[i].n_warmup_req, ==, n_prefix_req);
+    g_assert_cmpint(res[i].n_req, ==, res_true[0].n_req);
+    g_assert_cmpint(res[i].n_req_byte, ==, res_true[0].n_req_byte);
+  }
+  for (int i = 0; i < 2; i++) {
+    g_assert_cmpint(res[i].n_miss, ==, res_true[0].n_miss);
+    g_assert_cmpint(res[i].n_miss_byte, ==, res_true[0].n_miss_byte);
+  }
+  /* the branch with admission has a different result */
+  g_assert_cmpint(res[2].n_miss, !=, res_true[0].n_miss);
+
+  /* the parent cache stays at the branch point */
+  g_assert_cmpint(cache->n_req, ==, n_prefix_req);
+
+  g_free(res);
+  g_free(res_true);
+  cache->cache_free(cache);
+  caches[0]->cache_free(caches[0]);
+}
+
+/**
+ * this one for testing the metrics sink, the per-interval counters should sum
+ * up to the result of the simulation
+ * @param user_data
+ */
+static void test_simulator_with_metrics(gconstpointer user_data) {
+  reader_t *reader = (reader_t *)user_data;
+  const char *metrics_path = "test_simulator.metrics";
+  metrics_interval_type_e interval_types[2] = {METRICS_INTERVAL_SEC, METRICS_INTERVAL_REQ};
+  int64_t intervals[2] = {600, 1000};
+
+  for (int t = 0; t < 2; t++) {
+    common_cache_params_t cc_params = {.cache_size = STEP_SIZE, .default_ttl = 0};
+    cache_t *caches[2];
+    caches[0] = LRU_init(cc_params, NULL);
+    caches[1] = FIFO_init(cc_params, NULL);
+
+    metrics_sink_t *sink = create_metrics_sink(metrics_path, interval_types[t], intervals[t]);
+    g_assert_true(sink != NULL);
+    metrics_sink_attach(sink, caches[0]);
+    metrics_sink_attach(sink, caches[1]);
+    cache_stat_t *res = simulate_with_multi_caches(reader, caches, 2, NULL, 0.2, 0, 2, false, false);
+    close_metrics_sink(sink);
+
+    FILE *f = fopen(metrics_path, "rb");
+    g_assert_true(f != NULL);
+    char magic[8];
+    int32_t header_i32[4];
+    int64_t interval;
+    g_assert_cmpint(fread(magic, sizeof(magic), 1, f), ==, 1);
+    g_assert_cmpint(memcmp(magic, "LCSMTRC1", 8), ==, 0);
+    g_assert_cmpint(fread(header_i32, sizeof(header_i32), 1, f), ==, 1);
+    g_assert_cmpint(fread(&interval, sizeof(interval), 1, f), ==, 1);
+    g_assert_cmpint(header_i32[1], ==, METRICS_N_COLUMN);
+    g_assert_cmpint(header_i32[2], ==, 2);
+    g_assert_cmpint(header_i32[3], ==, interval_types[t]);
+    g_assert_cmpint(interval, ==, intervals[t]);
+    fseek(f, METRICS_N_COLUMN * METRICS_COLUMN_NAME_LEN + 2 * (CACHE_NAME_ARRAY_LEN + sizeof(int64_t)), SEEK_CUR);
+
+    int64_t n_req[2] = {0, 0}, n_miss[2] = {0, 0}, n_miss_byte[2] = {0, 0}, n_row[2] = {0, 0};
+    int32_t block_header[2];
+    int64_t *column = malloc(sizeof(int64_t) * METRICS_BLOCK_N_ROW);
+    while (fread(block_header, sizeof(block_header), 1, f) == 1) {
+      int32_t idx = block_header[0];
+      g_assert_true(idx >= 0 && idx < 2);
+      n_row[idx] += block_header[1];
+      for (int c = 0; c < METRICS_N_COLUMN; c++) {
+        g_assert_cmpint(fread(column, sizeof(int64_t), block_header[1], f), ==, block_header[1]);
+        for (int r = 0; r < block_header[1]; r++) {
+          if (c == METRICS_COL_N_REQ) n_req[idx] += column[r];
+          if (c == METRICS_COL_N_MISS) n_miss[idx] += column[r];
+          if (c == METRICS_COL_N_MISS_BYTE) n_miss_byte[idx] += column[r];
+          if (c == METRICS_COL_N_REQ && interval_types[t] == METRICS_INTERVAL_REQ && r < block_header[1] - 1)
+            g_assert_cmpint(column[r], ==, intervals[t]);
+        }
+      }
+    }
+    free(column);
+    fclose(f);
+    remove(metrics_path);
+
+    for (int i = 0; i < 2; i++) {
+      g_assert_cmpint(n_row[i], >, 1);
+      g_assert_cmpint(n_req[i], ==, res[i].n_req);
+      g_assert_cmpint(n_miss[i], ==, res[i].n_miss);
+      g_assert_cmpint(n_miss_byte[i], ==, res[i].n_miss_byte);
+    }
+
+    g_free(res);
+    caches[0]->cache_free(caches[0]);
+    caches[1]->cache_free(caches[1]);
+  }
+}
+
+static void test_simulator_sharded(gconstpointer user_data) {
+  reader_t *reader = (reader_t *)user_data;
+  common_cache_params_t cc_params = {.cache_size = CACHE_SIZE, .hashpower = 16, .default_ttl = 0};
+  cache_t *caches[4];
+  caches[0] = Sharded_init(cc_params, "n-shard=4,shard-cache=lru,parallel=true");
+  caches[1] = Sharded_init(cc_params, "n-shard=4,shard-cache=lru,parallel=false");
+  // one shard is the same as the shard cache
+  caches[2] = Sharded_init(cc_params, "n-shard=1,shard-cache=lru,parallel=true");
+  caches[3] = LRU_init(cc_params, NULL);
+  g_assert_true(Sharded_is_parallel(caches[0]));
+  g_assert_false(Sharded_is_parallel(caches[1]));
+  g_assert_false(Sharded_is_parallel(caches[3]));
+
+  cache_stat_t *res = simulate_with_multi_caches(reader, caches, 4, NULL, 0.2, 0, 2, false, false);
+
+  // the parallel run matches the serial run of the shards
+  g_assert_cmpint(res[0].n_req, ==, res[1].n_req);
+  g_assert_cmpint(res[0].n_miss, ==, res[1].n_miss);
+  g_assert_cmpint(res[0].n_miss_byte, ==, res[1].n_miss_byte);
+  g_assert_cmpint(res[0].n_obj, ==, caches[1]->get_n_obj(caches[1]));
+  g_assert_cmpint(res[2].n_miss, ==, res[3].n_miss);
+  g_assert_cmpint(res[2].n_miss_byte, ==, res[3].n_miss_byte);
+  // the evictions of the shards are counted in both modes
+  g_assert_cmpint(caches[0]->n_evict, >, 0);
+  g_assert_cmpint(caches[0]->n_evict, ==, caches[1]->n_evict);
+  g_assert_cmpint(caches[2]->n_evict, ==, caches[3]->n_evict);
+
+  g_free(res);
+  for (int i = 0; i < 4; i++) {
+    caches[i]->cache_free(caches[i]);
+  }
+}
+
+static void test_simulator_static(gconstpointer user_data) {
+  reader_t *reader = (reader_t *)user_data;
+  cache_init_func_ptr inits[] = {LRU_init,  FIFO_init, Clock_init, Clock_init, Sieve_init, S3FIFO_init, S3FIFO_init,
+                                 SLRU_init, SLRU_init, ARC_init,   LFU_init};
+  const char *params[] = {NULL, NULL, NULL, "n-bit-counter=2", NULL, NULL, "ghost-size-ratio=0",
+                          NULL, "seg-size=1:2:5", NULL, NULL};
+  const int n_algo = sizeof(inits) / sizeof(inits[0]);
+  const uint64_t cache_sizes[] = {CACHE_SIZE / 20, CACHE_SIZE / 2};
+
+  for (int s = 0; s < 2; s++) {
+    common_cache_params_t cc_params = {
+        .cache_size = cache_sizes[s], .hashpower = 16, .default_ttl = 0, .consider_obj_metadata = s == 1};
+    cache_t *caches[2 * n_algo];
+    for (int i = 0; i < n_algo; i++) {
+      caches[i] = inits[i](cc_params, params[i]);
+      caches[n_algo + i] = inits[i](cc_params, params[i]);
+      caches[n_algo + i]->use_static_sim = true;
+    }
+    // LFU is not supported and uses the generic path
+#ifdef SUPPORT_TTL
+    g_assert_false(static_sim_support(caches[0]));
+#else
+    g_assert_true(static_sim_support(caches[0]));
+#endif
+    g_assert_false(static_sim_support(caches[n_algo - 1]));
+
+    cache_stat_t *res = simulate_with_multi_caches(reader, caches, 2 * n_algo, NULL, 0.2, 0, _n_cores(), true, false);
+
+    // the static-dispatch engine has the same misses as cache->get
+    for (int i = 0; i < n_algo; i++) {
+      g_assert_cmpint(res[i].n_req, ==, res[n_algo + i].n_req);
+      g_assert_cmpint(res[i].n_miss, ==, res[n_algo + i].n_miss);
+      g_assert_cmpint(res[i].n_miss_byte, ==, res[n_algo + i].n_miss_byte);
+    }
+    g_free(res);
+  }
+}
+
+static cluster_t *create_test_cluster(int n_server) {
+  cluster_t *cluster = create_cluster();
+  for (int i = 0; i < n_server; i++) {
+    common_cache_params_t cc_params = {.cache_size = CACHE_SIZE / 40, .hashpower = 16, .default_ttl = 0};
+    cache_t *caches[2];
+    caches[0] = LRU_init(cc_params, NULL);
+    cc_params.cache_size = CACHE_SIZE / 8;
+    caches[1] = LRU_init(cc_params, NULL);
+    cluster_add_server(cluster, caches, 2, i % 2 == 0 ? 1.0 : 2.0);
+  }
+  return cluster;
+}
+
+static cluster_stat_t *simulate_test_cluster(reader_t *reader, int n_thread) {
+  /* find the time of the events */
+  int64_t n_req = get_num_of_req(reader);
+  int64_t event_time[3], i = 0;
+  request_t *req = new_request();
+  reset_reader(reader);
+  for (int j = 0; j < 3; j++) {
+    while (i++ < n_req * (j + 1) / 4) read_one_req(reader, req);
+    event_time[j] = req->clock_time;
+  }
+  free_request(req);
+  reset_reader(reader);
+
+  common_cache_params_t cc_params = {.cache_size = CACHE_SIZE / 8, .hashpower = 16, .default_ttl = 0};
+  cache_t *new_server_cache = LRU_init(cc_params, NULL);
+  cluster_event_t events[3] = {
+      {.time = event_time[0], .type = CLUSTER_REMOVE_SERVER, .server_id = 3},
+      {.time = event_time[1], .type = CLUSTER_ADD_SERVER, .server_id = -1, .caches = &new_server_cache, .n_cache = 1,
+       .weight = 1.0},
+      {.time = event_time[2], .type = CLUSTER_ADD_SERVER, .server_id = 3},
+  };
+
+  cluster_t *cluster = create_test_cluster(8);
+  cluster_stat_t *stat = simulate_cluster(reader, cluster, events, 3, n_thread);
+  free_cluster(cluster);
+  return stat;
+}
+
+static void test_simulator_cluster(gconstpointer user_data) {
+  reader_t *reader = (reader_t *)user_data;
+
+  // removing a server only moves the objects of the server
+  cluster_t *cluster = create_test_cluster(8);
+  int server_before[1000];
+  for (obj_id_t obj_id = 0; obj_id < 1000; obj_id++) {
+    server_before[obj_id] = cluster_get_server(cluster, obj_id);
+  }
+  cluster_remove_server(cluster, 3);
+  for (obj_id_t obj_id = 0; obj_id < 1000; obj_id++) {
+    int server_id = cluster_get_server(cluster, obj_id);
+    g_assert_cmpint(server_id, !=, 3);
+    if (server_before[obj_id] != 3) {
+      g_assert_cmpint(server_id, ==, server_before[obj_id]);
+    }
+  }
+  cluster_restore_server(cluster, 3);
+  for (obj_id_t obj_id = 0; obj_id < 1000; obj_id++) {
+    g_assert_cmpint(cluster_get_server(cluster, obj_id), ==, server_before[obj_id]);
+  }
+  free_cluster(cluster);
+
+  // the parallel run matches the serial run
+  cluster_stat_t *serial = simulate_test_cluster(reader, 1);
+  cluster_stat_t *parallel = simulate_test_cluster(reader, 4);
+  g_assert_cmpint(serial->n_req, ==, get_num_of_req(reader));
+  g_assert_cmpint(serial->n_server, ==, 9);
+  g_assert_cmpint(parallel->n_server, ==, 9);
+  g_assert_cmpint(serial->n_req_no_server, ==, 0);
+  g_assert_true(serial->server_stats[3].active);
+  g_assert_cmpint(serial->server_stats[8].n_req, >, 0);
+  int64_t n_miss = 0;
+  for (int i = 0; i < serial->n_server; i++) {
+    g_assert_cmpint(serial->server_stats[i].n_req, ==, parallel->server_stats[i].n_req);
+    g_assert_cmpint(serial->server_stats[i].n_miss, ==, parallel->server_stats[i].n_miss);
+    g_assert_cmpint(serial->server_stats[i].n_miss_byte, ==, parallel->server_stats[i].n_miss_byte);
+    n_miss += serial->server_stats[i].n_miss;
+  }
+  g_assert_cmpint(serial->n_miss, ==, n_miss);
+  g_assert_cmpint(serial->n_miss, ==, parallel->n_miss);
+  g_assert_cmpint(serial->n_miss, <, serial->n_req);
+
+  free_cluster_stat(serial);
+  free_cluster_stat(parallel);
+}
+
+static cache_t *create_hierarchy_test_cache(uint64_t cache_size) {
+  common_cache_params_t cc_params = {.cache_size = cache_size, .hashpower = 16, .default_ttl = 0};
+  return LRU_init(cc_params, NULL);
+}
+
+/* trace -> L1a, L1b -> L2 (misses of both), L2' (misses of L1a) -> L3 */
+static cache_stat_t *simulate_test_hierarchy(reader_t *reader, int n_thread) {
+  cache_hierarchy_t *hierarchy = create_cache_hierarchy();
+  int trace = hierarchy_add_trace(hierarchy, reader);
+  int l1a = hierarchy_add_cache(hierarchy, create_hierarchy_test_cache(CACHE_SIZE / 20), &trace, 1);
+  int l1b = hierarchy_add_cache(hierarchy, create_hierarchy_test_cache(CACHE_SIZE / 10), &trace, 1);
+  int l1[2] = {l1a, l1b};
+  hierarchy_add_cache(hierarchy, create_hierarchy_test_cache(CACHE_SIZE / 4), l1, 2);
+  int l2 = hierarchy_add_cache(hierarchy, create_hierarchy_test_cache(CACHE_SIZE / 2), &l1a, 1);
+  hierarchy_add_cache(hierarchy, create_hierarchy_test_cache(CACHE_SIZE), &l2, 1);
+  g_assert_cmpint(hierarchy_get_level(hierarchy, trace), ==, 0);
+  g_assert_cmpint(hierarchy_get_level(hierarchy, l2 + 1), ==, 3);
+  g_assert_null(hierarchy_get_cache(hierarchy, trace));
+
+  reset_reader(reader);
+  cache_stat_t *stat = simulate_cache_hierarchy(hierarchy, n_thread);
+  free_cache_hierarchy(hierarchy);
+  return stat;
+}
+
+static void test_simulator_hierarchy(gconstpointer user_data) {
+  reader_t *reader = (reader_t *)user_data;
+
+  // replay the misses by hand
+  cache_t *caches[5] = {create_hierarchy_test_cache(CACHE_SIZE / 20), create_hierarchy_test_cache(CACHE_SIZE / 10),
+                        create_hierarchy_test_cache(CACHE_SIZE / 4), create_hierarchy_test_cache(CACHE_SIZE / 2),
+                        create_hierarchy_test_cache(CACHE_SIZE)};
+  int64_t n_miss[5] = {0}, n_req[5] = {0};
+  request_t *req = new_request();
+  reset_reader(reader);
+  read_one_req(reader, req);
+  while (req->valid) {
+    bool hit_a = caches[0]->get(caches[0], req), hit_b = caches[1]->get(caches[1], req);
+    n_req[0]++, n_req[1]++;
+    n_miss[0] += !hit_a, n_miss[1] += !hit_b;
+    if (!hit_a) {
+      n_req[2]++;
+      n_miss[2] += !caches[2]->get(caches[2], req);
+    }
+    if (!hit_b) {
+      n_req[2]++;
+      n_miss[2] += !caches[2]->get(caches[2], req);
+    }
+    if (!hit_a) {
+      n_req[3]++;
+      if (!caches[3]->get(caches[3], req)) {
+        n_miss[3]++;
+        n_req[4]++;
+        n_miss[4] += !caches[4]->get(caches[4], req);
+      }
+    }
+    read_one_req(reader, req);
+  }
+  free_request(req);
+
+  cache_stat_t *serial = simulate_test_hierarchy(reader, 1);
+  cache_stat_t *parallel = simulate_test_hierarchy(reader, 4);
+  g_assert_cmpint(serial[0].n_req, ==, n_req[0]);
+  for (int i = 0; i < 5; i++) {
+    g_assert_cmpint(serial[i + 1].n_req, ==, n_req[i]);
+    g_assert_cmpint(serial[i + 1].n_miss, ==, n_miss[i]);
+    g_assert_cmpint(parallel[i + 1].n_req, ==, n_req[i]);
+    g_assert_cmpint(parallel[i + 1].n_miss, ==, n_miss[i]);
+    g_assert_cmpint(parallel[i + 1].n_miss_byte, ==, serial[i + 1].n_miss_byte);
+    caches[i]->cache_free(caches[i]);
+  }
+  g_assert_cmpint(n_miss[4], >, 0);
+
+  free(serial);
+  free(parallel);
+}
+
 static void test_simulator_with_ttl(gconstpointer user_data) {
   uint64_t req_cnt_true = 113872, req_byte_true = 4205978112;
   uint64_t miss_cnt_true[] = {93240, 87890, 83268, 81743, 72649, 72284, 72165, 72086};
   uint64_t miss_byte_true[] = {4035856384, 3842041344, 3662972928, 3615563264,
                                3090454016, 3082932736, 3078236672, 3075259904};
+  uint64_t expired_cnt_true[] = {3577, 5867, 8320, 10377, 13932, 16459, 21501, 25253};
 
   reader_t *reader = (reader_t *)user_data;
   common_cache_params_t cc_params = {.cache_size = CACHE_SIZE, .default_ttl = 2400};
@@ -194,12 +548,52 @@ static void test_simulator_with_ttl(gconstpointer user_data) {
     g_assert_cmpuint(res[i].n_req_byte, ==, req_byte_true);
     g_assert_cmpuint(res[i].n_miss, ==, miss_cnt_true[i]);
     g_assert_cmpuint(res[i].n_miss_byte, ==, miss_byte_true[i]);
+    g_assert_cmpuint(res[i].expired_obj_cnt, ==, expired_cnt_true[i]);
   }
   g_free(res);
 
   cache->cache_free(cache);
 }
 
+/**
+ * the caches that keep the objects in sub-caches (S3FIFO and QDLP) must
+ * expire the objects in the sub-caches, including the objects that moved
+ * from the small FIFO to the main cache
+ */
+#ifdef SUPPORT_TTL
+static void test_simulator_ttl_sub_cache(void) {
+  const char *algos[] = {"LRU", "S3FIFO", "QDLP"};
+  cache_init_func_ptr inits[] = {LRU_init, S3FIFO_init, QDLP_init};
+  common_cache_params_t cc_params = {.cache_size = 100 * 100, .default_ttl = 1000};
+  request_t *req = new_request();
+  req->obj_size = 100;
+
+  for (int i = 0; i < 3; i++) {
+    cache_t *cache = inits[i](cc_params, NULL);
+    /* each object is requested twice, so that some objects move to the main
+     * cache when the small FIFO evicts */
+    for (int64_t t = 0; t < 400; t++) {
+      req->clock_time = t + 1;
+      req->obj_id = t / 2;
+      cache->get(cache, req);
+    }
+    int64_t n_obj = cache->get_n_obj(cache);
+    g_assert_cmpint(n_obj, >, 0);
+    g_assert_cmpint(cache->n_expired_obj, ==, 0);
+
+    req->clock_time = 100000;
+    req->obj_id = 1000;
+    cache->get(cache, req);
+    printf("%s: %ld objects expired\n", algos[i], (long)cache->n_expired_obj);
+    g_assert_cmpint(cache->get_n_obj(cache), ==, 1);
+    g_assert_cmpint(cache->n_expired_obj, ==, n_obj);
+    g_assert_cmpint(cache->n_expired_byte, ==, n_obj * 100);
+    cache->cache_free(cache);
+  }
+  free_request(req);
+}
+#endif
+
 int main(int argc, char *argv[]) {
   g_test_init(&argc, &argv, NULL);
   reader_t *reader;
@@ -228,9 +622,36 @@ int main(int argc, char *argv[]) {
   reader = setup_vscsi_reader();
   g_test_add_data_func_full("/libCacheSim/simulator_warmup2", reader, test_simulator_with_warmup2, test_teardown);
 
+  reader = setup_vscsi_reader();
+  g_test_add_data_func_full("/libCacheSim/simulator_branches_vscsi", reader, test_simulator_with_branches,
+                            test_teardown);
+
+  reader = setup_csv_reader_obj_num();
+  g_test_add_data_func_full("/libCacheSim/simulator_branches_csv", reader, test_simulator_with_branches,
+                            test_teardown);
+
+  reader = setup_vscsi_reader();
+  g_test_add_data_func_full("/libCacheSim/simulator_metrics", reader, test_simulator_with_metrics, test_teardown);
+
+  reader = setup_vscsi_reader();
+  g_test_add_data_func_full("/libCacheSim/simulator_sharded", reader, test_simulator_sharded, test_teardown);
+
+  reader = setup_vscsi_reader();
+  g_test_add_data_func_full("/libCacheSim/simulator_static_vscsi", reader, test_simulator_static, test_teardown);
+
+  reader = setup_csv_reader_obj_num();
+  g_test_add_data_func_full("/libCacheSim/simulator_static_csv", reader, test_simulator_static, test_teardown);
+
+  reader = setup_vscsi_reader();
+  g_test_add_data_func_full("/libCacheSim/simulator_cluster", reader, test_simulator_cluster, test_teardown);
+
+  reader = setup_vscsi_reader();
+  g_test_add_data_func_full("/libCacheSim/simulator_hierarchy", reader, test_simulator_hierarchy, test_teardown);
+
 #ifdef SUPPORT_TTL
   reader = setup_vscsi_reader();
   g_test_add_data_func_full("/libCacheSim/simulator_with_ttl", reader, test_simulator_with_ttl, test_teardown);
+  g_test_add_func("/libCacheSim/simulator_ttl_sub_cache", test_simulator_ttl_sub_cache);
 #endif
 
   return g_test_run();
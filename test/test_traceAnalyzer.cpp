@@ -0,0 +1,278 @@
+//
+// test the trace analyzer
+//
+
+#include <dirent.h>
+
+#include <fstream>
+
+#include "common.h"
+#include "../libCacheSim/traceAnalyzer/analyzer.h"
+#include "../libCacheSim/traceAnalyzer/popularitySketch.h"
+
+using namespace traceAnalyzer;
+
+static analysis_option_t all_options(void) {
+  analysis_option_t option = default_option();
+  option.req_rate = true;
+  option.access_pattern = true;
+  option.size = true;
+  option.reuse = true;
+  option.popularity = true;
+  option.ttl = true;
+  option.popularity_decay = true;
+  option.prob_at_age = true;
+  option.lifetime = true;
+  option.size_change = true;
+  return option;
+}
+
+/* run the analysis and return the stat string, the output files are written
+ * to dir */
+static std::string run_analyzer(const char *dir, const analysis_option_t &option, const analysis_param_t &param) {
+  reader_t *reader = setup_vscsi_reader();
+  std::string output_path = std::string(dir) + "/trace";
+  TraceAnalyzer *analyzer = new TraceAnalyzer(reader, output_path, option, param);
+  analyzer->run();
+
+  std::stringstream ss;
+  ss << *analyzer;
+  delete analyzer;
+  close_reader(reader);
+  return ss.str();
+}
+
+/* the content of an output file without the first line, which has the
+ * output path */
+static std::string read_file(const std::string &path) {
+  std::ifstream ifs(path);
+  g_assert_true(ifs.good());
+  std::string header;
+  std::getline(ifs, header);
+  std::stringstream ss;
+  ss << ifs.rdbuf();
+  return ss.str();
+}
+
+/* every output file in dir1 has the same content in dir2, the files are
+ * removed after comparison */
+static void assert_same_output(const char *dir1, const char *dir2) {
+  DIR *dir = opendir(dir1);
+  g_assert_true(dir != NULL);
+  int n_file = 0;
+  struct dirent *entry;
+  while ((entry = readdir(dir)) != NULL) {
+    if (entry->d_name[0] == '.') continue;
+    std::string path1 = std::string(dir1) + "/" + entry->d_name;
+    std::string path2 = std::string(dir2) + "/" + entry->d_name;
+    g_assert_cmpstr(read_file(path1).c_str(), ==, read_file(path2).c_str());
+    remove(path1.c_str());
+    remove(path2.c_str());
+    n_file += 1;
+  }
+  closedir(dir);
+  g_assert_cmpint(n_file, >, 0);
+}
+
+/**
+ * the modules consume the same requests in the same order with and without
+ * the pipeline, so the results must be the same
+ */
+static void test_analyzer_pipeline(gconstpointer user_data) {
+  char serial_dir[] = "/tmp/libCacheSim_test_analyzer_XXXXXX";
+  char pipeline_dir[] = "/tmp/libCacheSim_test_analyzer_XXXXXX";
+  g_assert_true(mkdtemp(serial_dir) != NULL);
+  g_assert_true(mkdtemp(pipeline_dir) != NULL);
+
+  analysis_option_t option = all_options();
+  analysis_param_t param = default_param();
+  param.warmup_time = 3600;
+  std::string serial_stat = run_analyzer(serial_dir, option, param);
+
+  param.pipeline = true;
+  /* a small batch so that the slots are recycled many times */
+  param.pipeline_batch_size = 64;
+  std::string pipeline_stat = run_analyzer(pipeline_dir, option, param);
+
+  g_assert_cmpstr(serial_stat.c_str(), ==, pipeline_stat.c_str());
+  assert_same_output(serial_dir, pipeline_dir);
+
+  rmdir(serial_dir);
+  rmdir(pipeline_dir);
+}
+
+static void remove_output(const char *dir_path) {
+  DIR *dir = opendir(dir_path);
+  g_assert_true(dir != NULL);
+  struct dirent *entry;
+  while ((entry = readdir(dir)) != NULL) {
+    if (entry->d_name[0] == '.') continue;
+    remove((std::string(dir_path) + "/" + entry->d_name).c_str());
+  }
+  closedir(dir);
+  rmdir(dir_path);
+}
+
+/* the first n lines of a file after the header line */
+static std::string read_lines(const std::string &path, int n) {
+  std::ifstream ifs(path);
+  g_assert_true(ifs.good());
+  std::string line, lines;
+  std::getline(ifs, line);
+  for (int i = 0; i < n && std::getline(ifs, line); i++) {
+    lines += line + "\n";
+  }
+  return lines;
+}
+
+/**
+ * the request-level modules consume every request when the object table is
+ * over the memory budget and samples objects, so the request rate and the
+ * byte rate are the same as without the budget
+ */
+static void test_analyzer_obj_sampling(gconstpointer user_data) {
+  char full_dir[] = "/tmp/libCacheSim_test_analyzer_XXXXXX";
+  char sampled_dir[] = "/tmp/libCacheSim_test_analyzer_XXXXXX";
+  g_assert_true(mkdtemp(full_dir) != NULL);
+  g_assert_true(mkdtemp(sampled_dir) != NULL);
+
+  analysis_option_t option = default_option();
+  option.req_rate = true;
+  option.reuse = true;
+  analysis_param_t param = default_param();
+  run_analyzer(full_dir, option, param);
+
+  param.obj_table_mem_budget = 64 * KiB;
+  run_analyzer(sampled_dir, option, param);
+
+  std::string file = "/trace.reqRate_w" + std::to_string(param.time_window);
+  /* the req rate and byte rate lines with their comments */
+  std::string full = read_lines(full_dir + file, 4);
+  std::string sampled = read_lines(sampled_dir + file, 4);
+  g_assert_cmpint(full.size(), >, 0);
+  g_assert_cmpstr(full.c_str(), ==, sampled.c_str());
+
+  remove_output(full_dir);
+  remove_output(sampled_dir);
+}
+
+/* the standard error of HyperLogLog with 2^14 registers is 0.8% */
+static void test_popularity_sketch_hll(gconstpointer user_data) {
+  request_t *req = new_request();
+  for (int64_t n_obj : {1000, 100000, 1000000}) {
+    PopularitySketch sketch(16);
+    for (int64_t i = 0; i < n_obj; i++) {
+      /* every object is requested twice */
+      req->obj_id = i;
+      sketch.add_req(req);
+      req->obj_id = n_obj - i - 1;
+      sketch.add_req(req);
+    }
+    double err = fabs((double)sketch.n_obj() - (double)n_obj) / (double)n_obj;
+    g_assert_cmpfloat(err, <, 0.03);
+  }
+  free_request(req);
+}
+
+/* object i (1 <= i <= 20) is requested 1000 - 20 * i times, interleaved with
+ * n_one_hit one-hit wonders whose ids start from first_one_hit_id */
+static std::vector<obj_id_t> skewed_stream(obj_id_t first_one_hit_id, int n_one_hit) {
+  std::vector<obj_id_t> stream;
+  obj_id_t one_hit_id = first_one_hit_id;
+  for (int round = 0; round < 1000; round++) {
+    for (int i = 1; i <= 20; i++) {
+      if (round < 1000 - 20 * i) stream.push_back(i);
+    }
+    for (int j = 0; j < n_one_hit / 1000; j++) {
+      stream.push_back(one_hit_id++);
+    }
+  }
+  return stream;
+}
+
+static void add_stream(PopularitySketch &sketch, const std::vector<obj_id_t> &stream) {
+  request_t *req = new_request();
+  for (obj_id_t obj_id : stream) {
+    req->obj_id = obj_id;
+    sketch.add_req(req);
+  }
+  free_request(req);
+}
+
+/* the top objects are found in the right order, and the true frequency is
+ * between count - error and count */
+static void test_popularity_sketch_top_k(gconstpointer user_data) {
+  std::vector<obj_id_t> stream = skewed_stream(1000000, 10000);
+  SpaceSaving top_k(256);
+  for (obj_id_t obj_id : stream) top_k.add(obj_id);
+
+  std::vector<SpaceSaving::entry> entries = top_k.sorted_entries();
+  g_assert_cmpint(entries.size(), ==, 256);
+  for (int i = 1; i <= 20; i++) {
+    const SpaceSaving::entry &e = entries[i - 1];
+    g_assert_cmpuint(e.obj_id, ==, i);
+    g_assert_cmpuint(e.count - e.error, <=, 1000 - 20 * i);
+    g_assert_cmpuint(e.count, >=, 1000 - 20 * i);
+  }
+  /* the objects not in the summary are requested at most min_count times */
+  g_assert_cmpuint(top_k.min_count(), >=, 1);
+  g_assert_cmpuint(top_k.min_count(), <, 1000 - 20 * 20);
+
+  PopularitySketch sketch(256);
+  add_stream(sketch, stream);
+  sketch.compute();
+  std::vector<uint64_t> &freq = sketch.get_sorted_freq();
+  g_assert_cmpint(freq.size(), ==, 256);
+  g_assert_cmpuint(freq[0], ==, entries[0].count);
+}
+
+/* merging the sketches of two streams gives the same number of objects and
+ * the same top objects as the sketch of the union of the streams */
+static void test_popularity_sketch_merge(gconstpointer user_data) {
+  std::vector<obj_id_t> stream1 = skewed_stream(1000000, 5000);
+  std::vector<obj_id_t> stream2 = skewed_stream(2000000, 5000);
+  PopularitySketch sketch1(256), sketch2(256), sketch_union(256);
+  add_stream(sketch1, stream1);
+  add_stream(sketch2, stream2);
+  add_stream(sketch_union, stream1);
+  add_stream(sketch_union, stream2);
+
+  /* merge a saved sketch */
+  char dir[] = "/tmp/libCacheSim_test_analyzer_XXXXXX";
+  g_assert_true(mkdtemp(dir) != NULL);
+  std::string path_base = std::string(dir) + "/sketch2";
+  sketch2.save(path_base);
+  PopularitySketch loaded;
+  g_assert_true(loaded.load(path_base + ".popularitySketch"));
+  sketch1.merge(loaded);
+  remove_output(dir);
+
+  /* HyperLogLog merge is lossless */
+  g_assert_cmpint(sketch1.n_obj(), ==, sketch_union.n_obj());
+
+  sketch1.compute();
+  sketch_union.compute();
+  std::vector<uint64_t> &freq_merged = sketch1.get_sorted_freq();
+  std::vector<uint64_t> &freq_union = sketch_union.get_sorted_freq();
+  g_assert_cmpint(freq_merged.size(), ==, freq_union.size());
+  /* the top objects are requested 2 * (1000 - 20 * i) times in the union,
+   * the counts of a summary of N requests overestimate by at most N / k */
+  for (int i = 1; i <= 20; i++) {
+    uint64_t freq = 2 * (1000 - 20 * i);
+    g_assert_cmpuint(freq_union[i - 1], >=, freq);
+    g_assert_cmpuint(freq_merged[i - 1], >=, freq);
+    g_assert_cmpuint(freq_merged[i - 1], <=, freq + (stream1.size() + stream2.size()) / 256);
+  }
+}
+
+int main(int argc, char *argv[]) {
+  g_test_init(&argc, &argv, NULL);
+
+  g_test_add_data_func("/libCacheSim/test_analyzer_pipeline", NULL, test_analyzer_pipeline);
+  g_test_add_data_func("/libCacheSim/test_analyzer_obj_sampling", NULL, test_analyzer_obj_sampling);
+  g_test_add_data_func("/libCacheSim/test_popularity_sketch_hll", NULL, test_popularity_sketch_hll);
+  g_test_add_data_func("/libCacheSim/test_popularity_sketch_top_k", NULL, test_popularity_sketch_top_k);
+  g_test_add_data_func("/libCacheSim/test_popularity_sketch_merge", NULL, test_popularity_sketch_merge);
+
+  return g_test_run();
+}
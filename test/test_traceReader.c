@@ -71,6 +71,49 @@ void test_reader_basic(gconstpointer user_data) {
   free_request(req);
 }
 
+void test_trace_meta(gconstpointer user_data) {
+  reader_t *reader = (reader_t *)user_data;
+  trace_meta_t meta, meta_loaded;
+
+  compute_trace_meta(reader, &meta);
+  g_assert_cmpint(meta.n_req, ==, trace_length);
+  g_assert_cmpint(meta.n_obj, >, 0);
+  g_assert_cmpint(meta.n_obj, <=, meta.n_req);
+  g_assert_cmpint(meta.n_obj_byte, <=, meta.n_req_byte);
+
+  int64_t n_obj_in_hist = 0;
+  for (int i = 0; i < TRACE_META_N_SIZE_BUCKET; i++) {
+    n_obj_in_hist += meta.obj_size_hist[i];
+  }
+  g_assert_cmpint(n_obj_in_hist, ==, meta.n_obj);
+
+  // the sidecar is reused by later readers of the same trace
+  g_assert_true(save_trace_meta(reader, &meta));
+  g_assert_true(load_trace_meta(reader, &meta_loaded));
+  g_assert_true(memcmp(&meta, &meta_loaded, sizeof(trace_meta_t)) == 0);
+
+  char meta_path[1024];
+  snprintf(meta_path, sizeof(meta_path), "%s.meta", reader->trace_path);
+  remove(meta_path);
+  g_assert_false(load_trace_meta(reader, &meta_loaded));
+
+  // counting the requests does not compute the object statistics
+  reader_t *reader_new = setup_reader(reader->trace_path, reader->trace_type, &reader->init_params);
+  g_assert_cmpint(get_num_of_req(reader_new), ==, trace_length);
+  g_assert_null(reader_new->trace_meta);
+
+  // the sidecar is only written with save_trace_meta, but the metadata is
+  // kept in memory for the later readers of the trace
+  g_assert_cmpint(get_trace_meta(reader_new)->n_obj, ==, meta.n_obj);
+  g_assert_false(load_trace_meta(reader_new, &meta_loaded));
+  close_reader(reader_new);
+
+  reader_new = setup_reader(reader->trace_path, reader->trace_type, &reader->init_params);
+  g_assert_nonnull(find_trace_meta(reader_new));
+  g_assert_cmpint(find_trace_meta(reader_new)->n_obj, ==, meta.n_obj);
+  close_reader(reader_new);
+}
+
 void test_reader_more1(gconstpointer user_data) {
   reader_t *reader = (reader_t *)user_data;
   size_t i;
@@ -128,6 +171,59 @@ void test_reader_more2(gconstpointer user_data) {
   close_reader(cloned_reader);
 }
 
+void test_synthetic(gconstpointer user_data) {
+  const char *spec = "zipf:alpha=0.8,n_obj=1000,weight=3;loop:n_obj=100;scan;n_req=20000,seed=42";
+  const int64_t n_req = 20000;
+  reader_t *reader = setup_reader(spec, SYNTHETIC_TRACE, NULL);
+  g_assert_cmpint(get_num_of_req(reader), ==, n_req);
+
+  request_t *req = new_request();
+  obj_id_t *obj_ids = malloc(sizeof(obj_id_t) * n_req);
+  int64_t n_req_per_tenant[3] = {0}, n_read = 0;
+  obj_id_t last_loop_id = 0, last_scan_id = 0;
+  while (read_one_req(reader, req) == 0) {
+    g_assert_cmpint(req->tenant_id, <, 3);
+    g_assert_cmpint(req->obj_size, ==, 4096);
+    n_req_per_tenant[req->tenant_id]++;
+    if (req->tenant_id == 1) {
+      // loop is sequential
+      if (last_loop_id != 0) g_assert_cmpint((last_loop_id + 1) % 100, ==, req->obj_id % 100);
+      last_loop_id = req->obj_id;
+    } else if (req->tenant_id == 2) {
+      // scan never repeats
+      g_assert_cmpint(req->obj_id, >, last_scan_id);
+      last_scan_id = req->obj_id;
+    }
+    obj_ids[n_read++] = req->obj_id;
+  }
+  g_assert_cmpint(n_read, ==, n_req);
+  // the requests are split by weight
+  g_assert_cmpint(n_req_per_tenant[0], >, n_req * 0.55);
+  g_assert_cmpint(n_req_per_tenant[0], <, n_req * 0.65);
+
+  // the requests are deterministic after reset, clone and seeking
+  reset_reader(reader);
+  g_assert_cmpint(skip_n_req(reader, 100), ==, 100);
+  read_one_req(reader, req);
+  g_assert_cmpint(req->obj_id, ==, obj_ids[100]);
+  go_back_two_req(reader);
+  read_one_req(reader, req);
+  g_assert_cmpint(req->obj_id, ==, obj_ids[99]);
+  read_last_req(reader, req);
+  g_assert_cmpint(req->obj_id, ==, obj_ids[n_req - 1]);
+
+  reader_t *cloned_reader = clone_reader(reader);
+  for (int i = 0; i < 1000; i++) {
+    read_one_req(cloned_reader, req);
+    g_assert_cmpint(req->obj_id, ==, obj_ids[i]);
+  }
+  close_reader(cloned_reader);
+
+  free(obj_ids);
+  free_request(req);
+  close_reader(reader);
+}
+
 void test_twr(gconstpointer user_data) {
   reader_t *reader = setup_reader("/Users/junchengy/twr.sbin", TWR_TRACE, NULL);
   gint64 n_req = get_num_of_req(reader);
@@ -160,6 +256,7 @@ int main(int argc, char *argv[]) {
   reader = setup_csv_reader_obj_num();
   g_test_add_data_func("/libCacheSim/reader_basic_csv_num", reader, test_reader_basic);
   g_test_add_data_func("/libCacheSim/reader_more1_csv_num", reader, test_reader_more1);
+  g_test_add_data_func("/libCacheSim/trace_meta_csv_num", reader, test_trace_meta);
   g_test_add_data_func_full("/libCacheSim/reader_more2_csv_num", reader, test_reader_more2, test_teardown);
 
   reader = setup_csv_reader_obj_str();
@@ -182,6 +279,8 @@ int main(int argc, char *argv[]) {
   g_test_add_data_func("/libCacheSim/reader_more1_oracleGeneral", reader, test_reader_more1);
   g_test_add_data_func_full("/libCacheSim/reader_more2_oracleGeneral", reader, test_reader_more2, test_teardown);
 
+  g_test_add_data_func("/libCacheSim/reader_synthetic", NULL, test_synthetic);
+
   // g_test_add_data_func("/libCacheSim/test_twr", NULL, test_twr);
   return g_test_run();
 }
\ No newline at end of file